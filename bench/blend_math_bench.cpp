@@ -0,0 +1,59 @@
+// Benchmark: division-free mul8()/div255() vs the integer division forms (mul8_ref/div255_ref).
+// Every pass walks all 65536 (a, b) / (p, A) pairs; results are checked for bit-exactness first.
+//
+// Build: meson setup builddir && meson compile -C builddir && ./builddir/blend_math_bench
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include "../src/color_rgba.hpp"
+
+namespace {
+
+constexpr int cPasses = 200;
+
+// Keeps the compiler from folding loops over constant inputs.
+volatile uint8_t gSeed = 0;
+
+template <typename Fn>
+double nsPerOp(Fn fn, uint32_t& checksum) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < cPasses; ++pass) {
+        const uint8_t seed = gSeed;
+        for (uint32_t x = 0; x < 256; ++x) {
+            for (uint32_t y = 0; y < 256; ++y) {
+                checksum += fn(static_cast<uint8_t>(x ^ seed), static_cast<uint8_t>(y));
+            }
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return ns / (static_cast<double>(cPasses) * 65536.0);
+}
+
+} // namespace
+
+int main() {
+    int mismatches = 0;
+    for (uint32_t x = 0; x < 256; ++x) {
+        for (uint32_t y = 0; y < 256; ++y) {
+            mismatches += amp::mul8(uint8_t(x), uint8_t(y)) != amp::mul8_ref(uint8_t(x), uint8_t(y));
+            mismatches += amp::div255(uint16_t(y), uint8_t(x)) != amp::div255_ref(uint16_t(y), uint8_t(x));
+        }
+    }
+    if (mismatches != 0) {
+        std::printf("FAILED: %d mismatches\n", mismatches);
+        return 1;
+    }
+
+    uint32_t checksum = 0;
+    const double mulRef = nsPerOp([](uint8_t a, uint8_t b) { return amp::mul8_ref(a, b); }, checksum);
+    const double mulFast = nsPerOp([](uint8_t a, uint8_t b) { return amp::mul8(a, b); }, checksum);
+    const double divRef = nsPerOp([](uint8_t A, uint8_t p) { return amp::div255_ref(p, A); }, checksum);
+    const double divFast = nsPerOp([](uint8_t A, uint8_t p) { return amp::div255(p, A); }, checksum);
+
+    std::printf("AMP_FAST_DIV255=%d, %d passes x 65536 pairs (exact: yes)\n", AMP_FAST_DIV255, cPasses);
+    std::printf("mul8   : division %.3f ns/op, fast %.3f ns/op (x%.2f)\n", mulRef, mulFast, mulRef / mulFast);
+    std::printf("div255 : division %.3f ns/op, fast %.3f ns/op (x%.2f)\n", divRef, divFast, divRef / divFast);
+    std::printf("checksum %u\n", static_cast<unsigned>(checksum));
+    return 0;
+}
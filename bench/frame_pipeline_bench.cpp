@@ -0,0 +1,94 @@
+// Benchmark: csMatrixSFXSystem frame pipeline (csFramePipeline Sync / Double / Triple).
+// A plasma + flame stack on a 128x64 canvas; the output stage converts the frame to RGB bytes and
+// then blocks for a fixed time, like FastLED.show() on a long strip or a network send.
+// Sync pays render + output per frame; Double and Triple overlap them (throughput ~ max of the two).
+// Triple never waits for the output: frames the output could not take in time are dropped.
+//
+// Build: meson setup builddir && meson compile -C builddir && ./builddir/frame_pipeline_bench
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <initializer_list>
+#include <thread>
+#include <vector>
+#include "../src/matrix_sfx_system.hpp"
+#include "../src/render_efffects.hpp"
+
+namespace {
+
+using amp::csFramePipeline;
+
+constexpr int cFrames = 120;
+constexpr amp::tMatrixPixelsSize cWidth = 128;
+constexpr amp::tMatrixPixelsSize cHeight = 64;
+
+uint32_t gChecksum = 0;
+
+class csBlockingOutput : public amp::csFrameOutput {
+public:
+    explicit csBlockingOutput(int blockUs) : blockUs_(blockUs), rgb_(size_t(cWidth) * cHeight * 3) {}
+
+    void outputFrame(const amp::csMatrixPixels& frame, const amp::csRect& /*dirty*/) override {
+        size_t i = 0;
+        for (amp::tMatrixPixelsCoord y = 0; y < amp::to_coord(frame.height()); ++y) {
+            for (amp::tMatrixPixelsCoord x = 0; x < amp::to_coord(frame.width()); ++x) {
+                const amp::csColorRGBA c = frame.getPixel(x, y);
+                rgb_[i++] = c.r;
+                rgb_[i++] = c.g;
+                rgb_[i++] = c.b;
+            }
+        }
+        gChecksum += rgb_[rgb_.size() / 2];
+        std::this_thread::sleep_for(std::chrono::microseconds(blockUs_));
+    }
+
+private:
+    int blockUs_;
+    std::vector<uint8_t> rgb_;
+};
+
+const char* modeName(csFramePipeline mode) {
+    switch (mode) {
+        case csFramePipeline::Double:
+            return "double";
+        case csFramePipeline::Triple:
+            return "triple";
+        default:
+            return "sync";
+    }
+}
+
+void run(csFramePipeline mode, int blockUs) {
+    csBlockingOutput output{blockUs};
+    amp::csMatrixSFXSystem sfx{cWidth, cHeight};
+    sfx.effectManager->add(new amp::csRenderPlasma());
+    sfx.effectManager->add(new amp::csRenderFlame());
+    sfx.setFrameOutput(&output, mode);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < cFrames; ++frame) {
+        sfx.internalMatrix->clear();
+        sfx.recalcAndRender(static_cast<amp::tTime>(frame * 16));
+    }
+    sfx.flushFrameOutput();
+    const auto end = std::chrono::steady_clock::now();
+
+    const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    const amp::csFramePresenterStats st = sfx.presenter->stats();
+    std::printf("output %5d us, %-6s %8.1f frames/s, sent %3u, dropped %3u, waits %3u\n", blockUs, modeName(mode),
+                cFrames * 1000.0 / ms, static_cast<unsigned>(st.output), static_cast<unsigned>(st.dropped),
+                static_cast<unsigned>(st.waits));
+}
+
+} // namespace
+
+int main() {
+    std::printf("%ux%u canvas, %d frames\n", static_cast<unsigned>(cWidth), static_cast<unsigned>(cHeight), cFrames);
+    for (int blockUs : {500, 2000, 8000}) {
+        for (csFramePipeline mode : {csFramePipeline::Sync, csFramePipeline::Double, csFramePipeline::Triple}) {
+            run(mode, blockUs);
+        }
+    }
+    std::printf("checksum %u\n", static_cast<unsigned>(gChecksum));
+    return 0;
+}
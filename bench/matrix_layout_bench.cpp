@@ -0,0 +1,128 @@
+// Benchmark: csMatrixLayout::RowMajor vs Tiled8x8 on 512x512 and 2048x2048 canvases.
+// Row-wise work (fill, blit) favors RowMajor (long spans). Column walks and vertical neighborhoods
+// (column remaps, upward diffusion) favor Tiled8x8 once a canvas no longer fits the CPU caches;
+// on a cache-resident 512x512 canvas the hardware prefetcher hides row-major strides.
+//
+// Build: meson setup builddir && meson compile -C builddir && ./builddir/matrix_layout_bench
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <initializer_list>
+#include "../src/matrix_bytes.hpp"
+#include "../src/matrix_pixels.hpp"
+#include "../src/matrix_utils.hpp"
+
+namespace {
+
+using amp::csColorRGBA;
+using amp::csMatrixBytes;
+using amp::csMatrixLayout;
+using amp::csMatrixPixels;
+using amp::csRect;
+using amp::tMatrixPixelsCoord;
+
+constexpr int cPasses = 20;
+
+uint32_t gChecksum = 0;
+
+template <typename Fn>
+double msPerPass(Fn fn) {
+    fn(); // warm-up
+    const auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < cPasses; ++pass) {
+        fn();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / cPasses;
+}
+
+void fillSource(csMatrixPixels& m) {
+    const tMatrixPixelsCoord cSize = amp::to_coord(m.width());
+    for (tMatrixPixelsCoord y = 0; y < cSize; ++y) {
+        for (tMatrixPixelsCoord x = 0; x < cSize; ++x) {
+            const uint8_t v = static_cast<uint8_t>(x * 7 + y * 13);
+            m.setPixelRewrite(x, y, csColorRGBA{static_cast<uint8_t>(128 + (v >> 1)), v, static_cast<uint8_t>(~v), 40});
+        }
+    }
+}
+
+void report(const char* name, double rowMajor, double tiled) {
+    std::printf("%-28s row-major %8.3f ms, tiled %8.3f ms (tiled x%.2f)\n", name, rowMajor, tiled, rowMajor / tiled);
+}
+
+void runPixels(amp::tMatrixPixelsSize cSize) {
+    csMatrixPixels srcRows{cSize, cSize};
+    csMatrixPixels srcTiles{cSize, cSize, csMatrixLayout::Tiled8x8};
+    fillSource(srcRows);
+    fillSource(srcTiles);
+    csMatrixPixels dstRows{cSize, cSize};
+    csMatrixPixels dstTiles{cSize, cSize, csMatrixLayout::Tiled8x8};
+
+    auto columnWalk = [cSize](const csMatrixPixels& m) {
+        return [&m, cSize]() {
+            uint32_t sum = 0;
+            for (tMatrixPixelsCoord x = 0; x < cSize; ++x) {
+                for (tMatrixPixelsCoord y = 0; y < cSize; ++y) {
+                    sum += m.getPixel(x, y).value;
+                }
+            }
+            gChecksum += sum;
+        };
+    };
+    report("column walk (getPixel)", msPerPass(columnWalk(srcRows)), msPerPass(columnWalk(srcTiles)));
+
+    auto fill = [](csMatrixPixels& m) {
+        return [&m]() { amp::matrix_utils::fillArea(m, m.getRect(), csColorRGBA{200, 1, 2, 3}); };
+    };
+    report("fillArea (rows)", msPerPass(fill(dstRows)), msPerPass(fill(dstTiles)));
+
+    auto blit = [](csMatrixPixels& dst, const csMatrixPixels& src) {
+        return [&dst, &src]() { amp::matrix_utils::drawMatrix(dst, 0, 0, src, 200); };
+    };
+    report("drawMatrix (row blend)", msPerPass(blit(dstRows, srcRows)), msPerPass(blit(dstTiles, srcTiles)));
+
+    auto scale = [cSize](csMatrixPixels& dst, const csMatrixPixels& src) {
+        return [&dst, &src, cSize]() {
+            (void)amp::matrix_utils::drawMatrixScale(dst, csRect{0, 0, cSize, cSize}, csRect{0, 0, static_cast<amp::tMatrixPixelsSize>(cSize / 3), static_cast<amp::tMatrixPixelsSize>(cSize / 3)}, src);
+        };
+    };
+    report("drawMatrixScale 3:1", msPerPass(scale(dstRows, srcRows)), msPerPass(scale(dstTiles, srcTiles)));
+}
+
+void runBytes(amp::tMatrixPixelsSize cSize) {
+    csMatrixBytes rows{cSize, cSize};
+    csMatrixBytes tiles{cSize, cSize, 0, csMatrixLayout::Tiled8x8};
+    for (csMatrixBytes* m : {&rows, &tiles}) {
+        for (tMatrixPixelsCoord y = 0; y < cSize; ++y) {
+            for (tMatrixPixelsCoord x = 0; x < cSize; ++x) {
+                m->setValue(x, y, static_cast<uint8_t>(x ^ y));
+            }
+        }
+    }
+
+    // Upward diffusion in the style of the flame heat update: each cell reads three cells below.
+    auto diffuse = [cSize](csMatrixBytes& m) {
+        return [&m, cSize]() {
+            for (tMatrixPixelsCoord x = 0; x < cSize; ++x) {
+                for (tMatrixPixelsCoord y = 0; y < cSize - 2; ++y) {
+                    const uint16_t v = static_cast<uint16_t>(m.getValue(x, y + 1) + m.getValue(x, y + 2) * 2 + m.getValue(x + 1, y + 1));
+                    m.setValue(x, y, static_cast<uint8_t>(v >> 2));
+                }
+            }
+            gChecksum += m.getValue(7, 7);
+        };
+    };
+    report("bytes upward diffusion", msPerPass(diffuse(rows)), msPerPass(diffuse(tiles)));
+}
+
+} // namespace
+
+int main() {
+    for (amp::tMatrixPixelsSize size : {amp::tMatrixPixelsSize{512}, amp::tMatrixPixelsSize{2048}}) {
+        std::printf("%ux%u canvas, %d passes\n", static_cast<unsigned>(size), static_cast<unsigned>(size), cPasses);
+        runPixels(size);
+        runBytes(size);
+    }
+    std::printf("checksum %u\n", static_cast<unsigned>(gChecksum));
+    return 0;
+}
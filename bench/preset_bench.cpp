@@ -0,0 +1,237 @@
+// Benchmark: every loadEffectPreset() id on 8x8 .. 256x256 canvases (headless, no SDL).
+// Each run renders a fixed number of frames with a fixed seed and a fixed 16 ms time step, so the
+// checksum of the last frame is reproducible; the best of several runs is reported.
+// Output is JSON (one result object per line) on stdout or in --out; with --baseline the results
+// are compared with a saved output and slower ones (over --threshold percent) fail the run.
+//
+// Build: meson setup builddir && meson compile -C builddir
+// Usage: ./builddir/preset_bench [--frames N] [--repeats N] [--out file.json]
+//                                [--baseline file.json] [--threshold pct]
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../src/effect_presets.hpp"
+#include "../src/matrix_sfx_system.hpp"
+
+namespace {
+
+constexpr amp::tMatrixPixelsSize cSizes[] = {8, 16, 32, 64, 256};
+constexpr amp::tTime cFrameStepMs = 16;
+constexpr int cWarmupFrames = 2;
+
+struct Options {
+    int frames = 100;
+    int repeats = 3;
+    const char* out = nullptr;
+    const char* baseline = nullptr;
+    double thresholdPct = 10.0;
+};
+
+struct Result {
+    unsigned id;
+    unsigned width;
+    unsigned height;
+    std::string name;
+    double nsPerFrame;
+    double nsPerPixel;
+    uint32_t checksum;
+};
+
+struct BaselineEntry {
+    unsigned id;
+    unsigned width;
+    unsigned height;
+    double nsPerFrame;
+    uint32_t checksum;
+};
+
+uint32_t frameChecksum(const amp::csMatrixPixels& m) {
+    uint32_t sum = 2166136261u; // FNV-1a over the pixel values
+    for (amp::tMatrixPixelsCoord y = 0; y < amp::to_coord(m.height()); ++y) {
+        for (amp::tMatrixPixelsCoord x = 0; x < amp::to_coord(m.width()); ++x) {
+            sum = (sum ^ m.getPixel(x, y).value) * 16777619u;
+        }
+    }
+    return sum;
+}
+
+// One run of preset 'id': returns ns per timed frame, 'checksum' of the last frame.
+double runPreset(uint8_t id, amp::tMatrixPixelsSize size, int frames, uint32_t& checksum) {
+    amp::csMatrixSFXSystem sfx{size, size};
+    amp::csMatrixPixels secondBuffer{size, size};
+    loadEffectPreset(*sfx.effectManager, id, &secondBuffer);
+    amp::tTime t = 0;
+    auto frame = [&]() {
+        sfx.internalMatrix->clear();
+        sfx.recalcAndRender(t);
+        t = static_cast<amp::tTime>(t + cFrameStepMs);
+    };
+    for (int i = 0; i < cWarmupFrames; ++i) {
+        frame();
+    }
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        frame();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    checksum = frameChecksum(*sfx.internalMatrix);
+    return std::chrono::duration<double, std::nano>(end - start).count() / frames;
+}
+
+std::string jsonEscape(const char* s) {
+    std::string r;
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') {
+            r += '\\';
+        }
+        r += *s;
+    }
+    return r;
+}
+
+// Reads the result lines written by printResults() (keys in fixed order, one object per line).
+bool loadBaseline(const char* path, std::vector<BaselineEntry>& entries) {
+    FILE* f = std::fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+    char line[512];
+    while (std::fgets(line, sizeof(line), f)) {
+        BaselineEntry e{};
+        const char* ns = std::strstr(line, "\"ns_per_frame\": ");
+        const char* sum = std::strstr(line, "\"checksum\": ");
+        if (std::sscanf(line, " {\"id\": %u, \"width\": %u, \"height\": %u,", &e.id, &e.width, &e.height) != 3 ||
+            !ns || !sum) {
+            continue;
+        }
+        e.nsPerFrame = std::strtod(ns + std::strlen("\"ns_per_frame\": "), nullptr);
+        e.checksum = static_cast<uint32_t>(std::strtoul(sum + std::strlen("\"checksum\": "), nullptr, 10));
+        entries.push_back(e);
+    }
+    std::fclose(f);
+    return true;
+}
+
+const BaselineEntry* findBaseline(const std::vector<BaselineEntry>& entries, const Result& r) {
+    for (const BaselineEntry& e : entries) {
+        if (e.id == r.id && e.width == r.width && e.height == r.height) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+// Returns the number of regressions (0 without a baseline).
+int printResults(FILE* out, const Options& opt, const std::vector<Result>& results,
+                 const std::vector<BaselineEntry>* baseline) {
+    int regressions = 0;
+    int changedOutput = 0;
+    std::fprintf(out, "{\"frames\": %d, \"repeats\": %d, \"frame_step_ms\": %u, \"results\": [\n", opt.frames,
+                 opt.repeats, static_cast<unsigned>(cFrameStepMs));
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(out,
+                     "  {\"id\": %u, \"width\": %u, \"height\": %u, \"name\": \"%s\", \"ns_per_frame\": %.1f, "
+                     "\"ns_per_pixel\": %.3f, \"checksum\": %u",
+                     r.id, r.width, r.height, jsonEscape(r.name.c_str()).c_str(), r.nsPerFrame, r.nsPerPixel,
+                     static_cast<unsigned>(r.checksum));
+        const BaselineEntry* b = baseline ? findBaseline(*baseline, r) : nullptr;
+        if (b && b->nsPerFrame > 0) {
+            const double changePct = (r.nsPerFrame / b->nsPerFrame - 1.0) * 100.0;
+            const bool regression = changePct > opt.thresholdPct;
+            const bool outputChanged = b->checksum != r.checksum;
+            regressions += regression ? 1 : 0;
+            changedOutput += outputChanged ? 1 : 0;
+            std::fprintf(out,
+                         ", \"baseline_ns_per_frame\": %.1f, \"change_pct\": %.1f, \"regression\": %s, "
+                         "\"output_changed\": %s",
+                         b->nsPerFrame, changePct, regression ? "true" : "false", outputChanged ? "true" : "false");
+        }
+        std::fprintf(out, "}%s\n", (i + 1 < results.size()) ? "," : "");
+    }
+    std::fprintf(out, "]");
+    if (baseline) {
+        std::fprintf(out, ", \"threshold_pct\": %.1f, \"regressions\": %d, \"output_changed\": %d", opt.thresholdPct,
+                     regressions, changedOutput);
+    }
+    std::fprintf(out, "}\n");
+    return regressions;
+}
+
+bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (hasValue && std::strcmp(argv[i], "--frames") == 0) {
+            opt.frames = std::atoi(argv[++i]);
+        } else if (hasValue && std::strcmp(argv[i], "--repeats") == 0) {
+            opt.repeats = std::atoi(argv[++i]);
+        } else if (hasValue && std::strcmp(argv[i], "--out") == 0) {
+            opt.out = argv[++i];
+        } else if (hasValue && std::strcmp(argv[i], "--baseline") == 0) {
+            opt.baseline = argv[++i];
+        } else if (hasValue && std::strcmp(argv[i], "--threshold") == 0) {
+            opt.thresholdPct = std::atof(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    return opt.frames > 0 && opt.repeats > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) {
+        std::fprintf(stderr,
+                     "usage: %s [--frames N] [--repeats N] [--out file.json] [--baseline file.json] "
+                     "[--threshold pct]\n",
+                     argv[0]);
+        return 2;
+    }
+    std::vector<BaselineEntry> baseline;
+    if (opt.baseline && !loadBaseline(opt.baseline, baseline)) {
+        std::fprintf(stderr, "cannot read baseline %s\n", opt.baseline);
+        return 2;
+    }
+
+    std::vector<Result> results;
+    for (unsigned id = 1; id <= UINT8_MAX; ++id) {
+        amp::csEffectManager names;
+        amp::tProgmemStrPtr name = nullptr;
+        loadEffectPreset(names, static_cast<uint8_t>(id), nullptr, &name, true);
+        if (!name || name[0] == '\0') {
+            continue; // not a preset id
+        }
+        for (amp::tMatrixPixelsSize size : cSizes) {
+            double best = 0;
+            uint32_t checksum = 0;
+            for (int rep = 0; rep < opt.repeats; ++rep) {
+                const double ns = runPreset(static_cast<uint8_t>(id), size, opt.frames, checksum);
+                best = (rep == 0 || ns < best) ? ns : best;
+            }
+            const double pixels = static_cast<double>(size) * size;
+            results.push_back(Result{id, size, size, name, best, best / pixels, checksum});
+        }
+    }
+
+    FILE* out = opt.out ? std::fopen(opt.out, "w") : stdout;
+    if (!out) {
+        std::fprintf(stderr, "cannot write %s\n", opt.out);
+        return 2;
+    }
+    const int regressions = printResults(out, opt, results, opt.baseline ? &baseline : nullptr);
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    if (regressions > 0) {
+        std::fprintf(stderr, "%d result(s) slower than the baseline by more than %.1f%%\n", regressions,
+                     opt.thresholdPct);
+        return 1;
+    }
+    return 0;
+}
@@ -65,6 +65,9 @@ void setup() {
 #ifdef ALPHAMATRIX_SINGLE_EFFECT_FLAME
     tFlameSparkingSwitch.start();  // Start 10 s flame sparking switch timer
 #endif
+    // Track changed 8x8 tiles: output below copies (and shows) only what changed.
+    sfxSystem.internalMatrix->setDirtyTracking(true);
+
     loadEffectByIndexLocal(*sfxSystem.effectManager, effectIndex);
 }
 
@@ -115,8 +118,12 @@ void loop() {
         // Update and render all effects
         sfxSystem.recalcAndRender(currTime);
 
-        amp::copyMatrixToFastLED(*sfxSystem.internalMatrix, leds, cNumLeds, amp::csMappingPattern::SerpentineHorizontalInverted);
-        FastLED.show();
+        // Static frame: LEDs already hold this picture.
+        if (!sfxSystem.effectManager->getDirtyRect().empty()) {
+            amp::copyMatrixToFastLED(*sfxSystem.internalMatrix, leds, cNumLeds,
+                                     amp::csMappingPattern::SerpentineHorizontalInverted, nullptr, true);
+            FastLED.show();
+        }
         
         tRender.start();  // Restart timer with default time
     }
@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""
+Generate the reciprocal table used by the division-free div255() (src/div255_lut.hpp).
+
+Usage:
+  python scripts/gen_div255_lut.py > src/div255_lut.hpp
+
+Notes:
+- Entry A is ceil(255 * 65536 / A); entry 0 is 0 (div255(p, 0) == 0).
+- div255(p, A) == (p * m + c) >> 16 with m = table[A] and the rounding bias
+  c = 32768 for even A, c = 32768 - (m >> 9) for odd A.
+  The script checks this against (p * 255 + A / 2) / A for all p, A in 0..255.
+"""
+
+from __future__ import annotations
+
+import sys
+from typing import List
+
+
+def build_recip_lut() -> List[int]:
+    out: List[int] = [0]
+    for a in range(1, 256):
+        out.append(-(-255 * 65536 // a))
+    return out
+
+
+def div255_ref(p: int, a: int) -> int:
+    return 0 if a == 0 else ((p * 255 + a // 2) // a) & 0xFF
+
+
+def div255_lut(values: List[int], p: int, a: int) -> int:
+    m = values[a]
+    c = 32768 - (m >> 9) if (a & 1) else 32768
+    t = p * m + c
+    assert t < (1 << 32), 'product must fit uint32_t'
+    return (t >> 16) & 0xFF
+
+
+def verify(values: List[int]) -> None:
+    for a in range(256):
+        for p in range(256):
+            if div255_lut(values, p, a) != div255_ref(p, a):
+                raise SystemExit(f'mismatch: p={p} A={a}')
+
+
+def emit_header(values: List[int]) -> str:
+    lines = [
+        '#pragma once',
+        '',
+        '#include <stdint.h>',
+        '#include "amp_macros.hpp"',
+        '',
+        '// Reciprocal table for the division-free div255() (see color_rgba.hpp), stored in flash memory.',
+        '// Entry A = ceil(255 * 65536 / A), entry 0 = 0.',
+        '//',
+        '// Generated by `scripts/gen_div255_lut.py` (the script also verifies exactness).',
+        '// IMPORTANT: keep it in PROGMEM (Flash), not RAM.',
+        'static const uint32_t PROGMEM amp_div255_recip[256] = {',
+    ]
+    for row in range(0, 256, 8):
+        chunk = values[row : row + 8]
+        lines.append('    ' + ', '.join(f'{v:8d}u' for v in chunk) + ',')
+    lines.append('};')
+    return '\n'.join(lines)
+
+
+def main() -> int:
+    values = build_recip_lut()
+    verify(values)
+    sys.stdout.write(emit_header(values) + '\n')
+    return 0
+
+
+if __name__ == '__main__':
+    raise SystemExit(main())
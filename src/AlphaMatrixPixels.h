@@ -15,6 +15,10 @@
 // Matrix classes
 #include "matrix_pixels.hpp"
 #include "matrix_boolean.hpp"
+#include "matrix_views.hpp"
+#include "matrix_buffer_pool.hpp"
+#include "matrix_rgb.hpp"
+#include "matrix_pixels16.hpp"
 
 // Rendering
 #include "render_base.hpp"
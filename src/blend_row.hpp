@@ -0,0 +1,567 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "color_rgba.hpp"
+
+// Enable SIMD row kernels by default on host builds; Arduino targets use the scalar path.
+// Define AMP_ENABLE_SIMD to 0 to force the scalar fallback everywhere.
+#ifndef AMP_ENABLE_SIMD
+#  if defined(ARDUINO)
+#    define AMP_ENABLE_SIMD 0
+#  else
+#    define AMP_ENABLE_SIMD 1
+#  endif
+#endif
+
+#if AMP_ENABLE_SIMD && defined(__AVX2__)
+#  define AMP_BLEND_ROW_AVX2 1
+#  include <immintrin.h>
+#elif AMP_ENABLE_SIMD && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#  define AMP_BLEND_ROW_SSE2 1
+#  include <emmintrin.h>
+#elif AMP_ENABLE_SIMD && defined(__ARM_NEON) && defined(__aarch64__)
+// NEON path needs a float vector divide (AArch64 only); 32-bit ARM NEON uses the scalar path.
+#  define AMP_BLEND_ROW_NEON 1
+#  include <arm_neon.h>
+#endif
+
+namespace amp {
+
+using ::size_t;
+using ::uint8_t;
+
+// Row blend kernels: SourceOver (straight alpha) over runs of csColorRGBA.
+// All paths are bit-exact with csColorRGBA::sourceOverStraight(dst, src, globalAlpha).
+//
+// SIMD notes:
+// - mul8() is exact in 16-bit lanes: t = a*b + 127, t/255 == (t + 1 + (t >> 8)) >> 8 for t < 65535.
+// - div255(p, A) is computed as trunc(float(p*255 + A/2) / float(A)). The quotient is < 256 and
+//   its distance to the next integer is >= 1/255, far above float rounding error, so truncation is exact.
+// - out_p <= Aout always holds, so Aout == 0 gives p == 0 and the division by max(A, 1) yields 0.
+namespace blend_row_detail {
+
+// Scalar reference loop (also used for tails of SIMD paths).
+inline void blendRowScalar(csColorRGBA* out, const csColorRGBA* under, const csColorRGBA* over,
+                           size_t n, uint8_t globalAlpha) noexcept {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = csColorRGBA::sourceOverStraight(under[i], over[i], globalAlpha);
+    }
+}
+
+// SourceOver of one constant color over a run: source terms are computed once per call.
+inline void fillRowBlendScalar(csColorRGBA* dst, size_t n, csColorRGBA color) noexcept {
+    const uint8_t As = color.a;
+    const uint8_t invAs = static_cast<uint8_t>(255u - As);
+    const uint16_t srcR = mul8(color.r, As);
+    const uint16_t srcG = mul8(color.g, As);
+    const uint16_t srcB = mul8(color.b, As);
+    for (size_t i = 0; i < n; ++i) {
+        const csColorRGBA d = dst[i];
+        const uint8_t Aout = static_cast<uint8_t>(As + mul8(d.a, invAs));
+        if (Aout == 0) {
+            dst[i] = csColorRGBA{0, 0, 0, 0};
+            continue;
+        }
+        dst[i] = csColorRGBA{
+            Aout,
+            div255(static_cast<uint16_t>(srcR + mul8(mul8(d.r, d.a), invAs)), Aout),
+            div255(static_cast<uint16_t>(srcG + mul8(mul8(d.g, d.a), invAs)), Aout),
+            div255(static_cast<uint16_t>(srcB + mul8(mul8(d.b, d.a), invAs)), Aout)
+        };
+    }
+}
+
+#if defined(AMP_BLEND_ROW_SSE2) || defined(AMP_BLEND_ROW_AVX2)
+
+// Lane-wise helpers for 16-bit lanes holding 0..255 values (4 lanes per pixel: a, r, g, b).
+#if defined(AMP_BLEND_ROW_AVX2)
+using tVec = __m256i;
+static constexpr size_t cPixelsPerStep = 8;
+#define AMP_BR(op) _mm256_##op
+#define AMP_BR_SI(op) _mm256_##op##_si256
+using tVecF = __m256;
+#else
+using tVec = __m128i;
+static constexpr size_t cPixelsPerStep = 4;
+#define AMP_BR(op) _mm_##op
+#define AMP_BR_SI(op) _mm_##op##_si128
+using tVecF = __m128;
+#endif
+
+// mul8(a, b) for 16-bit lanes.
+inline tVec mul8x(tVec a, tVec b) noexcept {
+    const tVec t = AMP_BR(add_epi16)(AMP_BR(mullo_epi16)(a, b), AMP_BR(set1_epi16)(127));
+    const tVec t1 = AMP_BR(add_epi16)(t, AMP_BR(set1_epi16)(1));
+    return AMP_BR(srli_epi16)(AMP_BR(add_epi16)(t1, AMP_BR(srli_epi16)(t, 8)), 8);
+}
+
+// Broadcast per-pixel alpha (lane 0 of each 4-lane group) to all 4 lanes.
+inline tVec splatAlpha(tVec v) noexcept {
+    return AMP_BR(shufflehi_epi16)(AMP_BR(shufflelo_epi16)(v, 0x00), 0x00);
+}
+
+// trunc(num / den) for 16-bit lanes, computed in float (see exactness note above).
+inline tVec divLanes(tVec num, tVec den) noexcept {
+    const tVec zero = AMP_BR_SI(setzero)();
+    const tVecF nl = AMP_BR(cvtepi32_ps)(AMP_BR(unpacklo_epi16)(num, zero));
+    const tVecF nh = AMP_BR(cvtepi32_ps)(AMP_BR(unpackhi_epi16)(num, zero));
+    const tVecF dl = AMP_BR(cvtepi32_ps)(AMP_BR(unpacklo_epi16)(den, zero));
+    const tVecF dh = AMP_BR(cvtepi32_ps)(AMP_BR(unpackhi_epi16)(den, zero));
+    const tVec ql = AMP_BR(cvttps_epi32)(AMP_BR(div_ps)(nl, dl));
+    const tVec qh = AMP_BR(cvttps_epi32)(AMP_BR(div_ps)(nh, dh));
+    return AMP_BR(packs_epi32)(ql, qh);
+}
+
+// Blend source terms (As, invAs = 255 - As, srcP = mul8(Cs, As), per pixel) over 2 (SSE2) or
+// 4 (AVX2, 2 per 128-bit lane) destination pixels held as 16-bit lanes.
+inline tVec blendLanesTerms(tVec d, tVec As, tVec invAs, tVec srcP) noexcept {
+    const tVec c255 = AMP_BR(set1_epi16)(255);
+    const tVec Ad = splatAlpha(d);
+    const tVec Aout = AMP_BR(add_epi16)(As, mul8x(Ad, invAs));
+
+    const tVec dstP = mul8x(d, Ad);
+    const tVec outP = AMP_BR(add_epi16)(srcP, mul8x(dstP, invAs));
+
+    const tVec num = AMP_BR(add_epi16)(AMP_BR(mullo_epi16)(outP, c255), AMP_BR(srli_epi16)(Aout, 1));
+    const tVec den = AMP_BR(max_epi16)(Aout, AMP_BR(set1_epi16)(1));
+    const tVec q = divLanes(num, den);
+
+    // Alpha lanes take Aout, color lanes take the quotient.
+    const tVec alphaMask = AMP_BR(set1_epi64x)(0x000000000000FFFFLL);
+    return AMP_BR_SI(or)(AMP_BR_SI(and)(alphaMask, Aout), AMP_BR_SI(andnot)(alphaMask, q));
+}
+
+// Blend 2 (SSE2) or 4 (AVX2) source pixels over destination pixels, all held as 16-bit lanes.
+inline tVec blendLanes(tVec d, tVec s, tVec ga) noexcept {
+    const tVec As = mul8x(splatAlpha(s), ga);
+    const tVec invAs = AMP_BR(sub_epi16)(AMP_BR(set1_epi16)(255), As);
+    return blendLanesTerms(d, As, invAs, mul8x(s, As));
+}
+
+inline void blendRowVec(csColorRGBA* out, const csColorRGBA* under, const csColorRGBA* over,
+                        size_t n, uint8_t globalAlpha) noexcept {
+    const tVec zero = AMP_BR_SI(setzero)();
+    const tVec ga = AMP_BR(set1_epi16)(globalAlpha);
+    // Alpha byte of each pixel (lowest byte of the 32-bit lane, memory order a, r, g, b).
+    const tVec alphaBytes = AMP_BR(set1_epi32)(0x000000FF);
+    size_t i = 0;
+    for (; i + cPixelsPerStep <= n; i += cPixelsPerStep) {
+        const tVec s = AMP_BR_SI(loadu)(reinterpret_cast<const tVec*>(over + i));
+        // Opaque fast path: every source alpha is 255 and no global alpha -> result is the source.
+        if (globalAlpha == 255) {
+            const tVec opaque = AMP_BR(cmpeq_epi32)(AMP_BR_SI(and)(s, alphaBytes), alphaBytes);
+            if (AMP_BR(movemask_epi8)(opaque) == static_cast<int>(cPixelsPerStep == 8 ? 0xFFFFFFFFu : 0xFFFFu)) {
+                AMP_BR_SI(storeu)(reinterpret_cast<tVec*>(out + i), s);
+                continue;
+            }
+        }
+        const tVec d = AMP_BR_SI(loadu)(reinterpret_cast<const tVec*>(under + i));
+        const tVec lo = blendLanes(AMP_BR(unpacklo_epi8)(d, zero), AMP_BR(unpacklo_epi8)(s, zero), ga);
+        const tVec hi = blendLanes(AMP_BR(unpackhi_epi8)(d, zero), AMP_BR(unpackhi_epi8)(s, zero), ga);
+        AMP_BR_SI(storeu)(reinterpret_cast<tVec*>(out + i), AMP_BR(packus_epi16)(lo, hi));
+    }
+    blendRowScalar(out + i, under + i, over + i, n - i, globalAlpha);
+}
+
+inline void fillRowVec(csColorRGBA* dst, size_t n, csColorRGBA color) noexcept {
+    const tVec v = AMP_BR(set1_epi32)(static_cast<int>(color.value));
+    size_t i = 0;
+    for (; i + cPixelsPerStep <= n; i += cPixelsPerStep) {
+        AMP_BR_SI(storeu)(reinterpret_cast<tVec*>(dst + i), v);
+    }
+    for (; i < n; ++i) {
+        dst[i] = color;
+    }
+}
+
+inline void fillRowBlendVec(csColorRGBA* dst, size_t n, csColorRGBA color) noexcept {
+    const tVec zero = AMP_BR_SI(setzero)();
+    const tVec As = AMP_BR(set1_epi16)(color.a);
+    const tVec invAs = AMP_BR(set1_epi16)(static_cast<short>(255 - color.a));
+    // Lanes a, r, g, b of one pixel; the alpha lane of srcP is unused (alpha lanes take Aout).
+    const uint64_t terms = (static_cast<uint64_t>(mul8(color.r, color.a)) << 16) |
+                           (static_cast<uint64_t>(mul8(color.g, color.a)) << 32) |
+                           (static_cast<uint64_t>(mul8(color.b, color.a)) << 48);
+    const tVec srcP = AMP_BR(set1_epi64x)(static_cast<long long>(terms));
+    size_t i = 0;
+    for (; i + cPixelsPerStep <= n; i += cPixelsPerStep) {
+        const tVec d = AMP_BR_SI(loadu)(reinterpret_cast<const tVec*>(dst + i));
+        const tVec lo = blendLanesTerms(AMP_BR(unpacklo_epi8)(d, zero), As, invAs, srcP);
+        const tVec hi = blendLanesTerms(AMP_BR(unpackhi_epi8)(d, zero), As, invAs, srcP);
+        AMP_BR_SI(storeu)(reinterpret_cast<tVec*>(dst + i), AMP_BR(packus_epi16)(lo, hi));
+    }
+    fillRowBlendScalar(dst + i, n - i, color);
+}
+
+#undef AMP_BR
+#undef AMP_BR_SI
+
+// csColorRGBA16::toColor8Straight() for 4 pixels per step (128-bit lanes also on AVX2 builds).
+// Each pixel is one vector of 4 int32 lanes (a, r, g, b): numerator n = C*255 + A/2 over A for color
+// lanes, A*255 + 32767 over 65535 for the alpha lane. n < 2^24 is exact in float; the float quotient
+// is off by at most one, which the remainder check n - q*d in [0, d) corrects, so results are exact.
+inline __m128i quantizePixel16(__m128i p) noexcept {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaLane = _mm_set_epi32(0, 0, 0, -1);
+    const __m128i A = _mm_shuffle_epi32(p, 0x00);
+    const __m128i bias = _mm_or_si128(_mm_and_si128(alphaLane, _mm_set1_epi32(32767)),
+                                      _mm_andnot_si128(alphaLane, _mm_srli_epi32(A, 1)));
+    const __m128i den = _mm_or_si128(_mm_and_si128(alphaLane, _mm_set1_epi32(65535)),
+                                     _mm_andnot_si128(alphaLane, _mm_or_si128(A, _mm_and_si128(_mm_cmpeq_epi32(A, zero), _mm_set1_epi32(1)))));
+    const __m128i num = _mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(p, 8), p), bias);
+    const __m128 nf = _mm_cvtepi32_ps(num);
+    const __m128 df = _mm_cvtepi32_ps(den);
+    __m128i q = _mm_cvttps_epi32(_mm_div_ps(nf, df));
+    const __m128i r = _mm_cvttps_epi32(_mm_sub_ps(nf, _mm_mul_ps(_mm_cvtepi32_ps(q), df)));
+    q = _mm_add_epi32(q, _mm_cmpgt_epi32(zero, r));                                    // r < 0: q - 1
+    q = _mm_sub_epi32(q, _mm_cmpgt_epi32(r, _mm_sub_epi32(den, _mm_set1_epi32(1)))); // r >= d: q + 1
+    return q;
+}
+
+inline void quantizeRow16Vec(csColorRGBA* out, const csColorRGBA16* in, size_t n) noexcept {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 2));
+        const __m128i w0 = _mm_packs_epi32(quantizePixel16(_mm_unpacklo_epi16(v0, zero)),
+                                           quantizePixel16(_mm_unpackhi_epi16(v0, zero)));
+        const __m128i w1 = _mm_packs_epi32(quantizePixel16(_mm_unpacklo_epi16(v1, zero)),
+                                           quantizePixel16(_mm_unpackhi_epi16(v1, zero)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(w0, w1));
+    }
+    for (; i < n; ++i) {
+        out[i] = in[i].toColor8Straight();
+    }
+}
+
+#elif defined(AMP_BLEND_ROW_NEON)
+
+// mul8(a, b) for 16-bit lanes.
+inline uint16x8_t mul8x(uint16x8_t a, uint16x8_t b) noexcept {
+    const uint16x8_t t = vaddq_u16(vmulq_u16(a, b), vdupq_n_u16(127));
+    const uint16x8_t t1 = vaddq_u16(t, vdupq_n_u16(1));
+    return vshrq_n_u16(vaddq_u16(t1, vshrq_n_u16(t, 8)), 8);
+}
+
+// trunc(num / den) for 16-bit lanes, computed in float (see exactness note above).
+inline uint16x8_t divLanes(uint16x8_t num, uint16x8_t den) noexcept {
+    const float32x4_t nl = vcvtq_f32_u32(vmovl_u16(vget_low_u16(num)));
+    const float32x4_t nh = vcvtq_f32_u32(vmovl_u16(vget_high_u16(num)));
+    const float32x4_t dl = vcvtq_f32_u32(vmovl_u16(vget_low_u16(den)));
+    const float32x4_t dh = vcvtq_f32_u32(vmovl_u16(vget_high_u16(den)));
+    const uint32x4_t ql = vcvtq_u32_f32(vdivq_f32(nl, dl));
+    const uint32x4_t qh = vcvtq_u32_f32(vdivq_f32(nh, dh));
+    return vcombine_u16(vmovn_u32(ql), vmovn_u32(qh));
+}
+
+// Blend 2 pixels held as 16-bit lanes; 'sa'/'da' are alphas already broadcast per pixel.
+inline uint16x8_t blendLanes(uint16x8_t d, uint16x8_t s, uint16x8_t da, uint16x8_t sa, uint16x8_t ga) noexcept {
+    const uint16x8_t c255 = vdupq_n_u16(255);
+    const uint16x8_t As = mul8x(sa, ga);
+    const uint16x8_t invAs = vsubq_u16(c255, As);
+    const uint16x8_t Aout = vaddq_u16(As, mul8x(da, invAs));
+
+    const uint16x8_t srcP = mul8x(s, As);
+    const uint16x8_t dstP = mul8x(d, da);
+    const uint16x8_t outP = vaddq_u16(srcP, mul8x(dstP, invAs));
+
+    const uint16x8_t num = vaddq_u16(vmulq_u16(outP, c255), vshrq_n_u16(Aout, 1));
+    const uint16x8_t q = divLanes(num, vmaxq_u16(Aout, vdupq_n_u16(1)));
+
+    // Alpha lanes take Aout, color lanes take the quotient.
+    const uint16x8_t alphaMask = vreinterpretq_u16_u64(vdupq_n_u64(0x000000000000FFFFULL));
+    return vbslq_u16(alphaMask, Aout, q);
+}
+
+inline void blendRowVec(csColorRGBA* out, const csColorRGBA* under, const csColorRGBA* over,
+                        size_t n, uint8_t globalAlpha) noexcept {
+    const uint16x8_t ga = vdupq_n_u16(globalAlpha);
+    // Per-pixel alpha broadcast (memory order a, r, g, b): bytes 0 and 4 of each 8-byte half.
+    static const uint8_t kSplat[8] = {0, 0, 0, 0, 4, 4, 4, 4};
+    const uint8x8_t splat = vld1_u8(kSplat);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const uint8x16_t s = vld1q_u8(reinterpret_cast<const uint8_t*>(over + i));
+        // Opaque fast path: every source alpha is 255 and no global alpha -> result is the source.
+        if (globalAlpha == 255) {
+            const uint32x4_t sa32 = vandq_u32(vreinterpretq_u32_u8(s), vdupq_n_u32(0xFF));
+            if (vminvq_u32(sa32) == 0xFF) {
+                vst1q_u8(reinterpret_cast<uint8_t*>(out + i), s);
+                continue;
+            }
+        }
+        const uint8x16_t d = vld1q_u8(reinterpret_cast<const uint8_t*>(under + i));
+        const uint8x8_t sLo = vget_low_u8(s);
+        const uint8x8_t sHi = vget_high_u8(s);
+        const uint8x8_t dLo = vget_low_u8(d);
+        const uint8x8_t dHi = vget_high_u8(d);
+        const uint16x8_t lo = blendLanes(vmovl_u8(dLo), vmovl_u8(sLo),
+                                         vmovl_u8(vtbl1_u8(dLo, splat)), vmovl_u8(vtbl1_u8(sLo, splat)), ga);
+        const uint16x8_t hi = blendLanes(vmovl_u8(dHi), vmovl_u8(sHi),
+                                         vmovl_u8(vtbl1_u8(dHi, splat)), vmovl_u8(vtbl1_u8(sHi, splat)), ga);
+        vst1q_u8(reinterpret_cast<uint8_t*>(out + i), vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+    }
+    blendRowScalar(out + i, under + i, over + i, n - i, globalAlpha);
+}
+
+inline void fillRowVec(csColorRGBA* dst, size_t n, csColorRGBA color) noexcept {
+    const uint32x4_t v = vdupq_n_u32(color.value);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_u32(reinterpret_cast<uint32_t*>(dst + i), v);
+    }
+    for (; i < n; ++i) {
+        dst[i] = color;
+    }
+}
+
+#endif
+
+} // namespace blend_row_detail
+
+static_assert(sizeof(csColorRGBA16) == 8, "csColorRGBA16 rows are read as 4 uint16_t lanes per pixel");
+
+// out[i] = sourceOverStraight(under[i], over[i], globalAlpha) for i in [0, n).
+// 'out' may alias 'under' or 'over' exactly (in-place), but must not partially overlap them.
+inline void blendRowTo(csColorRGBA* out, const csColorRGBA* under, const csColorRGBA* over,
+                       size_t n, uint8_t globalAlpha = 255) noexcept {
+#if defined(AMP_BLEND_ROW_SSE2) || defined(AMP_BLEND_ROW_AVX2) || defined(AMP_BLEND_ROW_NEON)
+    blend_row_detail::blendRowVec(out, under, over, n, globalAlpha);
+#else
+    blend_row_detail::blendRowScalar(out, under, over, n, globalAlpha);
+#endif
+}
+
+// dst[i] = sourceOverStraight(dst[i], src[i], globalAlpha) for i in [0, n).
+inline void blendRow(csColorRGBA* dst, const csColorRGBA* src, size_t n, uint8_t globalAlpha = 255) noexcept {
+    blendRowTo(dst, dst, src, n, globalAlpha);
+}
+
+// dst[i] = color for i in [0, n).
+inline void fillRow(csColorRGBA* dst, size_t n, csColorRGBA color) noexcept {
+#if defined(AMP_BLEND_ROW_SSE2) || defined(AMP_BLEND_ROW_AVX2) || defined(AMP_BLEND_ROW_NEON)
+    blend_row_detail::fillRowVec(dst, n, color);
+#else
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = color;
+    }
+#endif
+}
+
+// dst[i] = sourceOverStraight(dst[i], color) for i in [0, n); the source terms are computed once.
+// An opaque color is a plain fill.
+inline void fillRowBlend(csColorRGBA* dst, size_t n, csColorRGBA color) noexcept {
+    if (color.a == 255) {
+        fillRow(dst, n, color);
+        return;
+    }
+#if defined(AMP_BLEND_ROW_SSE2) || defined(AMP_BLEND_ROW_AVX2)
+    blend_row_detail::fillRowBlendVec(dst, n, color);
+#else
+    blend_row_detail::fillRowBlendScalar(dst, n, color);
+#endif
+}
+
+// Blend-mode row kernels (see csBlendMode). SourceOver goes to blendRow / fillRowBlend; other modes
+// mix the mode result into the source in chunks (plain integer loops per mode, which the compiler
+// can vectorize), then composite the chunk with the SourceOver row kernel.
+// Bit-exact with csColorRGBA::blendStraight(dst, src, mode, globalAlpha).
+namespace blend_row_detail {
+
+static constexpr size_t cModeChunk = 32;
+
+// out[i] = csColorRGBA::mixBlendMode(dst[i], src[i], Mode) for i in [0, n).
+template <csBlendMode Mode>
+inline void mixRowMode(csColorRGBA* out, const csColorRGBA* dst, const csColorRGBA* src, size_t n) noexcept {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = csColorRGBA::mixBlendMode(dst[i], src[i], Mode);
+    }
+}
+
+template <csBlendMode Mode>
+inline void blendRowModeT(csColorRGBA* dst, const csColorRGBA* src, size_t n, uint8_t globalAlpha) noexcept {
+    csColorRGBA mixed[cModeChunk];
+    for (size_t i = 0; i < n; i += cModeChunk) {
+        const size_t len = (n - i < cModeChunk) ? n - i : cModeChunk;
+        mixRowMode<Mode>(mixed, dst + i, src + i, len);
+        blendRowTo(dst + i, dst + i, mixed, len, globalAlpha);
+    }
+}
+
+template <csBlendMode Mode>
+inline void fillRowModeT(csColorRGBA* dst, size_t n, csColorRGBA color) noexcept {
+    csColorRGBA src[cModeChunk];
+    for (csColorRGBA& c : src) {
+        c = color;
+    }
+    for (size_t i = 0; i < n; i += cModeChunk) {
+        const size_t len = (n - i < cModeChunk) ? n - i : cModeChunk;
+        blendRowModeT<Mode>(dst + i, src, len, 255);
+    }
+}
+
+} // namespace blend_row_detail
+
+// dst[i] = csColorRGBA::blendStraight(dst[i], src[i], mode, globalAlpha) for i in [0, n).
+inline void blendRowMode(csColorRGBA* dst, const csColorRGBA* src, size_t n, uint8_t globalAlpha,
+                         csBlendMode mode) noexcept {
+    switch (mode) {
+        case csBlendMode::Add:
+            blend_row_detail::blendRowModeT<csBlendMode::Add>(dst, src, n, globalAlpha);
+            break;
+        case csBlendMode::Multiply:
+            blend_row_detail::blendRowModeT<csBlendMode::Multiply>(dst, src, n, globalAlpha);
+            break;
+        case csBlendMode::Screen:
+            blend_row_detail::blendRowModeT<csBlendMode::Screen>(dst, src, n, globalAlpha);
+            break;
+        case csBlendMode::Max:
+            blend_row_detail::blendRowModeT<csBlendMode::Max>(dst, src, n, globalAlpha);
+            break;
+        case csBlendMode::Min:
+            blend_row_detail::blendRowModeT<csBlendMode::Min>(dst, src, n, globalAlpha);
+            break;
+        default:
+            blendRow(dst, src, n, globalAlpha);
+            break;
+    }
+}
+
+// dst[i] = csColorRGBA::blendStraight(dst[i], color, mode) for i in [0, n).
+inline void fillRowMode(csColorRGBA* dst, size_t n, csColorRGBA color, csBlendMode mode) noexcept {
+    switch (mode) {
+        case csBlendMode::Add:
+            blend_row_detail::fillRowModeT<csBlendMode::Add>(dst, n, color);
+            break;
+        case csBlendMode::Multiply:
+            blend_row_detail::fillRowModeT<csBlendMode::Multiply>(dst, n, color);
+            break;
+        case csBlendMode::Screen:
+            blend_row_detail::fillRowModeT<csBlendMode::Screen>(dst, n, color);
+            break;
+        case csBlendMode::Max:
+            blend_row_detail::fillRowModeT<csBlendMode::Max>(dst, n, color);
+            break;
+        case csBlendMode::Min:
+            blend_row_detail::fillRowModeT<csBlendMode::Min>(dst, n, color);
+            break;
+        default:
+            fillRowBlend(dst, n, color);
+            break;
+    }
+}
+
+// Premultiplied-alpha row kernels (scalar; simple multiply-add loops the compiler can vectorize).
+
+// out[i] = in[i].toPremul() for i in [0, n). 'out' may alias 'in'.
+inline void premultiplyRow(csColorRGBA* out, const csColorRGBA* in, size_t n) noexcept {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = in[i].toPremul();
+    }
+}
+
+// out[i] = in[i].fromPremul() for i in [0, n). 'out' may alias 'in'.
+inline void unpremultiplyRow(csColorRGBA* out, const csColorRGBA* in, size_t n) noexcept {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = in[i].fromPremul();
+    }
+}
+
+// dst[i] (premultiplied) = sourceOverPremul(dst[i], src[i] (straight) with alpha scaled by globalAlpha).
+inline void blendRowPremul(csColorRGBA* dst, const csColorRGBA* src, size_t n, uint8_t globalAlpha = 255) noexcept {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = csColorRGBA::sourceOverPremul(dst[i], src[i].alpha(globalAlpha).toPremul());
+    }
+}
+
+// dst[i] (premultiplied) = sourceOverPremul(dst[i], color) with 'color' already premultiplied.
+inline void fillRowPremul(csColorRGBA* dst, size_t n, csColorRGBA color) noexcept {
+    if (color.a == 255) {
+        fillRow(dst, n, color);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = csColorRGBA::sourceOverPremul(dst[i], color);
+    }
+}
+
+// Premultiplied unorm16 row kernels (see csMatrixPixels16). Sources are straight-alpha 8-bit
+// colors; results stay in 16 bits, so stacked layers are rounded once, in quantizeRow16().
+
+// dst[i] = sourceOverPremul16(dst[i], src[i] with alpha scaled by globalAlpha) for i in [0, n).
+inline void blendRow16(csColorRGBA16* dst, const csColorRGBA* src, size_t n, uint8_t globalAlpha = 255) noexcept {
+    for (size_t i = 0; i < n; ++i) {
+        const csColorRGBA16 s = csColorRGBA16::fromColor8Premul(src[i].alpha(globalAlpha));
+        const uint16_t invAs = static_cast<uint16_t>(65535u - s.a);
+        csColorRGBA16& d = dst[i];
+        d = csColorRGBA16{
+            static_cast<uint16_t>(s.a + mul16(d.a, invAs)),
+            static_cast<uint16_t>(s.r + mul16(d.r, invAs)),
+            static_cast<uint16_t>(s.g + mul16(d.g, invAs)),
+            static_cast<uint16_t>(s.b + mul16(d.b, invAs))
+        };
+    }
+}
+
+// dst[i] = sourceOverPremul16(dst[i], color) with 'color' already premultiplied (csColorRGBA16::fromColor8Premul).
+inline void fillRow16(csColorRGBA16* dst, size_t n, csColorRGBA16 color) noexcept {
+    const uint16_t invAs = static_cast<uint16_t>(65535u - color.a);
+    if (invAs == 0) {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = color;
+        }
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        csColorRGBA16& d = dst[i];
+        d = csColorRGBA16{
+            static_cast<uint16_t>(color.a + mul16(d.a, invAs)),
+            static_cast<uint16_t>(color.r + mul16(d.r, invAs)),
+            static_cast<uint16_t>(color.g + mul16(d.g, invAs)),
+            static_cast<uint16_t>(color.b + mul16(d.b, invAs))
+        };
+    }
+}
+
+// Additive blend: dst[i] += premultiplied src[i] (alpha scaled by globalAlpha), every channel saturated
+// at 65535. Channels never exceed alpha, so the sum stays a valid premultiplied color.
+inline void addRow16(csColorRGBA16* dst, const csColorRGBA* src, size_t n, uint8_t globalAlpha = 255) noexcept {
+    auto addSat = [](uint16_t x, uint16_t y) noexcept -> uint16_t {
+        const uint32_t sum = static_cast<uint32_t>(x) + y;
+        return static_cast<uint16_t>(sum > 65535u ? 65535u : sum);
+    };
+    for (size_t i = 0; i < n; ++i) {
+        const csColorRGBA16 s = csColorRGBA16::fromColor8Premul(src[i].alpha(globalAlpha));
+        csColorRGBA16& d = dst[i];
+        d = csColorRGBA16{addSat(d.a, s.a), addSat(d.r, s.r), addSat(d.g, s.g), addSat(d.b, s.b)};
+    }
+}
+
+// Scale all channels by fadeMul / 255, truncating: repeated fades always reach zero and 255 is an exact no-op.
+inline void fadeRow16(csColorRGBA16* dst, size_t n, uint8_t fadeMul) noexcept {
+    const uint32_t k = static_cast<uint32_t>(fadeMul) * 257u + 1u;
+    for (size_t i = 0; i < n; ++i) {
+        csColorRGBA16& d = dst[i];
+        d = csColorRGBA16{
+            static_cast<uint16_t>((d.a * k) >> 16),
+            static_cast<uint16_t>((d.r * k) >> 16),
+            static_cast<uint16_t>((d.g * k) >> 16),
+            static_cast<uint16_t>((d.b * k) >> 16)
+        };
+    }
+}
+
+// out[i] = in[i].toColor8Straight() for i in [0, n): the single rounding step at frame end.
+inline void quantizeRow16(csColorRGBA* out, const csColorRGBA16* in, size_t n) noexcept {
+#if defined(AMP_BLEND_ROW_SSE2) || defined(AMP_BLEND_ROW_AVX2)
+    blend_row_detail::quantizeRow16Vec(out, in, n);
+#else
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = in[i].toColor8Straight();
+    }
+#endif
+}
+
+} // namespace amp
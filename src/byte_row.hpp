@@ -0,0 +1,332 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "blend_row.hpp"
+
+namespace amp {
+
+using ::size_t;
+using ::uint8_t;
+
+// Integer convolution kernel over byte samples: out = min(255, floor(sum(w[i] * in[i]) / div)).
+// Sum of weights must be <= 255 and div in 1..255 (keeps every intermediate sum in 16 bits).
+template <size_t Taps>
+struct csByteKernel {
+    uint8_t w[Taps];
+    uint8_t div;
+};
+
+using csByteKernel3 = csByteKernel<3>;
+using csByteKernel5 = csByteKernel<5>;
+
+// Common kernels.
+static constexpr csByteKernel3 cByteKernelBlur3{{1, 2, 1}, 4};
+static constexpr csByteKernel5 cByteKernelBlur5{{1, 4, 6, 4, 1}, 16};
+// Upward diffusion weights: near-left, near, near-right, far (see diffuseUpRow()).
+static constexpr csByteKernel<4> cByteKernelDiffuseUp{{1, 1, 1, 2}, 5};
+
+// Samples outside a row / column.
+enum class csEdgeMode : uint8_t {
+    Zero = 0,  // Outside samples are 0.
+    Clamp = 1, // Outside samples repeat the nearest edge sample.
+};
+
+// Byte row kernels: whole-row convolution, box blur and diffusion over uint8_t runs.
+// SIMD paths (SSE2 / AVX2 / AArch64 NEON, same switches as blend_row.hpp) work in 16-bit lanes and
+// divide with a multiply-high by m = ceil(65536 / div). That is exact when maxSum * (m * div - 65536)
+// < 65536, maxSum = 255 * sum(w); other kernels (and div == 1) use the scalar path.
+// All paths are bit-exact with the scalar reference.
+namespace byte_row_detail {
+
+[[nodiscard]] inline int clampIndex(int i, int n) noexcept {
+    return (i < 0) ? 0 : (i >= n) ? (n - 1) : i;
+}
+
+// src[i] with 'edge' handling for i outside [0, n).
+[[nodiscard]] inline uint8_t sample(const uint8_t* src, int i, int n, csEdgeMode edge) noexcept {
+    if (i >= 0 && i < n) {
+        return src[i];
+    }
+    return (edge == csEdgeMode::Zero) ? uint8_t{0} : src[clampIndex(i, n)];
+}
+
+[[nodiscard]] inline uint8_t divideSum(uint32_t sum, uint8_t div) noexcept {
+    const uint32_t q = sum / div;
+    return static_cast<uint8_t>(q > 255u ? 255u : q);
+}
+
+// Multiply-high reciprocal of 'div'; 0 when the 16-bit SIMD divide is not exact for 'wsum'.
+[[nodiscard]] inline uint16_t simdReciprocal(uint16_t wsum, uint8_t div) noexcept {
+    if (div < 2) {
+        return 0;
+    }
+    const uint32_t m = (65536u + div - 1u) / div;
+    const uint32_t e = m * div - 65536u;
+    return (255u * wsum * e < 65536u) ? static_cast<uint16_t>(m) : uint16_t{0};
+}
+
+template <size_t K>
+[[nodiscard]] inline uint16_t weightSum(const csByteKernel<K>& k) noexcept {
+    uint16_t s = 0;
+    for (size_t i = 0; i < K; ++i) {
+        s = static_cast<uint16_t>(s + k.w[i]);
+    }
+    return s;
+}
+
+// dst[i] = kernel over rows[0..K)[i] for i in [from, n).
+template <size_t K>
+inline void weightedRowsScalar(uint8_t* dst, const uint8_t* const (&rows)[K], const csByteKernel<K>& k,
+                               size_t from, size_t n) noexcept {
+    for (size_t i = from; i < n; ++i) {
+        uint32_t sum = 0;
+        for (size_t t = 0; t < K; ++t) {
+            sum += static_cast<uint32_t>(k.w[t]) * rows[t][i];
+        }
+        dst[i] = divideSum(sum, k.div);
+    }
+}
+
+#if defined(AMP_BLEND_ROW_SSE2) || defined(AMP_BLEND_ROW_AVX2)
+
+#if defined(AMP_BLEND_ROW_AVX2)
+using tByteVec = __m256i;
+static constexpr size_t cBytesPerStep = 32;
+#define AMP_BYR(op) _mm256_##op
+#define AMP_BYR_SI(op) _mm256_##op##_si256
+#else
+using tByteVec = __m128i;
+static constexpr size_t cBytesPerStep = 16;
+#define AMP_BYR(op) _mm_##op
+#define AMP_BYR_SI(op) _mm_##op##_si128
+#endif
+
+// Vector body of weightedRowsScalar(); returns the number of bytes done. 'm' from simdReciprocal().
+// unpack/pack work per 128-bit lane on AVX2, so the byte order is kept.
+template <size_t K>
+inline size_t weightedRowsVec(uint8_t* dst, const uint8_t* const (&rows)[K], const csByteKernel<K>& k,
+                              uint16_t m, size_t n) noexcept {
+    const tByteVec zero = AMP_BYR_SI(setzero)();
+    const tByteVec mv = AMP_BYR(set1_epi16)(static_cast<short>(m));
+    tByteVec wv[K];
+    for (size_t t = 0; t < K; ++t) {
+        wv[t] = AMP_BYR(set1_epi16)(static_cast<short>(k.w[t]));
+    }
+    size_t i = 0;
+    for (; i + cBytesPerStep <= n; i += cBytesPerStep) {
+        tByteVec lo = zero;
+        tByteVec hi = zero;
+        for (size_t t = 0; t < K; ++t) {
+            const tByteVec v = AMP_BYR_SI(loadu)(reinterpret_cast<const tByteVec*>(rows[t] + i));
+            lo = AMP_BYR(add_epi16)(lo, AMP_BYR(mullo_epi16)(AMP_BYR(unpacklo_epi8)(v, zero), wv[t]));
+            hi = AMP_BYR(add_epi16)(hi, AMP_BYR(mullo_epi16)(AMP_BYR(unpackhi_epi8)(v, zero), wv[t]));
+        }
+        lo = AMP_BYR(mulhi_epu16)(lo, mv);
+        hi = AMP_BYR(mulhi_epu16)(hi, mv);
+        AMP_BYR_SI(storeu)(reinterpret_cast<tByteVec*>(dst + i), AMP_BYR(packus_epi16)(lo, hi));
+    }
+    return i;
+}
+
+#undef AMP_BYR
+#undef AMP_BYR_SI
+
+#elif defined(AMP_BLEND_ROW_NEON)
+
+template <size_t K>
+inline size_t weightedRowsVec(uint8_t* dst, const uint8_t* const (&rows)[K], const csByteKernel<K>& k,
+                              uint16_t m, size_t n) noexcept {
+    const uint16x4_t mv = vdup_n_u16(m);
+    uint16x8_t wv[K];
+    for (size_t t = 0; t < K; ++t) {
+        wv[t] = vdupq_n_u16(k.w[t]);
+    }
+    auto mulhi = [&](uint16x8_t v) noexcept {
+        const uint32x4_t a = vmull_u16(vget_low_u16(v), mv);
+        const uint32x4_t b = vmull_u16(vget_high_u16(v), mv);
+        return vcombine_u16(vshrn_n_u32(a, 16), vshrn_n_u32(b, 16));
+    };
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint16x8_t lo = vdupq_n_u16(0);
+        uint16x8_t hi = vdupq_n_u16(0);
+        for (size_t t = 0; t < K; ++t) {
+            const uint8x16_t v = vld1q_u8(rows[t] + i);
+            lo = vmlaq_u16(lo, vmovl_u8(vget_low_u8(v)), wv[t]);
+            hi = vmlaq_u16(hi, vmovl_u8(vget_high_u8(v)), wv[t]);
+        }
+        vst1q_u8(dst + i, vcombine_u8(vqmovn_u16(mulhi(lo)), vqmovn_u16(mulhi(hi))));
+    }
+    return i;
+}
+
+#endif
+
+// dst[i] = kernel over rows[0..K)[i] for i in [0, n): SIMD body when exact, scalar tail.
+template <size_t K>
+inline void weightedRows(uint8_t* dst, const uint8_t* const (&rows)[K], const csByteKernel<K>& k, size_t n) noexcept {
+    size_t i = 0;
+#if defined(AMP_BLEND_ROW_SSE2) || defined(AMP_BLEND_ROW_AVX2) || defined(AMP_BLEND_ROW_NEON)
+    const uint16_t m = simdReciprocal(weightSum(k), k.div);
+    if (m != 0) {
+        i = weightedRowsVec<K>(dst, rows, k, m, n);
+    }
+#endif
+    weightedRowsScalar<K>(dst, rows, k, i, n);
+}
+
+// One output of a horizontal kernel at x with edge handling.
+template <size_t K>
+[[nodiscard]] inline uint8_t convolveAt(const uint8_t* src, int x, int n, const csByteKernel<K>& k,
+                                        csEdgeMode edge) noexcept {
+    constexpr int r = static_cast<int>(K / 2);
+    uint32_t sum = 0;
+    for (size_t t = 0; t < K; ++t) {
+        sum += static_cast<uint32_t>(k.w[t]) * sample(src, x - r + static_cast<int>(t), n, edge);
+    }
+    return divideSum(sum, k.div);
+}
+
+// Exact floor(s / d) as (s * recip) >> 24 for s <= 255 * d, d <= 255 (running-sum blurs).
+[[nodiscard]] inline uint32_t boxReciprocal(uint32_t d) noexcept {
+    return ((1u << 24) + d - 1u) / d;
+}
+
+} // namespace byte_row_detail
+
+// Horizontal convolution of one row: dst[x] = kernel over src[x - K/2 .. x + K/2], K odd.
+// 'dst' and 'src' must not overlap. The interior runs as a vertical kernel over shifted row pointers.
+template <size_t K>
+inline void convolveRow(uint8_t* dst, const uint8_t* src, size_t n, const csByteKernel<K>& k,
+                        csEdgeMode edge = csEdgeMode::Clamp) noexcept {
+    static_assert((K % 2) == 1, "convolveRow: odd tap count expected");
+    constexpr size_t r = K / 2;
+    const int ni = static_cast<int>(n);
+    if (n <= 2 * r) {
+        for (int x = 0; x < ni; ++x) {
+            dst[x] = byte_row_detail::convolveAt(src, x, ni, k, edge);
+        }
+        return;
+    }
+    for (size_t x = 0; x < r; ++x) {
+        dst[x] = byte_row_detail::convolveAt(src, static_cast<int>(x), ni, k, edge);
+        dst[n - 1 - x] = byte_row_detail::convolveAt(src, ni - 1 - static_cast<int>(x), ni, k, edge);
+    }
+    const uint8_t* rows[K];
+    for (size_t t = 0; t < K; ++t) {
+        rows[t] = src + t;
+    }
+    byte_row_detail::weightedRows<K>(dst + r, rows, k, n - 2 * r);
+}
+
+// Vertical convolution: dst[i] = kernel over rows[0..K)[i] (rows top to bottom).
+// 'dst' may be one of the rows (same pointer) but must not overlap a row at an offset.
+template <size_t K>
+inline void convolveCols(uint8_t* dst, const uint8_t* const (&rows)[K], size_t n, const csByteKernel<K>& k) noexcept {
+    byte_row_detail::weightedRows<K>(dst, rows, k, n);
+}
+
+// Box blur of one row with a running sum: dst[x] = average of src[x - radius .. x + radius].
+// radius <= 127; 'dst' and 'src' must not overlap.
+inline void boxBlurRow(uint8_t* dst, const uint8_t* src, size_t n, uint8_t radius,
+                       csEdgeMode edge = csEdgeMode::Clamp) noexcept {
+    if (n == 0) {
+        return;
+    }
+    const int r = (radius > 127) ? 127 : radius;
+    const int ni = static_cast<int>(n);
+    const uint32_t recip = byte_row_detail::boxReciprocal(static_cast<uint32_t>(2 * r + 1));
+    uint32_t sum = 0;
+    for (int i = -r; i <= r; ++i) {
+        sum += byte_row_detail::sample(src, i, ni, edge);
+    }
+    for (int x = 0; x < ni; ++x) {
+        dst[x] = static_cast<uint8_t>((sum * recip) >> 24);
+        sum += byte_row_detail::sample(src, x + r + 1, ni, edge);
+        sum -= byte_row_detail::sample(src, x - r, ni, edge);
+    }
+}
+
+// Column running sums of a vertical box blur: sums[i] += add[i] - sub[i] (either row may be nullptr).
+inline void boxSumRow(uint16_t* sums, const uint8_t* add, const uint8_t* sub, size_t n) noexcept {
+    if (add) {
+        for (size_t i = 0; i < n; ++i) {
+            sums[i] = static_cast<uint16_t>(sums[i] + add[i]);
+        }
+    }
+    if (sub) {
+        for (size_t i = 0; i < n; ++i) {
+            sums[i] = static_cast<uint16_t>(sums[i] - sub[i]);
+        }
+    }
+}
+
+// dst[i] = sums[i] / (2 * radius + 1) (see boxSumRow()).
+inline void boxAverageRow(uint8_t* dst, const uint16_t* sums, size_t n, uint8_t radius) noexcept {
+    const uint32_t r = (radius > 127) ? 127u : radius;
+    const uint32_t recip = byte_row_detail::boxReciprocal(2u * r + 1u);
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<uint8_t>((sums[i] * recip) >> 24);
+    }
+}
+
+// Weighted upward diffusion of one row (heat rises one row per step):
+//   s = clamp(x + shift + jitter[x], 0, n - 1), sL = max(s - 1, 0), sR = min(s + 1, n - 1)
+//   dst[x] = (w0 * nearRow[sL] + w1 * nearRow[s] + w2 * nearRow[sR] + w3 * farRow[s]) / div
+// 'nearRow' is the row below 'dst', 'farRow' the one below it (neither may overlap 'dst').
+// 'jitter' holds -1 / 0 / +1 per pixel, or nullptr. Clamping is done only on the edge pixels;
+// without jitter the interior runs on the SIMD kernel.
+inline void diffuseUpRow(uint8_t* dst, const uint8_t* nearRow, const uint8_t* farRow, size_t n, int shift,
+                         const int8_t* jitter, const csByteKernel<4>& k = cByteKernelDiffuseUp) noexcept {
+    using byte_row_detail::clampIndex;
+    const int ni = static_cast<int>(n);
+    auto edgePixel = [&](int x) noexcept {
+        const int s = clampIndex(x + shift + (jitter ? jitter[x] : 0), ni);
+        const int sL = (s - 1 < 0) ? 0 : s - 1;
+        const int sR = (s + 1 >= ni) ? ni - 1 : s + 1;
+        const uint32_t sum = static_cast<uint32_t>(k.w[0]) * nearRow[sL] + static_cast<uint32_t>(k.w[1]) * nearRow[s] +
+                             static_cast<uint32_t>(k.w[2]) * nearRow[sR] + static_cast<uint32_t>(k.w[3]) * farRow[s];
+        dst[x] = byte_row_detail::divideSum(sum, k.div);
+    };
+    // Interior: every sample index (s - 1 .. s + 1 for any jitter) is inside the row.
+    const int jm = jitter ? 1 : 0;
+    const int lo = (1 + jm - shift > 0) ? (1 + jm - shift) : 0;
+    const int hiRaw = ni - 2 - jm - shift;
+    const int hi = (hiRaw < ni - 1) ? hiRaw : ni - 1; // last interior x
+    if (lo > hi) {
+        for (int x = 0; x < ni; ++x) {
+            edgePixel(x);
+        }
+        return;
+    }
+    for (int x = 0; x < lo; ++x) {
+        edgePixel(x);
+    }
+    if (jitter) {
+        for (int x = lo; x <= hi; ++x) {
+            const int s = x + shift + jitter[x];
+            const uint32_t sum = static_cast<uint32_t>(k.w[0]) * nearRow[s - 1] +
+                                 static_cast<uint32_t>(k.w[1]) * nearRow[s] +
+                                 static_cast<uint32_t>(k.w[2]) * nearRow[s + 1] +
+                                 static_cast<uint32_t>(k.w[3]) * farRow[s];
+            dst[x] = byte_row_detail::divideSum(sum, k.div);
+        }
+    } else {
+        const int s0 = lo + shift;
+        const uint8_t* rows[4] = {nearRow + s0 - 1, nearRow + s0, nearRow + s0 + 1, farRow + s0};
+        byte_row_detail::weightedRows<4>(dst + lo, rows, k, static_cast<size_t>(hi - lo + 1));
+    }
+    for (int x = hi + 1; x < ni; ++x) {
+        edgePixel(x);
+    }
+}
+
+// dst[i] = max(dst[i] - sub[i], 0) (e.g. random cooling of a heat row).
+inline void subSaturateRow(uint8_t* dst, const uint8_t* sub, size_t n) noexcept {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = (dst[i] > sub[i]) ? static_cast<uint8_t>(dst[i] - sub[i]) : uint8_t{0};
+    }
+}
+
+} // namespace amp
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <stdint.h>
+#include "amp_macros.hpp"
+#include "div255_lut.hpp"
 
 namespace amp {
 
@@ -11,6 +13,20 @@ using ::uint32_t;
 // Forward declaration
 struct csColorRGBA;
 
+// Blend mode of a layer over the destination (see csColorRGBA::blendStraight).
+// Non-SourceOver modes mix the mode result B(Cd, Cs) into the source by destination alpha
+// (Cs' = (1 - Ad) * Cs + Ad * B(Cd, Cs), W3C compositing), then composite with SourceOver;
+// over a transparent destination every mode is plain SourceOver.
+enum class csBlendMode : uint8_t {
+    SourceOver = 0, // B = Cs.
+    Add = 1,        // B = min(Cd + Cs, 255): glow, light.
+    Multiply = 2,   // B = Cd * Cs: shadows, tinting.
+    Screen = 3,     // B = Cd + Cs - Cd * Cs: soft light without clipping.
+    Max = 4,        // B = max(Cd, Cs) (lighten).
+    Min = 5,        // B = min(Cd, Cs) (darken).
+};
+static constexpr uint8_t cBlendModeCount = 6;
+
 struct csColorRGBA16 {
     uint16_t a;
     uint16_t r;
@@ -41,17 +57,67 @@ struct csColorRGBA16 {
 
     // Convert back to 8-bit color by dividing and rounding.
     [[nodiscard]] inline csColorRGBA toColor8(uint16_t divisor) const noexcept;
+
+    // Premultiplied unorm16 form (65535 = 1.0) of a straight-alpha 8-bit color (see csMatrixPixels16).
+    [[nodiscard]] static inline csColorRGBA16 fromColor8Premul(csColorRGBA c) noexcept;
+
+    // Quantize premultiplied unorm16 back to straight-alpha 8-bit (one rounding per channel).
+    [[nodiscard]] inline csColorRGBA toColor8Straight() const noexcept;
 };
 
+// AMP_FAST_DIV255: division-free mul8()/div255() (default 1).
+// Both forms are bit-exact (verified for all 65536 input pairs, see tests and bench/);
+// set to 0 to use the plain integer division forms (mul8_ref/div255_ref).
+#ifndef AMP_FAST_DIV255
+#define AMP_FAST_DIV255 1
+#endif
+
+// 8-bit multiply scaled by 1/255 with rounding-to-nearest (reference form, integer division).
+inline constexpr uint8_t mul8_ref(uint8_t a, uint8_t b) noexcept {
+    return static_cast<uint8_t>((static_cast<uint16_t>(a) * static_cast<uint16_t>(b) + 127u) / 255u);
+}
+
+// Divide premultiplied value by alpha with rounding to nearest (reference form, integer division).
+inline constexpr uint8_t div255_ref(uint16_t p, uint8_t A) noexcept {
+    return A == 0 ? 0 : static_cast<uint8_t>((static_cast<uint32_t>(p) * 255u + static_cast<uint32_t>(A) / 2u) / static_cast<uint32_t>(A));
+}
+
+// t / 255 without division: exact for t < 65535 (mul8 passes t <= 255*255 + 127).
+inline constexpr uint8_t div255_shift(uint16_t t) noexcept {
+    return static_cast<uint8_t>((static_cast<uint32_t>(t) + 1u + (t >> 8)) >> 8);
+}
+
 // 8-bit multiply scaled by 1/255 with rounding-to-nearest.
 // Example: mul8(128, 128) ~= round(128*128/255) = 64.
 inline constexpr uint8_t mul8(uint8_t a, uint8_t b) noexcept {
-    return static_cast<uint8_t>((static_cast<uint16_t>(a) * static_cast<uint16_t>(b) + 127u) / 255u);
+#if AMP_FAST_DIV255
+    return div255_shift(static_cast<uint16_t>(static_cast<uint16_t>(a) * static_cast<uint16_t>(b) + 127u));
+#else
+    return mul8_ref(a, b);
+#endif
 }
 
 // Divide premultiplied value by alpha with rounding to nearest.
-inline constexpr uint8_t div255(uint16_t p, uint8_t A) noexcept {
-    return A == 0 ? 0 : static_cast<uint8_t>((static_cast<uint32_t>(p) * 255u + static_cast<uint32_t>(A) / 2u) / static_cast<uint32_t>(A));
+// Fast form: (p * m + c) >> 16 with m = ceil(255 * 65536 / A) from amp_div255_recip and a rounding bias
+// for A/2 (exact for p <= 255, product fits uint32_t; A == 0 gives m = 0 -> 0). Larger p use division.
+inline uint8_t div255(uint16_t p, uint8_t A) noexcept {
+#if AMP_FAST_DIV255
+    if (p > 255u) {
+        return div255_ref(p, A);
+    }
+    const uint32_t m = pgm_read_dword(&amp_div255_recip[A]);
+    const uint32_t c = (A & 1u) ? (32768u - (m >> 9)) : 32768u;
+    return static_cast<uint8_t>((static_cast<uint32_t>(p) * m + c) >> 16);
+#else
+    return div255_ref(p, A);
+#endif
+}
+
+// 16-bit multiply scaled by 1/65535 with rounding-to-nearest (unorm16 counterpart of mul8).
+// t / 65535 == (t + 1 + (t >> 16)) >> 16 for t < 2^32 - 1; a*b + 32767 and the sum fit uint32_t.
+inline constexpr uint16_t mul16(uint16_t a, uint16_t b) noexcept {
+    return static_cast<uint16_t>(
+        (static_cast<uint32_t>(a) * b + 32767u + 1u + ((static_cast<uint32_t>(a) * b + 32767u) >> 16)) >> 16);
 }
 
 #if defined(__GNUC__) || defined(__clang__)
@@ -188,6 +254,70 @@ struct CS_PACKED csColorRGBA {
         return csColorRGBA{Aout, Rout, Gout, Bout};
     }
 
+    // Blend function B(Cd, Cs) of 'mode' for one channel.
+    [[nodiscard]] static inline uint8_t blendModeChannel(csBlendMode mode, uint8_t Cd, uint8_t Cs) noexcept {
+        switch (mode) {
+            case csBlendMode::Add: {
+                const uint16_t sum = static_cast<uint16_t>(Cd + Cs);
+                return static_cast<uint8_t>(sum > 255u ? 255u : sum);
+            }
+            case csBlendMode::Multiply:
+                return mul8(Cd, Cs);
+            case csBlendMode::Screen:
+                return static_cast<uint8_t>(Cd + Cs - mul8(Cd, Cs));
+            case csBlendMode::Max:
+                return Cd > Cs ? Cd : Cs;
+            case csBlendMode::Min:
+                return Cd < Cs ? Cd : Cs;
+            default:
+                return Cs;
+        }
+    }
+
+    // Source color with the 'mode' result mixed in by destination alpha; source alpha is kept.
+    // Cs' = mul8(Cs, 255 - Ad) + mul8(B(Cd, Cs), Ad), clamped to 255.
+    [[nodiscard]] static inline csColorRGBA mixBlendMode(csColorRGBA dst, csColorRGBA src, csBlendMode mode) noexcept {
+        const uint8_t Ad = dst.a;
+        const uint8_t invAd = static_cast<uint8_t>(255u - Ad);
+        auto mix = [&](uint8_t Cd, uint8_t Cs) noexcept -> uint8_t {
+            const uint16_t v = static_cast<uint16_t>(mul8(Cs, invAd) + mul8(blendModeChannel(mode, Cd, Cs), Ad));
+            return static_cast<uint8_t>(v > 255u ? 255u : v);
+        };
+        return csColorRGBA{src.a, mix(dst.r, src.r), mix(dst.g, src.g), mix(dst.b, src.b)};
+    }
+
+    // Blend src over dst with 'mode' (straight alpha); applies extra global alpha to source.
+    // SourceOver is exactly sourceOverStraight().
+    [[nodiscard]] static inline csColorRGBA blendStraight(csColorRGBA dst, csColorRGBA src, csBlendMode mode,
+                                                          uint8_t global_alpha = 255) noexcept {
+        if (mode != csBlendMode::SourceOver) {
+            src = mixBlendMode(dst, src, mode);
+        }
+        return sourceOverStraight(dst, src, global_alpha);
+    }
+
+    // Convert straight alpha to premultiplied alpha (channels scaled by alpha).
+    [[nodiscard]] inline csColorRGBA toPremul() const noexcept {
+        return csColorRGBA{a, mul8(r, a), mul8(g, a), mul8(b, a)};
+    }
+
+    // Convert premultiplied alpha back to straight alpha (lossy for low alpha values).
+    [[nodiscard]] inline csColorRGBA fromPremul() const noexcept {
+        return csColorRGBA{a, div255(r, a), div255(g, a), div255(b, a)};
+    }
+
+    // Porter-Duff SourceOver with premultiplied alpha (both colors premultiplied).
+    // One multiply-add per channel: out = src + dst * (1 - As).
+    [[nodiscard]] static inline csColorRGBA sourceOverPremul(csColorRGBA dst, csColorRGBA src) noexcept {
+        const uint8_t invAs = static_cast<uint8_t>(255u - src.a);
+        return csColorRGBA{
+            static_cast<uint8_t>(src.a + mul8(dst.a, invAs)),
+            static_cast<uint8_t>(src.r + mul8(dst.r, invAs)),
+            static_cast<uint8_t>(src.g + mul8(dst.g, invAs)),
+            static_cast<uint8_t>(src.b + mul8(dst.b, invAs))
+        };
+    }
+
     // Add channels of this color to 'other' and return 16-bit result (no saturation).
     [[nodiscard]] inline csColorRGBA16 sum(csColorRGBA other) const noexcept {
         return csColorRGBA16{
@@ -214,6 +344,28 @@ inline csColorRGBA csColorRGBA16::toColor8(uint16_t divisor) const noexcept {
     };
 }
 
+inline csColorRGBA16 csColorRGBA16::fromColor8Premul(csColorRGBA c) noexcept {
+    const uint16_t A = static_cast<uint16_t>(c.a * 257u);
+    return csColorRGBA16{
+        A,
+        mul16(static_cast<uint16_t>(c.r * 257u), A),
+        mul16(static_cast<uint16_t>(c.g * 257u), A),
+        mul16(static_cast<uint16_t>(c.b * 257u), A)
+    };
+}
+
+// a8 = round(A / 257); c8 = round(C * 255 / A), clamped to 255 (A == 0 gives transparent black).
+inline csColorRGBA csColorRGBA16::toColor8Straight() const noexcept {
+    const uint32_t A = a;
+    const uint32_t d = A ? A : 1u;
+    const uint32_t half = A / 2u;
+    auto channel = [&](uint32_t C) noexcept -> uint8_t {
+        const uint32_t q = (C * 255u + half) / d;
+        return static_cast<uint8_t>(q > 255u ? 255u : q);
+    };
+    return csColorRGBA{static_cast<uint8_t>((A * 255u + 32767u) / 65535u), channel(r), channel(g), channel(b)};
+}
+
 // TODO: 1. use `AMP_CONSTEXPR` instead of `if (__cplusplus >= 201402L`
 // TODO: 2. OPTIMIZE!!! - use a `uint8_t`
 // Linear interpolation of two channels with t in [0..255]; t=0 -> a, t=255 -> b.
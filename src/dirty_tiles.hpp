@@ -0,0 +1,260 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "color_rgba.hpp"
+#include "matrix_layout.hpp"
+#include "matrix_types.hpp"
+#include "rect.hpp"
+
+namespace amp {
+
+using ::size_t;
+using ::uint8_t;
+using ::uint32_t;
+
+// Dirty region tracking for a pixel matrix, in 8x8 tiles.
+//
+// Two stages:
+// - "touched": tiles written since the last commitFrame() (set by matrix write methods).
+// - "changed": result of commitFrame(): touched tiles whose content differs from the previous
+//   committed frame (per-tile 32-bit hash). Output drivers use this to skip unchanged pixels.
+//
+// The hash compare makes "clear + re-render the same picture" cost nothing at the output stage.
+// A hash collision (probability ~2^-32 per changed tile) hides a tile update until the tile's content
+// changes again: the stored hash already matches the new content, and an output that skips empty
+// dirty rects would keep the stale pixels for as long as the scene is static. To bound that, every
+// fullRefreshFrames-th commit reports all tiles as changed (setFullRefresh; 0 disables).
+//
+// clear() of the matrix only touches tiles that may hold non-zero pixels ("nonEmpty" bits).
+//
+// Every tile row starts on a fresh mask byte: writers of disjoint 8-row bands (parallel band
+// rendering, see csEffectManager::setThreadPool) never share a byte.
+class csDirtyTiles {
+public:
+    static constexpr uint8_t cTileShift = 3;
+    static constexpr tMatrixPixelsSize cTileSize = 1u << cTileShift;
+    static_assert(cTileShift == matrix_layout::cTileShift, "dirty tiles must match Tiled8x8 storage tiles");
+    // Default full refresh period in commits (~4 s at 60 FPS).
+    static constexpr uint16_t cDefaultFullRefresh = 256;
+
+    csDirtyTiles() = default;
+    csDirtyTiles(const csDirtyTiles&) = delete;
+    csDirtyTiles& operator=(const csDirtyTiles&) = delete;
+
+    ~csDirtyTiles() { release(); }
+
+    // Resize for matrix size (w, h). All tiles are reported as changed on the next commit.
+    void resize(tMatrixPixelsSize w, tMatrixPixelsSize h) {
+        release();
+        width_ = w;
+        height_ = h;
+        tilesX_ = static_cast<uint16_t>((w + cTileSize - 1u) >> cTileShift);
+        tilesY_ = static_cast<uint16_t>((h + cTileSize - 1u) >> cTileShift);
+        rowBytes_ = static_cast<uint16_t>((tilesX_ + 7u) / 8u);
+        const size_t tiles = tileCount();
+        if (tiles != 0) {
+            const size_t bytes = maskBytes();
+            touched_ = new uint8_t[bytes];
+            nonEmpty_ = new uint8_t[bytes];
+            changed_ = new uint8_t[bytes];
+            hashes_ = new uint32_t[tiles];
+            memset(touched_, 0, bytes);
+            memset(nonEmpty_, 0xFF, bytes);
+            memset(changed_, 0, bytes);
+        }
+        hashesValid_ = false;
+    }
+
+    // Report every tile as changed on every 'frames'-th commitFrame() (0: never).
+    void setFullRefresh(uint16_t frames) noexcept {
+        fullRefresh_ = frames;
+        sinceRefresh_ = 0;
+    }
+
+    [[nodiscard]] uint16_t tilesX() const noexcept { return tilesX_; }
+    [[nodiscard]] uint16_t tilesY() const noexcept { return tilesY_; }
+
+    // Mark pixel (x, y) as written. Coordinates must be inside the matrix.
+    inline void markPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y) noexcept {
+        setBit(touched_, bitIndex(x >> cTileShift, y >> cTileShift));
+        setBit(nonEmpty_, bitIndex(x >> cTileShift, y >> cTileShift));
+    }
+
+    // Mark 'len' pixels of row 'y' starting at 'x' as written. Span must be inside the matrix.
+    inline void markRow(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize len) noexcept {
+        if (len == 0) {
+            return;
+        }
+        const tMatrixPixelsCoord tx0 = x >> cTileShift;
+        const tMatrixPixelsCoord tx1 = (x + to_coord(len) - 1) >> cTileShift;
+        const tMatrixPixelsCoord ty = y >> cTileShift;
+        for (tMatrixPixelsCoord tx = tx0; tx <= tx1; ++tx) {
+            setBit(touched_, bitIndex(tx, ty));
+            setBit(nonEmpty_, bitIndex(tx, ty));
+        }
+    }
+
+    // Mark every tile as written.
+    void markAll() noexcept {
+        if (touched_) {
+            memset(touched_, 0xFF, maskBytes());
+            memset(nonEmpty_, 0xFF, maskBytes());
+        }
+    }
+
+    // Matrix was cleared to transparent black: only tiles that held data are touched.
+    void onClear() noexcept {
+        const size_t bytes = maskBytes();
+        for (size_t i = 0; i < bytes; ++i) {
+            touched_[i] |= nonEmpty_[i];
+            nonEmpty_[i] = 0;
+        }
+    }
+
+    // Finish frame: compare touched tiles with the previous frame and rebuild the "changed" set.
+    // 'pixels' is the matrix buffer (width_ x height_) stored in 'layout'; 'stride' is the RowMajor
+    // row pitch in pixels (0 = width_, larger for views over external memory).
+    void commitFrame(const csColorRGBA* pixels, csMatrixLayout layout = csMatrixLayout::RowMajor,
+                     size_t stride = 0) noexcept {
+        if (!touched_ || !pixels) {
+            return;
+        }
+        if (stride < width_) {
+            stride = width_;
+        }
+        if (fullRefresh_ != 0 && ++sinceRefresh_ >= fullRefresh_) {
+            sinceRefresh_ = 0;
+            hashesValid_ = false;
+        }
+        memset(changed_, 0, maskBytes());
+        for (uint16_t ty = 0; ty < tilesY_; ++ty) {
+            for (uint16_t tx = 0; tx < tilesX_; ++tx) {
+                const size_t t = tileIndex(tx, ty);
+                const size_t bit = bitIndex(tx, ty);
+                if (hashesValid_ && !getBit(touched_, bit)) {
+                    continue;
+                }
+                const uint32_t h = hashTile(pixels, layout, stride, tx, ty);
+                if (!hashesValid_ || h != hashes_[t]) {
+                    hashes_[t] = h;
+                    setBit(changed_, bit);
+                }
+            }
+        }
+        memset(touched_, 0, maskBytes());
+        hashesValid_ = true;
+    }
+
+    // Changed state of tile (tx, ty) after the last commitFrame().
+    [[nodiscard]] inline bool tileChanged(uint16_t tx, uint16_t ty) const noexcept {
+        return changed_ && getBit(changed_, bitIndex(tx, ty));
+    }
+
+    // Pixel rectangle of tile (tx, ty), clipped to matrix bounds.
+    [[nodiscard]] csRect tileRect(uint16_t tx, uint16_t ty) const noexcept {
+        const tMatrixPixelsCoord x = to_coord(tx) << cTileShift;
+        const tMatrixPixelsCoord y = to_coord(ty) << cTileShift;
+        return csRect{x, y, cTileSize, cTileSize}.intersect(csRect{0, 0, width_, height_});
+    }
+
+    // Bounding rectangle of all changed tiles (empty when nothing changed).
+    [[nodiscard]] csRect changedRect() const noexcept {
+        tMatrixPixelsCoord x0 = 0;
+        tMatrixPixelsCoord y0 = 0;
+        tMatrixPixelsCoord x1 = -1;
+        tMatrixPixelsCoord y1 = -1;
+        for (uint16_t ty = 0; ty < tilesY_; ++ty) {
+            for (uint16_t tx = 0; tx < tilesX_; ++tx) {
+                if (!tileChanged(tx, ty)) {
+                    continue;
+                }
+                if (x1 < x0) {
+                    x0 = x1 = tx;
+                    y0 = y1 = ty;
+                } else {
+                    x0 = min(x0, to_coord(tx));
+                    x1 = max(x1, to_coord(tx));
+                    y0 = min(y0, to_coord(ty));
+                    y1 = max(y1, to_coord(ty));
+                }
+            }
+        }
+        if (x1 < x0) {
+            return csRect{};
+        }
+        const csRect r{x0 << cTileShift, y0 << cTileShift,
+                       to_size((x1 - x0 + 1) << cTileShift), to_size((y1 - y0 + 1) << cTileShift)};
+        return r.intersect(csRect{0, 0, width_, height_});
+    }
+
+private:
+    tMatrixPixelsSize width_{0};
+    tMatrixPixelsSize height_{0};
+    uint16_t tilesX_{0};
+    uint16_t tilesY_{0};
+    uint16_t rowBytes_{0}; // mask bytes per tile row
+    uint8_t* touched_{nullptr};
+    uint8_t* nonEmpty_{nullptr};
+    uint8_t* changed_{nullptr};
+    uint32_t* hashes_{nullptr};
+    bool hashesValid_{false};
+    uint16_t fullRefresh_{cDefaultFullRefresh};
+    uint16_t sinceRefresh_{0};
+
+    [[nodiscard]] inline size_t tileCount() const noexcept { return static_cast<size_t>(tilesX_) * tilesY_; }
+    [[nodiscard]] inline size_t maskBytes() const noexcept { return static_cast<size_t>(rowBytes_) * tilesY_; }
+
+    [[nodiscard]] inline size_t tileIndex(tMatrixPixelsCoord tx, tMatrixPixelsCoord ty) const noexcept {
+        return static_cast<size_t>(ty) * tilesX_ + static_cast<size_t>(tx);
+    }
+
+    // Bit of tile (tx, ty) in the touched/nonEmpty/changed masks.
+    [[nodiscard]] inline size_t bitIndex(tMatrixPixelsCoord tx, tMatrixPixelsCoord ty) const noexcept {
+        return static_cast<size_t>(ty) * rowBytes_ * 8u + static_cast<size_t>(tx);
+    }
+
+    static inline void setBit(uint8_t* mask, size_t k) noexcept {
+        mask[k / 8] |= static_cast<uint8_t>(1U << (k % 8));
+    }
+
+    [[nodiscard]] static inline bool getBit(const uint8_t* mask, size_t k) noexcept {
+        return (mask[k / 8] & static_cast<uint8_t>(1U << (k % 8))) != 0;
+    }
+
+    // FNV-1a over the 32-bit pixel values of one tile.
+    // Tiled8x8 storage keeps each tile contiguous (padding pixels are never written, so they stay 0).
+    [[nodiscard]] uint32_t hashTile(const csColorRGBA* pixels, csMatrixLayout layout, size_t stride,
+                                  uint16_t tx, uint16_t ty) const noexcept {
+        uint32_t h = 2166136261u;
+        if (layout == csMatrixLayout::Tiled8x8) {
+            const csColorRGBA* tile = pixels + (tileIndex(tx, ty) << (2 * cTileShift));
+            for (size_t i = 0; i < (size_t{1} << (2 * cTileShift)); ++i) {
+                h = (h ^ tile[i].value) * 16777619u;
+            }
+            return h;
+        }
+        const csRect r = tileRect(tx, ty);
+        for (tMatrixPixelsCoord y = r.y; y < r.y + to_coord(r.height); ++y) {
+            const csColorRGBA* row = pixels + static_cast<size_t>(y) * stride;
+            for (tMatrixPixelsCoord x = r.x; x < r.x + to_coord(r.width); ++x) {
+                h = (h ^ row[x].value) * 16777619u;
+            }
+        }
+        return h;
+    }
+
+    void release() noexcept {
+        delete[] touched_;
+        delete[] nonEmpty_;
+        delete[] changed_;
+        delete[] hashes_;
+        touched_ = nullptr;
+        nonEmpty_ = nullptr;
+        changed_ = nullptr;
+        hashes_ = nullptr;
+    }
+};
+
+} // namespace amp
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include "amp_macros.hpp"
+
+// Reciprocal table for the division-free div255() (see color_rgba.hpp), stored in flash memory.
+// Entry A = ceil(255 * 65536 / A), entry 0 = 0.
+//
+// Generated by `scripts/gen_div255_lut.py` (the script also verifies exactness).
+// IMPORTANT: keep it in PROGMEM (Flash), not RAM.
+static const uint32_t PROGMEM amp_div255_recip[256] = {
+           0u, 16711680u,  8355840u,  5570560u,  4177920u,  3342336u,  2785280u,  2387383u,
+     2088960u,  1856854u,  1671168u,  1519244u,  1392640u,  1285514u,  1193692u,  1114112u,
+     1044480u,   983040u,   928427u,   879563u,   835584u,   795795u,   759622u,   726595u,
+      696320u,   668468u,   642757u,   618952u,   596846u,   576265u,   557056u,   539087u,
+      522240u,   506415u,   491520u,   477477u,   464214u,   451668u,   439782u,   428505u,
+      417792u,   407602u,   397898u,   388644u,   379811u,   371371u,   363298u,   355568u,
+      348160u,   341055u,   334234u,   327680u,   321379u,   315315u,   309476u,   303849u,
+      298423u,   293188u,   288133u,   283249u,   278528u,   273962u,   269544u,   265265u,
+      261120u,   257103u,   253208u,   249429u,   245760u,   242199u,   238739u,   235376u,
+      232107u,   228928u,   225834u,   222823u,   219891u,   217035u,   214253u,   211541u,
+      208896u,   206318u,   203801u,   201346u,   198949u,   196608u,   194322u,   192089u,
+      189906u,   187772u,   185686u,   183645u,   181649u,   179696u,   177784u,   175913u,
+      174080u,   172286u,   170528u,   168805u,   167117u,   165463u,   163840u,   162250u,
+      160690u,   159159u,   157658u,   156184u,   154738u,   153319u,   151925u,   150556u,
+      149212u,   147891u,   146594u,   145319u,   144067u,   142835u,   141625u,   140435u,
+      139264u,   138114u,   136981u,   135868u,   134772u,   133694u,   132633u,   131589u,
+      130560u,   129548u,   128552u,   127571u,   126604u,   125652u,   124715u,   123791u,
+      122880u,   121984u,   121100u,   120228u,   119370u,   118523u,   117688u,   116865u,
+      116054u,   115253u,   114464u,   113685u,   112917u,   112159u,   111412u,   110674u,
+      109946u,   109227u,   108518u,   107818u,   107127u,   106444u,   105771u,   105105u,
+      104448u,   103800u,   103159u,   102526u,   101901u,   101283u,   100673u,   100070u,
+       99475u,    98886u,    98304u,    97730u,    97161u,    96600u,    96045u,    95496u,
+       94953u,    94417u,    93886u,    93362u,    92843u,    92330u,    91823u,    91321u,
+       90825u,    90334u,    89848u,    89368u,    88892u,    88422u,    87957u,    87496u,
+       87040u,    86590u,    86143u,    85701u,    85264u,    84831u,    84403u,    83979u,
+       83559u,    83143u,    82732u,    82324u,    81920u,    81521u,    81125u,    80733u,
+       80345u,    79961u,    79580u,    79203u,    78829u,    78459u,    78092u,    77729u,
+       77369u,    77013u,    76660u,    76310u,    75963u,    75619u,    75278u,    74941u,
+       74606u,    74275u,    73946u,    73620u,    73297u,    72977u,    72660u,    72345u,
+       72034u,    71724u,    71418u,    71114u,    70813u,    70514u,    70218u,    69924u,
+       69632u,    69344u,    69057u,    68773u,    68491u,    68211u,    67934u,    67659u,
+       67386u,    67116u,    66847u,    66581u,    66317u,    66055u,    65795u,    65536u,
+};
@@ -0,0 +1,408 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "matrix_base.hpp"
+#include "render_base.hpp"
+#include "thread_pool.hpp"
+
+namespace amp {
+
+// Problem found while building a csEffectGraph; indices are positions in the effect list.
+struct csEffectHazard {
+    enum class Kind : uint8_t {
+        // 'effect' reads 'matrix', but the first writer of it ('other') comes later in the list:
+        // the read sees the previous frame. With reorder the writers are moved before the reader.
+        ReadBeforeWrite,
+        // Reordering put 'effect' on (or behind) a dependency cycle; 'other' is one of its
+        // unresolved successors. The graph falls back to list order.
+        Cycle
+    };
+
+    Kind kind;
+    uint8_t effect;
+    uint8_t other;
+    const csMatrixBase* matrix;
+};
+
+// Dependency graph of an effect list, derived from the matrix pointer properties of the effects:
+// matrixDest is written, every other property of type Matrix (matrixSource, matrixIndex, ...) is read.
+//
+// Edge a -> b (a renders first) when a comes before b in the list and
+//  - both write the same matrix (blending order), or one reads what the other writes;
+//  - both read the same matrix (csMatrixPixels fills its row alpha cache on read);
+//  - either one is opaque to the analysis: not a matrix renderer, or links other effects
+//    (containers, clocks) whose matrices are not visible here.
+// Matrices are compared by storageOwner(): a sub view conflicts with its parent.
+//
+// Effects without edges between them are independent: run() renders them concurrently.
+class csEffectGraph {
+public:
+    static constexpr uint8_t cMaxReads = 4;
+    static constexpr uint8_t cMaxHazards = 16;
+
+    csEffectGraph() = default;
+    csEffectGraph(const csEffectGraph&) = delete;
+    csEffectGraph& operator=(const csEffectGraph&) = delete;
+
+    ~csEffectGraph() {
+        release();
+    }
+
+    // Rebuild for effects[0..count-1].
+    // reorder: every writer of a matrix renders before its readers, even when the list says
+    // otherwise (see csEffectHazard::ReadBeforeWrite); on a cycle the list order is kept.
+    void build(csEffectBase* const* effects, uint8_t count, bool reorder = false) {
+        reserve(count);
+        count_ = count;
+        hazardCount_ = 0;
+        hasCycle_ = false;
+        if (count == 0) {
+            return;
+        }
+        for (uint8_t i = 0; i < count; ++i) {
+            collect(effects[i], nodes_[i]);
+        }
+
+        linkListOrder();
+        findReadBeforeWrite(reorder);
+        if (sortTopological()) {
+            return;
+        }
+        // Reordering closed a cycle: report it and keep the list order (always acyclic).
+        hasCycle_ = true;
+        for (uint8_t i = 0; i < count_; ++i) {
+            if (predCount_[i] == 0 || predCount_[i] == UINT8_MAX) {
+                continue;
+            }
+            for (uint8_t j = 0; j < count_; ++j) {
+                if (predCount_[j] != 0 && predCount_[j] != UINT8_MAX && hasEdge(i, j)) {
+                    addHazard(csEffectHazard::Kind::Cycle, i, j, nullptr);
+                    break;
+                }
+            }
+        }
+        linkListOrder();
+        sortTopological();
+    }
+
+    // Number of effects in the graph.
+    [[nodiscard]] uint8_t size() const noexcept {
+        return count_;
+    }
+
+    // Effect indices in a valid render order (list order wherever dependencies allow).
+    [[nodiscard]] const uint8_t* order() const noexcept {
+        return order_;
+    }
+
+    // true when 'before' must render before 'after' (direct edge).
+    [[nodiscard]] bool dependsOn(uint8_t after, uint8_t before) const noexcept {
+        return after < count_ && before < count_ && hasEdge(before, after);
+    }
+
+    [[nodiscard]] uint8_t hazardCount() const noexcept {
+        return hazardCount_;
+    }
+
+    [[nodiscard]] const csEffectHazard& hazard(uint8_t i) const noexcept {
+        return hazards_[i];
+    }
+
+    // true when reordering was requested but produced a cycle (see csEffectHazard::Cycle).
+    [[nodiscard]] bool hasCycle() const noexcept {
+        return hasCycle_;
+    }
+
+    // Call fn(index) once per effect, every effect after all of its predecessors.
+    // Without a pool (or with one thread) this walks order(); otherwise ready effects are taken
+    // from a shared queue by all pool threads, so independent branches render concurrently.
+    template <typename F>
+    void run(csThreadPool* pool, const F& fn) const {
+#if AMP_ENABLE_THREADS
+        if (pool && pool->threadCount() > 1 && count_ > 1) {
+            runParallel(*pool, fn);
+            return;
+        }
+#else
+        (void)pool;
+#endif
+        for (uint8_t i = 0; i < count_; ++i) {
+            fn(order_[i]);
+        }
+    }
+
+private:
+    struct Node {
+        const csMatrixBase* write;
+        const csMatrixBase* reads[cMaxReads];
+        uint8_t readCount;
+        // Not analysable: ordered against every other effect.
+        bool barrier;
+    };
+
+    Node* nodes_{nullptr};
+    uint8_t* edges_{nullptr};     // bit (a * capacity_ + b): edge a -> b
+    uint8_t* order_{nullptr};
+    uint8_t* predCount_{nullptr}; // scratch of sortTopological()
+    uint8_t capacity_{0};
+    uint8_t count_{0};
+    csEffectHazard hazards_[cMaxHazards];
+    uint8_t hazardCount_{0};
+    bool hasCycle_{false};
+
+    void reserve(uint8_t count) {
+        if (count <= capacity_) {
+            return;
+        }
+        release();
+        capacity_ = count;
+        nodes_ = new Node[count];
+        edges_ = new uint8_t[edgeBytes()];
+        order_ = new uint8_t[count];
+        predCount_ = new uint8_t[count];
+    }
+
+    void release() noexcept {
+        delete[] nodes_;
+        delete[] edges_;
+        delete[] order_;
+        delete[] predCount_;
+        nodes_ = nullptr;
+        edges_ = nullptr;
+        order_ = nullptr;
+        predCount_ = nullptr;
+        capacity_ = 0;
+        count_ = 0;
+    }
+
+    [[nodiscard]] size_t edgeBytes() const noexcept {
+        return (static_cast<size_t>(capacity_) * capacity_ + 7u) / 8u;
+    }
+
+    [[nodiscard]] size_t edgeBit(uint8_t a, uint8_t b) const noexcept {
+        return static_cast<size_t>(a) * capacity_ + b;
+    }
+
+    [[nodiscard]] bool hasEdge(uint8_t a, uint8_t b) const noexcept {
+        const size_t k = edgeBit(a, b);
+        return (edges_[k / 8] & static_cast<uint8_t>(1U << (k % 8))) != 0;
+    }
+
+    void setEdge(uint8_t a, uint8_t b, bool on) noexcept {
+        const size_t k = edgeBit(a, b);
+        const uint8_t bit = static_cast<uint8_t>(1U << (k % 8));
+        edges_[k / 8] = on ? static_cast<uint8_t>(edges_[k / 8] | bit) : static_cast<uint8_t>(edges_[k / 8] & ~bit);
+    }
+
+    void addHazard(csEffectHazard::Kind kind, uint8_t effect, uint8_t other, const csMatrixBase* matrix) noexcept {
+        if (hazardCount_ < cMaxHazards) {
+            hazards_[hazardCount_++] = csEffectHazard{kind, effect, other, matrix};
+        }
+    }
+
+    static const csMatrixBase* owner(const csMatrixBase* m) noexcept {
+        return m ? m->storageOwner() : nullptr;
+    }
+
+    // Matrices of one effect, from its property table.
+    static void collect(csEffectBase* eff, Node& node) {
+        node.write = nullptr;
+        node.readCount = 0;
+        node.barrier = true;
+        if (!eff || !eff->queryClassFamily(PropType::EffectMatrixDest)) {
+            return;
+        }
+        node.barrier = false;
+        const uint8_t propCount = eff->getPropsCount();
+        for (uint8_t propNum = 1; propNum <= propCount; ++propNum) {
+            csPropInfo info;
+            eff->getPropInfo(propNum, info);
+            if (info.disabled || !info.valuePtr) {
+                continue;
+            }
+            if (info.valueType >= PropType::EffectBase) {
+                if (*static_cast<csEffectBase* const*>(info.valuePtr) != nullptr) {
+                    node.barrier = true;
+                }
+                continue;
+            }
+            if (info.valueType != PropType::Matrix) {
+                continue;
+            }
+            // Matrix properties hold csMatrixBase* or csMatrixPixels* (single inheritance: same address).
+            const csMatrixBase* m = owner(*static_cast<csMatrixBase* const*>(info.valuePtr));
+            if (!m) {
+                continue;
+            }
+            if (propNum == csEffectBase::propMatrixDest) {
+                node.write = m;
+            } else if (node.readCount < cMaxReads) {
+                node.reads[node.readCount++] = m;
+            } else {
+                node.barrier = true;
+            }
+        }
+        // Reading the own destination is covered by the write ordering.
+        uint8_t kept = 0;
+        for (uint8_t r = 0; r < node.readCount; ++r) {
+            if (node.reads[r] != node.write) {
+                node.reads[kept++] = node.reads[r];
+            }
+        }
+        node.readCount = kept;
+    }
+
+    [[nodiscard]] static bool reads(const Node& node, const csMatrixBase* m) noexcept {
+        for (uint8_t r = 0; r < node.readCount; ++r) {
+            if (node.reads[r] == m) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] static bool conflict(const Node& a, const Node& b) noexcept {
+        if (a.barrier || b.barrier) {
+            return true;
+        }
+        if (a.write && (a.write == b.write || reads(b, a.write))) {
+            return true;
+        }
+        if (b.write && reads(a, b.write)) {
+            return true;
+        }
+        for (uint8_t r = 0; r < a.readCount; ++r) {
+            if (reads(b, a.reads[r])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Edges in list direction for every conflicting pair.
+    void linkListOrder() noexcept {
+        memset(edges_, 0, edgeBytes());
+        for (uint8_t a = 0; a < count_; ++a) {
+            for (uint8_t b = static_cast<uint8_t>(a + 1); b < count_; ++b) {
+                if (conflict(nodes_[a], nodes_[b])) {
+                    setEdge(a, b, true);
+                }
+            }
+        }
+    }
+
+    // Report reads of matrices that are only written later; with 'reorder' flip those edges.
+    void findReadBeforeWrite(bool reorder) noexcept {
+        for (uint8_t j = 0; j < count_; ++j) {
+            const Node& reader = nodes_[j];
+            for (uint8_t r = 0; r < reader.readCount; ++r) {
+                const csMatrixBase* m = reader.reads[r];
+                bool writtenBefore = false;
+                for (uint8_t i = 0; i < j && !writtenBefore; ++i) {
+                    writtenBefore = nodes_[i].write == m;
+                }
+                if (writtenBefore) {
+                    continue;
+                }
+                bool reported = false;
+                for (uint8_t k = static_cast<uint8_t>(j + 1); k < count_; ++k) {
+                    if (nodes_[k].write != m) {
+                        continue;
+                    }
+                    if (!reported) {
+                        addHazard(csEffectHazard::Kind::ReadBeforeWrite, j, k, m);
+                        reported = true;
+                    }
+                    if (reorder) {
+                        setEdge(j, k, false);
+                        setEdge(k, j, true);
+                    }
+                }
+            }
+        }
+    }
+
+    // Kahn's algorithm, lowest list index first. false on a cycle (order_ is then incomplete).
+    bool sortTopological() noexcept {
+        for (uint8_t b = 0; b < count_; ++b) {
+            uint8_t preds = 0;
+            for (uint8_t a = 0; a < count_; ++a) {
+                preds = static_cast<uint8_t>(preds + (hasEdge(a, b) ? 1 : 0));
+            }
+            predCount_[b] = preds;
+        }
+        uint8_t placed = 0;
+        while (placed < count_) {
+            uint8_t next = count_;
+            for (uint8_t i = 0; i < count_; ++i) {
+                if (predCount_[i] == 0) {
+                    next = i;
+                    break;
+                }
+            }
+            if (next == count_) {
+                return false;
+            }
+            order_[placed++] = next;
+            predCount_[next] = UINT8_MAX; // placed
+            for (uint8_t b = 0; b < count_; ++b) {
+                if (hasEdge(next, b) && predCount_[b] != UINT8_MAX) {
+                    --predCount_[b];
+                }
+            }
+        }
+        for (uint8_t i = 0; i < count_; ++i) {
+            predCount_[i] = 0;
+        }
+        return true;
+    }
+
+#if AMP_ENABLE_THREADS
+    // Every pool thread loops: take a ready effect, render it, release its successors.
+    template <typename F>
+    void runParallel(csThreadPool& pool, const F& fn) const {
+        uint8_t pending[UINT8_MAX];
+        uint8_t ready[UINT8_MAX];
+        uint8_t readyCount = 0;
+        uint8_t done = 0;
+        for (uint8_t b = 0; b < count_; ++b) {
+            pending[b] = 0;
+            for (uint8_t a = 0; a < count_; ++a) {
+                pending[b] = static_cast<uint8_t>(pending[b] + (hasEdge(a, b) ? 1 : 0));
+            }
+        }
+        // Highest list index at the bottom: list order is preferred when several are ready.
+        for (uint8_t i = count_; i-- > 0;) {
+            if (pending[i] == 0) {
+                ready[readyCount++] = i;
+            }
+        }
+        std::mutex mutex;
+        std::condition_variable wake;
+        pool.parallelFor(pool.threadCount(), [&](uint16_t /*slot*/) {
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;) {
+                wake.wait(lock, [&] { return readyCount != 0 || done == count_; });
+                if (readyCount == 0) {
+                    return;
+                }
+                const uint8_t node = ready[--readyCount];
+                lock.unlock();
+                fn(node);
+                lock.lock();
+                ++done;
+                for (uint8_t b = 0; b < count_; ++b) {
+                    if (hasEdge(node, b) && --pending[b] == 0) {
+                        ready[readyCount++] = b;
+                    }
+                }
+                wake.notify_all();
+            }
+        });
+    }
+#endif
+};
+
+} // namespace amp
@@ -1,4 +1,4 @@
-// Effect manager for managing array of effects
+// Effect manager: registry of effects (render order, stable handles, Effect property index)
 #ifndef EFFECT_MANAGER_HPP
 #define EFFECT_MANAGER_HPP
 
@@ -7,179 +7,225 @@
 #include <stdint.h>
 #include <limits.h>
 #include "matrix_pixels.hpp"
+#include "matrix_utils.hpp"
 #include "render_base.hpp"
 #include "rand_gen.hpp"
+#include "effect_graph.hpp"
+#include "thread_pool.hpp"
+#include "slot_pool.hpp"
+#include "effect_profiler.hpp"
+
+// Time the rest of the scope into the profile of the effect at order index 'index'.
+#if AMP_ENABLE_PROFILER
+#  define AMP_PROFILE_EFFECT(index, phase) \
+      csEffectProfileScope ampProfileScope_(profileAt(index), csEffectProfile::phase)
+#else
+#  define AMP_PROFILE_EFFECT(index, phase) ((void)0)
+#endif
 
 namespace amp {
 
 class csEffectManager {
 public:
-    static constexpr uint8_t maxEffects = 10;
+    // Stable id of an added effect: unchanged by adding or removing other effects, valid until the
+    // effect itself is removed (then the id may be reused by a later add()).
+    using tEffectHandle = uint8_t;
+
+    static constexpr uint8_t maxEffects = UINT8_MAX - 1;
     static constexpr uint8_t notFound = UINT8_MAX;
+    static constexpr tEffectHandle invalidHandle = UINT8_MAX;
 
     csEffectManager() = default;
 
+    csEffectManager(const csEffectManager&) = delete;
+    csEffectManager& operator=(const csEffectManager&) = delete;
+
     // Virtual destructor: safe deletion through base pointer in polymorphic class.
     virtual ~csEffectManager() {
         clearAll();
     }
 
-    // Add effect (returns index or notFound if array is full or effect is null)
+    // Add effect to the end of the render order (returns index or notFound if the registry is full
+    // or effect is null). O(1) plus one pass over the properties of 'eff'.
     uint8_t add(csEffectBase* eff) {
-        if (!eff) {
+        if (addHandle(eff) == invalidHandle) {
             return notFound;
         }
-        // Check if we need to grow the array
-        if (effectsCount >= effectsCapacity) {
-            uint8_t newCapacity = (effectsCapacity == 0) ? 4 : effectsCapacity * 2;
-            if (newCapacity > maxEffects) {
-                newCapacity = maxEffects;
-            }
-            if (newCapacity <= effectsCapacity) {
-                return notFound; // Array is full (reached maxEffects)
+        return static_cast<uint8_t>(effectsCount - 1u);
+    }
+
+    // Same as add(), returns the handle of the effect (invalidHandle on failure).
+    tEffectHandle addHandle(csEffectBase* eff) {
+        if (!eff || effectsCount >= maxEffects) {
+            return invalidHandle;
+        }
+        const tEffectHandle h = slots.acquire();
+        if (h == invalidHandle) {
+            return invalidHandle;
+        }
+        csEffectSlot& s = slots[h];
+        s.effect = eff;
+        s.caps = eff->getCapabilities();
+#if AMP_ENABLE_PROFILER
+        s.profile = profiling ? new csEffectProfile() : nullptr;
+#endif
+        s.prev = tail;
+        s.next = invalidHandle;
+        s.effectProps = invalidHandle;
+        if (tail != invalidHandle) {
+            slots[tail].next = h;
+        } else {
+            head = h;
+        }
+        tail = h;
+        if (orderValid && effectsCount < orderCapacity) {
+            orderEffects[effectsCount] = eff;
+            orderSlots[effectsCount] = h;
+            orderCaps[effectsCount] = s.caps;
+            if (s.caps & effect_caps::PostFrame) {
+                postFrameIndex[postFrameCount++] = effectsCount;
             }
-            resizeArray(newCapacity);
+        } else {
+            orderValid = false;
         }
-        // Add to the end
-        effects[effectsCount] = eff;
-        bindEffectMatrix(eff);
-        return effectsCount++;
+        ++effectsCount;
+        indexRefs(h);
+        bindEffectMatrix(eff, s.caps);
+        return h;
     }
 
-    // Remove effect by index
+    // Remove effect by index (deletes it; references to it from other effects are left as is,
+    // see deleteSlowAndSafety()).
     void remove(uint8_t index) {
-        if (index >= effectsCount) {
+        removeHandle(handle(index));
+    }
+
+    // Remove effect by handle in O(1) (deletes it, like remove()).
+    void removeHandle(tEffectHandle h) {
+        if (!isLive(h)) {
             return;
         }
-        deleteEffect(effects[index]);
-        
-        // Shift elements left to maintain compact array
-        for (uint8_t i = index; i < effectsCount - 1; ++i) {
-            effects[i] = effects[i + 1];
-        }
-        effectsCount--;
-        
-        // Shrink array if more than 25% is empty
-        // Empty space = effectsCapacity - effectsCount
-        // 25% empty means: (effectsCapacity - effectsCount) >= effectsCapacity * 0.25
-        // Which is equivalent to: effectsCount <= effectsCapacity * 0.75
-        if (effectsCapacity > 0 && effectsCount > 0) {
-            uint8_t threshold = (effectsCapacity * 3) / 4; // 75% of capacity
-            if (effectsCount <= threshold) {
-                uint8_t newCapacity = effectsCount * 2;
-                if (newCapacity < 4) {
-                    newCapacity = (effectsCount > 0) ? 4 : 0;
-                }
-                resizeArray(newCapacity);
-            }
-        } else if (effectsCount == 0 && effectsCapacity > 0) {
-            // Free array if empty
-            delete[] effects;
-            effects = nullptr;
-            effectsCapacity = 0;
-        }
+        csEffectBase* eff = slots[h].effect;
+        unlink(h);
+        deleteEffect(eff);
     }
 
     // Set effect at specific index (removes existing effect if present)
     // NOTE: This is the ONLY way to write/set effects. operator[] is read-only.
+    // The handle of the index is kept.
     void set(uint8_t index, csEffectBase* eff) {
-        if (index >= effectsCount) {
+        const tEffectHandle h = handle(index);
+        if (h == invalidHandle) {
             return; // Index out of range
         }
         if (eff == nullptr) {
-            remove(index);
+            removeHandle(h);
             return;
         }
+        csEffectSlot& s = slots[h];
+        csEffectBase* old = s.effect;
+        dropRefs(h);
         // Remove existing effect at this index
-        deleteEffect(effects[index]);
+        deleteEffect(old);
         // Set new effect
-        effects[index] = eff;
-        bindEffectMatrix(eff);
+        s.effect = eff;
+        s.caps = eff->getCapabilities();
+#if AMP_ENABLE_PROFILER
+        if (s.profile) {
+            s.profile->reset();
+        }
+#endif
+        orderValid = false;
+        indexRefs(h);
+        bindEffectMatrix(eff, s.caps);
     }
 
     // Clear all effects
     void clearAll() {
-        for (uint8_t i = 0; i < effectsCount; ++i) {
-            deleteEffect(effects[i]);
-        }
-        if (effects != nullptr) {
-            delete[] effects;
-            effects = nullptr;
+        for (tEffectHandle h = head; h != invalidHandle;) {
+            const tEffectHandle next = slots[h].next;
+            deleteEffect(slots[h].effect);
+#if AMP_ENABLE_PROFILER
+            delete slots[h].profile;
+#endif
+            h = next;
         }
+        slots.clear();
+        refs.clear();
+        refsOverflow = false;
+        head = invalidHandle;
+        tail = invalidHandle;
         effectsCount = 0;
-        effectsCapacity = 0;
+        freeOrder();
+        orderValid = true;
     }
 
     // Delete effect with safety: clears all references to it from other effects' properties
-    // Before deletion, scans all effects and their properties, and if any property
-    // of type Effect points to the object being deleted, sets it to nullptr and calls propChanged
+    // (every property of type Effect that points to the deleted object is set to nullptr and
+    // propChanged is called). Only the Effect-typed properties are visited: they are indexed by
+    // owner and property number in add() / set(), so values assigned later are found too.
+    // This is not a target -> (owner, property) index: properties are plain fields written without
+    // a manager hook, so the targets are not known ahead. Every delete walks all live effects and
+    // reads each of their Effect-typed properties once (getPropInfo), i.e. O(effects + Effect-typed
+    // properties) instead of O(all properties).
     void deleteSlowAndSafety(uint8_t index) {
-        if (index >= effectsCount) {
-            return;
-        }
+        deleteSafe(handle(index));
+    }
 
-        csEffectBase* eff = effects[index];
-        if (!eff) {
+    // deleteSlowAndSafety() by handle.
+    void deleteSafe(tEffectHandle h) {
+        if (!isLive(h)) {
             return;
         }
-
-        // Scan all effects and their properties
-        for (uint8_t i = 0; i < effectsCount; ++i) {
-            if (i == index) {
-                continue; // Skip the effect being deleted
-            }
-
-            csEffectBase* currentEff = effects[i];
-            const uint8_t propCount = currentEff->getPropsCount();
-
-            // Enumerate all properties
-            for (uint8_t propNum = 1; propNum <= propCount; ++propNum) {
-                csPropInfo info;
-                currentEff->getPropInfo(propNum, info);
-
-                // Check if property is of type Effect (pointer to effect)
-                // All effect family types are >= EffectBase ("Effect*")
-                // Using >= ensures we catch all current and future effect family types
-                if ((info.valueType >= PropType::EffectBase) && (info.valuePtr != nullptr)) {
-                    // Compare pointer value with the effect being deleted
-                    csEffectBase** effectPtr = static_cast<csEffectBase**>(info.valuePtr);
-                    if (*effectPtr == eff) {
-                        // Found reference to the effect being deleted
-                        *effectPtr = nullptr;
-                        currentEff->propChanged(propNum);
-                    }
+        csEffectBase* eff = slots[h].effect;
+        if (refsOverflow) {
+            // Property index incomplete: scan every property of every effect.
+            clearRefsByScan(eff);
+        } else {
+            for (tEffectHandle o = head; o != invalidHandle; o = slots[o].next) {
+                csEffectBase* owner = slots[o].effect;
+                if (owner == eff) {
+                    continue; // Self reference: deleted together with the effect
+                }
+                for (uint8_t r = slots[o].effectProps; r != invalidHandle; r = refs[r].next) {
+                    clearRef(owner, refs[r].propNum, eff);
                 }
             }
         }
-
-        // Shift elements left to maintain compact array
-        for (uint8_t i = index; i < effectsCount - 1; ++i) {
-            effects[i] = effects[i + 1];
-        }
-        effectsCount--;
-
+        unlink(h);
         // Now safe to delete the effect
         deleteEffect(eff);
+    }
 
-        // Shrink array if more than 25% is empty
-        // Empty space = effectsCapacity - effectsCount
-        // 25% empty means: (effectsCapacity - effectsCount) >= effectsCapacity * 0.25
-        // Which is equivalent to: effectsCount <= effectsCapacity * 0.75
-        if (effectsCapacity > 0 && effectsCount > 0) {
-            uint8_t threshold = (effectsCapacity * 3) / 4; // 75% of capacity
-            if (effectsCount <= threshold) {
-                uint8_t newCapacity = effectsCount * 2;
-                if (newCapacity < 4) {
-                    newCapacity = (effectsCount > 0) ? 4 : 0;
-                }
-                resizeArray(newCapacity);
+    // Handle of the effect at 'index' in render order (invalidHandle if out of range).
+    tEffectHandle handle(uint8_t index) const {
+        if (index >= effectsCount) {
+            return invalidHandle;
+        }
+        ensureOrder();
+        return orderSlots[index];
+    }
+
+    // Handle of 'eff' (invalidHandle if not in the manager). O(n).
+    tEffectHandle find(const csEffectBase* eff) const {
+        if (!eff) {
+            return invalidHandle;
+        }
+        for (tEffectHandle h = head; h != invalidHandle; h = slots[h].next) {
+            if (slots[h].effect == eff) {
+                return h;
             }
-        } else if (effectsCount == 0 && effectsCapacity > 0) {
-            // Free array if empty
-            delete[] effects;
-            effects = nullptr;
-            effectsCapacity = 0;
         }
+        return invalidHandle;
+    }
+
+    // Effect of a handle (nullptr if the handle is not in use).
+    csEffectBase* getByHandle(tEffectHandle h) {
+        return isLive(h) ? slots[h].effect : nullptr;
+    }
+
+    const csEffectBase* getByHandle(tEffectHandle h) const {
+        return isLive(h) ? slots[h].effect : nullptr;
     }
 
     // Set matrix and bind to all effects
@@ -202,48 +248,175 @@ public:
         if (!matrix) {
             return;
         }
+        ensureOrder();
         for (uint8_t i = 0; i < effectsCount; ++i) {
-            bindEffectMatrix(effects[i]);
+            bindEffectMatrix(orderEffects[i], orderCaps[i]);
         }
     }
 
+    // Parallel render mode: runs of consecutive band-capable effects (effect_caps::ThreadSafe)
+    // are rendered by 'pool' in horizontal bands of the matrix; other effects render serially on the
+    // calling thread, in list order. The frame is the same as with serial rendering.
+    // The pool is not owned; nullptr (default) or a single-thread pool restores serial rendering.
+    void setThreadPool(csThreadPool* pool) {
+        threadPool = pool;
+    }
+
+    csThreadPool* getThreadPool() {
+        return threadPool;
+    }
+
+    // Graph scheduling: each render() derives the dependency graph of the effects from their
+    // matrix properties (see csEffectGraph) and renders in its order; with a thread pool,
+    // independent branches (e.g. effects drawing into different scratch matrices) render
+    // concurrently. Band rendering is not used in this mode.
+    // Every effect gets its own random generator, seeded from randGen once per frame, so the frame
+    // does not depend on the thread count. reorder: see csEffectGraph::build().
+    void setGraphScheduling(bool enable, bool reorder = false) {
+        graphScheduling = enable;
+        graphReorder = reorder;
+    }
+
+    // Reduced resolution (csResolutionGovernor of csMatrixSFXSystem): with divisor > 1, runs of
+    // consecutive effect_caps::Scalable effects that draw into the manager matrix with SourceOver
+    // render into 'scratch' at 1/divisor of the resolution (csRenderMatrixBase::renderScaled); each
+    // one is upscaled onto its own rectDest with drawMatrixScale() at its place in the order, so
+    // pixels outside the effects are not touched. 'scratch' (straight alpha, not owned) needs at
+    // least scaledSize(width) x scaledSize(height) pixels. divisor <= 1 or nullptr: full resolution.
+    // Not used in graph scheduling mode.
+    void setRenderDivisor(uint8_t divisor, csMatrixPixels* scratch) {
+        renderDivisor = (scratch && divisor > 1) ? divisor : 1;
+        lowResMatrix = (renderDivisor > 1) ? scratch : nullptr;
+    }
+
+    uint8_t getRenderDivisor() const {
+        return renderDivisor;
+    }
+
+    // Scratch size for 'size' pixels at 1/divisor: one extra pixel keeps the bilinear upscale from
+    // fading towards transparent at the right / bottom matrix border.
+    static tMatrixPixelsSize scaledSize(tMatrixPixelsSize size, uint8_t divisor) {
+        return static_cast<tMatrixPixelsSize>((size + divisor - 1u) / divisor + 1u);
+    }
+
+    // Graph of the last render() in graph scheduling mode (order, hazards, cycles).
+    const csEffectGraph& getGraph() const {
+        return graph;
+    }
+
     // Recalc all effects (update internal state, no rendering)
     void recalc(csRandGen& randGen, tTime currTime) {
+        ensureOrder();
         for (uint8_t i = 0; i < effectsCount; ++i) {
-            effects[i]->recalc(randGen, currTime);
+            AMP_PROFILE_EFFECT(i, Recalc);
+            orderEffects[i]->recalc(randGen, currTime);
         }
     }
 
     // Render all effects and call onFrameDone for post-frame effects
     void render(csRandGen& randGen, tTime currTime) {
-        auto isPostFrame = [](csEffectBase* eff) -> bool {
-            return eff->queryClassFamily(PropType::EffectPostFrame) != nullptr;
-        };
+        ensureOrder();
+        const bool parallel = matrix && threadPool && threadPool->threadCount() > 1;
+        if (graphScheduling) {
+            renderGraph(randGen, currTime);
+        }
+        const bool scaled = matrix && lowResMatrix;
+        uint8_t i = graphScheduling ? effectsCount : 0;
+        while (i < effectsCount) {
+            if (scaled) {
+                uint8_t scaledEnd = i;
+                while (scaledEnd < effectsCount && canRenderScaled(scaledEnd)) {
+                    ++scaledEnd;
+                }
+                if (scaledEnd > i) {
+                    renderScaled(i, scaledEnd, currTime);
+                    i = scaledEnd;
+                    continue;
+                }
+            }
+            uint8_t runEnd = i;
+            if (parallel) {
+                while (runEnd < effectsCount && (orderCaps[runEnd] & effect_caps::ThreadSafe)) {
+                    ++runEnd;
+                }
+            }
+            if (runEnd > i) {
+                renderBands(i, runEnd, currTime);
+                i = runEnd;
+            } else {
+                AMP_PROFILE_EFFECT(i, Render);
+                orderEffects[i]->render(randGen, currTime);
+                ++i;
+            }
+        }
 
-        for (uint8_t i = 0; i < effectsCount; ++i) {
-            effects[i]->render(randGen, currTime);
+        if (matrix) {
+            for (uint8_t k = 0; k < postFrameCount; ++k) {
+                const uint8_t index = postFrameIndex[k];
+                AMP_PROFILE_EFFECT(index, FrameDone);
+                orderEffects[index]->onFrameDone(*matrix, randGen, currTime);
+            }
         }
+#if AMP_ENABLE_PROFILER
+        if (profiling) {
+            for (uint8_t k = 0; k < effectsCount; ++k) {
+                profileAt(k)->endFrame();
+            }
+        }
+#endif
 
         if (!matrix) {
             return;
         }
 
-        for (uint8_t i = 0; i < effectsCount; ++i) {
-            if (isPostFrame(effects[i])) {
-                effects[i]->onFrameDone(*matrix, randGen, currTime);
-            }
-        }
+        // Frame complete: publish changed tiles (no-op unless matrix dirty tracking is enabled)
+        matrix->commitDirtyFrame();
+        // Scratch buffers of this frame may go back to the heap (see csMatrixBufferPool).
+        matrix_buffer::endFrame();
+    }
+
+    // Area changed by the last render() (tile-aligned bounding box).
+    // Whole matrix when dirty tracking is disabled; empty rect when nothing changed or no matrix.
+    csRect getDirtyRect() const {
+        return matrix ? matrix->dirtyRect() : csRect{};
     }
 
     // Find first free slot (returns index or notFound if array is full)
     // NOTE: Not used in current implementation, kept for future use
     virtual uint8_t findFreeSlot() const {
-        for (uint8_t i = 0; i < maxEffects; ++i) {
-            if (i >= effectsCount || effects[i] == nullptr) {
-                return i;
-            }
+        return (effectsCount < maxEffects) ? effectsCount : notFound;
+    }
+
+#if AMP_ENABLE_PROFILER
+    // Per-effect timing of recalc(), render() and onFrameDone() (see csEffectProfile; clock:
+    // profiler::setClock()). Enabling gives every effect a fresh profile, disabling frees them.
+    void setProfiling(bool enable) {
+        profiling = enable;
+        for (tEffectHandle h = head; h != invalidHandle; h = slots[h].next) {
+            csEffectSlot& s = slots[h];
+            delete s.profile;
+            s.profile = enable ? new csEffectProfile() : nullptr;
+        }
+    }
+
+    bool getProfiling() const {
+        return profiling;
+    }
+
+    // Profile of the effect at 'index' (nullptr when profiling is off or index is out of range).
+    // Its values are read-only properties (getPropInfo), published every csEffectProfile::cWindow frames.
+    csEffectProfile* getProfile(uint8_t index) {
+        return (index < effectsCount) ? slots[handle(index)].profile : nullptr;
+    }
+#endif
+
+    // Capability bits (effect_caps) cached when the effect was added (0 if out of range).
+    uint8_t getCapabilities(uint8_t index) const {
+        if (index >= effectsCount) {
+            return 0;
         }
-        return notFound; // Array is full
+        ensureOrder();
+        return orderCaps[index];
     }
 
     // Get current number of effects
@@ -253,11 +426,19 @@ public:
 
     // Access effects
     csEffectBase* get(uint8_t index) {
-        return (index < effectsCount) ? effects[index] : nullptr;
+        if (index >= effectsCount) {
+            return nullptr;
+        }
+        ensureOrder();
+        return orderEffects[index];
     }
 
     const csEffectBase* get(uint8_t index) const {
-        return (index < effectsCount) ? effects[index] : nullptr;
+        if (index >= effectsCount) {
+            return nullptr;
+        }
+        ensureOrder();
+        return orderEffects[index];
     }
 
     // Read-only access via operator[] (for reading only, use set() for writing)
@@ -270,31 +451,191 @@ public:
         return get(index);
     }
 
-    // Iterators for range-based for
+    // Iterators for range-based for (render order; invalidated by add/remove)
     csEffectBase** begin() {
-        return effects; // May be nullptr if array is empty
+        ensureOrder();
+        return orderEffects; // May be nullptr if there are no effects
     }
 
     csEffectBase** end() {
-        return effects + effectsCount; // Safe even if effects is nullptr (effectsCount is 0)
+        ensureOrder();
+        return orderEffects + effectsCount; // Safe even if orderEffects is nullptr (effectsCount is 0)
     }
 
     const csEffectBase* const* begin() const {
-        return effects; // May be nullptr if array is empty
+        ensureOrder();
+        return orderEffects; // May be nullptr if there are no effects
     }
 
     const csEffectBase* const* end() const {
-        return effects + effectsCount; // Safe even if effects is nullptr (effectsCount is 0)
+        ensureOrder();
+        return orderEffects + effectsCount; // Safe even if orderEffects is nullptr (effectsCount is 0)
     }
 
 private:
+    // Bands per pool thread: more bands than threads evens out rows of different cost.
+    static constexpr uint8_t cBandsPerThread = 2;
+
     csMatrixPixels* matrix = nullptr;
-    csEffectBase** effects = nullptr;
+    csThreadPool* threadPool = nullptr;
+    csMatrixPixels* lowResMatrix = nullptr;
+    uint8_t renderDivisor = 1;
+    csEffectGraph graph;
+    bool graphScheduling = false;
+    bool graphReorder = false;
+
+    // Registry entry of an added effect. Render order is a doubly linked list through the slots.
+    struct csEffectSlot {
+        csEffectBase* effect;
+        // effect_caps bits, read once in add() / set().
+        uint8_t caps;
+        tEffectHandle prev;
+        tEffectHandle next;
+        // Effect-typed properties of this effect (list through csEffectRef::next).
+        uint8_t effectProps;
+#if AMP_ENABLE_PROFILER
+        // Owned; nullptr while profiling is off.
+        csEffectProfile* profile;
+#endif
+    };
+
+    // Property 'propNum' of an effect has an Effect type (checked again by deleteSafe()).
+    struct csEffectRef {
+        uint8_t propNum;
+        uint8_t next;
+    };
+
+    csSlotPool<csEffectSlot> slots;
+    csSlotPool<csEffectRef> refs;
+    tEffectHandle head = invalidHandle;
+    tEffectHandle tail = invalidHandle;
+    // More than 255 Effect-typed properties: the index is incomplete, deleteSafe() falls back to a
+    // full scan.
+    bool refsOverflow = false;
     uint8_t effectsCount = 0;
-    uint8_t effectsCapacity = 0;
 
-    void bindEffectMatrix(csEffectBase* eff) {
-        if (!eff || !matrix) {
+    // Dense copy of the render order for indexed access and rendering, with the cached capability
+    // bits and the pre-filtered onFrameDone() list; rebuilt in O(n) on first use after a removal or
+    // set() (add() appends to it in place).
+    mutable csEffectBase** orderEffects = nullptr;
+    mutable tEffectHandle* orderSlots = nullptr;
+    mutable uint8_t* orderCaps = nullptr;
+    // Order indices of the effects with effect_caps::PostFrame.
+    mutable uint8_t* postFrameIndex = nullptr;
+    mutable uint8_t postFrameCount = 0;
+    mutable uint16_t orderCapacity = 0;
+    mutable bool orderValid = true;
+#if AMP_ENABLE_PROFILER
+    bool profiling = false;
+
+    csEffectProfile* profileAt(uint8_t index) const {
+        return slots[orderSlots[index]].profile;
+    }
+#endif
+
+    void renderGraph(csRandGen& randGen, tTime currTime) {
+        graph.build(orderEffects, effectsCount, graphReorder);
+        const uint16_t frameSeed = randGen.rand16();
+        // Installed matrix allocators are not thread-safe: effects creating scratch matrices in
+        // render() would race on them.
+        csThreadPool* pool = matrix_buffer::allocator() ? nullptr : threadPool;
+        graph.run(pool, [&](uint8_t index) {
+            csRandGen effectRand(static_cast<uint16_t>(frameSeed + index * 40503u));
+            AMP_PROFILE_EFFECT(index, Render);
+            orderEffects[index]->render(effectRand, currTime);
+        });
+    }
+
+    // Render effects [first, last) band by band on the thread pool; each band runs the effects in
+    // list order, so blending matches serial rendering.
+    // Bands are whole 8-row tiles: Tiled8x8 storage, dirty tile masks and tightly packed bit rows
+    // of two bands never share a byte. The last band is open-ended (effects may render into a
+    // matrixDest taller than the manager matrix).
+    void renderBands(uint8_t first, uint8_t last, tTime currTime) {
+        const uint32_t tileRows = (static_cast<uint32_t>(matrix->height()) + csDirtyTiles::cTileSize - 1u) >>
+                                  csDirtyTiles::cTileShift;
+        uint32_t bands = static_cast<uint32_t>(threadPool->threadCount()) * cBandsPerThread;
+        if (bands > tileRows) {
+            bands = tileRows;
+        }
+        if (bands <= 1) {
+            for (uint8_t k = first; k < last; ++k) {
+                AMP_PROFILE_EFFECT(k, Render);
+                orderEffects[k]->renderBand(currTime, 0, csEffectBase::cBandEnd);
+            }
+            return;
+        }
+        const uint32_t bandRows = ((tileRows + bands - 1u) / bands) << csDirtyTiles::cTileShift;
+        bands = (static_cast<uint32_t>(matrix->height()) + bandRows - 1u) / bandRows;
+        threadPool->parallelFor(static_cast<uint16_t>(bands), [&](uint16_t band) {
+            const tMatrixPixelsCoord y0 = to_coord(static_cast<uint32_t>(band) * bandRows);
+            const tMatrixPixelsCoord y1 =
+                (band + 1u == bands) ? csEffectBase::cBandEnd : to_coord(static_cast<uint32_t>(band + 1u) * bandRows);
+            // Render time of an effect is the sum over its bands (CPU time, not wall time).
+            for (uint8_t k = first; k < last; ++k) {
+                AMP_PROFILE_EFFECT(k, Render);
+                orderEffects[k]->renderBand(currTime, y0, y1);
+            }
+        });
+    }
+
+    // Other blend modes would be applied against the cleared scratch, not against the matrix.
+    bool canRenderScaled(uint8_t index) const {
+        constexpr uint8_t cNeeded = effect_caps::Scalable | effect_caps::MatrixDest;
+        if ((orderCaps[index] & cNeeded) != cNeeded) {
+            return false;
+        }
+        const auto* m = static_cast<const csRenderMatrixBase*>(
+            orderEffects[index]->queryClassFamily(PropType::EffectMatrixDest));
+        return m && m->matrixDest == matrix && m->blendMode == csBlendMode::SourceOver;
+    }
+
+    // Scratch area of a rectDest at 1/renderDivisor, clipped to 'lowArea'. It reaches one pixel past
+    // the last covered one: the bilinear upscale of the rect's last row / column reads it.
+    csRect scaledRect(csRect rect, csRect lowArea) const {
+        if (rect.empty()) {
+            return csRect{};
+        }
+        const tMatrixPixelsCoord d = renderDivisor;
+        // Floor division for possibly negative coordinates.
+        auto divFloor = [d](tMatrixPixelsCoord v) { return (v >= 0) ? v / d : -((-v + d - 1) / d); };
+        const tMatrixPixelsCoord x0 = divFloor(rect.x);
+        const tMatrixPixelsCoord y0 = divFloor(rect.y);
+        const tMatrixPixelsCoord x1 = divFloor(rect.x + to_coord(rect.width) - 1) + 2;
+        const tMatrixPixelsCoord y1 = divFloor(rect.y + to_coord(rect.height) - 1) + 2;
+        return csRect{x0, y0, to_size(x1 - x0), to_size(y1 - y0)}.intersect(lowArea);
+    }
+
+    // Render effects [first, last) one by one into lowResMatrix and upscale each onto its rectDest
+    // (pixel x of the scratch lands on x * renderDivisor). The scratch area is cleared per effect,
+    // so an effect never composites pixels of another one.
+    void renderScaled(uint8_t first, uint8_t last, tTime currTime) {
+        const tMatrixPixelsCoord d = renderDivisor;
+        const csRect lowArea = csRect{0, 0, scaledSize(matrix->width(), renderDivisor),
+                                      scaledSize(matrix->height(), renderDivisor)}
+                                   .intersect(lowResMatrix->getRect());
+        for (uint8_t k = first; k < last; ++k) {
+            const auto* m = static_cast<const csRenderMatrixBase*>(
+                orderEffects[k]->queryClassFamily(PropType::EffectMatrixDest));
+            const csRect clip = m->rectDest.intersect(matrix->getRect());
+            const csRect rect = scaledRect(clip, lowArea);
+            if (rect.empty() || m->disabled) {
+                continue;
+            }
+            AMP_PROFILE_EFFECT(k, Render);
+            for (tMatrixPixelsCoord y = rect.y; y < rect.y + to_coord(rect.height); ++y) {
+                lowResMatrix->fillPixelsRowRewrite(rect.x, y, rect.width, csColorRGBA{0, 0, 0, 0});
+            }
+            m->renderScaled(currTime, *lowResMatrix, rect, renderDivisor);
+            const csRect upscaled{rect.x * d, rect.y * d, to_size(to_coord(rect.width) * d),
+                                  to_size(to_coord(rect.height) * d)};
+            (void)matrix_utils::drawMatrixScale(*matrix, rect, upscaled, *lowResMatrix, clip);
+        }
+    }
+
+    // 'caps': cached capability bits of 'eff' (no family query for effects without matrixDest).
+    void bindEffectMatrix(csEffectBase* eff, uint8_t caps) {
+        if (!eff || !matrix || !(caps & effect_caps::MatrixDest)) {
             return;
         }
         if (auto* m = static_cast<csRenderMatrixBase*>(
@@ -304,41 +645,139 @@ private:
         }
     }
 
-    // Resize the effects array to new capacity
-    void resizeArray(uint8_t newCapacity) {
-        if (newCapacity == 0) {
-            if (effects != nullptr) {
-                delete[] effects;
-                effects = nullptr;
-            }
-            effectsCapacity = 0;
+    bool isLive(tEffectHandle h) const {
+        return h < slots.capacity() && slots[h].effect != nullptr;
+    }
+
+    void ensureOrder() const {
+        if (orderValid) {
             return;
         }
+        if (orderCapacity < effectsCount) {
+            freeOrder();
+            // Sized to the slot pool: appends need no reallocation until the pool grows.
+            orderCapacity = slots.capacity();
+            orderEffects = new csEffectBase*[orderCapacity];
+            orderSlots = new tEffectHandle[orderCapacity];
+            orderCaps = new uint8_t[orderCapacity];
+            postFrameIndex = new uint8_t[orderCapacity];
+        }
+        uint8_t i = 0;
+        postFrameCount = 0;
+        for (tEffectHandle h = head; h != invalidHandle; h = slots[h].next) {
+            const csEffectSlot& s = slots[h];
+            orderEffects[i] = s.effect;
+            orderSlots[i] = h;
+            orderCaps[i] = s.caps;
+            if (s.caps & effect_caps::PostFrame) {
+                postFrameIndex[postFrameCount++] = i;
+            }
+            ++i;
+        }
+        orderValid = true;
+    }
 
-        csEffectBase** newEffects = new csEffectBase*[newCapacity];
-        if (newEffects == nullptr) {
-            return; // Allocation failed
+    void freeOrder() const {
+        delete[] orderEffects;
+        delete[] orderSlots;
+        delete[] orderCaps;
+        delete[] postFrameIndex;
+        orderEffects = nullptr;
+        orderSlots = nullptr;
+        orderCaps = nullptr;
+        postFrameIndex = nullptr;
+        postFrameCount = 0;
+        orderCapacity = 0;
+    }
+
+    // Take slot 'h' out of the registry (the effect itself is not deleted).
+    void unlink(tEffectHandle h) {
+        dropRefs(h);
+        csEffectSlot& s = slots[h];
+        if (s.prev != invalidHandle) {
+            slots[s.prev].next = s.next;
+        } else {
+            head = s.next;
+        }
+        if (s.next != invalidHandle) {
+            slots[s.next].prev = s.prev;
+        } else {
+            tail = s.prev;
         }
+        s.effect = nullptr;
+#if AMP_ENABLE_PROFILER
+        delete s.profile;
+        s.profile = nullptr;
+#endif
+        slots.release(h);
+        --effectsCount;
+        // Removing the last effect keeps the dense order valid.
+        if (orderValid && effectsCount < orderCapacity && orderSlots[effectsCount] == h) {
+            if (orderCaps[effectsCount] & effect_caps::PostFrame) {
+                --postFrameCount;
+            }
+        } else {
+            orderValid = false;
+        }
+    }
 
-        // Copy existing elements
-        uint8_t copyCount = (effectsCount < newCapacity) ? effectsCount : newCapacity;
-        for (uint8_t i = 0; i < copyCount; ++i) {
-            newEffects[i] = effects[i];
+    // Index the Effect-typed properties of the effect in slot 'h' (by type: null values too).
+    void indexRefs(tEffectHandle h) {
+        csEffectBase* eff = slots[h].effect;
+        const uint8_t propCount = eff->getPropsCount();
+        for (uint8_t propNum = 1; propNum <= propCount; ++propNum) {
+            csPropInfo info;
+            eff->getPropInfo(propNum, info);
+            // All effect family types are >= EffectBase ("Effect*")
+            if (info.valueType < PropType::EffectBase) {
+                continue;
+            }
+            const uint8_t r = refs.acquire();
+            if (r == invalidHandle) {
+                refsOverflow = true;
+                return;
+            }
+            refs[r].propNum = propNum;
+            refs[r].next = slots[h].effectProps;
+            slots[h].effectProps = r;
         }
+    }
 
-        // Initialize remaining elements to nullptr
-        for (uint8_t i = copyCount; i < newCapacity; ++i) {
-            newEffects[i] = nullptr;
+    // Drop the property index of slot 'h'.
+    void dropRefs(tEffectHandle h) {
+        uint8_t r = slots[h].effectProps;
+        while (r != invalidHandle) {
+            const uint8_t next = refs[r].next;
+            refs.release(r);
+            r = next;
         }
+        slots[h].effectProps = invalidHandle;
+    }
 
-        // Free old array and update pointers
-        if (effects != nullptr) {
-            delete[] effects;
+    // Set property 'propNum' of 'owner' to nullptr (and call propChanged) if it points to 'eff'.
+    static void clearRef(csEffectBase* owner, uint8_t propNum, const csEffectBase* eff) {
+        csPropInfo info;
+        owner->getPropInfo(propNum, info);
+        if ((info.valueType >= PropType::EffectBase) && (info.valuePtr != nullptr)) {
+            csEffectBase** effectPtr = static_cast<csEffectBase**>(info.valuePtr);
+            if (*effectPtr == eff) {
+                *effectPtr = nullptr;
+                owner->propChanged(propNum);
+            }
         }
-        effects = newEffects;
-        effectsCapacity = newCapacity;
-        if (effectsCount > newCapacity) {
-            effectsCount = newCapacity;
+    }
+
+    // Fallback of deleteSafe(): clear references to 'eff' in every property of every effect.
+    void clearRefsByScan(csEffectBase* eff) {
+        for (tEffectHandle h = head; h != invalidHandle; h = slots[h].next) {
+            csEffectBase* currentEff = slots[h].effect;
+            if (currentEff == eff) {
+                continue; // Skip the effect being deleted
+            }
+            const uint8_t propCount = currentEff->getPropsCount();
+            for (uint8_t propNum = 1; propNum <= propCount; ++propNum) {
+                clearRef(currentEff, propNum, eff);
+            }
         }
     }
 
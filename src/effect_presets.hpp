@@ -30,10 +30,10 @@ inline void loadEffectPreset(
     // Optional effect name stored in PROGMEM (Flash). If pointer is provided, will be set to effect name.
     // If eff_name is nullptr, use a dummy local pointer as a placeholder
     amp::tProgmemStrPtr dummy_name;
-    amp::tProgmemStrPtr *name_ptr = eff_name;
     if (eff_name == nullptr) {
         eff_name = &dummy_name;
     }
+    amp::tProgmemStrPtr *name_ptr = eff_name;
     *name_ptr = F("");
 
     if (effectId == 0) {
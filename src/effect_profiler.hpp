@@ -0,0 +1,216 @@
+#pragma once
+
+#include <stdint.h>
+#include "amp_class_base.hpp"
+#include "thread_pool.hpp"
+
+// Per-effect frame-time profiler of csEffectManager (setProfiling()).
+// Off by default: with AMP_ENABLE_PROFILER == 0 the manager has no profiling code or fields at all.
+#ifndef AMP_ENABLE_PROFILER
+#  define AMP_ENABLE_PROFILER 0
+#endif
+
+#if AMP_ENABLE_PROFILER
+
+#include "frame_clock.hpp"
+
+namespace amp {
+
+using ::uint8_t;
+using ::uint16_t;
+using ::uint32_t;
+
+namespace profiler {
+
+// Current clock slot (function-local static keeps this header-only without inline variables).
+inline tMicrosFn& clockSlot() noexcept {
+    static tMicrosFn current = &systemMicros;
+    return current;
+}
+
+// Install 'fn' (nullptr restores systemMicros()). With a thread pool the clock is called from the
+// pool threads too.
+inline void setClock(tMicrosFn fn) noexcept {
+    clockSlot() = fn ? fn : &systemMicros;
+}
+
+inline uint32_t now() {
+    return clockSlot()();
+}
+
+} // namespace profiler
+
+// Timing of one effect, published every cWindow frames as read-only properties:
+// min / avg / max per phase (recalc, render, onFrameDone; microseconds per frame) and a histogram of
+// the frame total (all three phases) over the same window.
+class csEffectProfile : public csBase {
+public:
+    enum Phase : uint8_t { Recalc = 0, Render = 1, FrameDone = 2, cPhases = 3 };
+
+    static constexpr uint16_t cWindow = 32;
+    static constexpr uint8_t cHistogramBuckets = 8;
+    // Upper bound of bucket 0; each next bucket doubles it, the last one is open-ended.
+    static constexpr uint32_t cHistogramFirstUs = 64;
+
+    static constexpr uint8_t base = csBase::propLast;
+    static constexpr uint8_t propFrames = base + 1;
+    static constexpr uint8_t propRecalcMin = base + 2;
+    static constexpr uint8_t propRecalcAvg = base + 3;
+    static constexpr uint8_t propRecalcMax = base + 4;
+    static constexpr uint8_t propRenderMin = base + 5;
+    static constexpr uint8_t propRenderAvg = base + 6;
+    static constexpr uint8_t propRenderMax = base + 7;
+    static constexpr uint8_t propFrameDoneMin = base + 8;
+    static constexpr uint8_t propFrameDoneAvg = base + 9;
+    static constexpr uint8_t propFrameDoneMax = base + 10;
+    // propHistogram + k: frames of the window in bucket k.
+    static constexpr uint8_t propHistogram = base + 11;
+    static constexpr uint8_t propLast = propHistogram + cHistogramBuckets - 1;
+
+    // Frames profiled since the last reset().
+    uint32_t frames = 0;
+    // Last complete window.
+    uint32_t minUs[cPhases] = {};
+    uint32_t avgUs[cPhases] = {};
+    uint32_t maxUs[cPhases] = {};
+    uint16_t histogram[cHistogramBuckets] = {};
+
+    uint8_t getPropsCount() const override {
+        return propLast;
+    }
+
+    void getPropInfo(uint8_t propNum, csPropInfo& info) override {
+        csBase::getPropInfo(propNum, info);
+        if (propNum <= base || propNum > propLast) {
+            return;
+        }
+        static const char* const cNames[] = {
+            "Frames",          "Recalc min us",     "Recalc avg us",     "Recalc max us",
+            "Render min us",   "Render avg us",     "Render max us",     "Frame done min us",
+            "Frame done avg us", "Frame done max us", "Frame < 64 us",   "Frame < 128 us",
+            "Frame < 256 us",  "Frame < 512 us",    "Frame < 1024 us",   "Frame < 2048 us",
+            "Frame < 4096 us", "Frame >= 4096 us"};
+        info.name = cNames[propNum - base - 1];
+        info.desc = nullptr;
+        info.readOnly = true;
+        info.disabled = false;
+        if (propNum == propFrames) {
+            info.valueType = PropType::UInt32;
+            info.valuePtr = &frames;
+        } else if (propNum < propHistogram) {
+            const uint8_t k = static_cast<uint8_t>(propNum - propRecalcMin);
+            uint32_t* const fields[] = {minUs, avgUs, maxUs};
+            info.valueType = PropType::UInt32;
+            info.valuePtr = &fields[k % 3][k / 3];
+        } else {
+            info.valueType = PropType::UInt16;
+            info.valuePtr = &histogram[propNum - propHistogram];
+        }
+    }
+
+    const char* getClassName() const override {
+        return "csEffectProfile";
+    }
+
+    // Add 'us' to a phase of the current frame. Safe to call concurrently (band / graph rendering).
+    void add(Phase phase, uint32_t us) {
+#if AMP_ENABLE_THREADS
+        frameUs_[phase].fetch_add(us, std::memory_order_relaxed);
+#else
+        frameUs_[phase] += us;
+#endif
+    }
+
+    // Close the current frame (called by csEffectManager::render(), single-threaded).
+    void endFrame() {
+        uint32_t total = 0;
+        for (uint8_t p = 0; p < cPhases; ++p) {
+#if AMP_ENABLE_THREADS
+            const uint32_t us = frameUs_[p].exchange(0, std::memory_order_relaxed);
+#else
+            const uint32_t us = frameUs_[p];
+            frameUs_[p] = 0;
+#endif
+            total += us;
+            if (windowFrames_ == 0 || us < winMin_[p]) {
+                winMin_[p] = us;
+            }
+            if (us > winMax_[p]) {
+                winMax_[p] = us;
+            }
+            winSum_[p] += us;
+        }
+        uint8_t bucket = 0;
+        for (uint32_t bound = cHistogramFirstUs; bucket + 1u < cHistogramBuckets && total >= bound; bound <<= 1) {
+            ++bucket;
+        }
+        ++winHistogram_[bucket];
+        ++frames;
+        if (++windowFrames_ < cWindow) {
+            return;
+        }
+        for (uint8_t p = 0; p < cPhases; ++p) {
+            minUs[p] = winMin_[p];
+            avgUs[p] = winSum_[p] / cWindow;
+            maxUs[p] = winMax_[p];
+            winMax_[p] = 0;
+            winSum_[p] = 0;
+        }
+        for (uint8_t k = 0; k < cHistogramBuckets; ++k) {
+            histogram[k] = winHistogram_[k];
+            winHistogram_[k] = 0;
+        }
+        windowFrames_ = 0;
+    }
+
+    void reset() {
+        frames = 0;
+        for (uint8_t p = 0; p < cPhases; ++p) {
+            minUs[p] = avgUs[p] = maxUs[p] = 0;
+            winMin_[p] = winMax_[p] = winSum_[p] = 0;
+            frameUs_[p] = 0;
+        }
+        for (uint8_t k = 0; k < cHistogramBuckets; ++k) {
+            histogram[k] = 0;
+            winHistogram_[k] = 0;
+        }
+        windowFrames_ = 0;
+    }
+
+private:
+#if AMP_ENABLE_THREADS
+    std::atomic<uint32_t> frameUs_[cPhases] = {};
+#else
+    uint32_t frameUs_[cPhases] = {};
+#endif
+    uint32_t winMin_[cPhases] = {};
+    uint32_t winMax_[cPhases] = {};
+    uint32_t winSum_[cPhases] = {};
+    uint16_t winHistogram_[cHistogramBuckets] = {};
+    uint16_t windowFrames_ = 0;
+};
+
+// Adds the lifetime of the scope to a phase of 'profile' (nothing for nullptr).
+class csEffectProfileScope {
+public:
+    csEffectProfileScope(csEffectProfile* profile, csEffectProfile::Phase phase)
+        : profile_(profile), phase_(phase), start_(profile ? profiler::now() : 0) {}
+
+    csEffectProfileScope(const csEffectProfileScope&) = delete;
+    csEffectProfileScope& operator=(const csEffectProfileScope&) = delete;
+
+    ~csEffectProfileScope() {
+        if (profile_) {
+            profile_->add(phase_, profiler::now() - start_);
+        }
+    }
+
+private:
+    csEffectProfile* profile_;
+    csEffectProfile::Phase phase_;
+    uint32_t start_;
+};
+
+} // namespace amp
+
+#endif // AMP_ENABLE_PROFILER
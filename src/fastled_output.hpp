@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <FastLED.h>
 #include "matrix_pixels.hpp"
+#include "matrix_pixels_premul.hpp"
 #include "color_rgba.hpp"
 #include "gamma8_lut.hpp"
 #include "output_driver.hpp"
@@ -22,6 +23,8 @@ namespace amp {
 //   numLeds - size of leds array
 //   pattern - mapping pattern (default: Serpentine)
 //   customMapping - optional custom mapping function (nullptr to use pattern)
+//   dirtyOnly - copy only tiles changed in the last committed frame (see csMatrixPixels::setDirtyTracking);
+//               'leds' must keep the previous frame. Ignored when the matrix has no dirty tracking.
 //
 // Gamma correction is controlled by AMP_ENABLE_GAMMA macro.
 // If macro is not defined, gamma correction is enabled by default.
@@ -32,7 +35,8 @@ inline void copyMatrixToFastLED(
     CRGB* leds,
     uint16_t numLeds,
     csMappingPattern pattern = csMappingPattern::Serpentine,
-    tMappingFunc customMapping = nullptr
+    tMappingFunc customMapping = nullptr,
+    bool dirtyOnly = false
 ) noexcept {
     if (!leds || numLeds == 0) {
         return;
@@ -50,16 +54,31 @@ inline void copyMatrixToFastLED(
     // Get mapping function from output_driver module.
     const tMappingFunc mapper = getMappingFunc(pattern, customMapping);
 
-    // Copy pixels with mapping and optional gamma correction.
-    for (tMatrixPixelsSize y = 0; y < height; ++y) {
-        for (tMatrixPixelsSize x = 0; x < width; ++x) {
-            const csColorRGBA c = matrix.getPixel(x, y);
-            
-            // Apply alpha channel as brightness multiplier (premultiplied alpha).
-            // Multiply RGB channels by alpha/255 to respect transparency.
-            const uint8_t r_scaled = mul8(c.r, c.a);
-            const uint8_t g_scaled = mul8(c.g, c.a);
-            const uint8_t b_scaled = mul8(c.b, c.a);
+    // Premultiplied matrix already holds alpha-scaled channels: read storage directly.
+    const csMatrixPixelsPremul* premul = (matrix.pixelFormat() == csPixelFormat::ARGB8Premul)
+        ? static_cast<const csMatrixPixelsPremul*>(&matrix)
+        : nullptr;
+
+    // Copy one row span [x0, x1) of row y with mapping and optional gamma correction.
+    auto copyRow = [&](tMatrixPixelsCoord x0, tMatrixPixelsCoord x1, tMatrixPixelsCoord y) {
+        for (tMatrixPixelsCoord x = x0; x < x1; ++x) {
+            uint8_t r_scaled;
+            uint8_t g_scaled;
+            uint8_t b_scaled;
+            if (premul) {
+                const csColorRGBA c = premul->getPixelPremul(x, y);
+                r_scaled = c.r;
+                g_scaled = c.g;
+                b_scaled = c.b;
+            } else {
+                const csColorRGBA c = matrix.getPixel(x, y);
+
+                // Apply alpha channel as brightness multiplier (premultiplied alpha).
+                // Multiply RGB channels by alpha/255 to respect transparency.
+                r_scaled = mul8(c.r, c.a);
+                g_scaled = mul8(c.g, c.a);
+                b_scaled = mul8(c.b, c.a);
+            }
             
             // Apply gamma correction if enabled (controlled by AMP_ENABLE_GAMMA macro).
             #if AMP_ENABLE_GAMMA
@@ -77,6 +96,27 @@ inline void copyMatrixToFastLED(
                 leds[index] = out;
             }
         }
+    };
+
+    // Only changed tiles.
+    const csDirtyTiles* dirty = dirtyOnly ? matrix.dirtyTiles() : nullptr;
+    if (dirty) {
+        for (uint16_t ty = 0; ty < dirty->tilesY(); ++ty) {
+            for (uint16_t tx = 0; tx < dirty->tilesX(); ++tx) {
+                if (!dirty->tileChanged(tx, ty)) {
+                    continue;
+                }
+                const csRect r = dirty->tileRect(tx, ty);
+                for (tMatrixPixelsCoord y = r.y; y < r.y + to_coord(r.height); ++y) {
+                    copyRow(r.x, r.x + to_coord(r.width), y);
+                }
+            }
+        }
+        return;
+    }
+
+    for (tMatrixPixelsSize y = 0; y < height; ++y) {
+        copyRow(0, to_coord(width), to_coord(y));
     }
 }
 
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+#if defined(ARDUINO)
+#  include <Arduino.h>
+#else
+#  include <chrono>
+#endif
+
+namespace amp {
+
+using ::uint32_t;
+
+// Microsecond clock for frame timing (profiler, resolution governor); may wrap around, only
+// differences are used.
+using tMicrosFn = uint32_t (*)();
+
+// micros() on Arduino, steady_clock on host.
+inline uint32_t systemMicros() {
+#if defined(ARDUINO)
+    return static_cast<uint32_t>(micros());
+#else
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+#endif
+}
+
+} // namespace amp
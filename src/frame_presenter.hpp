@@ -0,0 +1,232 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "matrix_pixels.hpp"
+#include "rect.hpp"
+#include "thread_pool.hpp"
+
+namespace amp {
+
+// Output stage of a frame pipeline: LED strip, network sender, window.
+class csFrameOutput {
+public:
+    virtual ~csFrameOutput() = default;
+
+    // Send one finished frame. 'frame' belongs to the output stage only for the duration of the
+    // call (it is reused for a later frame afterwards). 'dirty' is the area changed since the
+    // previous frame given to this output: empty when the picture is the same, the whole matrix
+    // when dirty tracking is disabled.
+    virtual void outputFrame(const csMatrixPixels& frame, const csRect& dirty) = 0;
+};
+
+// How csFramePresenter overlaps output with rendering.
+enum class csFramePipeline : uint8_t {
+    // Output on the rendering thread, straight from the render matrix (no copy, no overlap).
+    Sync = 0,
+    // One front buffer: the next frame renders while the output thread sends the previous one.
+    // present() waits when the output has not finished the previous frame yet.
+    Double = 1,
+    // Two front buffers: present() never waits; a queued frame that the output has not started
+    // yet is replaced by the newer one (dropped, its dirty area is carried over).
+    Triple = 2
+};
+
+struct csFramePresenterStats {
+    uint32_t presented{0};
+    uint32_t output{0};
+    uint32_t dropped{0};
+    // present() calls that had to wait for the output stage (Double only).
+    uint32_t waits{0};
+};
+
+// Hands finished frames from the rendering thread to an output thread.
+//
+// Ownership of a front buffer:
+//   Free -> (present: copy of the render matrix) -> Queued -> (output thread) -> Busy
+//        -> (outputFrame returns) -> Free
+// The rendering thread writes only Free buffers (and, in Triple mode, a Queued one it replaces);
+// the output thread reads only its Busy buffer. The render matrix itself is never shared, so
+// the caller may clear and render the next frame as soon as present() returns.
+//
+// Without threads (AMP_ENABLE_THREADS == 0) every mode behaves as Sync.
+class csFramePresenter {
+public:
+    // 'front0'/'front1' are matrices of the render matrix type (e.g. csMatrixPixelsPremul for a
+    // premultiplied render matrix), any size: Double uses front0, Triple both, Sync none.
+    // The presenter owns (and deletes) them.
+    csFramePresenter(csFrameOutput& output, csFramePipeline mode,
+                     csMatrixPixels* front0 = nullptr, csMatrixPixels* front1 = nullptr)
+        : output_(output) {
+        csMatrixPixels* fronts[cMaxFronts] = {front0, front1};
+        uint8_t wanted = static_cast<uint8_t>(mode);
+#if !AMP_ENABLE_THREADS
+        wanted = 0;
+#endif
+        for (uint8_t i = 0; i < cMaxFronts; ++i) {
+            if (i < wanted && fronts[i]) {
+                fronts_[frontCount_++] = fronts[i];
+            } else {
+                delete fronts[i];
+            }
+        }
+        mode_ = (frontCount_ == 0) ? csFramePipeline::Sync
+                                   : (frontCount_ == 1 ? csFramePipeline::Double : csFramePipeline::Triple);
+#if AMP_ENABLE_THREADS
+        if (frontCount_ != 0) {
+            thread_ = std::thread([this] { outputLoop(); });
+        }
+#endif
+    }
+
+    csFramePresenter(const csFramePresenter&) = delete;
+    csFramePresenter& operator=(const csFramePresenter&) = delete;
+
+    // Sends the frames still queued, then stops the output thread.
+    ~csFramePresenter() {
+#if AMP_ENABLE_THREADS
+        if (thread_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            changed_.notify_all();
+            thread_.join();
+        }
+#endif
+        for (uint8_t i = 0; i < frontCount_; ++i) {
+            delete fronts_[i];
+        }
+    }
+
+    // Effective mode (Sync when buffers or threads are missing).
+    [[nodiscard]] csFramePipeline mode() const noexcept {
+        return mode_;
+    }
+
+    // Hand the finished 'frame' to the output stage. 'dirty': area changed since the previous
+    // present() (csEffectManager::getDirtyRect()).
+    void present(const csMatrixPixels& frame, csRect dirty) {
+#if AMP_ENABLE_THREADS
+        if (frontCount_ != 0) {
+            presentQueued(frame, dirty);
+            return;
+        }
+#endif
+        output_.outputFrame(frame, dirty);
+        ++stats_.presented;
+        ++stats_.output;
+    }
+
+    // Block until the output stage has sent every presented frame.
+    void flush() {
+#if AMP_ENABLE_THREADS
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this] { return idle(); });
+#endif
+    }
+
+    [[nodiscard]] csFramePresenterStats stats() {
+#if AMP_ENABLE_THREADS
+        std::lock_guard<std::mutex> lock(mutex_);
+#endif
+        return stats_;
+    }
+
+private:
+    static constexpr uint8_t cMaxFronts = 2;
+
+    enum class csFrontState : uint8_t { Free, Filling, Queued, Busy };
+
+    csFrameOutput& output_;
+    csFramePipeline mode_{csFramePipeline::Sync};
+    csMatrixPixels* fronts_[cMaxFronts] = {nullptr, nullptr};
+    csRect dirty_[cMaxFronts];
+    csFrontState state_[cMaxFronts] = {csFrontState::Free, csFrontState::Free};
+    uint32_t queuedAt_[cMaxFronts] = {0, 0};
+    uint32_t queueCounter_{0};
+    uint8_t frontCount_{0};
+    csFramePresenterStats stats_;
+
+#if AMP_ENABLE_THREADS
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    bool stop_{false};
+
+    // Index of a buffer in 'state' (the oldest one for Queued), or -1.
+    [[nodiscard]] int8_t find(csFrontState state) const noexcept {
+        int8_t found = -1;
+        for (uint8_t i = 0; i < frontCount_; ++i) {
+            if (state_[i] == state && (found < 0 || queuedAt_[i] < queuedAt_[found])) {
+                found = static_cast<int8_t>(i);
+            }
+        }
+        return found;
+    }
+
+    [[nodiscard]] bool idle() const noexcept {
+        for (uint8_t i = 0; i < frontCount_; ++i) {
+            if (state_[i] != csFrontState::Free) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void presentQueued(const csMatrixPixels& frame, csRect dirty) {
+        int8_t b = -1;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (;;) {
+                b = find(csFrontState::Free);
+                if (b >= 0) {
+                    break;
+                }
+                if (mode_ == csFramePipeline::Triple) {
+                    b = find(csFrontState::Queued);
+                    if (b >= 0) {
+                        // The output never saw that frame: its changes are part of this one.
+                        dirty = dirty_[b].unite(dirty);
+                        ++stats_.dropped;
+                        break;
+                    }
+                }
+                ++stats_.waits;
+                changed_.wait(lock);
+            }
+            state_[b] = csFrontState::Filling;
+        }
+        // Raw copy: keeps the pixel format and layout of the render matrix.
+        *fronts_[b] = frame;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            dirty_[b] = dirty;
+            state_[b] = csFrontState::Queued;
+            queuedAt_[b] = ++queueCounter_;
+            ++stats_.presented;
+        }
+        changed_.notify_all();
+    }
+
+    void outputLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            changed_.wait(lock, [this] { return stop_ || find(csFrontState::Queued) >= 0; });
+            const int8_t b = find(csFrontState::Queued);
+            if (b < 0) {
+                return; // stop_ and nothing left to send
+            }
+            state_[b] = csFrontState::Busy;
+            lock.unlock();
+            output_.outputFrame(*fronts_[b], dirty_[b]);
+            lock.lock();
+            state_[b] = csFrontState::Free;
+            ++stats_.output;
+            changed_.notify_all();
+        }
+    }
+#endif
+};
+
+} // namespace amp
@@ -85,6 +85,48 @@ inline constexpr float min(float a, float b) noexcept {
     return (a < b) ? a : b;
 }
 
+// Number of set bits (compiler builtin where available, SWAR fallback otherwise).
+inline int popcount(uint32_t v) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(v);
+#else
+    v = v - ((v >> 1) & 0x55555555u);
+    v = (v & 0x33333333u) + ((v >> 2) & 0x33333333u);
+    return static_cast<int>((((v + (v >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+#endif
+}
+
+inline int popcount(uint64_t v) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(v);
+#else
+    return popcount(static_cast<uint32_t>(v)) + popcount(static_cast<uint32_t>(v >> 32));
+#endif
+}
+
+// Index of the lowest set bit. 'v' must be non-zero.
+inline int ctz(uint32_t v) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(v);
+#else
+    int n = 0;
+    while ((v & 1u) == 0) {
+        v >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+inline int ctz(uint64_t v) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(v);
+#else
+    const uint32_t lo = static_cast<uint32_t>(v);
+    return lo ? ctz(lo) : 32 + ctz(static_cast<uint32_t>(v >> 32));
+#endif
+}
+
 } // namespace math
 } // namespace amp
 
@@ -1,11 +1,28 @@
 #pragma once
 
+#include <stdint.h>
 #include "color_rgba.hpp"
+#include "fixed_point.hpp"
+#include "math.hpp"
 #include "matrix_types.hpp"
 #include "rect.hpp"
 
 namespace amp {
 
+using math::csFP16;
+
+// Storage format of a matrix (used to pick fast paths without RTTI).
+enum class csPixelFormat : uint8_t {
+    Unknown = 0,     // No direct storage assumptions; use getPixel/setPixel.
+    ARGB8 = 1,       // csColorRGBA, straight alpha (csMatrixPixels).
+    ARGB8Premul = 2, // csColorRGBA, premultiplied alpha (csMatrixPixelsPremul).
+    Gray8 = 3,       // One byte per pixel, read as opaque gray (csMatrixBytes).
+    Mono1 = 4,       // One bit per pixel, read as opaque white / transparent (csMatrixBoolean).
+    RGB565 = 5,      // 16-bit opaque RGB (csMatrixRGB565).
+    RGB888 = 6,      // Packed 24-bit opaque RGB (csMatrixRGB888).
+    ARGB16Premul = 7, // csColorRGBA16, premultiplied unorm16 accumulation (csMatrixPixels16).
+};
+
 // Base abstract matrix interface in terms of csColorRGBA.
 // All matrix implementations provide safe out-of-bounds behavior:
 // - Writes outside bounds are ignored.
@@ -31,12 +48,223 @@ public:
     // Write pixel with blending (semantics depend on implementation).
     virtual void setPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y, csColorRGBA color) noexcept = 0;
 
+    // Storage format; derived classes with direct storage override this.
+    [[nodiscard]] virtual csPixelFormat pixelFormat() const noexcept {
+        return csPixelFormat::Unknown;
+    }
+
+    // Matrix that owns the memory and caches written through this one (the parent of a
+    // csMatrixSubView); the effect graph treats matrices with the same owner as one resource.
+    [[nodiscard]] virtual const csMatrixBase* storageOwner() const noexcept {
+        return this;
+    }
+
+    // Blend a row of straight-alpha colors starting at (x, y); each source alpha is scaled by 'alpha'.
+    // Same result as calling setPixel(x + i, y, colors[i].alpha(alpha)); out-of-bounds pixels are skipped.
+    // 'colors' must not overlap this matrix's own storage.
+    virtual void setPixelsRow(tMatrixPixelsCoord x, tMatrixPixelsCoord y, const csColorRGBA* colors,
+                              tMatrixPixelsSize count, uint8_t alpha = 255) noexcept {
+        for (tMatrixPixelsSize i = 0; i < count; ++i) {
+            setPixel(x + to_coord(i), y, colors[i].alpha(alpha));
+        }
+    }
+
+    // Blend a row of straight-alpha colors with 'mode' (see csBlendMode, csColorRGBA::blendStraight).
+    // SourceOver is setPixelsRow(); other modes mix each source with the destination pixel and blend it
+    // with setPixel(), so every matrix keeps its own SourceOver semantics. Derived classes with direct
+    // storage override this with row kernels.
+    virtual void setPixelsRowMode(tMatrixPixelsCoord x, tMatrixPixelsCoord y, const csColorRGBA* colors,
+                                  tMatrixPixelsSize count, uint8_t alpha, csBlendMode mode) noexcept {
+        if (mode == csBlendMode::SourceOver) {
+            setPixelsRow(x, y, colors, count, alpha);
+            return;
+        }
+        for (tMatrixPixelsSize i = 0; i < count; ++i) {
+            setPixelMode(x + to_coord(i), y, colors[i].alpha(alpha), mode);
+        }
+    }
+
+    // Blend pixel with 'mode'; SourceOver is setPixel().
+    inline void setPixelMode(tMatrixPixelsCoord x, tMatrixPixelsCoord y, csColorRGBA color, csBlendMode mode) noexcept {
+        if (mode != csBlendMode::SourceOver) {
+            color = csColorRGBA::mixBlendMode(getPixel(x, y), color, mode);
+        }
+        setPixel(x, y, color);
+    }
+
+    // Blend one color over 'count' pixels of row 'y' starting at 'x'.
+    // Same result as calling setPixel(x + i, y, color); out-of-bounds pixels are skipped.
+    virtual void fillPixelsRow(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize count,
+                               csColorRGBA color) noexcept {
+        for (tMatrixPixelsSize i = 0; i < count; ++i) {
+            setPixel(x + to_coord(i), y, color);
+        }
+    }
+
+    // Overwrite 'count' pixels of row 'y' starting at 'x' with one color (setPixelRewrite per pixel).
+    virtual void fillPixelsRowRewrite(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize count,
+                                      csColorRGBA color) noexcept {
+        for (tMatrixPixelsSize i = 0; i < count; ++i) {
+            setPixelRewrite(x + to_coord(i), y, color);
+        }
+    }
+
+    // Blend source color over destination pixels using sub-pixel positioning.
+    // Fixed-point coordinates allow positioning between pixels; color is distributed across 1-2 pixels
+    // with alpha proportional to distance from pixel center.
+    void setPixelFloat2(csFP16 x, csFP16 y, csColorRGBA color, csBlendMode mode = csBlendMode::SourceOver) noexcept {
+        // Round to nearest pixel to find the center pixel
+        const tMatrixPixelsCoord cx = static_cast<tMatrixPixelsCoord>(x.round_int());
+        const tMatrixPixelsCoord cy = static_cast<tMatrixPixelsCoord>(y.round_int());
+
+        // Check if exact pixel center (no fractional part)
+        if (x.frac_abs_raw() == 0 && y.frac_abs_raw() == 0) {
+            // Draw single pixel with full alpha
+            setPixelMode(cx, cy, color, mode);
+            return;
+        }
+
+        // Calculate offset from rounded center to determine direction.
+        // Compute offsets from the center pixel. These tell us how far the point is from the center
+        // Note: cx/cy are integer pixel coords; we convert them to csFP16 via constructor
+        // (exact, no float) so dx/dy are computed in fixed-point units.
+        const csFP16 cx_fp = csFP16(cx);
+        const csFP16 cy_fp = csFP16(cy);
+
+        // dx/dy: signed sub-pixel offset from the rounded-center pixel (typically in [-0.5, +0.5]).
+        // Used to pick the sign (+1/-1) for the secondary pixel direction and to compute alpha weights.
+        const csFP16 dx = x - cx_fp;
+        const csFP16 dy = y - cy_fp;
+
+        // Select secondary pixel direction.
+        // IMPORTANT: axis decision uses original fractional parts (relative to the integer grid),
+        // not the abs offset relative to the rounded center (which can lose info, e.g. 2.75 -> -0.25).
+        tMatrixPixelsCoord sx = cx;
+        tMatrixPixelsCoord sy = cy;
+
+        const uint8_t fx_axis = static_cast<uint8_t>(x.frac_abs_raw());
+        const uint8_t fy_axis = static_cast<uint8_t>(y.frac_abs_raw());
+
+        if (fy_axis > fx_axis) {
+            // Vertical direction
+            sy = cy + (dy.raw_value() >= 0 ? 1 : -1);
+        } else if (fx_axis > fy_axis) {
+            // Horizontal direction
+            sx = cx + (dx.raw_value() >= 0 ? 1 : -1);
+        } else {
+            // Diagonal direction (equal components)
+            sx = cx + (dx.raw_value() >= 0 ? 1 : -1);
+            sy = cy + (dy.raw_value() >= 0 ? 1 : -1);
+        }
+
+        // Get absolute fractional parts for weight calculation
+        const uint8_t fx_abs = static_cast<uint8_t>(dx.frac_abs_raw());
+        const uint8_t fy_abs = static_cast<uint8_t>(dy.frac_abs_raw());
+
+        // Calculate alpha weights using absolute fractional parts
+        const uint8_t max_offset_raw = math::max(fx_abs, fy_abs);
+        const uint8_t weight_uint8 = static_cast<uint8_t>((static_cast<uint16_t>(max_offset_raw) * 255u + 8u) / 16u);
+
+        const uint8_t secondary_alpha = mul8(color.a, weight_uint8);
+        const uint8_t center_alpha = color.a - secondary_alpha;
+
+        if (center_alpha > 0) {
+            setPixelMode(cx, cy, csColorRGBA{center_alpha, color.r, color.g, color.b}, mode);
+        }
+        if (secondary_alpha > 0) {
+            setPixelMode(sx, sy, csColorRGBA{secondary_alpha, color.r, color.g, color.b}, mode);
+        }
+    }
+
+    // Blend source color over destination pixels using classical 4-tap bilinear splat.
+    // Integer coordinates are treated as pixel centers, so (10.0, 1.0) affects exactly one pixel.
+    // The source color is distributed to the 4 neighboring pixel centers around floor(x), floor(y).
+    void setPixelFloat4(csFP16 x, csFP16 y, csColorRGBA color, csBlendMode mode = csBlendMode::SourceOver) noexcept {
+        // Fast path: exact pixel center.
+        if (x.frac_abs_raw() == 0 && y.frac_abs_raw() == 0) {
+            setPixelMode(static_cast<tMatrixPixelsCoord>(x.int_trunc()),
+                         static_cast<tMatrixPixelsCoord>(y.int_trunc()),
+                         color, mode);
+            return;
+        }
+
+        // Use floor-based cell origin so fractions are always in [0,1) even for negative coordinates.
+        const tMatrixPixelsCoord x0 = static_cast<tMatrixPixelsCoord>(x.floor_int());
+        const tMatrixPixelsCoord y0 = static_cast<tMatrixPixelsCoord>(y.floor_int());
+
+        const csFP16 fx = x - csFP16(x0);
+        const csFP16 fy = y - csFP16(y0);
+
+        // csFP16 is 12.4, so the fractional part is 0..15 (scale=16).
+        const uint16_t fx_raw = static_cast<uint16_t>(fx.frac_abs_raw());
+        const uint16_t fy_raw = static_cast<uint16_t>(fy.frac_abs_raw());
+        const uint16_t inv_fx = static_cast<uint16_t>(csFP16::scale) - fx_raw; // 16 - fx
+        const uint16_t inv_fy = static_cast<uint16_t>(csFP16::scale) - fy_raw; // 16 - fy
+
+        // Weights sum to 256 (16*16). Each weight is in [0..256].
+        const uint16_t w00 = static_cast<uint16_t>(inv_fx * inv_fy);
+        const uint16_t w10 = static_cast<uint16_t>(fx_raw * inv_fy);
+        const uint16_t w01 = static_cast<uint16_t>(inv_fx * fy_raw);
+        const uint16_t w11 = static_cast<uint16_t>(fx_raw * fy_raw);
+
+        auto weight_to_alpha = [&](uint16_t w) noexcept -> uint8_t {
+            // Round to nearest: (a*w)/256
+            return static_cast<uint8_t>((static_cast<uint32_t>(color.a) * static_cast<uint32_t>(w) + 128u) >> 8);
+        };
+
+        const uint8_t a00 = weight_to_alpha(w00);
+        const uint8_t a10 = weight_to_alpha(w10);
+        const uint8_t a01 = weight_to_alpha(w01);
+        const uint8_t a11 = weight_to_alpha(w11);
+
+        if (a00 > 0) {
+            setPixelMode(x0, y0, csColorRGBA{a00, color.r, color.g, color.b}, mode);
+        }
+        if (a10 > 0) {
+            setPixelMode(x0 + 1, y0, csColorRGBA{a10, color.r, color.g, color.b}, mode);
+        }
+        if (a01 > 0) {
+            setPixelMode(x0, y0 + 1, csColorRGBA{a01, color.r, color.g, color.b}, mode);
+        }
+        if (a11 > 0) {
+            setPixelMode(x0 + 1, y0 + 1, csColorRGBA{a11, color.r, color.g, color.b}, mode);
+        }
+    }
+
     // Resize matrix to new dimensions. Existing data is lost (matrix is cleared).
     // Optional: derived classes may override; default does nothing.
     virtual void resize(tMatrixPixelsSize w, tMatrixPixelsSize h) {
         (void)w;
         (void)h;
     }
+
+    // Row-span access (zero-copy).
+    // Returns pointer to contiguous pixels starting at (area.x + offset_x, area.y + offset_y)
+    // and the number of valid pixels in 'lineLen' (clipped to area and matrix bounds).
+    // A span may be shorter than the rest of the row: callers loop, advancing offset_x by lineLen.
+    // Returns false when the start pixel is outside area/matrix, or when the implementation
+    // has no direct csColorRGBA storage (use getPixel/setPixel then).
+    // Writes through the pointer bypass setPixel: only plain storage may expose spans.
+    virtual bool getScanLine(csRect area, tMatrixPixelsCoord offset_x, tMatrixPixelsCoord offset_y,
+                             csColorRGBA*& ptrLineOfColors, tMatrixPixelsSize& lineLen) noexcept {
+        (void)area;
+        (void)offset_x;
+        (void)offset_y;
+        ptrLineOfColors = nullptr;
+        lineLen = 0;
+        return false;
+    }
+
+    // Read-only row-span access; same semantics as the mutable overload.
+    virtual bool getScanLine(csRect area, tMatrixPixelsCoord offset_x, tMatrixPixelsCoord offset_y,
+                             const csColorRGBA*& ptrLineOfColors, tMatrixPixelsSize& lineLen) const noexcept {
+        (void)area;
+        (void)offset_x;
+        (void)offset_y;
+        ptrLineOfColors = nullptr;
+        lineLen = 0;
+        return false;
+    }
 };
 
 } // namespace amp
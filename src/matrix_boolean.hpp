@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <string.h>
 #include "matrix_base.hpp"
+#include "math.hpp"
+#include "matrix_buffer_pool.hpp"
 #include "matrix_types.hpp"
 #include "rect.hpp"
 
@@ -13,21 +15,34 @@ using ::size_t;
 using ::uint8_t;
 
 // Header-only bit matrix where each pixel is represented by a single bit (boolean).
+// Besides per-bit access it has word-parallel row operations (logic ops, row shift, popcount,
+// find-first-set, row compare) that process tWord bits per step.
 class csMatrixBoolean : public csMatrixBase {
 public:
+    // Machine word of the word-parallel operations (32-bit on 8-bit AVR, 64-bit elsewhere).
+#if defined(__AVR__)
+    using tWord = uint32_t;
+#else
+    using tWord = uint64_t;
+#endif
+    static constexpr size_t cWordBits = sizeof(tWord) * 8;
+
     // Construct matrix with given size, all bits cleared.
     csMatrixBoolean(tMatrixPixelsSize width, tMatrixPixelsSize height, bool defaultOutOfBoundsValue = false)
-        : outOfBoundsValue{defaultOutOfBoundsValue}, width_{width}, height_{height}, bytes_(allocate(width, height)) {}
+        : outOfBoundsValue{defaultOutOfBoundsValue}, width_{width}, height_{height}, strideBits_{width},
+          bytes_(allocate(width, height)) {}
 
-    // Copy constructor: makes deep copy of bit buffer.
+    // Copy constructor: makes deep copy of bit buffer (a view is copied into an owned buffer).
     csMatrixBoolean(const csMatrixBoolean& other)
-        : outOfBoundsValue{other.outOfBoundsValue}, width_{other.width_}, height_{other.height_}, bytes_(allocate(width_, height_)) {
-        copyBytes(bytes_, other.bytes_, byteCount());
+        : outOfBoundsValue{other.outOfBoundsValue}, width_{other.width_}, height_{other.height_}, strideBits_{other.width_},
+          bytes_(allocate(width_, height_)) {
+        copyContent(other);
     }
 
     // Move constructor: transfers ownership of buffer, leaving source empty.
     csMatrixBoolean(csMatrixBoolean&& other) noexcept
-        : outOfBoundsValue{other.outOfBoundsValue}, width_{other.width_}, height_{other.height_}, bytes_{other.bytes_} {
+        : outOfBoundsValue{other.outOfBoundsValue}, width_{other.width_}, height_{other.height_},
+          strideBits_{other.strideBits_}, ownsBytes_{other.ownsBytes_}, bytes_{other.bytes_} {
         other.bytes_ = nullptr;
         other.width_ = 0;
         other.height_ = 0;
@@ -35,10 +50,11 @@ public:
     }
 
     // Copy assignment: deep copy when assigning existing object.
+    // A view keeps its external buffer and size: only the overlapping area is copied.
     csMatrixBoolean& operator=(const csMatrixBoolean& other) {
         if (this != &other) {
             resize(other.width_, other.height_);
-            copyBytes(bytes_, other.bytes_, byteCount());
+            copyContent(other);
             outOfBoundsValue = other.outOfBoundsValue;
         }
         return *this;
@@ -47,9 +63,11 @@ public:
     // Move assignment: steal buffer from other, reset other to empty.
     csMatrixBoolean& operator=(csMatrixBoolean&& other) noexcept {
         if (this != &other) {
-            delete[] bytes_;
+            releaseBytes();
             width_ = other.width_;
             height_ = other.height_;
+            strideBits_ = other.strideBits_;
+            ownsBytes_ = other.ownsBytes_;
             outOfBoundsValue = other.outOfBoundsValue;
             bytes_ = other.bytes_;
             other.bytes_ = nullptr;
@@ -60,12 +78,14 @@ public:
         return *this;
     }
 
-    ~csMatrixBoolean() { delete[] bytes_; }
+    virtual ~csMatrixBoolean() { releaseBytes(); }
 
     [[nodiscard]] tMatrixPixelsSize width() const noexcept override { return width_; }
     [[nodiscard]] tMatrixPixelsSize height() const noexcept override { return height_; }
 
     // csMatrixBase (RGBA interface)
+    [[nodiscard]] csPixelFormat pixelFormat() const noexcept override { return csPixelFormat::Mono1; }
+
     [[nodiscard]] inline csColorRGBA getPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept override {
         return getValue(x, y) ? csColorRGBA{255, 255, 255, 255} : csColorRGBA{0, 0, 0, 0};
     }
@@ -84,7 +104,13 @@ public:
     // Default value returned when accessing out-of-bounds coordinates.
     bool outOfBoundsValue{false};
 
-    // Get bit value by linear index k. Returns outOfBoundsValue when out of bounds.
+    // Bits between the starts of two rows; equals width() unless this is a strided view.
+    [[nodiscard]] size_t stride() const noexcept { return strideBits_; }
+
+    // False for views over caller-owned memory (see csMatrixBooleanView).
+    [[nodiscard]] bool ownsBytes() const noexcept { return ownsBytes_; }
+
+    // Get bit value by linear index k (y * stride + x). Returns outOfBoundsValue when out of bounds.
     [[nodiscard]] inline bool get(size_t k) const noexcept {
         if (k >= bitCount()) {
             return outOfBoundsValue;
@@ -113,7 +139,7 @@ public:
         }
         const auto xx = static_cast<size_t>(x);
         const auto yy = static_cast<size_t>(y);
-        const auto k = yy * width_ + xx;
+        const auto k = yy * strideBits_ + xx;
         return get(k);
     }
 
@@ -124,7 +150,7 @@ public:
         }
         const auto xx = static_cast<size_t>(x);
         const auto yy = static_cast<size_t>(y);
-        const auto k = yy * width_ + xx;
+        const auto k = yy * strideBits_ + xx;
         if (value) {
             setbit(k);
         } else {
@@ -132,50 +158,193 @@ public:
         }
     }
 
-    // Clear matrix: set all bits to 0.
+    // Clear matrix: set all bits to 0. Strided views clear row by row and keep the bits between rows.
     inline void clear() noexcept {
-        const size_t bytes = byteCount();
-        if (bytes != 0 && bytes_) {
-            memset(static_cast<void*>(bytes_), 0, bytes);
+        if (!bytes_) {
+            return;
+        }
+        if (strideBits_ == width_) {
+            clearBits(0, bitCount());
+            return;
+        }
+        for (tMatrixPixelsSize y = 0; y < height_; ++y) {
+            clearBits(static_cast<size_t>(y) * strideBits_, width_);
         }
     }
 
     // Resize matrix to new dimensions. Existing bits are lost (matrix is cleared).
+    // Views (see csMatrixBooleanView) do not own their buffer and ignore resize().
     void resize(tMatrixPixelsSize w, tMatrixPixelsSize h) override {
-        if (w == width_ && h == height_) {
+        if ((w == width_ && h == height_) || !ownsBytes_) {
             return;
         }
-        delete[] bytes_;
+        releaseBytes();
         width_ = w;
         height_ = h;
+        strideBits_ = w;
         bytes_ = allocate(width_, height_);
     }
 
+    // Word-parallel logic ops with another matrix over the shared area (both anchored at 0,0).
+    // Bits outside the shared area are unchanged.
+    void andWith(const csMatrixBoolean& other) noexcept {
+        combine(other, [](tWord a, tWord b) noexcept { return a & b; });
+    }
+    void orWith(const csMatrixBoolean& other) noexcept {
+        combine(other, [](tWord a, tWord b) noexcept { return a | b; });
+    }
+    void xorWith(const csMatrixBoolean& other) noexcept {
+        combine(other, [](tWord a, tWord b) noexcept { return a ^ b; });
+    }
+
+    // Logical NOT of every bit.
+    void invert() noexcept {
+        forEachRowRange([&](size_t k, size_t n) {
+            for (size_t i = 0; i < n; i += cWordBits) {
+                const size_t len = wordLen(n - i);
+                storeBits(k + i, len, ~loadBits(k + i, len));
+            }
+        });
+    }
+
+    // Shift rows by 'dy' (positive: content moves down). Vacated rows are filled with 'fill'.
+    void shiftRows(tMatrixPixelsCoord dy, bool fill = false) noexcept {
+        if (!bytes_ || dy == 0) {
+            return;
+        }
+        const size_t h = height_;
+        const size_t shift = static_cast<size_t>(dy > 0 ? dy : -dy);
+        if (shift >= h) {
+            for (size_t y = 0; y < h; ++y) {
+                fillBits(y * strideBits_, width_, fill);
+            }
+            return;
+        }
+        // Packed byte-aligned rows: one memmove for the whole block.
+        if (strideBits_ == width_ && (width_ % 8) == 0) {
+            const size_t rowBytes = width_ / 8;
+            uint8_t* moved = (dy > 0) ? bytes_ + shift * rowBytes : bytes_;
+            const uint8_t* from = (dy > 0) ? bytes_ : bytes_ + shift * rowBytes;
+            memmove(static_cast<void*>(moved), static_cast<const void*>(from), (h - shift) * rowBytes);
+        } else if (dy > 0) {
+            for (size_t y = h; y-- > shift;) {
+                copyBits(y * strideBits_, (y - shift) * strideBits_, width_);
+            }
+        } else {
+            for (size_t y = 0; y + shift < h; ++y) {
+                copyBits(y * strideBits_, (y + shift) * strideBits_, width_);
+            }
+        }
+        const size_t fillFrom = (dy > 0) ? 0 : h - shift;
+        for (size_t y = fillFrom; y < fillFrom + shift; ++y) {
+            fillBits(y * strideBits_, width_, fill);
+        }
+    }
+
+    // Number of set bits in the whole matrix.
+    [[nodiscard]] size_t countOnes() const noexcept {
+        size_t total = 0;
+        forEachRowRange([&](size_t k, size_t n) { total += countBits(k, n); });
+        return total;
+    }
+
+    // Number of set bits in 'area' (clipped to the matrix).
+    [[nodiscard]] size_t countOnes(csRect area) const noexcept {
+        const csRect r = area.intersect(getRect());
+        if (!bytes_ || r.empty()) {
+            return 0;
+        }
+        size_t total = 0;
+        for (size_t y = 0; y < r.height; ++y) {
+            total += countBits((static_cast<size_t>(r.y) + y) * strideBits_ + static_cast<size_t>(r.x), r.width);
+        }
+        return total;
+    }
+
+    // X of the first set bit in row 'y' at or after 'fromX'; -1 when there is none (or 'y' is outside).
+    [[nodiscard]] tMatrixPixelsCoord findFirstSet(tMatrixPixelsCoord y, tMatrixPixelsCoord fromX = 0) const noexcept {
+        if (!bytes_ || y < 0 || y >= to_coord(height_) || fromX >= to_coord(width_)) {
+            return -1;
+        }
+        const size_t x0 = fromX > 0 ? static_cast<size_t>(fromX) : 0u;
+        const size_t k = static_cast<size_t>(y) * strideBits_ + x0;
+        const size_t n = width_ - x0;
+        for (size_t i = 0; i < n; i += cWordBits) {
+            const tWord v = loadBits(k + i, wordLen(n - i));
+            if (v != 0) {
+                return to_coord(x0 + i + static_cast<size_t>(math::ctz(v)));
+            }
+        }
+        return -1;
+    }
+
+    // True when row 'y' equals row 'otherY' of 'other' (widths must match).
+    [[nodiscard]] bool rowEqual(tMatrixPixelsCoord y, const csMatrixBoolean& other, tMatrixPixelsCoord otherY) const noexcept {
+        if (width_ != other.width_ || y < 0 || otherY < 0 || y >= to_coord(height_) || otherY >= to_coord(other.height_)) {
+            return false;
+        }
+        if (!bytes_ || !other.bytes_) {
+            return width_ == 0;
+        }
+        const size_t k = static_cast<size_t>(y) * strideBits_;
+        const size_t ok = static_cast<size_t>(otherY) * other.strideBits_;
+        for (size_t i = 0; i < width_; i += cWordBits) {
+            const size_t len = wordLen(static_cast<size_t>(width_) - i);
+            if (loadBits(k + i, len) != other.loadBits(ok + i, len)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+protected:
+    // Non-owning constructor for views: wraps 'external' (bit k = y * strideBits + x, LSB first).
+    csMatrixBoolean(uint8_t* external, tMatrixPixelsSize width, tMatrixPixelsSize height, size_t strideBits,
+                    bool defaultOutOfBoundsValue)
+        : outOfBoundsValue{defaultOutOfBoundsValue}, width_{width}, height_{height},
+          strideBits_{(strideBits > width) ? strideBits : static_cast<size_t>(width)}, ownsBytes_{false},
+          bytes_{external} {}
+
+    // Start of the buffer (owned or external).
+    [[nodiscard]] uint8_t* buffer() const noexcept { return bytes_; }
+
+    // Point a view at another external buffer.
+    void attachExternal(uint8_t* external, tMatrixPixelsSize width, tMatrixPixelsSize height, size_t strideBits) noexcept {
+        releaseBytes();
+        width_ = width;
+        height_ = height;
+        strideBits_ = (strideBits > width) ? strideBits : static_cast<size_t>(width);
+        ownsBytes_ = false;
+        bytes_ = external;
+    }
+
 private:
     tMatrixPixelsSize width_;
     tMatrixPixelsSize height_;
+    size_t strideBits_{0};
+    bool ownsBytes_{true};
     uint8_t* bytes_{nullptr};
 
     [[nodiscard]] inline bool inside(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept {
         return x >= 0 && y >= 0 && x < static_cast<tMatrixPixelsCoord>(width_) && y < static_cast<tMatrixPixelsCoord>(height_);
     }
 
+    // Number of addressable bits (ends at the last pixel of the last row for strided views).
     [[nodiscard]] inline size_t bitCount() const noexcept {
-        return static_cast<size_t>(width_) * static_cast<size_t>(height_);
+        if (height_ == 0) {
+            return 0;
+        }
+        return strideBits_ * (static_cast<size_t>(height_) - 1u) + static_cast<size_t>(width_);
     }
 
     [[nodiscard]] inline size_t byteCount() const noexcept {
         return (bitCount() + 7) / 8;
     }
 
+    // Zero-filled storage from the matrix buffer allocator; nullptr when empty.
     [[nodiscard]] static uint8_t* allocate(uint16_t w, uint16_t h) {
         const size_t bits = static_cast<size_t>(w) * static_cast<size_t>(h);
-        const size_t bytes = (bits + 7) / 8;
-        uint8_t* buf = bytes > 0 ? new uint8_t[bytes] : nullptr;
-        if (buf && bytes > 0) {
-            memset(static_cast<void*>(buf), 0, bytes);
-        }
-        return buf;
+        return static_cast<uint8_t*>(matrix_buffer::allocate((bits + 7) / 8));
     }
 
     static void copyBytes(uint8_t* dst, const uint8_t* src, size_t n) {
@@ -183,6 +352,172 @@ private:
             memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n);
         }
     }
+
+    void releaseBytes() noexcept {
+        if (ownsBytes_) {
+            matrix_buffer::release(bytes_, byteCount());
+        }
+        bytes_ = nullptr;
+    }
+
+    // Clear 'n' bits starting at bit 'k0': partial head/tail bytes bit by bit, whole bytes with memset.
+    void clearBits(size_t k0, size_t n) noexcept {
+        size_t k = k0;
+        const size_t end = k0 + n;
+        while (k < end && (k % 8) != 0) {
+            clrbit(k++);
+        }
+        const size_t whole = (end - k) / 8;
+        if (whole != 0) {
+            memset(static_cast<void*>(bytes_ + k / 8), 0, whole);
+            k += whole * 8;
+        }
+        while (k < end) {
+            clrbit(k++);
+        }
+    }
+
+    // Bits handled in one step when 'n' bits remain.
+    [[nodiscard]] static constexpr size_t wordLen(size_t n) noexcept {
+        return (n < cWordBits) ? n : cWordBits;
+    }
+
+    [[nodiscard]] static constexpr tWord lowMask(size_t n) noexcept {
+        return (n >= cWordBits) ? ~tWord{0} : ((tWord{1} << n) - 1u);
+    }
+
+    // Little-endian word from 'p'; only the first 'avail' bytes are read (missing bytes are zero).
+    [[nodiscard]] static tWord readWord(const uint8_t* p, size_t avail) noexcept {
+        uint8_t b[sizeof(tWord)] = {};
+        if (avail >= sizeof(tWord)) {
+            memcpy(b, p, sizeof(tWord));
+        } else {
+            memcpy(b, p, avail);
+        }
+        tWord v = 0;
+        for (size_t i = 0; i < sizeof(tWord); ++i) {
+            v |= static_cast<tWord>(b[i]) << (8 * i);
+        }
+        return v;
+    }
+
+    // Counterpart of readWord(): only the first 'avail' bytes are written.
+    static void writeWord(uint8_t* p, size_t avail, tWord v) noexcept {
+        uint8_t b[sizeof(tWord)];
+        for (size_t i = 0; i < sizeof(tWord); ++i) {
+            b[i] = static_cast<uint8_t>(v >> (8 * i));
+        }
+        memcpy(p, b, (avail >= sizeof(tWord)) ? sizeof(tWord) : avail);
+    }
+
+    // 'n' (1..cWordBits) bits starting at bit 'k', bit k in the lowest position.
+    [[nodiscard]] tWord loadBits(size_t k, size_t n) const noexcept {
+        const size_t byte = k / 8;
+        const size_t shift = k % 8;
+        tWord v = readWord(bytes_ + byte, byteCount() - byte) >> shift;
+        if (shift != 0 && shift + n > cWordBits) {
+            v |= static_cast<tWord>(bytes_[byte + sizeof(tWord)]) << (cWordBits - shift);
+        }
+        return v & lowMask(n);
+    }
+
+    // Write the low 'n' (1..cWordBits) bits of 'v' at bit 'k'; other bits are kept.
+    void storeBits(size_t k, size_t n, tWord v) noexcept {
+        const size_t byte = k / 8;
+        const size_t shift = k % 8;
+        const size_t avail = byteCount() - byte;
+        const tWord mask = lowMask(n);
+        v &= mask;
+        const tWord w = readWord(bytes_ + byte, avail);
+        writeWord(bytes_ + byte, avail, (w & ~(mask << shift)) | (v << shift));
+        if (shift != 0 && shift + n > cWordBits) {
+            const uint8_t hiMask = static_cast<uint8_t>((1u << (shift + n - cWordBits)) - 1u);
+            uint8_t& b = bytes_[byte + sizeof(tWord)];
+            b = static_cast<uint8_t>((b & ~hiMask) | (static_cast<uint8_t>(v >> (cWordBits - shift)) & hiMask));
+        }
+    }
+
+    // Set 'n' bits starting at bit 'k' to 'value'.
+    void fillBits(size_t k, size_t n, bool value) noexcept {
+        const tWord v = value ? ~tWord{0} : tWord{0};
+        for (size_t i = 0; i < n; i += cWordBits) {
+            storeBits(k + i, wordLen(n - i), v);
+        }
+    }
+
+    // Copy 'n' bits from bit 'src' to bit 'dst' (ranges must not overlap).
+    void copyBits(size_t dst, size_t src, size_t n) noexcept {
+        for (size_t i = 0; i < n; i += cWordBits) {
+            const size_t len = wordLen(n - i);
+            storeBits(dst + i, len, loadBits(src + i, len));
+        }
+    }
+
+    [[nodiscard]] size_t countBits(size_t k, size_t n) const noexcept {
+        size_t total = 0;
+        for (size_t i = 0; i < n; i += cWordBits) {
+            total += static_cast<size_t>(math::popcount(loadBits(k + i, wordLen(n - i))));
+        }
+        return total;
+    }
+
+    // Call op(k, n) for each run of pixel bits: the whole buffer when rows are packed, else row by row.
+    template <typename Op>
+    void forEachRowRange(Op op) const {
+        if (!bytes_ || width_ == 0) {
+            return;
+        }
+        if (strideBits_ == width_) {
+            op(size_t{0}, bitCount());
+            return;
+        }
+        for (size_t y = 0; y < height_; ++y) {
+            op(y * strideBits_, static_cast<size_t>(width_));
+        }
+    }
+
+    // this = op(this, other) over the shared area, tWord bits per step.
+    template <typename Op>
+    void combine(const csMatrixBoolean& other, Op op) noexcept {
+        if (!bytes_ || !other.bytes_) {
+            return;
+        }
+        auto apply = [&](size_t k, size_t ok, size_t n) {
+            for (size_t i = 0; i < n; i += cWordBits) {
+                const size_t len = wordLen(n - i);
+                storeBits(k + i, len, op(loadBits(k + i, len), other.loadBits(ok + i, len)));
+            }
+        };
+        if (width_ == other.width_ && height_ == other.height_ &&
+            strideBits_ == width_ && other.strideBits_ == other.width_) {
+            apply(0, 0, bitCount());
+            return;
+        }
+        const size_t w = min(width_, other.width_);
+        const size_t h = min(height_, other.height_);
+        for (size_t y = 0; y < h; ++y) {
+            apply(y * strideBits_, y * other.strideBits_, w);
+        }
+    }
+
+    // Copy bits of the area both matrices share (whole buffer when sizes match and neither is strided).
+    void copyContent(const csMatrixBoolean& other) noexcept {
+        if (!bytes_ || !other.bytes_) {
+            return;
+        }
+        if (width_ == other.width_ && height_ == other.height_ &&
+            strideBits_ == width_ && other.strideBits_ == other.width_) {
+            copyBytes(bytes_, other.bytes_, byteCount());
+            return;
+        }
+        const tMatrixPixelsCoord w = to_coord(min(width_, other.width_));
+        const tMatrixPixelsCoord h = to_coord(min(height_, other.height_));
+        for (tMatrixPixelsCoord y = 0; y < h; ++y) {
+            for (tMatrixPixelsCoord x = 0; x < w; ++x) {
+                setValue(x, y, other.getValue(x, y));
+            }
+        }
+    }
 };
 
 } // namespace amp
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace amp {
+
+using ::size_t;
+using ::uint8_t;
+using ::uint32_t;
+
+// Allocator for matrix storage (pixel, byte and bit buffers of csMatrixPixels, csMatrixBytes and
+// csMatrixBoolean). Install one with matrix_buffer::setAllocator(); without one, buffers come from
+// plain operator new / delete as before.
+//
+// The allocator must be installed before the first matrix is created and stay installed while any
+// matrix lives: buffers are returned to the allocator that is current at release time.
+class csMatrixAllocator {
+public:
+    virtual ~csMatrixAllocator() = default;
+
+    // Storage for 'bytes' bytes ('bytes' > 0), suitably aligned for csColorRGBA.
+    virtual void* allocate(size_t bytes) = 0;
+
+    // Return storage obtained from allocate(bytes); 'bytes' is the same value.
+    virtual void release(void* ptr, size_t bytes) noexcept = 0;
+
+    // Called by csEffectManager::render() after each frame.
+    virtual void endFrame() noexcept {}
+};
+
+namespace matrix_buffer {
+
+// Current allocator slot (function-local static keeps this header-only without inline variables).
+inline csMatrixAllocator*& allocatorSlot() noexcept {
+    static csMatrixAllocator* current = nullptr;
+    return current;
+}
+
+inline csMatrixAllocator* allocator() noexcept {
+    return allocatorSlot();
+}
+
+// Install 'a' (nullptr restores operator new / delete). See csMatrixAllocator for the lifetime rule.
+inline void setAllocator(csMatrixAllocator* a) noexcept {
+    allocatorSlot() = a;
+}
+
+// Zero-filled storage of 'bytes' bytes; nullptr for 0.
+inline void* allocate(size_t bytes) {
+    if (bytes == 0) {
+        return nullptr;
+    }
+    csMatrixAllocator* a = allocator();
+    void* ptr = a ? a->allocate(bytes) : ::operator new(bytes);
+    memset(ptr, 0, bytes);
+    return ptr;
+}
+
+inline void release(void* ptr, size_t bytes) noexcept {
+    if (!ptr) {
+        return;
+    }
+    csMatrixAllocator* a = allocator();
+    if (a) {
+        a->release(ptr, bytes);
+    } else {
+        ::operator delete(ptr);
+    }
+}
+
+inline void endFrame() noexcept {
+    csMatrixAllocator* a = allocator();
+    if (a) {
+        a->endFrame();
+    }
+}
+
+} // namespace matrix_buffer
+
+// Matrix buffer pool: freed buffers are kept per size class and handed out again, so the
+// delete/new churn of resizes, glyph matrices and other scratch matrices stops fragmenting the heap
+// (long running ESP8266 devices die from fragmentation, not from a lack of free bytes).
+//
+// - Size classes are quarter steps between powers of two (16, 20, 24, 28, 32, 40, ...): a request
+//   wastes at most 25% and buffers of similar matrices share a class.
+// - Up to cMaxCached free buffers are kept, optionally limited to 'cacheLimitBytes' in total.
+// - Mode::ReleaseAfterFrame: cached buffers are returned to the heap in endFrame(), so scratch
+//   matrices reuse one buffer within a frame but hold no memory between frames.
+// - Statistics report the bytes taken from the heap and their high-water mark.
+class csMatrixBufferPool : public csMatrixAllocator {
+public:
+    enum class Mode : uint8_t {
+        Cache = 0,             // keep freed buffers until trim()
+        ReleaseAfterFrame = 1, // keep freed buffers until endFrame()
+    };
+
+    static constexpr uint8_t cMaxCached = 8;
+    static constexpr size_t cMinClass = 16;
+
+    explicit csMatrixBufferPool(Mode mode = Mode::Cache, size_t cacheLimitBytes = 0) noexcept
+        : mode_{mode}, cacheLimit_{cacheLimitBytes} {}
+
+    csMatrixBufferPool(const csMatrixBufferPool&) = delete;
+    csMatrixBufferPool& operator=(const csMatrixBufferPool&) = delete;
+
+    ~csMatrixBufferPool() override { trim(); }
+
+    // Allocated size for a request of 'bytes' bytes.
+    static size_t sizeClass(size_t bytes) noexcept {
+        if (bytes <= cMinClass) {
+            return cMinClass;
+        }
+        size_t pow2 = cMinClass;
+        while ((pow2 << 1) < bytes && (pow2 << 1) > pow2) {
+            pow2 <<= 1;
+        }
+        const size_t step = pow2 >> 2;
+        return (bytes + step - 1) / step * step;
+    }
+
+    void* allocate(size_t bytes) override {
+        const size_t cls = sizeClass(bytes);
+        for (uint8_t i = 0; i < cachedCount_; ++i) {
+            if (cached_[i].bytes == cls) {
+                void* ptr = cached_[i].ptr;
+                cachedBytes_ -= cls;
+                cached_[i] = cached_[--cachedCount_];
+                usedBytes_ += cls;
+                ++reuseCount_;
+                return ptr;
+            }
+        }
+        void* ptr = ::operator new(cls);
+        usedBytes_ += cls;
+        ++heapAllocCount_;
+        if (heapBytes() > highWater_) {
+            highWater_ = heapBytes();
+        }
+        return ptr;
+    }
+
+    void release(void* ptr, size_t bytes) noexcept override {
+        if (!ptr) {
+            return;
+        }
+        const size_t cls = sizeClass(bytes);
+        usedBytes_ -= cls;
+        if (cachedCount_ < cMaxCached && (cacheLimit_ == 0 || cachedBytes_ + cls <= cacheLimit_)) {
+            cached_[cachedCount_++] = Block{ptr, cls};
+            cachedBytes_ += cls;
+            return;
+        }
+        ::operator delete(ptr);
+    }
+
+    void endFrame() noexcept override {
+        if (mode_ == Mode::ReleaseAfterFrame) {
+            trim();
+        }
+    }
+
+    // Return all cached buffers to the heap.
+    void trim() noexcept {
+        for (uint8_t i = 0; i < cachedCount_; ++i) {
+            ::operator delete(cached_[i].ptr);
+        }
+        cachedCount_ = 0;
+        cachedBytes_ = 0;
+    }
+
+    void setMode(Mode mode) noexcept { mode_ = mode; }
+    [[nodiscard]] Mode mode() const noexcept { return mode_; }
+
+    // Bytes held by live matrices.
+    [[nodiscard]] size_t usedBytes() const noexcept { return usedBytes_; }
+    // Bytes kept for reuse.
+    [[nodiscard]] size_t cachedBytes() const noexcept { return cachedBytes_; }
+    // Bytes taken from the heap by this pool right now.
+    [[nodiscard]] size_t heapBytes() const noexcept { return usedBytes_ + cachedBytes_; }
+    // Maximum of heapBytes() since construction (or resetHighWater()).
+    [[nodiscard]] size_t highWaterBytes() const noexcept { return highWater_; }
+    void resetHighWater() noexcept { highWater_ = heapBytes(); }
+
+    // Requests served from the cache / from the heap.
+    [[nodiscard]] uint32_t reuseCount() const noexcept { return reuseCount_; }
+    [[nodiscard]] uint32_t heapAllocCount() const noexcept { return heapAllocCount_; }
+
+private:
+    struct Block {
+        void* ptr;
+        size_t bytes;
+    };
+
+    Mode mode_;
+    size_t cacheLimit_;
+    Block cached_[cMaxCached]{};
+    uint8_t cachedCount_{0};
+    size_t cachedBytes_{0};
+    size_t usedBytes_{0};
+    size_t highWater_{0};
+    uint32_t reuseCount_{0};
+    uint32_t heapAllocCount_{0};
+};
+
+} // namespace amp
@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <string.h>
 #include "matrix_base.hpp"
+#include "matrix_buffer_pool.hpp"
+#include "matrix_layout.hpp"
 #include "matrix_types.hpp"
 #include "rect.hpp"
 
@@ -16,29 +18,42 @@ using ::uint8_t;
 class csMatrixBytes : public csMatrixBase {
 public:
     // Construct matrix with given size, all bytes cleared to 0.
-    csMatrixBytes(tMatrixPixelsSize width, tMatrixPixelsSize height, uint8_t defaultOutOfBoundsValue = 0)
-        : outOfBoundsValue{defaultOutOfBoundsValue}, width_{width}, height_{height}, bytes_(allocate(width, height)) {}
+    // 'layout' selects the buffer order (see csMatrixLayout); it is fixed for the matrix lifetime.
+    csMatrixBytes(tMatrixPixelsSize width, tMatrixPixelsSize height, uint8_t defaultOutOfBoundsValue = 0,
+                  csMatrixLayout layout = csMatrixLayout::RowMajor)
+        : outOfBoundsValue{defaultOutOfBoundsValue}, width_{width}, height_{height}, stride_{width}, layout_{layout},
+          bytes_(allocate(layout, width, height)) {}
 
-    // Copy constructor: makes deep copy of byte buffer.
+    // Copy constructor: makes deep copy of byte buffer (a view is copied into an owned buffer).
     csMatrixBytes(const csMatrixBytes& other)
-        : outOfBoundsValue{other.outOfBoundsValue}, width_{other.width_}, height_{other.height_}, bytes_(allocate(width_, height_)) {
-        copyBytes(bytes_, other.bytes_, count());
+        : outOfBoundsValue{other.outOfBoundsValue}, width_{other.width_}, height_{other.height_}, stride_{other.width_},
+          layout_{other.layout_}, bytes_(allocate(layout_, width_, height_)) {
+        copyContent(other);
     }
 
     // Move constructor: transfers ownership of buffer, leaving source empty.
     csMatrixBytes(csMatrixBytes&& other) noexcept
-        : outOfBoundsValue{other.outOfBoundsValue}, width_{other.width_}, height_{other.height_}, bytes_{other.bytes_} {
+        : outOfBoundsValue{other.outOfBoundsValue}, width_{other.width_}, height_{other.height_}, stride_{other.stride_},
+          layout_{other.layout_}, ownsBytes_{other.ownsBytes_}, bytes_{other.bytes_} {
         other.bytes_ = nullptr;
         other.width_ = 0;
         other.height_ = 0;
         other.outOfBoundsValue = 0;
     }
 
-    // Copy assignment: deep copy when assigning existing object.
+    // Copy assignment: deep copy when assigning existing object (layout is copied too).
+    // A view keeps its external buffer and size: only the overlapping area is copied.
     csMatrixBytes& operator=(const csMatrixBytes& other) {
         if (this != &other) {
+            if (ownsBytes_ && layout_ != other.layout_) {
+                // Force reallocation in the other layout.
+                releaseBytes();
+                layout_ = other.layout_;
+                width_ = 0;
+                height_ = 0;
+            }
             resize(other.width_, other.height_);
-            copyBytes(bytes_, other.bytes_, count());
+            copyContent(other);
             outOfBoundsValue = other.outOfBoundsValue;
         }
         return *this;
@@ -47,9 +62,12 @@ public:
     // Move assignment: steal buffer from other, reset other to empty.
     csMatrixBytes& operator=(csMatrixBytes&& other) noexcept {
         if (this != &other) {
-            delete[] bytes_;
+            releaseBytes();
             width_ = other.width_;
             height_ = other.height_;
+            stride_ = other.stride_;
+            layout_ = other.layout_;
+            ownsBytes_ = other.ownsBytes_;
             outOfBoundsValue = other.outOfBoundsValue;
             bytes_ = other.bytes_;
             other.bytes_ = nullptr;
@@ -60,12 +78,14 @@ public:
         return *this;
     }
 
-    ~csMatrixBytes() { delete[] bytes_; }
+    virtual ~csMatrixBytes() { releaseBytes(); }
 
     [[nodiscard]] tMatrixPixelsSize width() const noexcept override { return width_; }
     [[nodiscard]] tMatrixPixelsSize height() const noexcept override { return height_; }
 
     // csMatrixBase (RGBA interface)
+    [[nodiscard]] csPixelFormat pixelFormat() const noexcept override { return csPixelFormat::Gray8; }
+
     [[nodiscard]] inline csColorRGBA getPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept override {
         const uint8_t v = getValue(x, y);
         return csColorRGBA{255, v, v, v};
@@ -96,7 +116,16 @@ public:
     // Default value returned when accessing out-of-bounds coordinates.
     uint8_t outOfBoundsValue{0};
 
-    // Get byte value by linear index k. Returns outOfBoundsValue when out of bounds.
+    // Buffer order selected at construction.
+    [[nodiscard]] csMatrixLayout layout() const noexcept { return layout_; }
+
+    // Bytes between the starts of two rows (RowMajor); equals width() unless this is a strided view.
+    [[nodiscard]] size_t stride() const noexcept { return stride_; }
+
+    // False for views over caller-owned memory (see csMatrixBytesView).
+    [[nodiscard]] bool ownsBytes() const noexcept { return ownsBytes_; }
+
+    // Get byte value by linear buffer index k (y * stride + x for RowMajor). Returns outOfBoundsValue when out of bounds.
     [[nodiscard]] inline uint8_t get(size_t k) const noexcept {
         if (k >= count()) {
             return outOfBoundsValue;
@@ -104,7 +133,7 @@ public:
         return bytes_[k];
     }
 
-    // Set byte value by linear index k. Out-of-bounds writes are silently ignored.
+    // Set byte value by linear buffer index k. Out-of-bounds writes are silently ignored.
     inline void set(size_t k, uint8_t value) noexcept {
         if (k < count()) {
             bytes_[k] = value;
@@ -127,51 +156,163 @@ public:
         bytes_[index(x, y)] = value;
     }
 
-    // Clear matrix: set all bytes to 0.
+    // Clear matrix: set all bytes to 0 (row by row for strided views).
     inline void clear() noexcept {
         const size_t n = count();
         if (n != 0 && bytes_) {
-            memset(static_cast<void*>(bytes_), 0, n);
+            if (stride_ == width_) {
+                memset(static_cast<void*>(bytes_), 0, n);
+            } else {
+                for (tMatrixPixelsSize y = 0; y < height_; ++y) {
+                    memset(static_cast<void*>(bytes_ + static_cast<size_t>(y) * stride_), 0, width_);
+                }
+            }
         }
     }
 
     // Resize matrix to new dimensions. Existing bytes are lost (matrix is cleared).
+    // Views (see csMatrixBytesView) do not own their buffer and ignore resize().
     void resize(tMatrixPixelsSize w, tMatrixPixelsSize h) override {
-        if (w == width_ && h == height_) {
+        if ((w == width_ && h == height_) || !ownsBytes_) {
             return;
         }
-        delete[] bytes_;
+        releaseBytes();
         width_ = w;
         height_ = h;
-        bytes_ = allocate(width_, height_);
+        stride_ = w;
+        bytes_ = allocate(layout_, width_, height_);
+    }
+
+    // Row-span access to raw bytes (same semantics as csMatrixBase::getScanLine).
+    bool getScanLineBytes(csRect area, tMatrixPixelsCoord offset_x, tMatrixPixelsCoord offset_y,
+                          uint8_t*& ptrLine, tMatrixPixelsSize& lineLen) noexcept {
+        size_t start = 0;
+        if (!scanLineSpan(area, offset_x, offset_y, start, lineLen)) {
+            ptrLine = nullptr;
+            return false;
+        }
+        ptrLine = bytes_ + start;
+        return true;
+    }
+
+    bool getScanLineBytes(csRect area, tMatrixPixelsCoord offset_x, tMatrixPixelsCoord offset_y,
+                          const uint8_t*& ptrLine, tMatrixPixelsSize& lineLen) const noexcept {
+        size_t start = 0;
+        if (!scanLineSpan(area, offset_x, offset_y, start, lineLen)) {
+            ptrLine = nullptr;
+            return false;
+        }
+        ptrLine = bytes_ + start;
+        return true;
+    }
+
+    // Start of row 'y' (width() contiguous bytes) for RowMajor buffers; nullptr for Tiled8x8 or outside rows.
+    // Used by the byte row kernels (byte_row.hpp).
+    [[nodiscard]] uint8_t* row(tMatrixPixelsCoord y) noexcept {
+        return (layout_ == csMatrixLayout::RowMajor && bytes_ && y >= 0 && y < to_coord(height_))
+            ? bytes_ + static_cast<size_t>(y) * stride_
+            : nullptr;
+    }
+
+    [[nodiscard]] const uint8_t* row(tMatrixPixelsCoord y) const noexcept {
+        return const_cast<csMatrixBytes*>(this)->row(y);
+    }
+
+protected:
+    // Non-owning constructor for views: wraps 'external' (row-major, 'stride' bytes per row).
+    csMatrixBytes(uint8_t* external, tMatrixPixelsSize width, tMatrixPixelsSize height, size_t stride,
+                  uint8_t defaultOutOfBoundsValue)
+        : outOfBoundsValue{defaultOutOfBoundsValue}, width_{width}, height_{height},
+          stride_{(stride > width) ? stride : static_cast<size_t>(width)}, ownsBytes_{false}, bytes_{external} {}
+
+    // Start of the buffer (owned or external).
+    [[nodiscard]] uint8_t* buffer() const noexcept { return bytes_; }
+
+    // Point a view at another external buffer.
+    void attachExternal(uint8_t* external, tMatrixPixelsSize width, tMatrixPixelsSize height, size_t stride) noexcept {
+        releaseBytes();
+        width_ = width;
+        height_ = height;
+        stride_ = (stride > width) ? stride : static_cast<size_t>(width);
+        layout_ = csMatrixLayout::RowMajor;
+        ownsBytes_ = false;
+        bytes_ = external;
     }
 
 private:
     tMatrixPixelsSize width_;
     tMatrixPixelsSize height_;
+    size_t stride_{0};
+    csMatrixLayout layout_{csMatrixLayout::RowMajor};
+    bool ownsBytes_{true};
     uint8_t* bytes_{nullptr};
 
+    // Resolve span start index and length for getScanLineBytes(); false when the span is empty.
+    [[nodiscard]] bool scanLineSpan(csRect area, tMatrixPixelsCoord offset_x, tMatrixPixelsCoord offset_y,
+                                    size_t& start, tMatrixPixelsSize& lineLen) const noexcept {
+        lineLen = 0;
+        if (offset_x < 0 || offset_y < 0 ||
+            offset_x >= to_coord(area.width) || offset_y >= to_coord(area.height)) {
+            return false;
+        }
+        const tMatrixPixelsCoord x = area.x + offset_x;
+        const tMatrixPixelsCoord y = area.y + offset_y;
+        if (!inside(x, y) || !bytes_) {
+            return false;
+        }
+        const tMatrixPixelsCoord end_x =
+            matrix_layout::runEnd(layout_, x, min(area.x + to_coord(area.width), to_coord(width_)));
+        start = index(x, y);
+        lineLen = to_size(end_x - x);
+        return true;
+    }
+
     [[nodiscard]] inline bool inside(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept {
         return x >= 0 && y >= 0 && x < static_cast<tMatrixPixelsCoord>(width_) && y < static_cast<tMatrixPixelsCoord>(height_);
     }
 
     [[nodiscard]] inline size_t index(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept {
-        const auto xx = static_cast<size_t>(x);
-        const auto yy = static_cast<size_t>(y);
-        return yy * width_ + xx;
+        return matrix_layout::index(layout_, stride_, x, y);
     }
 
+    // Number of addressable buffer elements (includes tile padding for Tiled8x8; ends at the last
+    // pixel of the last row for strided views).
     [[nodiscard]] inline size_t count() const noexcept {
-        return static_cast<size_t>(width_) * static_cast<size_t>(height_);
+        if (stride_ != width_ && height_ != 0) {
+            return stride_ * (height_ - 1u) + width_;
+        }
+        return matrix_layout::storageCount(layout_, width_, height_);
     }
 
-    [[nodiscard]] static uint8_t* allocate(uint16_t w, uint16_t h) {
-        const size_t n = static_cast<size_t>(w) * static_cast<size_t>(h);
-        uint8_t* buf = n > 0 ? new uint8_t[n] : nullptr;
-        if (buf && n > 0) {
-            memset(static_cast<void*>(buf), 0, n);
+    void releaseBytes() noexcept {
+        if (ownsBytes_) {
+            matrix_buffer::release(bytes_, count());
         }
-        return buf;
+        bytes_ = nullptr;
+    }
+
+    // Copy bytes of the area both matrices share (whole buffer when layouts and strides match).
+    void copyContent(const csMatrixBytes& other) noexcept {
+        if (!bytes_ || !other.bytes_) {
+            return;
+        }
+        if (layout_ == other.layout_ && width_ == other.width_ && height_ == other.height_ &&
+            stride_ == width_ && other.stride_ == other.width_) {
+            copyBytes(bytes_, other.bytes_, count());
+            return;
+        }
+        const tMatrixPixelsCoord w = to_coord(min(width_, other.width_));
+        const tMatrixPixelsCoord h = to_coord(min(height_, other.height_));
+        for (tMatrixPixelsCoord y = 0; y < h; ++y) {
+            for (tMatrixPixelsCoord x = 0; x < w; ++x) {
+                bytes_[index(x, y)] = other.bytes_[other.index(x, y)];
+            }
+        }
+    }
+
+    // Zero-filled storage from the matrix buffer allocator; nullptr when empty.
+    [[nodiscard]] static uint8_t* allocate(csMatrixLayout layout, uint16_t w, uint16_t h) {
+        return static_cast<uint8_t*>(matrix_buffer::allocate(matrix_layout::storageCount(layout, w, h)));
     }
 
     static void copyBytes(uint8_t* dst, const uint8_t* src, size_t n) {
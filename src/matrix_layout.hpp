@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "matrix_types.hpp"
+
+namespace amp {
+
+using ::size_t;
+using ::uint8_t;
+
+// Storage order of a matrix buffer (selected at construction of csMatrixPixels / csMatrixBytes).
+//
+// RowMajor: index = y * width + x. Best for row-wise work (fills, blits, output drivers).
+// Tiled8x8: buffer is a row-major grid of 8x8 tiles, each tile stored row-major (64 elements).
+//   Width and height are padded to multiples of 8. A column walk touches 8 rows per tile instead of
+//   one cache line per row, which helps vertical access on large canvases (scaling, column remaps,
+//   upward diffusion). Row spans are at most 8 pixels long (one tile row).
+//
+// Layout is invisible through getPixel/setPixel; getScanLine() callers already loop over spans.
+enum class csMatrixLayout : uint8_t {
+    RowMajor = 0,
+    Tiled8x8 = 1,
+};
+
+namespace matrix_layout {
+
+constexpr uint8_t cTileShift = 3;
+constexpr tMatrixPixelsCoord cTileMask = (1 << cTileShift) - 1;
+
+// Number of 8x8 tiles covering 'size' pixels.
+constexpr size_t tileCount(tMatrixPixelsSize size) noexcept {
+    return (static_cast<size_t>(size) + static_cast<size_t>(cTileMask)) >> cTileShift;
+}
+
+// Number of elements to allocate for a w x h matrix.
+constexpr size_t storageCount(csMatrixLayout layout, tMatrixPixelsSize w, tMatrixPixelsSize h) noexcept {
+    return (layout == csMatrixLayout::Tiled8x8)
+        ? ((tileCount(w) * tileCount(h)) << (2 * cTileShift))
+        : static_cast<size_t>(w) * static_cast<size_t>(h);
+}
+
+// Buffer index of (x, y); coordinates must be inside the matrix.
+inline size_t index(csMatrixLayout layout, tMatrixPixelsSize w, tMatrixPixelsCoord x, tMatrixPixelsCoord y) noexcept {
+    if (layout == csMatrixLayout::RowMajor) {
+        return static_cast<size_t>(y) * w + static_cast<size_t>(x);
+    }
+    const size_t tile = static_cast<size_t>(y >> cTileShift) * tileCount(w) + static_cast<size_t>(x >> cTileShift);
+    return (tile << (2 * cTileShift)) + (static_cast<size_t>(y & cTileMask) << cTileShift) + static_cast<size_t>(x & cTileMask);
+}
+
+// End (exclusive) of the contiguous run that starts at 'x' and must not pass 'limit'.
+inline tMatrixPixelsCoord runEnd(csMatrixLayout layout, tMatrixPixelsCoord x, tMatrixPixelsCoord limit) noexcept {
+    if (layout == csMatrixLayout::RowMajor) {
+        return limit;
+    }
+    const tMatrixPixelsCoord tileEnd = (x | cTileMask) + 1;
+    return (tileEnd < limit) ? tileEnd : limit;
+}
+
+} // namespace matrix_layout
+
+} // namespace amp
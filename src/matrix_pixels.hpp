@@ -3,8 +3,12 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
+#include "blend_row.hpp"
 #include "color_rgba.hpp"
+#include "dirty_tiles.hpp"
 #include "matrix_base.hpp"
+#include "matrix_buffer_pool.hpp"
+#include "matrix_layout.hpp"
 #include "matrix_types.hpp"
 #include "rect.hpp"
 #include "math.hpp"
@@ -18,21 +22,33 @@ using math::max;
 using math::min;
 using math::csFP16;
 
+// Alpha summary of one matrix row (see csMatrixPixels::rowAlpha()).
+enum class csRowAlpha : uint8_t {
+    Unknown = 0,     // Row was written since the last classification.
+    Opaque = 1,      // Every pixel has a == 255.
+    Transparent = 2, // Every pixel is transparent black (value 0), e.g. after clear().
+    Mixed = 3,       // Anything else.
+};
+
 // Header-only RGBA pixel matrix with straight-alpha SourceOver blending.
 // Color format: 0xAARRGGBB (A in the most significant byte).
 class csMatrixPixels : public csMatrixBase {
 public:
     // Construct matrix with given size, all pixels cleared.
-    csMatrixPixels(tMatrixPixelsSize size_x, tMatrixPixelsSize size_y)
-        : size_x_{size_x}, size_y_{size_y}, pixels_(allocate(size_x, size_y)) {}
+    // 'layout' selects the buffer order (see csMatrixLayout); it is fixed for the matrix lifetime.
+    csMatrixPixels(tMatrixPixelsSize size_x, tMatrixPixelsSize size_y, csMatrixLayout layout = csMatrixLayout::RowMajor)
+        : size_x_{size_x}, size_y_{size_y}, stride_{size_x}, layout_{layout}, pixels_(allocate(layout, size_x, size_y)),
+          rowAlpha_(allocateRowAlpha(size_y, csRowAlpha::Transparent)) {}
 
-    // Copy constructor: makes deep copy of pixel buffer.
+    // Copy constructor: makes deep copy of pixel buffer (a view is copied into an owned buffer).
     // Triggers when you pass by value or return by value, e.g.:
     //   csMatrixPixels b = a;  // invokes copy ctor
     //   auto f() { return a; } // NRVO elided or copy/move ctor
     csMatrixPixels(const csMatrixPixels& other)
-        : size_x_{other.size_x_}, size_y_{other.size_y_}, pixels_(allocate(size_x_, size_y_)) {
-        copyPixels(pixels_, other.pixels_, count());
+        : size_x_{other.size_x_}, size_y_{other.size_y_}, stride_{other.size_x_}, layout_{other.layout_},
+          pixels_(allocate(layout_, size_x_, size_y_)), rowAlpha_(allocateRowAlpha(size_y_, csRowAlpha::Transparent)) {
+        copyContent(other);
+        copyRowAlpha(other);
     }
 
     // Move constructor: transfers ownership of buffer, leaving source empty.
@@ -40,18 +56,35 @@ public:
     //   csMatrixPixels b = std::move(a);
     //   return csMatrixPixels{w,h};
     csMatrixPixels(csMatrixPixels&& other) noexcept
-        : size_x_{other.size_x_}, size_y_{other.size_y_}, pixels_{other.pixels_} {
+        : size_x_{other.size_x_}, size_y_{other.size_y_}, stride_{other.stride_}, layout_{other.layout_},
+          ownsPixels_{other.ownsPixels_}, pixels_{other.pixels_}, rowAlpha_{other.rowAlpha_}, dirty_{other.dirty_},
+          parent_{other.parent_}, parentX_{other.parentX_}, parentY_{other.parentY_} {
         other.pixels_ = nullptr;
+        other.rowAlpha_ = nullptr;
+        other.dirty_ = nullptr;
         other.size_x_ = 0;
         other.size_y_ = 0;
     }
 
-    // Copy assignment: deep copy when assigning existing object.
+    // Copy assignment: deep copy when assigning existing object (layout is copied too).
+    // A view keeps its external buffer and size: only the overlapping area is copied.
     //   b = a;
     csMatrixPixels& operator=(const csMatrixPixels& other) {
         if (this != &other) {
+            if (ownsPixels_ && layout_ != other.layout_) {
+                // Force reallocation in the other layout.
+                releasePixels();
+                layout_ = other.layout_;
+                size_x_ = 0;
+                size_y_ = 0;
+            }
             resize(other.size_x_, other.size_y_);
-            copyPixels(pixels_, other.pixels_, count());
+            copyContent(other);
+            copyRowAlpha(other);
+            touchParent();
+            if (dirty_) {
+                dirty_->markAll();
+            }
         }
         return *this;
     }
@@ -60,18 +93,34 @@ public:
     //   b = std::move(a);
     csMatrixPixels& operator=(csMatrixPixels&& other) noexcept {
         if (this != &other) {
-            delete[] pixels_;
+            releasePixels();
+            delete[] rowAlpha_;
+            delete dirty_;
             size_x_ = other.size_x_;
             size_y_ = other.size_y_;
+            stride_ = other.stride_;
+            layout_ = other.layout_;
+            ownsPixels_ = other.ownsPixels_;
+            parent_ = other.parent_;
+            parentX_ = other.parentX_;
+            parentY_ = other.parentY_;
             pixels_ = other.pixels_;
+            rowAlpha_ = other.rowAlpha_;
+            dirty_ = other.dirty_;
             other.pixels_ = nullptr;
+            other.rowAlpha_ = nullptr;
+            other.dirty_ = nullptr;
             other.size_x_ = 0;
             other.size_y_ = 0;
         }
         return *this;
     }
 
-    ~csMatrixPixels() { delete[] pixels_; }
+    virtual ~csMatrixPixels() {
+        releasePixels();
+        delete[] rowAlpha_;
+        delete dirty_;
+    }
 
     [[nodiscard]] tMatrixPixelsSize width() const noexcept override { return size_x_; }
     [[nodiscard]] tMatrixPixelsSize height() const noexcept override { return size_y_; }
@@ -79,191 +128,449 @@ public:
     // Overwrite pixel. Out-of-bounds writes are silently ignored.
     inline void setPixelRewrite(tMatrixPixelsCoord x, tMatrixPixelsCoord y, csColorRGBA color) noexcept override {
         if (inside(x, y)) {
-            pixels_[index(x, y)] = color;
+            csColorRGBA& dst = pixels_[index(x, y)];
+            if (dst.value != color.value) {
+                touchPixel(x, y);
+                dst = color;
+            }
         }
     }
 
     // Blend source color over destination pixel using SourceOver (straight alpha).
     void setPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y, csColorRGBA color) noexcept override {
         if (inside(x, y)) {
-            const csColorRGBA dst = pixels_[index(x, y)];
-            pixels_[index(x, y)] = csColorRGBA::sourceOverStraight(dst, color);
+            csColorRGBA& dst = pixels_[index(x, y)];
+            const csColorRGBA out = csColorRGBA::sourceOverStraight(dst, color);
+            if (dst.value != out.value) {
+                touchPixel(x, y);
+                dst = out;
+            }
         }
     }
 
-    // Blend source color over destination pixels using sub-pixel positioning.
-    // Fixed-point coordinates allow positioning between pixels; color is distributed across 1-2 pixels
-    // with alpha proportional to distance from pixel center.
-    void setPixelFloat2(csFP16 x, csFP16 y, csColorRGBA color) noexcept {
-        // Round to nearest pixel to find the center pixel
-        const tMatrixPixelsCoord cx = static_cast<tMatrixPixelsCoord>(x.round_int());
-        const tMatrixPixelsCoord cy = static_cast<tMatrixPixelsCoord>(y.round_int());
+    // Read pixel; returns transparent black when out of bounds.
+    [[nodiscard]] inline csColorRGBA getPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept override {
+        if (inside(x, y)) {
+            return pixels_[index(x, y)];
+        }
+        return csColorRGBA{0, 0, 0, 0};
+    }
 
-        // Check if exact pixel center (no fractional part)
-        if (x.frac_abs_raw() == 0 && y.frac_abs_raw() == 0) {
-            // Draw single pixel with full alpha
-            setPixel(cx, cy, color);
-            return;
+    // Clear matrix to transparent black.
+    void clear() noexcept {
+        const size_t bytes = count() * sizeof(csColorRGBA);
+        if (bytes != 0 && pixels_) {
+            // Fast zero-fill; csColorRGBA is 4 bytes (see static_assert in color_rgba.hpp).
+            if (contiguous()) {
+                memset(static_cast<void*>(pixels_), 0, bytes);
+            } else {
+                // Strided view: keep the caller's memory between rows intact.
+                for (tMatrixPixelsSize y = 0; y < size_y_; ++y) {
+                    memset(static_cast<void*>(pixels_ + index(0, to_coord(y))), 0, size_x_ * sizeof(csColorRGBA));
+                }
+            }
+            memset(rowAlpha_, static_cast<int>(csRowAlpha::Transparent), size_y_);
+            touchParent();
         }
+        if (dirty_) {
+            dirty_->onClear();
+        }
+    }
 
-        // Calculate offset from rounded center to determine direction.
-        // Compute offsets from the center pixel. These tell us how far the point is from the center
-        // Note: cx/cy are integer pixel coords; we convert them to csFP16 via constructor
-        // (exact, no float) so dx/dy are computed in fixed-point units.
-        const csFP16 cx_fp = csFP16(cx);
-        const csFP16 cy_fp = csFP16(cy);
+    // Fill matrix with 'color' (no blending); clear(csColorRGBA{0, 0, 0, 0}) is the same as clear().
+    void clear(csColorRGBA color) noexcept {
+        if (color.value == 0) {
+            clear();
+            return;
+        }
+        for (tMatrixPixelsSize y = 0; y < size_y_; ++y) {
+            fillPixelsRowRewrite(0, to_coord(y), size_x_, color);
+        }
+    }
 
-        // dx/dy: signed sub-pixel offset from the rounded-center pixel (typically in [-0.5, +0.5]).
-        // Used to pick the sign (+1/-1) for the secondary pixel direction and to compute alpha weights.
-        const csFP16 dx = x - cx_fp;
-        const csFP16 dy = y - cy_fp;
+    // Resize matrix to new dimensions. Existing pixels are lost (matrix is cleared).
+    // Views (see csMatrixPixelsView) do not own their buffer and ignore resize().
+    void resize(tMatrixPixelsSize sx, tMatrixPixelsSize sy) override {
+        if ((sx == size_x_ && sy == size_y_) || !ownsPixels_) {
+            return;
+        }
+        releasePixels();
+        delete[] rowAlpha_;
+        size_x_ = sx;
+        size_y_ = sy;
+        stride_ = sx;
+        pixels_ = allocate(layout_, size_x_, size_y_);
+        rowAlpha_ = allocateRowAlpha(size_y_, csRowAlpha::Transparent);
+        if (dirty_) {
+            dirty_->resize(size_x_, size_y_);
+        }
+    }
 
-        // Select secondary pixel direction.
-        // IMPORTANT: axis decision uses original fractional parts (relative to the integer grid),
-        // not the abs offset relative to the rounded center (which can lose info, e.g. 2.75 -> -0.25).
-        tMatrixPixelsCoord sx = cx;
-        tMatrixPixelsCoord sy = cy;
+    // Dirty region tracking (see csDirtyTiles). Disabled by default: no memory, one branch per write.
+    // Write methods and mutable getScanLine() mark tiles; commitDirtyFrame() publishes changed tiles.
+    // fullRefreshFrames: every n-th commit reports the whole matrix (see csDirtyTiles::setFullRefresh).
+    void setDirtyTracking(bool enable, uint16_t fullRefreshFrames = csDirtyTiles::cDefaultFullRefresh) {
+        if (!enable) {
+            delete dirty_;
+            dirty_ = nullptr;
+            return;
+        }
+        if (!dirty_) {
+            dirty_ = new csDirtyTiles();
+            dirty_->resize(size_x_, size_y_);
+        }
+        dirty_->setFullRefresh(fullRefreshFrames);
+    }
 
-        const uint8_t fx_axis = static_cast<uint8_t>(x.frac_abs_raw());
-        const uint8_t fy_axis = static_cast<uint8_t>(y.frac_abs_raw());
+    // Tile tracker, or nullptr when tracking is disabled.
+    [[nodiscard]] const csDirtyTiles* dirtyTiles() const noexcept { return dirty_; }
 
-        if (fy_axis > fx_axis) {
-            // Vertical direction
-            sy = cy + (dy.raw_value() >= 0 ? 1 : -1);
-        } else if (fx_axis > fy_axis) {
-            // Horizontal direction
-            sx = cx + (dx.raw_value() >= 0 ? 1 : -1);
-        } else {
-            // Diagonal direction (equal components)
-            sx = cx + (dx.raw_value() >= 0 ? 1 : -1);
-            sy = cy + (dy.raw_value() >= 0 ? 1 : -1);
+    // End of frame: compare written tiles with the previous frame (see csDirtyTiles::commitFrame).
+    void commitDirtyFrame() noexcept {
+        if (dirty_) {
+            dirty_->commitFrame(pixels_, layout_, stride_);
         }
+    }
+
+    // Changed area after the last commitDirtyFrame(); whole matrix when tracking is disabled.
+    [[nodiscard]] csRect dirtyRect() const noexcept {
+        return dirty_ ? dirty_->changedRect() : getRect();
+    }
+
+    [[nodiscard]] csPixelFormat pixelFormat() const noexcept override { return csPixelFormat::ARGB8; }
 
-        // Get absolute fractional parts for weight calculation
-        const uint8_t fx_abs = static_cast<uint8_t>(dx.frac_abs_raw());
-        const uint8_t fy_abs = static_cast<uint8_t>(dy.frac_abs_raw());
+    // Buffer order selected at construction.
+    [[nodiscard]] csMatrixLayout layout() const noexcept { return layout_; }
 
-        // Calculate alpha weights using absolute fractional parts
-        const uint8_t max_offset_raw = max(fx_abs, fy_abs);
-        const uint8_t weight_uint8 = static_cast<uint8_t>((static_cast<uint16_t>(max_offset_raw) * 255u + 8u) / 16u);
+    // Pixels between the starts of two rows (RowMajor); equals width() unless this is a strided view.
+    [[nodiscard]] size_t stride() const noexcept { return stride_; }
 
-        const uint8_t secondary_alpha = mul8(color.a, weight_uint8);
-        const uint8_t center_alpha = color.a - secondary_alpha;
+    // False for views over caller-owned memory (see csMatrixPixelsView).
+    [[nodiscard]] bool ownsPixels() const noexcept { return ownsPixels_; }
 
-        if (center_alpha > 0) {
-            setPixel(cx, cy, csColorRGBA{center_alpha, color.r, color.g, color.b});
+    [[nodiscard]] const csMatrixBase* storageOwner() const noexcept override {
+        return parent_ ? parent_->storageOwner() : this;
+    }
+
+    // Alpha class of row 'y'. Writes only reset the row to Unknown; the row is scanned here
+    // on first request and the result is cached until the next write. Mixed when 'y' is outside.
+    // Sub views (see csMatrixSubView) scan every time: the parent may be written directly.
+    [[nodiscard]] csRowAlpha rowAlpha(tMatrixPixelsCoord y) const noexcept {
+        if (y < 0 || y >= to_coord(size_y_) || !pixels_) {
+            return csRowAlpha::Mixed;
+        }
+        if (parent_ || rowAlpha_[y] == static_cast<uint8_t>(csRowAlpha::Unknown)) {
+            // Merge run classes: any Mixed run, or Opaque next to Transparent, gives Mixed.
+            csRowAlpha cls = csRowAlpha::Unknown;
+            forEachRowSpan(0, y, size_x_, [&](size_t start, tMatrixPixelsSize /*skip*/, tMatrixPixelsSize len) {
+                const csRowAlpha run = classifyRow(pixels_ + start, len);
+                cls = (cls == csRowAlpha::Unknown || cls == run) ? run : csRowAlpha::Mixed;
+            });
+            rowAlpha_[y] = static_cast<uint8_t>(cls);
+        }
+        return static_cast<csRowAlpha>(rowAlpha_[y]);
+    }
+
+    // Alpha class of 'n' straight-alpha colors (Opaque / Transparent / Mixed).
+    [[nodiscard]] static csRowAlpha classifyRow(const csColorRGBA* colors, tMatrixPixelsSize n) noexcept {
+        uint8_t alphaAnd = 255;
+        uint32_t valueOr = 0;
+        for (tMatrixPixelsSize i = 0; i < n; ++i) {
+            alphaAnd &= colors[i].a;
+            valueOr |= colors[i].value;
+            if (alphaAnd != 255 && valueOr != 0) {
+                return csRowAlpha::Mixed;
+            }
         }
-        if (secondary_alpha > 0) {
-            setPixel(sx, sy, csColorRGBA{secondary_alpha, color.r, color.g, color.b});
+        if (valueOr == 0) {
+            return csRowAlpha::Transparent;
         }
+        return (alphaAnd == 255) ? csRowAlpha::Opaque : csRowAlpha::Mixed;
     }
 
-    // Blend source color over destination pixels using classical 4-tap bilinear splat.
-    // Integer coordinates are treated as pixel centers, so (10.0, 1.0) affects exactly one pixel.
-    // The source color is distributed to the 4 neighboring pixel centers around floor(x), floor(y).
-    void setPixelFloat4(csFP16 x, csFP16 y, csColorRGBA color) noexcept {
-        // Fast path: exact pixel center.
-        if (x.frac_abs_raw() == 0 && y.frac_abs_raw() == 0) {
-            setPixel(static_cast<tMatrixPixelsCoord>(x.int_trunc()),
-                     static_cast<tMatrixPixelsCoord>(y.int_trunc()),
-                     color);
+    // setPixelsRow() for colors with a known alpha class (e.g. a source matrix row, see rowAlpha()):
+    // - Opaque colors with alpha 255 replace the destination (copied, no blending).
+    // - Transparent colors (or alpha 0) are skipped where SourceOver is an exact no-op: premultiplied
+    //   storage, and Opaque or Transparent destination rows. Straight-alpha SourceOver of a transparent
+    //   source re-quantizes partially transparent pixels (div255 round-trip), so Mixed rows are blended.
+    void setPixelsRowClass(tMatrixPixelsCoord x, tMatrixPixelsCoord y, const csColorRGBA* colors,
+                           tMatrixPixelsSize count, uint8_t alpha, csRowAlpha colorsClass) noexcept {
+        if (colorsClass == csRowAlpha::Transparent || alpha == 0) {
+            if (pixelFormat() == csPixelFormat::ARGB8Premul) {
+                return;
+            }
+            const csRowAlpha dstClass = rowAlpha(y);
+            if (dstClass == csRowAlpha::Opaque || dstClass == csRowAlpha::Transparent) {
+                return;
+            }
+        } else if (colorsClass == csRowAlpha::Opaque && alpha == 255) {
+            // Opaque pixels are stored unchanged in both straight and premultiplied form.
+            tMatrixPixelsSize copied = 0;
+            forEachRowSpan(x, y, count, [&](size_t start, tMatrixPixelsSize skip, tMatrixPixelsSize len) {
+                memcpy(static_cast<void*>(pixels_ + start), colors + skip, static_cast<size_t>(len) * sizeof(csColorRGBA));
+                touchRow(x + to_coord(skip), y, len);
+                copied = to_size(copied + len);
+            });
+            if (copied != 0 && copied == size_x_) {
+                rowAlpha_[y] = static_cast<uint8_t>(csRowAlpha::Opaque);
+            }
             return;
         }
+        setPixelsRow(x, y, colors, count, alpha);
+    }
 
-        // Use floor-based cell origin so fractions are always in [0,1) even for negative coordinates.
-        const tMatrixPixelsCoord x0 = static_cast<tMatrixPixelsCoord>(x.floor_int());
-        const tMatrixPixelsCoord y0 = static_cast<tMatrixPixelsCoord>(y.floor_int());
+    // Blend a row of colors (see csMatrixBase::setPixelsRow) using the row kernel.
+    void setPixelsRow(tMatrixPixelsCoord x, tMatrixPixelsCoord y, const csColorRGBA* colors,
+                      tMatrixPixelsSize count, uint8_t alpha = 255) noexcept override {
+        forEachRowSpan(x, y, count, [&](size_t start, tMatrixPixelsSize skip, tMatrixPixelsSize len) {
+            blendRow(pixels_ + start, colors + skip, len, alpha);
+            touchRow(x + to_coord(skip), y, len);
+        });
+    }
 
-        const csFP16 fx = x - csFP16(x0);
-        const csFP16 fy = y - csFP16(y0);
+    // Blend a row of colors with 'mode' (see csMatrixBase::setPixelsRowMode) using the mode row kernel.
+    void setPixelsRowMode(tMatrixPixelsCoord x, tMatrixPixelsCoord y, const csColorRGBA* colors,
+                          tMatrixPixelsSize count, uint8_t alpha, csBlendMode mode) noexcept override {
+        forEachRowSpan(x, y, count, [&](size_t start, tMatrixPixelsSize skip, tMatrixPixelsSize len) {
+            blendRowMode(pixels_ + start, colors + skip, len, alpha, mode);
+            touchRow(x + to_coord(skip), y, len);
+        });
+    }
 
-        // csFP16 is 12.4, so the fractional part is 0..15 (scale=16).
-        const uint16_t fx_raw = static_cast<uint16_t>(fx.frac_abs_raw());
-        const uint16_t fy_raw = static_cast<uint16_t>(fy.frac_abs_raw());
-        const uint16_t inv_fx = static_cast<uint16_t>(csFP16::scale) - fx_raw; // 16 - fx
-        const uint16_t inv_fy = static_cast<uint16_t>(csFP16::scale) - fy_raw; // 16 - fy
+    // Blend one color over a row (see csMatrixBase::fillPixelsRow) using the fill kernel.
+    // A transparent color is skipped on Opaque and Transparent rows, where SourceOver is an exact no-op.
+    void fillPixelsRow(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize count,
+                       csColorRGBA color) noexcept override {
+        if (color.a == 255) {
+            fillPixelsRowRewrite(x, y, count, color);
+            return;
+        }
+        if (color.a == 0) {
+            const csRowAlpha dstClass = rowAlpha(y);
+            if (dstClass == csRowAlpha::Opaque || dstClass == csRowAlpha::Transparent) {
+                return;
+            }
+        }
+        forEachRowSpan(x, y, count, [&](size_t start, tMatrixPixelsSize skip, tMatrixPixelsSize len) {
+            fillRowBlend(pixels_ + start, len, color);
+            touchRow(x + to_coord(skip), y, len);
+        });
+    }
 
-        // Weights sum to 256 (16*16). Each weight is in [0..256].
-        const uint16_t w00 = static_cast<uint16_t>(inv_fx * inv_fy);
-        const uint16_t w10 = static_cast<uint16_t>(fx_raw * inv_fy);
-        const uint16_t w01 = static_cast<uint16_t>(inv_fx * fy_raw);
-        const uint16_t w11 = static_cast<uint16_t>(fx_raw * fy_raw);
+    // Overwrite a row with one color; a whole row gets its alpha class without a rescan.
+    void fillPixelsRowRewrite(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize count,
+                              csColorRGBA color) noexcept override {
+        fillRowStored(x, y, count, color);
+    }
 
-        auto weight_to_alpha = [&](uint16_t w) noexcept -> uint8_t {
-            // Round to nearest: (a*w)/256
-            return static_cast<uint8_t>((static_cast<uint32_t>(color.a) * static_cast<uint32_t>(w) + 128u) >> 8);
-        };
+    // Row-span access to the pixel buffer (one span per row for RowMajor, per tile row for Tiled8x8).
+    bool getScanLine(csRect area, tMatrixPixelsCoord offset_x, tMatrixPixelsCoord offset_y,
+                     csColorRGBA*& ptrLineOfColors, tMatrixPixelsSize& lineLen) noexcept override {
+        size_t start = 0;
+        if (!scanLineSpan(area, offset_x, offset_y, start, lineLen)) {
+            ptrLineOfColors = nullptr;
+            return false;
+        }
+        ptrLineOfColors = pixels_ + start;
+        // Caller may write through the span.
+        touchRow(area.x + offset_x, area.y + offset_y, lineLen);
+        return true;
+    }
 
-        const uint8_t a00 = weight_to_alpha(w00);
-        const uint8_t a10 = weight_to_alpha(w10);
-        const uint8_t a01 = weight_to_alpha(w01);
-        const uint8_t a11 = weight_to_alpha(w11);
+    bool getScanLine(csRect area, tMatrixPixelsCoord offset_x, tMatrixPixelsCoord offset_y,
+                     const csColorRGBA*& ptrLineOfColors, tMatrixPixelsSize& lineLen) const noexcept override {
+        size_t start = 0;
+        if (!scanLineSpan(area, offset_x, offset_y, start, lineLen)) {
+            ptrLineOfColors = nullptr;
+            return false;
+        }
+        ptrLineOfColors = pixels_ + start;
+        return true;
+    }
 
-        if (a00 > 0) {
-            setPixel(x0, y0, csColorRGBA{a00, color.r, color.g, color.b});
+protected:
+    // Non-owning constructor for views: wraps 'external' (row-major, 'stride' pixels per row).
+    csMatrixPixels(csColorRGBA* external, tMatrixPixelsSize size_x, tMatrixPixelsSize size_y, size_t stride)
+        : size_x_{size_x}, size_y_{size_y}, stride_{(stride > size_x) ? stride : static_cast<size_t>(size_x)},
+          ownsPixels_{false}, pixels_{external}, rowAlpha_(allocateRowAlpha(size_y, csRowAlpha::Unknown)) {}
+
+    // Point a view at another external buffer (content is unknown: row classes reset, all tiles dirty).
+    void attachExternal(csColorRGBA* external, tMatrixPixelsSize size_x, tMatrixPixelsSize size_y, size_t stride) {
+        releasePixels();
+        delete[] rowAlpha_;
+        size_x_ = size_x;
+        size_y_ = size_y;
+        stride_ = (stride > size_x) ? stride : static_cast<size_t>(size_x);
+        layout_ = csMatrixLayout::RowMajor;
+        ownsPixels_ = false;
+        pixels_ = external;
+        parent_ = nullptr;
+        rowAlpha_ = allocateRowAlpha(size_y_, csRowAlpha::Unknown);
+        if (dirty_) {
+            dirty_->resize(size_x_, size_y_);
         }
-        if (a10 > 0) {
-            setPixel(x0 + 1, y0, csColorRGBA{a10, color.r, color.g, color.b});
+    }
+
+    // Resolve span start index and length for getScanLine(); false when the span is empty.
+    [[nodiscard]] bool scanLineSpan(csRect area, tMatrixPixelsCoord offset_x, tMatrixPixelsCoord offset_y,
+                                    size_t& start, tMatrixPixelsSize& lineLen) const noexcept {
+        lineLen = 0;
+        if (offset_x < 0 || offset_y < 0 ||
+            offset_x >= to_coord(area.width) || offset_y >= to_coord(area.height)) {
+            return false;
+        }
+        const tMatrixPixelsCoord x = area.x + offset_x;
+        const tMatrixPixelsCoord y = area.y + offset_y;
+        if (!inside(x, y) || !pixels_) {
+            return false;
         }
-        if (a01 > 0) {
-            setPixel(x0, y0 + 1, csColorRGBA{a01, color.r, color.g, color.b});
+        const tMatrixPixelsCoord end_x =
+            matrix_layout::runEnd(layout_, x, min(area.x + to_coord(area.width), to_coord(size_x_)));
+        start = index(x, y);
+        lineLen = to_size(end_x - x);
+        return true;
+    }
+
+    // Clip row (x, y, count) to matrix bounds and call op(start, skip, len) for each contiguous run:
+    // buffer start index, number of row pixels before the run and run length.
+    // RowMajor gives a single run; Tiled8x8 splits the row at tile boundaries.
+    template <typename SpanOp>
+    void forEachRowSpan(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize count, SpanOp op) const {
+        if (y < 0 || y >= to_coord(size_y_) || !pixels_) {
+            return;
         }
-        if (a11 > 0) {
-            setPixel(x0 + 1, y0 + 1, csColorRGBA{a11, color.r, color.g, color.b});
+        const tMatrixPixelsCoord x1 = min(x + to_coord(count), to_coord(size_x_));
+        tMatrixPixelsCoord x0 = max(x, to_coord(0));
+        while (x0 < x1) {
+            const tMatrixPixelsCoord end = matrix_layout::runEnd(layout_, x0, x1);
+            op(index(x0, y), to_size(x0 - x), to_size(end - x0));
+            x0 = end;
         }
     }
 
-    // Read pixel; returns transparent black when out of bounds.
-    [[nodiscard]] inline csColorRGBA getPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept override {
-        if (inside(x, y)) {
-            return pixels_[index(x, y)];
+    // Store 'stored' (already in storage format) into a row span.
+    void fillRowStored(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize count,
+                       csColorRGBA stored) noexcept {
+        tMatrixPixelsSize filled = 0;
+        forEachRowSpan(x, y, count, [&](size_t start, tMatrixPixelsSize skip, tMatrixPixelsSize len) {
+            fillRow(pixels_ + start, len, stored);
+            touchRow(x + to_coord(skip), y, len);
+            filled = to_size(filled + len);
+        });
+        if (filled != 0 && filled == size_x_) {
+            rowAlpha_[y] = static_cast<uint8_t>(classifyRow(&stored, 1));
         }
-        return csColorRGBA{0, 0, 0, 0};
     }
 
-    // Clear matrix to transparent black.
-    void clear() noexcept {
-        const size_t bytes = count() * sizeof(csColorRGBA);
-        if (bytes != 0 && pixels_) {
-            // Fast zero-fill; csColorRGBA is 4 bytes (see static_assert in color_rgba.hpp).
-            memset(static_cast<void*>(pixels_), 0, bytes);
+    // Pixel (x, y) inside the matrix was changed: reset row alpha class, mark dirty tile.
+    inline void touchPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y) noexcept {
+        rowAlpha_[y] = static_cast<uint8_t>(csRowAlpha::Unknown);
+        if (dirty_) {
+            dirty_->markPixel(x, y);
+        }
+        if (parent_) {
+            parent_->touchPixel(parentX_ + x, parentY_ + y);
         }
     }
 
-    // Resize matrix to new dimensions. Existing pixels are lost (matrix is cleared).
-    void resize(tMatrixPixelsSize sx, tMatrixPixelsSize sy) override {
-        if (sx == size_x_ && sy == size_y_) {
+    // Row span inside the matrix was (or may have been) written.
+    inline void touchRow(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize len) noexcept {
+        rowAlpha_[y] = static_cast<uint8_t>(csRowAlpha::Unknown);
+        if (dirty_) {
+            dirty_->markRow(x, y, len);
+        }
+        if (parent_) {
+            parent_->touchRow(parentX_ + x, parentY_ + y, len);
+        }
+    }
+
+    // Whole view area was written behind touchRow() (clear, copy): forward to the parent.
+    void touchParent() noexcept {
+        if (!parent_) {
             return;
         }
-        delete[] pixels_;
-        // TODO: добавиь проверку на нулевой размер - в таком случае `pixels_ = nullptr`.
-        size_x_ = sx;
-        size_y_ = sy;
-        pixels_ = allocate(size_x_, size_y_);
+        for (tMatrixPixelsSize y = 0; y < size_y_; ++y) {
+            parent_->touchRow(parentX_, parentY_ + to_coord(y), size_x_);
+        }
     }
 
-private:
     tMatrixPixelsSize size_x_;
     tMatrixPixelsSize size_y_;
+    size_t stride_{0};
+    csMatrixLayout layout_{csMatrixLayout::RowMajor};
+    bool ownsPixels_{true};
     csColorRGBA* pixels_{nullptr};
+    mutable uint8_t* rowAlpha_{nullptr}; // csRowAlpha per row; cache filled by rowAlpha() const.
+    csDirtyTiles* dirty_{nullptr};
+    // Sub view: matrix that owns the memory, and position of this view's (0, 0) in it.
+    csMatrixPixels* parent_{nullptr};
+    tMatrixPixelsCoord parentX_{0};
+    tMatrixPixelsCoord parentY_{0};
 
     [[nodiscard]] inline bool inside(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept {
         return x >= 0 && y >= 0 && x < static_cast<tMatrixPixelsCoord>(size_x_) && y < static_cast<tMatrixPixelsCoord>(size_y_);
     }
 
     [[nodiscard]] inline size_t index(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept {
-        return static_cast<size_t>(y) * size_x_ + static_cast<size_t>(x);
+        return matrix_layout::index(layout_, stride_, x, y);
     }
 
-    [[nodiscard]] inline size_t count() const noexcept { return static_cast<size_t>(size_x_) * size_y_; }
+    // Number of buffer elements (includes tile padding for Tiled8x8; width * height for views).
+    [[nodiscard]] inline size_t count() const noexcept { return matrix_layout::storageCount(layout_, size_x_, size_y_); }
 
-    [[nodiscard]] static csColorRGBA* allocate(uint16_t sx, uint16_t sy) {
-        const size_t n = static_cast<size_t>(sx) * static_cast<size_t>(sy);
-        csColorRGBA* buf = n ? new csColorRGBA[n] : nullptr;
-        for (size_t i = 0; i < n; ++i) {
-            buf[i] = csColorRGBA{0, 0, 0, 0};
+    // Buffer holds exactly count() elements with no gaps between rows.
+    [[nodiscard]] inline bool contiguous() const noexcept { return stride_ == size_x_; }
+
+    void releasePixels() noexcept {
+        if (ownsPixels_) {
+            matrix_buffer::release(pixels_, count() * sizeof(csColorRGBA));
+        }
+        pixels_ = nullptr;
+    }
+
+    // Copy pixels of the area both matrices share (whole buffer when layouts and strides match).
+    void copyContent(const csMatrixPixels& other) noexcept {
+        if (!pixels_ || !other.pixels_) {
+            return;
+        }
+        if (layout_ == other.layout_ && size_x_ == other.size_x_ && size_y_ == other.size_y_ &&
+            contiguous() && other.contiguous()) {
+            copyPixels(pixels_, other.pixels_, count());
+            return;
+        }
+        const tMatrixPixelsSize w = min(size_x_, other.size_x_);
+        const tMatrixPixelsSize h = min(size_y_, other.size_y_);
+        for (tMatrixPixelsSize y = 0; y < h; ++y) {
+            forEachRowSpan(0, to_coord(y), w, [&](size_t start, tMatrixPixelsSize skip, tMatrixPixelsSize len) {
+                for (tMatrixPixelsSize i = 0; i < len; ++i) {
+                    pixels_[start + i] = other.pixels_[other.index(to_coord(skip + i), to_coord(y))];
+                }
+            });
+        }
+    }
+
+    // Zero-filled (transparent black) storage from the matrix buffer allocator; nullptr when empty.
+    [[nodiscard]] static csColorRGBA* allocate(csMatrixLayout layout, uint16_t sx, uint16_t sy) {
+        const size_t n = matrix_layout::storageCount(layout, sx, sy);
+        return static_cast<csColorRGBA*>(matrix_buffer::allocate(n * sizeof(csColorRGBA)));
+    }
+
+    // Row classes: Transparent for a freshly allocated matrix, Unknown for external memory.
+    [[nodiscard]] static uint8_t* allocateRowAlpha(uint16_t sy, csRowAlpha initial) {
+        uint8_t* rows = sy ? new uint8_t[sy] : nullptr;
+        for (uint16_t y = 0; y < sy; ++y) {
+            rows[y] = static_cast<uint8_t>(initial);
+        }
+        return rows;
+    }
+
+    // Views (external storage or a parent) may be written around their cache: rows start Unknown.
+    void copyRowAlpha(const csMatrixPixels& other) noexcept {
+        const bool same = (size_x_ == other.size_x_ && size_y_ == other.size_y_) && other.ownsPixels_ &&
+                          !other.parent_;
+        for (tMatrixPixelsSize y = 0; y < size_y_; ++y) {
+            rowAlpha_[y] = same ? other.rowAlpha_[y] : static_cast<uint8_t>(csRowAlpha::Unknown);
         }
-        return buf;
     }
 
     static void copyPixels(csColorRGBA* dst, const csColorRGBA* src, size_t n) {
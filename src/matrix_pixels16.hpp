@@ -0,0 +1,286 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "blend_row.hpp"
+#include "color_rgba.hpp"
+#include "matrix_base.hpp"
+#include "matrix_buffer_pool.hpp"
+#include "matrix_pixels.hpp"
+#include "matrix_types.hpp"
+#include "rect.hpp"
+#include "math.hpp"
+
+namespace amp {
+
+using ::size_t;
+using ::uint8_t;
+using ::uint16_t;
+
+// Accumulation matrix: csColorRGBA16 pixels, premultiplied alpha in unorm16 (65535 = 1.0).
+// Deep layer stacks (snowfall plus glow, slow-fading trails) composite here without rounding each
+// layer to 8 bits; quantizeTo() converts the result to a csMatrixPixels once, at frame end.
+//
+// - The public interface stays straight-alpha 8-bit: getPixel() quantizes one pixel,
+//   setPixel()/setPixelRewrite() take straight colors (SourceOver in 16 bits).
+// - addPixel()/addPixelsRow() blend additively (saturating), for light-like layers.
+// - fade() scales the whole matrix; repeated fades reach zero without the 8-bit banding.
+// - 8 bytes per pixel; no csColorRGBA spans: getScanLine() returns false, use getScanLine16().
+//   matrix_utils reads rows through getPixelsRow() (quantized).
+class csMatrixPixels16 : public csMatrixBase {
+public:
+    // Construct matrix with given size, all pixels transparent black.
+    csMatrixPixels16(tMatrixPixelsSize width, tMatrixPixelsSize height)
+        : width_{width}, height_{height}, pixels_(allocate(width, height)) {}
+
+    // Copy constructor: deep copy of the pixel buffer.
+    csMatrixPixels16(const csMatrixPixels16& other)
+        : width_{other.width_}, height_{other.height_}, pixels_(allocate(width_, height_)) {
+        copyStorage(other);
+    }
+
+    // Move constructor: transfers ownership of buffer, leaving source empty.
+    csMatrixPixels16(csMatrixPixels16&& other) noexcept
+        : width_{other.width_}, height_{other.height_}, pixels_{other.pixels_} {
+        other.pixels_ = nullptr;
+        other.width_ = 0;
+        other.height_ = 0;
+    }
+
+    csMatrixPixels16& operator=(const csMatrixPixels16& other) {
+        if (this != &other) {
+            resize(other.width_, other.height_);
+            copyStorage(other);
+        }
+        return *this;
+    }
+
+    csMatrixPixels16& operator=(csMatrixPixels16&& other) noexcept {
+        if (this != &other) {
+            releasePixels();
+            width_ = other.width_;
+            height_ = other.height_;
+            pixels_ = other.pixels_;
+            other.pixels_ = nullptr;
+            other.width_ = 0;
+            other.height_ = 0;
+        }
+        return *this;
+    }
+
+    virtual ~csMatrixPixels16() { releasePixels(); }
+
+    [[nodiscard]] tMatrixPixelsSize width() const noexcept override { return width_; }
+    [[nodiscard]] tMatrixPixelsSize height() const noexcept override { return height_; }
+
+    [[nodiscard]] csPixelFormat pixelFormat() const noexcept override { return csPixelFormat::ARGB16Premul; }
+
+    // Read pixel quantized to straight-alpha 8-bit; transparent black when out of bounds.
+    [[nodiscard]] csColorRGBA getPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept override {
+        if (inside(x, y)) {
+            return pixels_[index(x, y)].toColor8Straight();
+        }
+        return csColorRGBA{0, 0, 0, 0};
+    }
+
+    // Overwrite pixel with straight-alpha color (stored premultiplied).
+    void setPixelRewrite(tMatrixPixelsCoord x, tMatrixPixelsCoord y, csColorRGBA color) noexcept override {
+        if (inside(x, y)) {
+            pixels_[index(x, y)] = csColorRGBA16::fromColor8Premul(color);
+        }
+    }
+
+    // Blend straight-alpha color over destination pixel (premultiplied SourceOver in 16 bits).
+    void setPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y, csColorRGBA color) noexcept override {
+        if (inside(x, y)) {
+            blendRow16(pixels_ + index(x, y), &color, 1);
+        }
+    }
+
+    void setPixelsRow(tMatrixPixelsCoord x, tMatrixPixelsCoord y, const csColorRGBA* colors,
+                      tMatrixPixelsSize count, uint8_t alpha = 255) noexcept override {
+        if (alpha == 0) {
+            return;
+        }
+        forEachRowSpan(x, y, count, [&](csColorRGBA16* row, tMatrixPixelsSize skip, tMatrixPixelsSize len) {
+            blendRow16(row, colors + skip, len, alpha);
+        });
+    }
+
+    // Blend straight-alpha color over a row; the premultiplied color is computed once.
+    void fillPixelsRow(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize count,
+                       csColorRGBA color) noexcept override {
+        if (color.a == 0) {
+            // Premultiplied SourceOver of transparent black is an exact no-op.
+            return;
+        }
+        const csColorRGBA16 src = csColorRGBA16::fromColor8Premul(color);
+        forEachRowSpan(x, y, count, [&](csColorRGBA16* row, tMatrixPixelsSize /*skip*/, tMatrixPixelsSize len) {
+            fillRow16(row, len, src);
+        });
+    }
+
+    // Overwrite a row with a straight-alpha color (stored premultiplied).
+    void fillPixelsRowRewrite(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize count,
+                              csColorRGBA color) noexcept override {
+        const csColorRGBA16 src = csColorRGBA16::fromColor8Premul(color);
+        forEachRowSpan(x, y, count, [&](csColorRGBA16* row, tMatrixPixelsSize /*skip*/, tMatrixPixelsSize len) {
+            for (tMatrixPixelsSize i = 0; i < len; ++i) {
+                row[i] = src;
+            }
+        });
+    }
+
+    // Add straight-alpha color to pixel (premultiplied, saturating; see addRow16).
+    void addPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y, csColorRGBA color) noexcept {
+        if (inside(x, y)) {
+            addRow16(pixels_ + index(x, y), &color, 1);
+        }
+    }
+
+    // Additive counterpart of setPixelsRow(): each source alpha is scaled by 'alpha'.
+    void addPixelsRow(tMatrixPixelsCoord x, tMatrixPixelsCoord y, const csColorRGBA* colors,
+                      tMatrixPixelsSize count, uint8_t alpha = 255) noexcept {
+        if (alpha == 0) {
+            return;
+        }
+        forEachRowSpan(x, y, count, [&](csColorRGBA16* row, tMatrixPixelsSize skip, tMatrixPixelsSize len) {
+            addRow16(row, colors + skip, len, alpha);
+        });
+    }
+
+    // Scale all pixels by fadeMul / 255 (see fadeRow16); 255 keeps the matrix unchanged.
+    void fade(uint8_t fadeMul) noexcept {
+        if (fadeMul != 255 && pixels_) {
+            fadeRow16(pixels_, count(), fadeMul);
+        }
+    }
+
+    // Raw premultiplied pixel; transparent black when out of bounds.
+    [[nodiscard]] csColorRGBA16 getPixel16(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept {
+        if (inside(x, y)) {
+            return pixels_[index(x, y)];
+        }
+        return csColorRGBA16{};
+    }
+
+    // Quantize 'n' pixels of row 'y' starting at 'x' into 'out'. The run must be inside the matrix.
+    void getPixelsRow(tMatrixPixelsCoord x, tMatrixPixelsCoord y, csColorRGBA* out, tMatrixPixelsSize n) const noexcept {
+        quantizeRow16(out, pixels_ + index(x, y), n);
+    }
+
+    // Row-span access to the 16-bit storage (same semantics as csMatrixBase::getScanLine).
+    bool getScanLine16(csRect area, tMatrixPixelsCoord offset_x, tMatrixPixelsCoord offset_y,
+                       csColorRGBA16*& ptrLineOfColors, tMatrixPixelsSize& lineLen) noexcept {
+        const csColorRGBA16* line = nullptr;
+        const bool ok = static_cast<const csMatrixPixels16*>(this)->getScanLine16(area, offset_x, offset_y, line, lineLen);
+        ptrLineOfColors = const_cast<csColorRGBA16*>(line);
+        return ok;
+    }
+
+    bool getScanLine16(csRect area, tMatrixPixelsCoord offset_x, tMatrixPixelsCoord offset_y,
+                       const csColorRGBA16*& ptrLineOfColors, tMatrixPixelsSize& lineLen) const noexcept {
+        ptrLineOfColors = nullptr;
+        lineLen = 0;
+        if (offset_x < 0 || offset_y < 0 ||
+            offset_x >= to_coord(area.width) || offset_y >= to_coord(area.height)) {
+            return false;
+        }
+        const tMatrixPixelsCoord x = area.x + offset_x;
+        const tMatrixPixelsCoord y = area.y + offset_y;
+        if (!inside(x, y) || !pixels_) {
+            return false;
+        }
+        ptrLineOfColors = pixels_ + index(x, y);
+        lineLen = to_size(math::min(area.x + to_coord(area.width), to_coord(width_)) - x);
+        return true;
+    }
+
+    // Frame end: quantize the accumulated image into 'dst' (resized to match), one pass per row.
+    void quantizeTo(csMatrixPixels& dst) const {
+        dst.resize(width_, height_);
+        const csRect area = getRect();
+        for (tMatrixPixelsCoord y = 0; y < to_coord(height_); ++y) {
+            tMatrixPixelsCoord x = 0;
+            csColorRGBA* out = nullptr;
+            tMatrixPixelsSize len = 0;
+            while (x < to_coord(width_) && dst.getScanLine(area, x, y, out, len)) {
+                quantizeRow16(out, pixels_ + index(x, y), len);
+                x += to_coord(len);
+            }
+            for (; x < to_coord(width_); ++x) {
+                dst.setPixelRewrite(x, y, pixels_[index(x, y)].toColor8Straight());
+            }
+        }
+    }
+
+    // Set all pixels to transparent black.
+    void clear() noexcept {
+        if (pixels_) {
+            memset(static_cast<void*>(pixels_), 0, count() * sizeof(csColorRGBA16));
+        }
+    }
+
+    // Resize matrix to new dimensions. Existing pixels are lost (matrix is cleared).
+    void resize(tMatrixPixelsSize w, tMatrixPixelsSize h) override {
+        if (w == width_ && h == height_) {
+            return;
+        }
+        releasePixels();
+        width_ = w;
+        height_ = h;
+        pixels_ = allocate(width_, height_);
+    }
+
+    // Raw storage (row-major, width() pixels per row).
+    [[nodiscard]] csColorRGBA16* data() noexcept { return pixels_; }
+    [[nodiscard]] const csColorRGBA16* data() const noexcept { return pixels_; }
+
+private:
+    tMatrixPixelsSize width_;
+    tMatrixPixelsSize height_;
+    csColorRGBA16* pixels_{nullptr};
+
+    [[nodiscard]] inline bool inside(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept {
+        return x >= 0 && y >= 0 && x < static_cast<tMatrixPixelsCoord>(width_) && y < static_cast<tMatrixPixelsCoord>(height_);
+    }
+
+    [[nodiscard]] inline size_t index(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept {
+        return static_cast<size_t>(y) * width_ + static_cast<size_t>(x);
+    }
+
+    [[nodiscard]] inline size_t count() const noexcept { return static_cast<size_t>(width_) * height_; }
+
+    // Clip row (x, y, count) to matrix bounds and call op(row, skip, len) for the run inside:
+    // storage of the run, number of row pixels before the run and run length.
+    template <typename SpanOp>
+    void forEachRowSpan(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize count, SpanOp op) noexcept {
+        if (y < 0 || y >= to_coord(height_) || !pixels_) {
+            return;
+        }
+        const tMatrixPixelsCoord x1 = math::min(x + to_coord(count), to_coord(width_));
+        const tMatrixPixelsCoord x0 = math::max(x, to_coord(0));
+        if (x0 < x1) {
+            op(pixels_ + index(x0, y), to_size(x0 - x), to_size(x1 - x0));
+        }
+    }
+
+    void releasePixels() noexcept {
+        matrix_buffer::release(pixels_, count() * sizeof(csColorRGBA16));
+        pixels_ = nullptr;
+    }
+
+    void copyStorage(const csMatrixPixels16& other) noexcept {
+        if (pixels_ && other.pixels_) {
+            memcpy(static_cast<void*>(pixels_), other.pixels_, count() * sizeof(csColorRGBA16));
+        }
+    }
+
+    // Zero-filled (transparent black) storage from the matrix buffer allocator; nullptr when empty.
+    [[nodiscard]] static csColorRGBA16* allocate(tMatrixPixelsSize w, tMatrixPixelsSize h) {
+        return static_cast<csColorRGBA16*>(matrix_buffer::allocate(static_cast<size_t>(w) * h * sizeof(csColorRGBA16)));
+    }
+};
+
+} // namespace amp
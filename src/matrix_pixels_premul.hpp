@@ -0,0 +1,210 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "blend_row.hpp"
+#include "color_rgba.hpp"
+#include "matrix_pixels.hpp"
+#include "matrix_types.hpp"
+#include "rect.hpp"
+
+namespace amp {
+
+// RGBA pixel matrix that stores premultiplied alpha (channels already scaled by alpha).
+// SourceOver is one multiply-add per channel (see csColorRGBA::sourceOverPremul), no division.
+//
+// The public interface stays straight-alpha: getPixel() converts back (fromPremul) and
+// setPixel()/setPixelRewrite() take straight colors. Round-trip is exact for A=255 and lossy
+// for low alpha values, so use this matrix as a compositing target, not as data storage.
+//
+// getScanLine() returns false (spans would be premultiplied); use getScanLinePremul() for raw rows.
+class csMatrixPixelsPremul : public csMatrixPixels {
+public:
+    csMatrixPixelsPremul(tMatrixPixelsSize size_x, tMatrixPixelsSize size_y,
+                         csMatrixLayout layout = csMatrixLayout::RowMajor)
+        : csMatrixPixels(size_x, size_y, layout) {}
+
+    [[nodiscard]] csPixelFormat pixelFormat() const noexcept override { return csPixelFormat::ARGB8Premul; }
+
+    // Read pixel as straight alpha; returns transparent black when out of bounds.
+    [[nodiscard]] csColorRGBA getPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept override {
+        if (inside(x, y)) {
+            return pixels_[index(x, y)].fromPremul();
+        }
+        return csColorRGBA{0, 0, 0, 0};
+    }
+
+    // Overwrite pixel with straight-alpha color (stored premultiplied).
+    void setPixelRewrite(tMatrixPixelsCoord x, tMatrixPixelsCoord y, csColorRGBA color) noexcept override {
+        if (inside(x, y)) {
+            csColorRGBA& dst = pixels_[index(x, y)];
+            const csColorRGBA out = color.toPremul();
+            if (dst.value != out.value) {
+                touchPixel(x, y);
+                dst = out;
+            }
+        }
+    }
+
+    // Blend straight-alpha color over destination pixel (premultiplied SourceOver).
+    void setPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y, csColorRGBA color) noexcept override {
+        if (inside(x, y)) {
+            csColorRGBA& dst = pixels_[index(x, y)];
+            const csColorRGBA out = csColorRGBA::sourceOverPremul(dst, color.toPremul());
+            if (dst.value != out.value) {
+                touchPixel(x, y);
+                dst = out;
+            }
+        }
+    }
+
+    void setPixelsRow(tMatrixPixelsCoord x, tMatrixPixelsCoord y, const csColorRGBA* colors,
+                      tMatrixPixelsSize count, uint8_t alpha = 255) noexcept override {
+        forEachRowSpan(x, y, count, [&](size_t start, tMatrixPixelsSize skip, tMatrixPixelsSize len) {
+            blendRowPremul(pixels_ + start, colors + skip, len, alpha);
+            touchRow(x + to_coord(skip), y, len);
+        });
+    }
+
+    // Blend a row with 'mode' (see csMatrixBase::setPixelsRowMode). The mode row kernels are
+    // straight-alpha, so each span pixel is mixed in straight form and blended premultiplied:
+    // same result as csMatrixBase::setPixelMode() per pixel.
+    void setPixelsRowMode(tMatrixPixelsCoord x, tMatrixPixelsCoord y, const csColorRGBA* colors,
+                          tMatrixPixelsSize count, uint8_t alpha, csBlendMode mode) noexcept override {
+        if (mode == csBlendMode::SourceOver) {
+            setPixelsRow(x, y, colors, count, alpha);
+            return;
+        }
+        forEachRowSpan(x, y, count, [&](size_t start, tMatrixPixelsSize skip, tMatrixPixelsSize len) {
+            csColorRGBA* dst = pixels_ + start;
+            const csColorRGBA* src = colors + skip;
+            for (tMatrixPixelsSize i = 0; i < len; ++i) {
+                const csColorRGBA mixed = csColorRGBA::mixBlendMode(dst[i].fromPremul(), src[i].alpha(alpha), mode);
+                dst[i] = csColorRGBA::sourceOverPremul(dst[i], mixed.toPremul());
+            }
+            touchRow(x + to_coord(skip), y, len);
+        });
+    }
+
+    // Blend straight-alpha color over a row; the premultiplied color is computed once.
+    void fillPixelsRow(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize count,
+                       csColorRGBA color) noexcept override {
+        const csColorRGBA src = color.toPremul();
+        if (src.value == 0) {
+            // Premultiplied SourceOver of transparent black is an exact no-op.
+            return;
+        }
+        if (src.a == 255) {
+            fillRowStored(x, y, count, src);
+            return;
+        }
+        forEachRowSpan(x, y, count, [&](size_t start, tMatrixPixelsSize skip, tMatrixPixelsSize len) {
+            fillRowPremul(pixels_ + start, len, src);
+            touchRow(x + to_coord(skip), y, len);
+        });
+    }
+
+    // Overwrite a row with a straight-alpha color (stored premultiplied).
+    void fillPixelsRowRewrite(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize count,
+                              csColorRGBA color) noexcept override {
+        fillRowStored(x, y, count, color.toPremul());
+    }
+
+    // Straight-alpha spans are not available.
+    bool getScanLine(csRect /*area*/, tMatrixPixelsCoord /*offset_x*/, tMatrixPixelsCoord /*offset_y*/,
+                     csColorRGBA*& ptrLineOfColors, tMatrixPixelsSize& lineLen) noexcept override {
+        ptrLineOfColors = nullptr;
+        lineLen = 0;
+        return false;
+    }
+
+    bool getScanLine(csRect /*area*/, tMatrixPixelsCoord /*offset_x*/, tMatrixPixelsCoord /*offset_y*/,
+                     const csColorRGBA*& ptrLineOfColors, tMatrixPixelsSize& lineLen) const noexcept override {
+        ptrLineOfColors = nullptr;
+        lineLen = 0;
+        return false;
+    }
+
+    // Row-span access to premultiplied storage (same semantics as csMatrixBase::getScanLine).
+    bool getScanLinePremul(csRect area, tMatrixPixelsCoord offset_x, tMatrixPixelsCoord offset_y,
+                           csColorRGBA*& ptrLineOfColors, tMatrixPixelsSize& lineLen) noexcept {
+        size_t start = 0;
+        if (!scanLineSpan(area, offset_x, offset_y, start, lineLen)) {
+            ptrLineOfColors = nullptr;
+            return false;
+        }
+        ptrLineOfColors = pixels_ + start;
+        // Caller may write through the span.
+        touchRow(area.x + offset_x, area.y + offset_y, lineLen);
+        return true;
+    }
+
+    bool getScanLinePremul(csRect area, tMatrixPixelsCoord offset_x, tMatrixPixelsCoord offset_y,
+                           const csColorRGBA*& ptrLineOfColors, tMatrixPixelsSize& lineLen) const noexcept {
+        size_t start = 0;
+        if (!scanLineSpan(area, offset_x, offset_y, start, lineLen)) {
+            ptrLineOfColors = nullptr;
+            return false;
+        }
+        ptrLineOfColors = pixels_ + start;
+        return true;
+    }
+
+    // Raw premultiplied pixel; transparent black when out of bounds.
+    [[nodiscard]] inline csColorRGBA getPixelPremul(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept {
+        if (inside(x, y)) {
+            return pixels_[index(x, y)];
+        }
+        return csColorRGBA{0, 0, 0, 0};
+    }
+
+    // Load from straight-alpha matrix (resizes to match). Layouts may differ: spans are walked per run.
+    void copyFrom(const csMatrixPixels& src) {
+        resize(src.width(), src.height());
+        const csRect area = getRect();
+        for (tMatrixPixelsCoord y = 0; y < to_coord(area.height); ++y) {
+            tMatrixPixelsCoord x = 0;
+            csColorRGBA* out = nullptr;
+            tMatrixPixelsSize len = 0;
+            while (getScanLinePremul(area, x, y, out, len)) {
+                const csColorRGBA* in = nullptr;
+                tMatrixPixelsSize inLen = 0;
+                if (src.getScanLine(area, x, y, in, inLen)) {
+                    len = min(len, inLen);
+                    premultiplyRow(out, in, len);
+                } else {
+                    for (tMatrixPixelsSize i = 0; i < len; ++i) {
+                        out[i] = src.getPixel(x + to_coord(i), y).toPremul();
+                    }
+                }
+                x += to_coord(len);
+            }
+        }
+    }
+
+    // Store into straight-alpha matrix (resizes 'dst' to match). Layouts may differ: spans are walked per run.
+    void copyTo(csMatrixPixels& dst) const {
+        dst.resize(width(), height());
+        const csRect area = getRect();
+        for (tMatrixPixelsCoord y = 0; y < to_coord(area.height); ++y) {
+            tMatrixPixelsCoord x = 0;
+            const csColorRGBA* in = nullptr;
+            tMatrixPixelsSize len = 0;
+            while (getScanLinePremul(area, x, y, in, len)) {
+                csColorRGBA* out = nullptr;
+                tMatrixPixelsSize outLen = 0;
+                if (dst.getScanLine(area, x, y, out, outLen)) {
+                    len = min(len, outLen);
+                    unpremultiplyRow(out, in, len);
+                } else {
+                    for (tMatrixPixelsSize i = 0; i < len; ++i) {
+                        dst.setPixelRewrite(x + to_coord(i), y, in[i].fromPremul());
+                    }
+                }
+                x += to_coord(len);
+            }
+        }
+    }
+};
+
+} // namespace amp
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "blend_row.hpp"
+#include "color_rgba.hpp"
+#include "matrix_base.hpp"
+#include "matrix_buffer_pool.hpp"
+#include "matrix_types.hpp"
+#include "rect.hpp"
+#include "math.hpp"
+
+namespace amp {
+
+using ::size_t;
+using ::uint8_t;
+using ::uint16_t;
+
+// Packed 24-bit RGB pixel (3 bytes, no alpha).
+struct CS_PACKED csColorRGB888 {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+};
+
+static_assert(sizeof(csColorRGB888) == 3, "csColorRGB888 must be tightly packed to 3 bytes");
+
+// Pixel codecs and row conversion kernels for opaque storage formats.
+// Encoding flattens the color onto black (channels scaled by alpha, as the LED output does),
+// decoding always gives a = 255.
+namespace rgb_codec {
+
+// RGB565: 5-6-5 bits, channels rounded to nearest; decode replicates high bits into the low bits,
+// so decode -> encode is lossless and 0 / 255 stay exact.
+struct csRGB565 {
+    using tStorage = uint16_t;
+    static constexpr csPixelFormat cFormat = csPixelFormat::RGB565;
+
+    [[nodiscard]] static inline tStorage encode(csColorRGBA c) noexcept {
+        const uint16_t r = mul8(c.r, c.a);
+        const uint16_t g = mul8(c.g, c.a);
+        const uint16_t b = mul8(c.b, c.a);
+        // round(v * 31 / 255) and round(v * 63 / 255) without division.
+        const uint16_t r5 = static_cast<uint16_t>((r * 249u + 1014u) >> 11);
+        const uint16_t g6 = static_cast<uint16_t>((g * 253u + 505u) >> 10);
+        const uint16_t b5 = static_cast<uint16_t>((b * 249u + 1014u) >> 11);
+        return static_cast<tStorage>((r5 << 11) | (g6 << 5) | b5);
+    }
+
+    [[nodiscard]] static inline csColorRGBA decode(tStorage v) noexcept {
+        const uint8_t r5 = static_cast<uint8_t>(v >> 11);
+        const uint8_t g6 = static_cast<uint8_t>((v >> 5) & 0x3F);
+        const uint8_t b5 = static_cast<uint8_t>(v & 0x1F);
+        return csColorRGBA{255,
+                           static_cast<uint8_t>((r5 << 3) | (r5 >> 2)),
+                           static_cast<uint8_t>((g6 << 2) | (g6 >> 4)),
+                           static_cast<uint8_t>((b5 << 3) | (b5 >> 2))};
+    }
+};
+
+// RGB888: lossless for opaque colors.
+struct csRGB888 {
+    using tStorage = csColorRGB888;
+    static constexpr csPixelFormat cFormat = csPixelFormat::RGB888;
+
+    [[nodiscard]] static inline tStorage encode(csColorRGBA c) noexcept {
+        return tStorage{mul8(c.r, c.a), mul8(c.g, c.a), mul8(c.b, c.a)};
+    }
+
+    [[nodiscard]] static inline csColorRGBA decode(tStorage v) noexcept {
+        return csColorRGBA{255, v.r, v.g, v.b};
+    }
+};
+
+// out[i] = Codec::decode(in[i]) for i in [0, n).
+template <typename Codec>
+inline void decodeRow(csColorRGBA* out, const typename Codec::tStorage* in, size_t n) noexcept {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = Codec::decode(in[i]);
+    }
+}
+
+// out[i] = Codec::encode(in[i]) for i in [0, n).
+template <typename Codec>
+inline void encodeRow(typename Codec::tStorage* out, const csColorRGBA* in, size_t n) noexcept {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = Codec::encode(in[i]);
+    }
+}
+
+} // namespace rgb_codec
+
+// Opaque RGB matrix for layers that never need alpha (plasma, gradients, flame, canvases that are
+// copied as a whole). A 32x32 layer takes 2 KB as RGB565 and 3 KB as RGB888 instead of 4 KB.
+//
+// - Pixels read back opaque (a = 255); out-of-bounds reads give transparent black.
+// - setPixelRewrite() stores the color flattened onto black (channels scaled by alpha).
+// - setPixel() blends over the opaque pixel (SourceOver result is opaque, no division needed).
+// - Row writes (setPixelsRow, fillPixelsRow) decode a chunk, run the RGBA row kernels and encode back,
+//   so they are bit-exact with setPixel(). matrix_utils reads rows through decodeRow().
+// - No csColorRGBA spans: getScanLine() returns false.
+template <typename Codec>
+class csMatrixRGB : public csMatrixBase {
+public:
+    using tStorage = typename Codec::tStorage;
+
+    // Construct matrix with given size, all pixels black.
+    csMatrixRGB(tMatrixPixelsSize width, tMatrixPixelsSize height)
+        : width_{width}, height_{height}, pixels_(allocate(width, height)) {}
+
+    // Copy constructor: deep copy of the pixel buffer.
+    csMatrixRGB(const csMatrixRGB& other)
+        : width_{other.width_}, height_{other.height_}, pixels_(allocate(width_, height_)) {
+        copyStorage(other);
+    }
+
+    // Move constructor: transfers ownership of buffer, leaving source empty.
+    csMatrixRGB(csMatrixRGB&& other) noexcept
+        : width_{other.width_}, height_{other.height_}, pixels_{other.pixels_} {
+        other.pixels_ = nullptr;
+        other.width_ = 0;
+        other.height_ = 0;
+    }
+
+    csMatrixRGB& operator=(const csMatrixRGB& other) {
+        if (this != &other) {
+            resize(other.width_, other.height_);
+            copyStorage(other);
+        }
+        return *this;
+    }
+
+    csMatrixRGB& operator=(csMatrixRGB&& other) noexcept {
+        if (this != &other) {
+            releasePixels();
+            width_ = other.width_;
+            height_ = other.height_;
+            pixels_ = other.pixels_;
+            other.pixels_ = nullptr;
+            other.width_ = 0;
+            other.height_ = 0;
+        }
+        return *this;
+    }
+
+    virtual ~csMatrixRGB() { releasePixels(); }
+
+    [[nodiscard]] tMatrixPixelsSize width() const noexcept override { return width_; }
+    [[nodiscard]] tMatrixPixelsSize height() const noexcept override { return height_; }
+
+    [[nodiscard]] csPixelFormat pixelFormat() const noexcept override { return Codec::cFormat; }
+
+    [[nodiscard]] inline csColorRGBA getPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept override {
+        if (inside(x, y)) {
+            return Codec::decode(pixels_[index(x, y)]);
+        }
+        return csColorRGBA{0, 0, 0, 0};
+    }
+
+    inline void setPixelRewrite(tMatrixPixelsCoord x, tMatrixPixelsCoord y, csColorRGBA color) noexcept override {
+        if (inside(x, y)) {
+            pixels_[index(x, y)] = Codec::encode(color);
+        }
+    }
+
+    void setPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y, csColorRGBA color) noexcept override {
+        // Transparent source over an opaque pixel is an exact no-op.
+        if (color.a == 0 || !inside(x, y)) {
+            return;
+        }
+        tStorage& dst = pixels_[index(x, y)];
+        dst = Codec::encode(csColorRGBA::sourceOverStraight(Codec::decode(dst), color));
+    }
+
+    void setPixelsRow(tMatrixPixelsCoord x, tMatrixPixelsCoord y, const csColorRGBA* colors,
+                      tMatrixPixelsSize count, uint8_t alpha = 255) noexcept override {
+        if (alpha == 0) {
+            return;
+        }
+        forEachChunk(x, y, count, [&](tStorage* row, tMatrixPixelsSize skip, tMatrixPixelsSize len) {
+            csColorRGBA buf[cChunk];
+            rgb_codec::decodeRow<Codec>(buf, row, len);
+            blendRow(buf, colors + skip, len, alpha);
+            rgb_codec::encodeRow<Codec>(row, buf, len);
+        });
+    }
+
+    void fillPixelsRow(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize count,
+                       csColorRGBA color) noexcept override {
+        if (color.a == 0) {
+            return;
+        }
+        if (color.a == 255) {
+            fillPixelsRowRewrite(x, y, count, color);
+            return;
+        }
+        forEachChunk(x, y, count, [&](tStorage* row, tMatrixPixelsSize /*skip*/, tMatrixPixelsSize len) {
+            csColorRGBA buf[cChunk];
+            rgb_codec::decodeRow<Codec>(buf, row, len);
+            fillRowBlend(buf, len, color);
+            rgb_codec::encodeRow<Codec>(row, buf, len);
+        });
+    }
+
+    void fillPixelsRowRewrite(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize count,
+                              csColorRGBA color) noexcept override {
+        const tStorage v = Codec::encode(color);
+        forEachChunk(x, y, count, [&](tStorage* row, tMatrixPixelsSize /*skip*/, tMatrixPixelsSize len) {
+            for (tMatrixPixelsSize i = 0; i < len; ++i) {
+                row[i] = v;
+            }
+        });
+    }
+
+    // Decode 'n' pixels of row 'y' starting at 'x' into 'out'. The run must be inside the matrix.
+    void getPixelsRow(tMatrixPixelsCoord x, tMatrixPixelsCoord y, csColorRGBA* out, tMatrixPixelsSize n) const noexcept {
+        rgb_codec::decodeRow<Codec>(out, pixels_ + index(x, y), n);
+    }
+
+    // Set all pixels to black.
+    void clear() noexcept {
+        if (pixels_) {
+            memset(static_cast<void*>(pixels_), 0, count() * sizeof(tStorage));
+        }
+    }
+
+    // Resize matrix to new dimensions. Existing pixels are lost (matrix is cleared).
+    void resize(tMatrixPixelsSize w, tMatrixPixelsSize h) override {
+        if (w == width_ && h == height_) {
+            return;
+        }
+        releasePixels();
+        width_ = w;
+        height_ = h;
+        pixels_ = allocate(width_, height_);
+    }
+
+    // Raw storage (row-major, width() pixels per row).
+    [[nodiscard]] tStorage* data() noexcept { return pixels_; }
+    [[nodiscard]] const tStorage* data() const noexcept { return pixels_; }
+
+private:
+    // Pixels decoded per step of the row paths (stack buffer).
+    static constexpr tMatrixPixelsSize cChunk = 32;
+
+    tMatrixPixelsSize width_;
+    tMatrixPixelsSize height_;
+    tStorage* pixels_{nullptr};
+
+    [[nodiscard]] inline bool inside(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept {
+        return x >= 0 && y >= 0 && x < static_cast<tMatrixPixelsCoord>(width_) && y < static_cast<tMatrixPixelsCoord>(height_);
+    }
+
+    [[nodiscard]] inline size_t index(tMatrixPixelsCoord x, tMatrixPixelsCoord y) const noexcept {
+        return static_cast<size_t>(y) * width_ + static_cast<size_t>(x);
+    }
+
+    [[nodiscard]] inline size_t count() const noexcept { return static_cast<size_t>(width_) * height_; }
+
+    // Clip row (x, y, count) to matrix bounds and call op(row, skip, len) for runs of at most cChunk
+    // pixels: storage of the run, number of row pixels before the run and run length.
+    template <typename ChunkOp>
+    void forEachChunk(tMatrixPixelsCoord x, tMatrixPixelsCoord y, tMatrixPixelsSize count, ChunkOp op) noexcept {
+        if (y < 0 || y >= to_coord(height_) || !pixels_) {
+            return;
+        }
+        const tMatrixPixelsCoord x1 = math::min(x + to_coord(count), to_coord(width_));
+        tMatrixPixelsCoord x0 = math::max(x, to_coord(0));
+        while (x0 < x1) {
+            const tMatrixPixelsSize len = to_size(math::min(x1 - x0, to_coord(cChunk)));
+            op(pixels_ + index(x0, y), to_size(x0 - x), len);
+            x0 += to_coord(len);
+        }
+    }
+
+    void releasePixels() noexcept {
+        matrix_buffer::release(pixels_, count() * sizeof(tStorage));
+        pixels_ = nullptr;
+    }
+
+    void copyStorage(const csMatrixRGB& other) noexcept {
+        if (pixels_ && other.pixels_) {
+            memcpy(static_cast<void*>(pixels_), other.pixels_, count() * sizeof(tStorage));
+        }
+    }
+
+    // Zero-filled (black) storage from the matrix buffer allocator; nullptr when empty.
+    [[nodiscard]] static tStorage* allocate(tMatrixPixelsSize w, tMatrixPixelsSize h) {
+        return static_cast<tStorage*>(matrix_buffer::allocate(static_cast<size_t>(w) * h * sizeof(tStorage)));
+    }
+};
+
+using csMatrixRGB565 = csMatrixRGB<rgb_codec::csRGB565>;
+using csMatrixRGB888 = csMatrixRGB<rgb_codec::csRGB888>;
+
+} // namespace amp
@@ -3,7 +3,11 @@
 #define MATRIX_SFX_SYSTEM_HPP
 
 #include "matrix_pixels.hpp"
+#include "matrix_pixels_premul.hpp"
+#include "matrix_views.hpp"
 #include "effect_manager.hpp"
+#include "frame_presenter.hpp"
+#include "resolution_governor.hpp"
 #include "rand_gen.hpp"
 #include "matrix_types.hpp"
 #include "render_base.hpp"
@@ -60,10 +64,13 @@ public:
 
     // Construct matrix system with given matrix size.
     // Creates matrix and effect manager via virtual factory methods, and binds matrix to manager.
-    csMatrixSFXSystem(tMatrixPixelsSize width, tMatrixPixelsSize height)
+    // premultiplied: use csMatrixPixelsPremul as internal compositing buffer (faster blending,
+    // output drivers skip the final alpha multiply; see csMatrixPixelsPremul for precision notes).
+    csMatrixSFXSystem(tMatrixPixelsSize width, tMatrixPixelsSize height, bool premultiplied = false)
         : csRenderMatrixBase()  // matrixDest will be nullptr (external matrix not used yet)
         , effectManager(createEffectManager())
-        , randGen(csRandGen::RAND16_SEED) {
+        , randGen(csRandGen::RAND16_SEED)
+        , premultipliedMatrix(premultiplied) {
         // Create internal matrix
         internalMatrix = createMatrix(width, height);
 
@@ -75,6 +82,11 @@ public:
 
     // Virtual destructor: destroys both objects.
     virtual ~csMatrixSFXSystem() {
+        // Sends the frames still in flight before the matrices go away.
+        delete presenter;
+        presenter = nullptr;
+        delete lowResMatrix;
+        lowResMatrix = nullptr;
         if (effectManager) {
             delete effectManager;
             effectManager = nullptr;
@@ -98,24 +110,106 @@ public:
     */
     mutable csRandGen randGen;
 
+    // Internal matrix stores premultiplied alpha (csMatrixPixelsPremul). Used by createMatrix().
+    bool premultipliedMatrix = false;
+
+    // Frame pipeline of recalcAndRender() (see setFrameOutput); nullptr when not used.
+    csFramePresenter* presenter = nullptr;
+
+    // Render resolution of recalcAndRender() (see setFrameBudget).
+    csResolutionGovernor governor;
+    // Scratch of the reduced resolution levels (straight alpha); nullptr at full resolution.
+    csMatrixPixels* lowResMatrix = nullptr;
+
     // Override csEffectBase::recalc - recalc all effects (update internal state, no rendering).
-    void recalc(csRandGen& rand, tTime currTime) override {
+    void recalc(csRandGen& /*rand*/, tTime currTime) override {
         if (effectManager) {
             effectManager->recalc(randGen, currTime);
         }
     }
 
     // Override csEffectBase::render - render all effects and call onFrameDone for post-frame effects.
-    void render(csRandGen& rand, tTime currTime) const override {
+    void render(csRandGen& /*rand*/, tTime currTime) const override {
         if (effectManager) {
             effectManager->render(randGen, currTime);
         }
     }
 
     // Convenience method: recalc and render all effects in one call.
+    // With a frame output (setFrameOutput) the finished frame is then presented to it.
+    // With a frame budget (setFrameBudget) the time of recalc + render drives the governor.
     void recalcAndRender(tTime currTime) {
+        const bool timed = governor.targetFrameUs != 0 || governor.level() != 0;
+        const uint32_t start = timed ? governor.clock() : 0;
+        if (lowResMatrix && internalMatrix &&
+            lowResMatrix->width() != csEffectManager::scaledSize(internalMatrix->width(), governor.divisor())) {
+            applyRenderDivisor(); // the internal matrix was resized
+        }
         recalc(randGen, currTime);
         render(randGen, currTime);
+        if (timed && governor.frameDone(governor.clock() - start)) {
+            applyRenderDivisor();
+        }
+        if (presenter && internalMatrix && effectManager) {
+            presenter->present(*internalMatrix, effectManager->getDirtyRect());
+        }
+    }
+
+    // Output stage of recalcAndRender() (nullptr: render only, the default).
+    // Double / Triple: frames are copied into front buffers made by createMatrix() and sent by a
+    // separate thread, so the next frame is simulated while the previous one is sent (see
+    // csFramePresenter for the buffer handoff). The output must outlive this system or the next call.
+    void setFrameOutput(csFrameOutput* output, csFramePipeline mode = csFramePipeline::Double) {
+        delete presenter;
+        presenter = nullptr;
+        if (!output) {
+            return;
+        }
+        // Front buffers are resized to the frame on the first present().
+        csMatrixPixels* front0 = (mode != csFramePipeline::Sync) ? createMatrix(1, 1) : nullptr;
+        csMatrixPixels* front1 = (mode == csFramePipeline::Triple) ? createMatrix(1, 1) : nullptr;
+        presenter = new csFramePresenter(*output, mode, front0, front1);
+    }
+
+    // Frame time budget of recalcAndRender() in microseconds (0: always full resolution, the default).
+    // Over budget, runs of effect_caps::Scalable effects drawing into the internal matrix with
+    // SourceOver render at 1/2 or 1/4 of the resolution and are upscaled bilinearly; all other
+    // effects always render at full resolution. Thresholds: see csResolutionGovernor.
+    void setFrameBudget(uint32_t frameUs) {
+        governor.targetFrameUs = frameUs;
+        if (frameUs == 0 && governor.level() != 0) {
+            governor.reset();
+            applyRenderDivisor();
+        }
+    }
+
+    // Wait until the output stage has sent every finished frame.
+    void flushFrameOutput() {
+        if (presenter) {
+            presenter->flush();
+        }
+    }
+
+    // Hand the divisor of the governor level (and a scratch of matching size) to the effect manager.
+    void applyRenderDivisor() {
+        if (!effectManager) {
+            return;
+        }
+        const uint8_t d = governor.divisor();
+        if (d <= 1 || !internalMatrix) {
+            effectManager->setRenderDivisor(1, nullptr);
+            delete lowResMatrix;
+            lowResMatrix = nullptr;
+            return;
+        }
+        const tMatrixPixelsSize w = csEffectManager::scaledSize(internalMatrix->width(), d);
+        const tMatrixPixelsSize h = csEffectManager::scaledSize(internalMatrix->height(), d);
+        if (!lowResMatrix) {
+            lowResMatrix = new csMatrixPixels(w, h);
+        } else {
+            lowResMatrix->resize(w, h);
+        }
+        effectManager->setRenderDivisor(d, lowResMatrix);
     }
 
     // Delete current internal matrix. Effect manager reference is not updated (caller should handle this).
@@ -126,9 +220,20 @@ public:
         }
     }
 
+    // Render into 'rect' of 'parent' instead of an own buffer: the internal matrix becomes a
+    // csMatrixSubView of the parent (no scratch matrix, no copy step). Effects are rebound.
+    // The parent must outlive this system (or the next setRegion()/deleteMatrix() call).
+    void setRegion(csMatrixPixels& parent, csRect rect) {
+        deleteMatrix();
+        internalMatrix = new csMatrixSubView(parent, rect);
+        if (effectManager) {
+            effectManager->setMatrix(*internalMatrix);
+        }
+    }
+
     // Set external matrix pointer (base class field 'matrixDest').
     // This sets the external matrix reference, not the internal matrix.
-    void setMatrix(csMatrixPixels* m) {
+    void setMatrix(csMatrixBase* m) {
         matrixDest = m;  // Base class field - external matrix
         propChanged(propMatrixDest);  // Call base class propChanged
     }
@@ -138,6 +243,9 @@ public:
         if (width == 0 || height == 0) {
             return nullptr;
         }
+        if (premultipliedMatrix) {
+            return new csMatrixPixelsPremul(width, height);
+        }
         return new csMatrixPixels(width, height);
     }
 
@@ -1,7 +1,14 @@
 #pragma once
 
+#include <string.h>
+#include "byte_row.hpp"
 #include "color_rgba.hpp"
 #include "matrix_base.hpp"
+#include "matrix_boolean.hpp"
+#include "matrix_bytes.hpp"
+#include "matrix_pixels.hpp"
+#include "matrix_pixels16.hpp"
+#include "matrix_rgb.hpp"
 #include "matrix_types.hpp"
 #include "rand_gen.hpp"
 #include "rect.hpp"
@@ -22,57 +29,203 @@ using math::min;
 /*
 // TODO:
 
-    `void getScanLine(csRect area, offset_x, offset_y, OUT &* ptrLineOfColors, OUT & lineLen)`
-
-    `void fill(csRect area, color)`
-
     // overwrite dst area. fast.
     `bool copyMatrix(dst_x, dst_y, const csMatrixPixels& source)`
 */
 
 
+namespace detail {
+
+// Read up to 'bufLen' straight-alpha colors of row 'y' of 'srcArea', starting at column 'x'.
+// Type-tag dispatch on 'fmt' (RTTI is off): csMatrixPixels returns a direct span, csMatrixBytes,
+// csMatrixBoolean and csMatrixRGB565 / csMatrixRGB888 expand their rows into 'buf', csMatrixPixels16
+// quantizes its rows into 'buf', other matrices use getPixel().
+// 'srcArea' must be clipped to source bounds. Returns number of colors in 'out'.
+inline tMatrixPixelsSize readRow(const csMatrixBase& src, csPixelFormat fmt, csRect srcArea,
+                                 tMatrixPixelsCoord x, tMatrixPixelsCoord y,
+                                 csColorRGBA* buf, tMatrixPixelsSize bufLen, const csColorRGBA*& out) noexcept {
+    const tMatrixPixelsCoord sx = srcArea.x + x;
+    const tMatrixPixelsCoord sy = srcArea.y + y;
+    tMatrixPixelsSize n = to_size(min(to_coord(srcArea.width) - x, to_coord(bufLen)));
+    out = buf;
+    switch (fmt) {
+        case csPixelFormat::ARGB8: {
+            const csMatrixPixels& m = static_cast<const csMatrixPixels&>(src);
+            tMatrixPixelsSize len = 0;
+            if (m.csMatrixPixels::getScanLine(srcArea, x, y, out, len)) {
+                return len;
+            }
+            out = buf;
+            break;
+        }
+        case csPixelFormat::Gray8: {
+            const csMatrixBytes& m = static_cast<const csMatrixBytes&>(src);
+            const uint8_t* line = nullptr;
+            tMatrixPixelsSize len = 0;
+            if (m.getScanLineBytes(srcArea, x, y, line, len)) {
+                n = min(n, len);
+                for (tMatrixPixelsSize i = 0; i < n; ++i) {
+                    const uint8_t v = line[i];
+                    buf[i] = csColorRGBA{255, v, v, v};
+                }
+                return n;
+            }
+            break;
+        }
+        case csPixelFormat::RGB565:
+            static_cast<const csMatrixRGB565&>(src).getPixelsRow(sx, sy, buf, n);
+            return n;
+        case csPixelFormat::RGB888:
+            static_cast<const csMatrixRGB888&>(src).getPixelsRow(sx, sy, buf, n);
+            return n;
+        case csPixelFormat::ARGB16Premul:
+            static_cast<const csMatrixPixels16&>(src).getPixelsRow(sx, sy, buf, n);
+            return n;
+        case csPixelFormat::Mono1: {
+            const csMatrixBoolean& m = static_cast<const csMatrixBoolean&>(src);
+            for (tMatrixPixelsSize i = 0; i < n; ++i) {
+                buf[i] = m.getValue(sx + to_coord(i), sy) ? csColorRGBA{255, 255, 255, 255} : csColorRGBA{0, 0, 0, 0};
+            }
+            return n;
+        }
+        default:
+            break;
+    }
+    for (tMatrixPixelsSize i = 0; i < n; ++i) {
+        buf[i] = src.getPixel(sx + to_coord(i), sy);
+    }
+    return n;
+}
+
+// Blend 'srcArea' of 'src' over the equally sized 'dstArea' of 'dst' (both clipped), row by row.
+// Source rows come from readRow(). csMatrixPixels destinations get the source row alpha class
+// (csMatrixPixels::setPixelsRowClass: opaque rows are copied, transparent rows skipped where exact);
+// other destinations use csMatrixBase::setPixelsRow(). Modes other than SourceOver go through
+// csMatrixBase::setPixelsRowMode() (the row class shortcuts are SourceOver-only).
+inline void blendArea(csMatrixBase& dst, csRect dstArea, const csMatrixBase& src, csRect srcArea,
+                      uint8_t alpha, csBlendMode mode = csBlendMode::SourceOver) noexcept {
+    // Same matrix: rows may overlap, keep the per-pixel order of the original implementation.
+    if (&dst == &src) {
+        for (tMatrixPixelsCoord y = 0; y < to_coord(dstArea.height); ++y) {
+            for (tMatrixPixelsCoord x = 0; x < to_coord(dstArea.width); ++x) {
+                const csColorRGBA pixel = src.getPixel(srcArea.x + x, srcArea.y + y);
+                dst.setPixelMode(dstArea.x + x, dstArea.y + y, pixel.alpha(alpha), mode);
+            }
+        }
+        return;
+    }
+
+    static constexpr tMatrixPixelsSize cGatherChunk = 32;
+    csColorRGBA gather[cGatherChunk];
+    const csPixelFormat srcFormat = src.pixelFormat();
+    const csPixelFormat dstFormat = dst.pixelFormat();
+    csMatrixPixels* dstPixels = (mode == csBlendMode::SourceOver &&
+                                 (dstFormat == csPixelFormat::ARGB8 || dstFormat == csPixelFormat::ARGB8Premul))
+        ? static_cast<csMatrixPixels*>(&dst)
+        : nullptr;
+    // Row classes are kept by csMatrixPixels (readRow() converts premultiplied rows to straight
+    // alpha, which keeps the class); Gray8 and RGB rows always read as opaque.
+    const csMatrixPixels* srcPixels = (srcFormat == csPixelFormat::ARGB8 || srcFormat == csPixelFormat::ARGB8Premul)
+        ? static_cast<const csMatrixPixels*>(&src)
+        : nullptr;
+    const tMatrixPixelsCoord w = to_coord(dstArea.width);
+    const tMatrixPixelsCoord h = to_coord(dstArea.height);
+    for (tMatrixPixelsCoord y = 0; y < h; ++y) {
+        csRowAlpha rowClass = csRowAlpha::Mixed;
+        if (dstPixels) {
+            if (srcPixels) {
+                rowClass = srcPixels->rowAlpha(srcArea.y + y);
+            } else if (srcFormat == csPixelFormat::Gray8 || srcFormat == csPixelFormat::RGB565 ||
+                       srcFormat == csPixelFormat::RGB888) {
+                rowClass = csRowAlpha::Opaque;
+            }
+        }
+        tMatrixPixelsCoord x = 0;
+        while (x < w) {
+            const csColorRGBA* srcLine = nullptr;
+            const tMatrixPixelsSize len = readRow(src, srcFormat, srcArea, x, y, gather, cGatherChunk, srcLine);
+            if (dstPixels) {
+                dstPixels->setPixelsRowClass(dstArea.x + x, dstArea.y + y, srcLine, len, alpha, rowClass);
+            } else {
+                dst.setPixelsRowMode(dstArea.x + x, dstArea.y + y, srcLine, len, alpha, mode);
+            }
+            x += to_coord(len);
+        }
+    }
+}
+
+// Clip a copy of 'srcArea' (already inside source bounds) placed at (dst_x, dst_y) against 'dstBounds'.
+// Returns the destination area; 'srcArea' is adjusted to the matching part. Empty result means nothing to draw.
+inline csRect clipCopyAreas(csRect& srcArea, tMatrixPixelsCoord dst_x, tMatrixPixelsCoord dst_y, csRect dstBounds) noexcept {
+    const csRect dstArea = csRect{dst_x, dst_y, srcArea.width, srcArea.height}.intersect(dstBounds);
+    if (dstArea.empty()) {
+        return dstArea;
+    }
+    srcArea = csRect{srcArea.x + (dstArea.x - dst_x), srcArea.y + (dstArea.y - dst_y), dstArea.width, dstArea.height};
+    return dstArea;
+}
+
+} // namespace detail
+
+
 // Draw another matrix over destination with clipping. Source alpha is respected and additionally scaled by 'alpha'.
+// 'mode' selects the blend mode (see csBlendMode); SourceOver is the plain alpha blend.
 inline void drawMatrix(csMatrixBase& dst, tMatrixPixelsCoord dst_x, tMatrixPixelsCoord dst_y, 
-                       const csMatrixBase& src, uint8_t alpha = 255) noexcept {
-    const tMatrixPixelsCoord start_x = max(to_coord(0), -dst_x);
-    const tMatrixPixelsCoord start_y = max(to_coord(0), -dst_y);
-    const tMatrixPixelsCoord end_x = min(to_coord(src.width()),
-                                         to_coord(dst.width()) - dst_x);
-    const tMatrixPixelsCoord end_y = min(to_coord(src.height()),
-                                         to_coord(dst.height()) - dst_y);
-
-    for (tMatrixPixelsCoord sy = start_y; sy < end_y; ++sy) {
-        const tMatrixPixelsCoord dy = sy + dst_y;
-        for (tMatrixPixelsCoord sx = start_x; sx < end_x; ++sx) {
-            const tMatrixPixelsCoord dx = sx + dst_x;
-            const csColorRGBA pixel = src.getPixel(sx, sy);
-            dst.setPixel(dx, dy, pixel.alpha(alpha));
+                       const csMatrixBase& src, uint8_t alpha = 255,
+                       csBlendMode mode = csBlendMode::SourceOver) noexcept {
+    csRect srcArea = src.getRect();
+    const csRect dstArea = detail::clipCopyAreas(srcArea, dst_x, dst_y, dst.getRect());
+    if (dstArea.empty()) {
+        return;
+    }
+
+    detail::blendArea(dst, dstArea, src, srcArea, alpha, mode);
+}
+
+// Add another matrix to a 16-bit accumulation matrix (additive, saturating; see csMatrixPixels16::addPixelsRow).
+// Source alpha is respected and additionally scaled by 'alpha'. Clipped like drawMatrix().
+inline void addMatrix(csMatrixPixels16& dst, tMatrixPixelsCoord dst_x, tMatrixPixelsCoord dst_y,
+                      const csMatrixBase& src, uint8_t alpha = 255) noexcept {
+    csRect srcArea = src.getRect();
+    const csRect dstArea = detail::clipCopyAreas(srcArea, dst_x, dst_y, dst.getRect());
+    if (dstArea.empty() || &src == &dst) {
+        return;
+    }
+
+    static constexpr tMatrixPixelsSize cGatherChunk = 32;
+    csColorRGBA gather[cGatherChunk];
+    const csPixelFormat srcFormat = src.pixelFormat();
+    for (tMatrixPixelsCoord y = 0; y < to_coord(dstArea.height); ++y) {
+        tMatrixPixelsCoord x = 0;
+        while (x < to_coord(dstArea.width)) {
+            const csColorRGBA* srcLine = nullptr;
+            const tMatrixPixelsSize len = detail::readRow(src, srcFormat, srcArea, x, y, gather, cGatherChunk, srcLine);
+            dst.addPixelsRow(dstArea.x + x, dstArea.y + y, srcLine, len, alpha);
+            x += to_coord(len);
         }
     }
 }
 
 // Draw specific source area to destination coordinates with clipping.
 // 'srcRect' is the area to copy from source matrix, (dst_x, dst_y) is where to draw in destination matrix.
-// Source alpha is respected and additionally scaled by 'alpha'.
+// Source alpha is respected and additionally scaled by 'alpha'; 'mode' as in drawMatrix().
 inline void drawMatrixArea(csMatrixBase& dst, csRect srcRect, tMatrixPixelsCoord dst_x, tMatrixPixelsCoord dst_y,
-                          const csMatrixBase& src, uint8_t alpha = 255) noexcept {
+                          const csMatrixBase& src, uint8_t alpha = 255,
+                          csBlendMode mode = csBlendMode::SourceOver) noexcept {
     // Clip source rectangle to source matrix bounds
     const csRect srcBounds = src.getRect();
-    const csRect srcClipped = srcRect.intersect(srcBounds);
+    csRect srcClipped = srcRect.intersect(srcBounds);
     if (srcClipped.empty()) {
         return;
     }
-    
-    // Copy pixels from source area to destination coordinates
-    for (tMatrixPixelsSize y = 0; y < srcClipped.height; ++y) {
-        for (tMatrixPixelsSize x = 0; x < srcClipped.width; ++x) {
-            const csColorRGBA pixel = src.getPixel(srcClipped.x + static_cast<tMatrixPixelsCoord>(x), 
-                                                   srcClipped.y + static_cast<tMatrixPixelsCoord>(y));
-            dst.setPixel(dst_x + static_cast<tMatrixPixelsCoord>(x),
-                        dst_y + static_cast<tMatrixPixelsCoord>(y),
-                        pixel.alpha(alpha));
-        }
+
+    // Clip against destination bounds (keeps source/destination areas aligned)
+    const csRect dstArea = detail::clipCopyAreas(srcClipped, dst_x, dst_y, dst.getRect());
+    if (dstArea.empty()) {
+        return;
     }
+
+    detail::blendArea(dst, dstArea, src, srcClipped, alpha, mode);
 }
 
 // Draw specific source area to destination coordinates with clipping, overwriting destination pixels.
@@ -82,38 +235,189 @@ inline void drawMatrixAreaRewrite(csMatrixBase& dst, csRect srcRect, tMatrixPixe
                                   const csMatrixBase& src) noexcept {
     // Clip source rectangle to source matrix bounds
     const csRect srcBounds = src.getRect();
-    const csRect srcClipped = srcRect.intersect(srcBounds);
+    csRect srcClipped = srcRect.intersect(srcBounds);
     if (srcClipped.empty()) {
         return;
     }
 
-    // Copy pixels from source area to destination coordinates (overwrite mode)
-    for (tMatrixPixelsSize y = 0; y < srcClipped.height; ++y) {
-        for (tMatrixPixelsSize x = 0; x < srcClipped.width; ++x) {
-            const csColorRGBA pixel = src.getPixel(srcClipped.x + static_cast<tMatrixPixelsCoord>(x),
-                                                   srcClipped.y + static_cast<tMatrixPixelsCoord>(y));
-            dst.setPixelRewrite(dst_x + static_cast<tMatrixPixelsCoord>(x),
-                               dst_y + static_cast<tMatrixPixelsCoord>(y),
-                               pixel);
+    const csRect dstArea = detail::clipCopyAreas(srcClipped, dst_x, dst_y, dst.getRect());
+    if (dstArea.empty()) {
+        return;
+    }
+
+    // Copy pixels from source area to destination coordinates (overwrite mode).
+    // Same matrix: element-wise forward copy keeps the old per-pixel semantics.
+    if (&dst == &src) {
+        for (tMatrixPixelsCoord y = 0; y < to_coord(dstArea.height); ++y) {
+            for (tMatrixPixelsCoord x = 0; x < to_coord(dstArea.width); ++x) {
+                dst.setPixelRewrite(dstArea.x + x, dstArea.y + y, src.getPixel(srcClipped.x + x, srcClipped.y + y));
+            }
+        }
+        return;
+    }
+
+    static constexpr tMatrixPixelsSize cGatherChunk = 32;
+    csColorRGBA gather[cGatherChunk];
+    const csPixelFormat srcFormat = src.pixelFormat();
+    for (tMatrixPixelsCoord y = 0; y < to_coord(dstArea.height); ++y) {
+        tMatrixPixelsCoord x = 0;
+        while (x < to_coord(dstArea.width)) {
+            const csColorRGBA* srcLine = nullptr;
+            tMatrixPixelsSize len = detail::readRow(src, srcFormat, srcClipped, x, y, gather, cGatherChunk, srcLine);
+            csColorRGBA* dstLine = nullptr;
+            tMatrixPixelsSize dstLen = 0;
+            if (dst.getScanLine(dstArea, x, y, dstLine, dstLen)) {
+                len = min(len, dstLen);
+                memcpy(static_cast<void*>(dstLine), srcLine, static_cast<size_t>(len) * sizeof(csColorRGBA));
+            } else {
+                for (tMatrixPixelsSize i = 0; i < len; ++i) {
+                    dst.setPixelRewrite(dstArea.x + x + to_coord(i), dstArea.y + y, srcLine[i]);
+                }
+            }
+            x += to_coord(len);
         }
     }
 }
 
 // Fill rectangular area with color. Area is clipped to matrix bounds.
-inline void fillArea(csMatrixBase& dst, csRect area, csColorRGBA color) noexcept {
+// 'mode' selects the blend mode (see csBlendMode); SourceOver uses the fill kernels.
+inline void fillArea(csMatrixBase& dst, csRect area, csColorRGBA color,
+                     csBlendMode mode = csBlendMode::SourceOver) noexcept {
     const csRect target = area.intersect(dst.getRect());
-    if (target.empty()) {
+    if (mode == csBlendMode::SourceOver) {
+        for (tMatrixPixelsSize y = 0; y < target.height; ++y) {
+            dst.fillPixelsRow(target.x, target.y + to_coord(y), target.width, color);
+        }
         return;
     }
-    const tMatrixPixelsCoord endX = target.x + to_coord(target.width);
-    const tMatrixPixelsCoord endY = target.y + to_coord(target.height);
-    for (tMatrixPixelsCoord y = target.y; y < endY; ++y) {
-        for (tMatrixPixelsCoord x = target.x; x < endX; ++x) {
-            dst.setPixel(x, y, color);
+    static constexpr tMatrixPixelsSize cFillChunk = 32;
+    csColorRGBA chunk[cFillChunk];
+    for (tMatrixPixelsSize i = 0; i < cFillChunk; ++i) {
+        chunk[i] = color;
+    }
+    for (tMatrixPixelsSize y = 0; y < target.height; ++y) {
+        for (tMatrixPixelsSize x = 0; x < target.width; x += cFillChunk) {
+            const tMatrixPixelsSize len = min(cFillChunk, static_cast<tMatrixPixelsSize>(target.width - x));
+            dst.setPixelsRowMode(target.x + to_coord(x), target.y + to_coord(y), chunk, len, 255, mode);
         }
     }
 }
 
+// Overwrite area with a color (no blending). Clipped to destination bounds.
+inline void fillAreaRewrite(csMatrixBase& dst, csRect area, csColorRGBA color) noexcept {
+    const csRect target = area.intersect(dst.getRect());
+    for (tMatrixPixelsSize y = 0; y < target.height; ++y) {
+        dst.fillPixelsRowRewrite(target.x, target.y + to_coord(y), target.width, color);
+    }
+}
+
+namespace detail {
+
+// Run op(rm) on a RowMajor matrix holding the content of 'm' ('m' itself when it is RowMajor;
+// Tiled8x8 content is copied to a temporary and back).
+template <typename Op>
+inline void withRowMajorBytes(csMatrixBytes& m, Op op) {
+    if (m.layout() == csMatrixLayout::RowMajor) {
+        op(m);
+        return;
+    }
+    csMatrixBytes rm(m.width(), m.height());
+    for (tMatrixPixelsCoord y = 0; y < to_coord(m.height()); ++y) {
+        for (tMatrixPixelsCoord x = 0; x < to_coord(m.width()); ++x) {
+            rm.setValue(x, y, m.getValue(x, y));
+        }
+    }
+    op(rm);
+    for (tMatrixPixelsCoord y = 0; y < to_coord(m.height()); ++y) {
+        for (tMatrixPixelsCoord x = 0; x < to_coord(m.width()); ++x) {
+            m.setValue(x, y, rm.getValue(x, y));
+        }
+    }
+}
+
+// Row 'y' of 'src' for vertical kernels: rows outside give 'zeros' (Zero, may be nullptr) or the edge row (Clamp).
+inline const uint8_t* edgeRow(const csMatrixBytes& src, int y, csEdgeMode edge, const uint8_t* zeros) noexcept {
+    const int h = static_cast<int>(src.height());
+    if (y >= 0 && y < h) {
+        return src.row(to_coord(y));
+    }
+    return (edge == csEdgeMode::Zero) ? zeros : src.row(to_coord(y < 0 ? 0 : h - 1));
+}
+
+} // namespace detail
+
+// Horizontal convolution of every row of 'm' in place (odd tap count, see convolveRow()).
+template <size_t K>
+inline void convolveBytesH(csMatrixBytes& m, const csByteKernel<K>& k, csEdgeMode edge = csEdgeMode::Clamp) {
+    detail::withRowMajorBytes(m, [&](csMatrixBytes& rm) {
+        const tMatrixPixelsSize w = rm.width();
+        csMatrixBytes line(w, 1);
+        if (!line.row(0)) {
+            return;
+        }
+        for (tMatrixPixelsCoord y = 0; y < to_coord(rm.height()); ++y) {
+            memcpy(line.row(0), rm.row(y), w);
+            convolveRow<K>(rm.row(y), line.row(0), w, k, edge);
+        }
+    });
+}
+
+// Vertical convolution of every column of 'm' in place (K rows centered on each output row).
+template <size_t K>
+inline void convolveBytesV(csMatrixBytes& m, const csByteKernel<K>& k, csEdgeMode edge = csEdgeMode::Clamp) {
+    static_assert((K % 2) == 1, "convolveBytesV: odd tap count expected");
+    detail::withRowMajorBytes(m, [&](csMatrixBytes& rm) {
+        const tMatrixPixelsSize w = rm.width();
+        const csMatrixBytes src(rm);
+        const csMatrixBytes zeros(w, 1);
+        if (!src.row(0) || !zeros.row(0)) {
+            return;
+        }
+        constexpr int r = static_cast<int>(K / 2);
+        const uint8_t* rows[K];
+        for (int y = 0; y < static_cast<int>(rm.height()); ++y) {
+            for (size_t t = 0; t < K; ++t) {
+                rows[t] = detail::edgeRow(src, y - r + static_cast<int>(t), edge, zeros.row(0));
+            }
+            convolveCols<K>(rm.row(to_coord(y)), rows, w, k);
+        }
+    });
+}
+
+// Separable box blur in place: horizontal running sums (radius 'rx'), then vertical column sums (radius 'ry').
+// Radii are limited to 127; 0 skips the pass.
+inline void boxBlurBytes(csMatrixBytes& m, uint8_t rx, uint8_t ry, csEdgeMode edge = csEdgeMode::Clamp) {
+    detail::withRowMajorBytes(m, [&](csMatrixBytes& rm) {
+        const tMatrixPixelsSize w = rm.width();
+        const int h = static_cast<int>(rm.height());
+        if (w == 0 || h == 0) {
+            return;
+        }
+        if (rx != 0) {
+            csMatrixBytes line(w, 1);
+            for (tMatrixPixelsCoord y = 0; y < to_coord(h); ++y) {
+                memcpy(line.row(0), rm.row(y), w);
+                boxBlurRow(rm.row(y), line.row(0), w, rx, edge);
+            }
+        }
+        if (ry == 0) {
+            return;
+        }
+        const int r = (ry > 127) ? 127 : ry;
+        const csMatrixBytes src(rm);
+        const size_t sumBytes = static_cast<size_t>(w) * sizeof(uint16_t);
+        uint16_t* sums = static_cast<uint16_t*>(matrix_buffer::allocate(sumBytes));
+        for (int i = -r; i <= r; ++i) {
+            boxSumRow(sums, detail::edgeRow(src, i, edge, nullptr), nullptr, w);
+        }
+        for (int y = 0; y < h; ++y) {
+            boxAverageRow(rm.row(to_coord(y)), sums, w, static_cast<uint8_t>(r));
+            boxSumRow(sums, detail::edgeRow(src, y + r + 1, edge, nullptr), detail::edgeRow(src, y - r, edge, nullptr), w);
+        }
+        matrix_buffer::release(sums, sumBytes);
+    });
+}
+
 // Calculate average color of area. Fast.
 // Uses two-level hierarchical averaging to avoid overflow in uint16_t accumulators.
 // Max area: 65536 pixels (256x256). Larger areas return transparent black.
@@ -148,20 +452,31 @@ inline void fillArea(csMatrixBase& dst, csRect area, csColorRGBA color) noexcept
     csColorRGBA16 sum2;
     uint16_t count2 = 0;
 
-    // Iterate through the bounded area using getPixel calls
-    for (tMatrixPixelsSize iy = 0; iy < h; ++iy) {
-        for (tMatrixPixelsSize ix = 0; ix < w; ++ix) {
-            const csColorRGBA pixel = m.getPixel(bounded.x + static_cast<tMatrixPixelsCoord>(ix),
-                                                 bounded.y + static_cast<tMatrixPixelsCoord>(iy));
-            sum1 += pixel.sum(kZero);
-            ++count1;
-
-            if (count1 == kChunk) {
-                sum2 += sum1.div(kChunk);
-                ++count2;
-                sum1 = csColorRGBA16{};
-                count1 = 0;
+    auto accumulate = [&](csColorRGBA pixel) {
+        sum1 += pixel.sum(kZero);
+        ++count1;
+
+        if (count1 == kChunk) {
+            sum2 += sum1.div(kChunk);
+            ++count2;
+            sum1 = csColorRGBA16{};
+            count1 = 0;
+        }
+    };
+
+    // Iterate through the bounded area row by row (spans or typed row expansion, see readRow)
+    static constexpr tMatrixPixelsSize cGatherChunk = 32;
+    csColorRGBA gather[cGatherChunk];
+    const csPixelFormat format = m.pixelFormat();
+    for (tMatrixPixelsCoord iy = 0; iy < to_coord(h); ++iy) {
+        tMatrixPixelsCoord ix = 0;
+        while (ix < to_coord(w)) {
+            const csColorRGBA* line = nullptr;
+            const tMatrixPixelsSize len = detail::readRow(m, format, bounded, ix, iy, gather, cGatherChunk, line);
+            for (tMatrixPixelsSize i = 0; i < len; ++i) {
+                accumulate(line[i]);
             }
+            ix += to_coord(len);
         }
     }
 
@@ -179,8 +494,10 @@ inline void fillArea(csMatrixBase& dst, csRect area, csColorRGBA color) noexcept
 
 // Scale and draw source matrix onto destination matrix using bilinear interpolation.
 // 'srcRect' is the source rectangle in 'src' matrix, 'dstRect' is the destination rectangle in 'dst' matrix.
+// Only the part of dstRect inside 'clipRect' is drawn; the scale still follows the whole dstRect.
 // Returns false if srcRect or dstRect is empty, or if srcRect is out of bounds of source matrix.
-[[nodiscard]] inline bool drawMatrixScale(csMatrixBase& dst, csRect srcRect, csRect dstRect, const csMatrixBase& src) noexcept {
+[[nodiscard]] inline bool drawMatrixScale(csMatrixBase& dst, csRect srcRect, csRect dstRect, const csMatrixBase& src,
+                                          csRect clipRect) noexcept {
     // Validate input rectangles
     if (srcRect.empty() || dstRect.empty()) {
         return false;
@@ -194,7 +511,7 @@ inline void fillArea(csMatrixBase& dst, csRect area, csColorRGBA color) noexcept
     }
 
     // Clip destination rectangle to destination matrix bounds
-    const csRect dstBounded = dstRect.intersect(dst.getRect());
+    const csRect dstBounded = dstRect.intersect(clipRect).intersect(dst.getRect());
     if (dstBounded.empty()) {
         return true; // Nothing to draw, but operation is valid
     }
@@ -204,49 +521,81 @@ inline void fillArea(csMatrixBase& dst, csRect area, csColorRGBA color) noexcept
     const int32_t scale_x_fp = (static_cast<int32_t>(srcRect.width) << 16) / static_cast<int32_t>(dstRect.width);
     const int32_t scale_y_fp = (static_cast<int32_t>(srcRect.height) << 16) / static_cast<int32_t>(dstRect.height);
 
-    // Iterate over each pixel in clipped destination rectangle
+    const tMatrixPixelsCoord dst_x0 = dstBounded.x;
+
+    // Iterate over each row in clipped destination rectangle
     for (tMatrixPixelsSize dy = 0; dy < dstBounded.height; ++dy) {
         const tMatrixPixelsCoord dst_y = dstBounded.y + static_cast<tMatrixPixelsCoord>(dy);
-        
-        for (tMatrixPixelsSize dx = 0; dx < dstBounded.width; ++dx) {
-            const tMatrixPixelsCoord dst_x = dstBounded.x + static_cast<tMatrixPixelsCoord>(dx);
 
-            // Calculate corresponding position in source (fixed-point)
-            // Map from dst coordinates to src coordinates, accounting for offset from dst origin
+        // Calculate corresponding source row (fixed-point), accounting for offset from dst origin
+        const int32_t offset_y = dst_y - dstRect.y;
+        const int32_t src_y_fp = (static_cast<int32_t>(srcRect.y) << 16) + 
+                                 (offset_y * scale_y_fp);
+        const int32_t src_y_int = src_y_fp >> 16;
+        const uint8_t fy = static_cast<uint8_t>((src_y_fp & 0xFFFF) >> 8); // 8-bit fractional part
+
+        // Both source rows as spans (nullptr: row is out of bounds or source has no direct storage)
+        const csColorRGBA* row0 = nullptr;
+        const csColorRGBA* row1 = nullptr;
+        tMatrixPixelsSize len0 = 0;
+        tMatrixPixelsSize len1 = 0;
+        src.getScanLine(sourceBounds, 0, src_y_int, row0, len0);
+        src.getScanLine(sourceBounds, 0, src_y_int + 1, row1, len1);
+
+        // Source pixel fetch: direct span read, otherwise getPixel (out-of-bounds -> transparent black)
+        auto fetch = [&src](const csColorRGBA* row, tMatrixPixelsSize len,
+                            tMatrixPixelsCoord x, tMatrixPixelsCoord y) -> csColorRGBA {
+            if (row != nullptr && x >= 0 && x < to_coord(len)) {
+                return row[x];
+            }
+            return src.getPixel(x, y);
+        };
+
+        // Interpolated source color for destination column 'dst_x'
+        auto sample = [&](tMatrixPixelsCoord dst_x) -> csColorRGBA {
             const int32_t offset_x = dst_x - dstRect.x;
-            const int32_t offset_y = dst_y - dstRect.y;
             const int32_t src_x_fp = (static_cast<int32_t>(srcRect.x) << 16) + 
                                      (offset_x * scale_x_fp);
-            const int32_t src_y_fp = (static_cast<int32_t>(srcRect.y) << 16) + 
-                                     (offset_y * scale_y_fp);
-
-            // Extract integer and fractional parts
             const int32_t src_x_int = src_x_fp >> 16;
-            const int32_t src_y_int = src_y_fp >> 16;
-            const uint8_t fx = static_cast<uint8_t>((src_x_fp & 0xFFFF) >> 8); // 8-bit fractional part
-            const uint8_t fy = static_cast<uint8_t>((src_y_fp & 0xFFFF) >> 8);
+            const uint8_t fx = static_cast<uint8_t>((src_x_fp & 0xFFFF) >> 8);
 
             // Get 4 neighboring pixels for bilinear interpolation
-            const csColorRGBA p00 = src.getPixel(src_x_int, src_y_int);
-            const csColorRGBA p10 = src.getPixel(src_x_int + 1, src_y_int);
-            const csColorRGBA p01 = src.getPixel(src_x_int, src_y_int + 1);
-            const csColorRGBA p11 = src.getPixel(src_x_int + 1, src_y_int + 1);
+            const csColorRGBA p00 = fetch(row0, len0, src_x_int, src_y_int);
+            const csColorRGBA p10 = fetch(row0, len0, src_x_int + 1, src_y_int);
+            const csColorRGBA p01 = fetch(row1, len1, src_x_int, src_y_int + 1);
+            const csColorRGBA p11 = fetch(row1, len1, src_x_int + 1, src_y_int + 1);
 
             // Bilinear interpolation: first interpolate horizontally (top and bottom)
             const csColorRGBA top = lerp(p00, p10, fx);
             const csColorRGBA bottom = lerp(p01, p11, fx);
 
             // Then interpolate vertically
-            const csColorRGBA result = lerp(top, bottom, fy);
-
-            // Draw the interpolated pixel with alpha blending
-            dst.setPixel(dst_x, dst_y, result);
+            return lerp(top, bottom, fy);
+        };
+
+        // Draw the interpolated row with alpha blending
+        const csRect rowArea{dst_x0, dst_y, dstBounded.width, 1};
+        tMatrixPixelsCoord x = 0;
+        csColorRGBA* line = nullptr;
+        tMatrixPixelsSize len = 0;
+        while (x < to_coord(rowArea.width) && dst.getScanLine(rowArea, x, 0, line, len)) {
+            for (tMatrixPixelsSize i = 0; i < len; ++i) {
+                line[i] = csColorRGBA::sourceOverStraight(line[i], sample(dst_x0 + x + to_coord(i)));
+            }
+            x += to_coord(len);
+        }
+        for (; x < to_coord(rowArea.width); ++x) {
+            dst.setPixel(dst_x0 + x, dst_y, sample(dst_x0 + x));
         }
     }
 
     return true;
 }
 
+[[nodiscard]] inline bool drawMatrixScale(csMatrixBase& dst, csRect srcRect, csRect dstRect, const csMatrixBase& src) noexcept {
+    return drawMatrixScale(dst, srcRect, dstRect, src, dst.getRect());
+}
+
 // Compute blended color of matrix pixel over bgColor; does not modify matrix.
 // Out-of-bounds returns bgColor unchanged.
 [[nodiscard]] inline csColorRGBA getPixelBlend(const csMatrixBase& m, tMatrixPixelsCoord x, tMatrixPixelsCoord y, csColorRGBA bgColor) noexcept {
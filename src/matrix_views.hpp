@@ -0,0 +1,183 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "color_rgba.hpp"
+#include "matrix_boolean.hpp"
+#include "matrix_bytes.hpp"
+#include "matrix_pixels.hpp"
+#include "matrix_types.hpp"
+#include "rect.hpp"
+
+namespace amp {
+
+using ::size_t;
+using ::uint8_t;
+
+// Non-owning matrices over caller-owned memory (frame buffers of a display driver, DMA buffers,
+// shared memory, a region of a larger image). Effects render straight into that memory, no copies.
+//
+// - The buffer is row-major; 'stride' is the distance between row starts in elements (pixels,
+//   bytes or bits). 0 or a value below width means "tightly packed". Memory between rows is never
+//   written (clear() included).
+// - The caller keeps the buffer alive for the lifetime of the view and must not resize it.
+// - resize() is ignored: the view size is fixed by the buffer (use attach() to switch buffers).
+// - Copying a view aliases the same memory. Copying a view into an owning matrix
+//   (csMatrixPixels m = view;) makes a deep copy.
+// - The content of the buffer is unknown to the matrix: row alpha classes start as Unknown and
+//   dirty tracking (when enabled) reports every tile on the first commit.
+
+// csMatrixPixels over external csColorRGBA pixels.
+class csMatrixPixelsView : public csMatrixPixels {
+public:
+    csMatrixPixelsView(csColorRGBA* pixels, tMatrixPixelsSize width, tMatrixPixelsSize height, size_t stride = 0)
+        : csMatrixPixels(pixels, width, height, stride) {}
+
+    csMatrixPixelsView(const csMatrixPixelsView& other)
+        : csMatrixPixels(other.pixels_, other.size_x_, other.size_y_, other.stride_) {}
+
+    csMatrixPixelsView& operator=(const csMatrixPixelsView& other) {
+        if (this != &other) {
+            attachExternal(other.pixels_, other.size_x_, other.size_y_, other.stride_);
+        }
+        return *this;
+    }
+
+    // Point the view at another buffer.
+    void attach(csColorRGBA* pixels, tMatrixPixelsSize width, tMatrixPixelsSize height, size_t stride = 0) {
+        attachExternal(pixels, width, height, stride);
+    }
+
+    // External memory was modified behind the matrix (e.g. by DMA): forget cached row classes.
+    void invalidate() noexcept {
+        for (tMatrixPixelsSize y = 0; y < size_y_; ++y) {
+            rowAlpha_[y] = static_cast<uint8_t>(csRowAlpha::Unknown);
+        }
+        if (dirty_) {
+            dirty_->markAll();
+        }
+    }
+
+    // First pixel of the external buffer.
+    [[nodiscard]] csColorRGBA* data() const noexcept { return pixels_; }
+};
+
+// Rectangle of a parent csMatrixPixels presented as a matrix of its own: (0, 0) is rect.x, rect.y
+// of the parent. Pixels are the parent's pixels (origin and stride are resolved once here), so an
+// effect or a nested csMatrixSFXSystem renders into a region of the parent without a scratch matrix
+// and without per-pixel offset math. Writes outside the rectangle are clipped.
+//
+// - Writes through the view invalidate the parent (row alpha classes, dirty tiles).
+// - Row classes of the view are not cached (the parent may be written directly).
+// - The rectangle is clipped to the parent; the parent must outlive the view and must not be
+//   resized while it is viewed.
+// - The view and its parent share storage: do not blit one into the other.
+// - Only straight-alpha RowMajor parents can be viewed (other parents give an empty view):
+//   Tiled8x8 rows are not strided, premultiplied pixels would be read as straight.
+class csMatrixSubView : public csMatrixPixels {
+public:
+    csMatrixSubView(csMatrixPixels& parent, csRect rect)
+        : csMatrixPixels(nullptr, 0, 0, 0) {
+        attach(parent, rect);
+    }
+
+    csMatrixSubView(const csMatrixSubView& other)
+        : csMatrixPixels(other.pixels_, other.size_x_, other.size_y_, other.stride_) {
+        parent_ = other.parent_;
+        parentX_ = other.parentX_;
+        parentY_ = other.parentY_;
+    }
+
+    csMatrixSubView& operator=(const csMatrixSubView& other) {
+        if (this != &other) {
+            attachExternal(other.pixels_, other.size_x_, other.size_y_, other.stride_);
+            parent_ = other.parent_;
+            parentX_ = other.parentX_;
+            parentY_ = other.parentY_;
+        }
+        return *this;
+    }
+
+    // View another rectangle (of the same or another parent).
+    void attach(csMatrixPixels& parent, csRect rect) {
+        const csRect area = rect.intersect(parent.getRect());
+        // Read-only span request: resolving the origin must not invalidate the parent row.
+        const csMatrixPixels& source = parent;
+        const csColorRGBA* origin = nullptr;
+        tMatrixPixelsSize len = 0;
+        if (area.empty() || parent.pixelFormat() != csPixelFormat::ARGB8 ||
+            parent.layout() != csMatrixLayout::RowMajor || !source.getScanLine(area, 0, 0, origin, len)) {
+            attachExternal(nullptr, 0, 0, 0);
+            return;
+        }
+        attachExternal(const_cast<csColorRGBA*>(origin), area.width, area.height, parent.stride());
+        parent_ = &parent;
+        parentX_ = area.x;
+        parentY_ = area.y;
+    }
+
+    // Parent matrix (nullptr for an empty view).
+    [[nodiscard]] csMatrixPixels* parent() const noexcept { return parent_; }
+
+    // Position of this view's (0, 0) in the parent.
+    [[nodiscard]] csRect parentRect() const noexcept {
+        return csRect{parentX_, parentY_, size_x_, size_y_};
+    }
+};
+
+// csMatrixBytes over external uint8_t memory.
+class csMatrixBytesView : public csMatrixBytes {
+public:
+    csMatrixBytesView(uint8_t* bytes, tMatrixPixelsSize width, tMatrixPixelsSize height, size_t stride = 0,
+                      uint8_t defaultOutOfBoundsValue = 0)
+        : csMatrixBytes(bytes, width, height, stride, defaultOutOfBoundsValue) {}
+
+    csMatrixBytesView(const csMatrixBytesView& other)
+        : csMatrixBytes(other.data(), other.width(), other.height(), other.stride(), other.outOfBoundsValue) {}
+
+    csMatrixBytesView& operator=(const csMatrixBytesView& other) {
+        if (this != &other) {
+            attachExternal(other.data(), other.width(), other.height(), other.stride());
+            outOfBoundsValue = other.outOfBoundsValue;
+        }
+        return *this;
+    }
+
+    // Point the view at another buffer.
+    void attach(uint8_t* bytes, tMatrixPixelsSize width, tMatrixPixelsSize height, size_t stride = 0) noexcept {
+        attachExternal(bytes, width, height, stride);
+    }
+
+    // First byte of the external buffer.
+    [[nodiscard]] uint8_t* data() const noexcept { return buffer(); }
+};
+
+// csMatrixBoolean over external bit memory (bit k is (bytes[k / 8] >> (k % 8)) & 1).
+// 'strideBits' lets the view address a sub-area of a larger bit image.
+class csMatrixBooleanView : public csMatrixBoolean {
+public:
+    csMatrixBooleanView(uint8_t* bytes, tMatrixPixelsSize width, tMatrixPixelsSize height, size_t strideBits = 0,
+                        bool defaultOutOfBoundsValue = false)
+        : csMatrixBoolean(bytes, width, height, strideBits, defaultOutOfBoundsValue) {}
+
+    csMatrixBooleanView(const csMatrixBooleanView& other)
+        : csMatrixBoolean(other.data(), other.width(), other.height(), other.stride(), other.outOfBoundsValue) {}
+
+    csMatrixBooleanView& operator=(const csMatrixBooleanView& other) {
+        if (this != &other) {
+            attachExternal(other.data(), other.width(), other.height(), other.stride());
+            outOfBoundsValue = other.outOfBoundsValue;
+        }
+        return *this;
+    }
+
+    // Point the view at another buffer.
+    void attach(uint8_t* bytes, tMatrixPixelsSize width, tMatrixPixelsSize height, size_t strideBits = 0) noexcept {
+        attachExternal(bytes, width, height, strideBits);
+    }
+
+    // First byte of the external buffer.
+    [[nodiscard]] uint8_t* data() const noexcept { return buffer(); }
+};
+
+} // namespace amp
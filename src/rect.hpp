@@ -43,6 +43,23 @@ public:
 
         return csRect{nx, ny, to_size(w), to_size(h)};
     }
+
+    // Return bounding box of two rectangles; an empty rectangle does not contribute.
+    [[nodiscard]] inline csRect unite(const csRect& other) const noexcept {
+        if (empty()) {
+            return other;
+        }
+        if (other.empty()) {
+            return *this;
+        }
+        const auto nx = min(x, other.x);
+        const auto ny = min(y, other.y);
+        const auto rx = max(x + to_coord(width),
+                            other.x + to_coord(other.width));
+        const auto ry = max(y + to_coord(height),
+                            other.y + to_coord(other.height));
+        return csRect{nx, ny, to_size(rx - nx), to_size(ry - ny)};
+    }
 };
 
 
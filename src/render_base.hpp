@@ -36,6 +36,25 @@ struct csEventEmitterLinkToRecv {
     PropType validReceiverClass;
 };
 
+// Capability bits of an effect (csEffectBase::getCapabilities()).
+// csEffectManager reads them once in add()/set() and keeps them next to the effect pointer.
+namespace effect_caps {
+// Family EffectPostFrame: onFrameDone() is called after every frame.
+static constexpr uint8_t PostFrame = 1u << 0;
+// Family EffectMatrixDest: matrixDest is bound to the manager matrix.
+static constexpr uint8_t MatrixDest = 1u << 1;
+// Family EffectPipe: reads a source matrix.
+static constexpr uint8_t Pipe = 1u << 2;
+// Keeps state between frames (buffers, particles, rand): a frame depends on the previous ones.
+static constexpr uint8_t Stateful = 1u << 3;
+// renderBand() may run concurrently for disjoint bands (canRenderBands()).
+static constexpr uint8_t ThreadSafe = 1u << 4;
+// Ignores time: the output changes only with properties or source data.
+static constexpr uint8_t Static = 1u << 5;
+// csRenderMatrixBase::renderScaled() draws the frame at a reduced resolution.
+static constexpr uint8_t Scalable = 1u << 6;
+} // namespace effect_caps
+
 // Base class for all render/effect implementations
 // Contains standard property types without the actual fields - only their property ID.
 // All these properties are disabled by default - derived classes can enable them.
@@ -65,6 +84,7 @@ public:
     static constexpr uint8_t propMatrixSource = base + 12;
     static constexpr uint8_t propRectSource = base + 13;
     static constexpr uint8_t propRewrite = base + 14;
+    static constexpr uint8_t propBlendMode = base + 15;
 
     // `propLast` - Special "property" - the last one in the list. 
     // Shadowed in each derived class.
@@ -74,7 +94,7 @@ public:
     //     static constexpr uint8_t propNew = base+1;
     //     static constexpr uint8_t propLast = propNew;
     // ```
-    static constexpr uint8_t propLast = propRewrite;
+    static constexpr uint8_t propLast = propBlendMode;
 
     // Property introspection: returns number of exposed properties
     // NOTE: property indices start at 1 (not 0).
@@ -148,6 +168,11 @@ public:
                 info.valueType = PropType::Bool;
                 info.name = "Rewrite";
                 break;
+            case propBlendMode:
+                info.valueType = PropType::UInt8;
+                info.name = "Blend mode";
+                info.desc = "0 source-over, 1 add, 2 multiply, 3 screen, 4 max, 5 min";
+                break;
             default:
                 csBase::getPropInfo(propNum, info);
                 break;
@@ -172,6 +197,42 @@ public:
         (void)currTime;
     }
 
+    // Band rendering capability (parallel render mode, see csEffectManager::setThreadPool).
+    // true: renderBand() may run concurrently on several threads for disjoint row ranges, and
+    // rendering all bands gives the same frame as render(). Only stateless per-pixel effects qualify:
+    // no rand, no internal buffers, writes only to rows inside the band.
+    virtual bool canRenderBands() const {
+        return false;
+    }
+
+    // Capability bits (effect_caps). Cached by csEffectManager when the effect is added: they must not
+    // change while the effect is in a manager. Derived classes add bits to the base result.
+    // Default: families from queryClassFamily(); band-capable effects are ThreadSafe. Effects that keep
+    // state between frames add Stateful themselves.
+    virtual uint8_t getCapabilities() {
+        uint8_t caps = canRenderBands() ? effect_caps::ThreadSafe : 0;
+        if (queryClassFamily(PropType::EffectPostFrame)) {
+            caps |= effect_caps::PostFrame;
+        }
+        if (queryClassFamily(PropType::EffectMatrixDest)) {
+            caps |= effect_caps::MatrixDest;
+        }
+        if (queryClassFamily(PropType::EffectPipe)) {
+            caps |= effect_caps::Pipe;
+        }
+        return caps;
+    }
+
+    // Render rows [yBegin, yEnd) of the destination matrix only (called when canRenderBands()).
+    virtual void renderBand(tTime currTime, tMatrixPixelsCoord yBegin, tMatrixPixelsCoord yEnd) const {
+        (void)currTime;
+        (void)yBegin;
+        (void)yEnd;
+    }
+
+    // End of the "all rows" band: render() of band-capable effects is renderBand(t, 0, cBandEnd).
+    static constexpr tMatrixPixelsCoord cBandEnd = 0x7FFFFFFF;
+
     // Called after the entire frame is rendered; gives the effect access to the final matrix.
     // TODO: MOVE!!!
     virtual void onFrameDone(csMatrixPixels& frame, csRandGen& rand, tTime currTime) {
@@ -227,7 +288,8 @@ public:
 // All fields are public by design for direct access/performance.
 class csRenderMatrixBase : public csEffectBase {
 public:
-    csMatrixPixels* matrixDest = nullptr;
+    // Any csMatrixBase: RGBA matrices, or compact opaque layers (csMatrixRGB565 / csMatrixRGB888).
+    csMatrixBase* matrixDest = nullptr;
 
     csRect rectDest;
 
@@ -235,17 +297,27 @@ public:
 
     bool disabled = false;
 
+    // How the effect output is composited into matrixDest (see csBlendMode).
+    csBlendMode blendMode = csBlendMode::SourceOver;
+
     virtual ~csRenderMatrixBase() = default;
 
-    void setMatrix(csMatrixPixels* m) noexcept {
+    void setMatrix(csMatrixBase* m) noexcept {
         matrixDest = m;
         propChanged(propMatrixDest);
     }
-    void setMatrix(csMatrixPixels& m) noexcept {
+    void setMatrix(csMatrixBase& m) noexcept {
         matrixDest = &m;
         propChanged(propMatrixDest);
     }
 
+    // Reduced-resolution frame (effect_caps::Scalable, see csEffectManager::setRenderDivisor): draw what
+    // render() draws, but into 'rect' of 'dest' at 1/'divisor' of the resolution: pixel (x, y) of 'dest'
+    // shows pixel (x * divisor, y * divisor) of the full frame. matrixDest, rectDest and the other
+    // properties are only read. Called only for effects that report Scalable.
+    virtual void renderScaled(tTime /*currTime*/, csMatrixBase& /*dest*/, csRect /*rect*/,
+                              uint8_t /*divisor*/) const {}
+
     // Class family identifier
     static constexpr PropType ClassFamilyId = PropType::EffectMatrixDest;
 
@@ -285,6 +357,10 @@ public:
                 info.valuePtr = &disabled;
                 info.disabled = false;
                 break;
+            case propBlendMode:
+                info.valuePtr = &blendMode;
+                info.disabled = false;
+                break;
             default:
                 break;
         }
@@ -298,12 +374,32 @@ public:
                     updateRenderRect();
                 }
                 break;
+            case propBlendMode:
+                if (static_cast<uint8_t>(blendMode) >= cBlendModeCount) {
+                    blendMode = csBlendMode::SourceOver;
+                }
+                break;
             default:
                 break;
         }
     }
 
 protected:
+    // Rows [yBegin, yEnd) of 'target' (band rendering).
+    static csRect bandRows(const csRect& target, tMatrixPixelsCoord yBegin, tMatrixPixelsCoord yEnd) noexcept {
+        const tMatrixPixelsCoord y0 = math::max(target.y, yBegin);
+        const tMatrixPixelsCoord y1 = math::min(target.y + to_coord(target.height), yEnd);
+        if (y1 <= y0) {
+            return csRect{};
+        }
+        return csRect{target.x, y0, target.width, to_size(y1 - y0)};
+    }
+
+    // Composite one pixel into matrixDest with blendMode.
+    void blendPixel(tMatrixPixelsCoord x, tMatrixPixelsCoord y, csColorRGBA color) const noexcept {
+        matrixDest->setPixelMode(x, y, color, blendMode);
+    }
+
     virtual void updateRenderRect() {
         if (!matrixDest) {
             return;
@@ -51,26 +51,49 @@ public:
 // Simple animated RGB gradient (float).
 class csRenderGradientWaves : public csRenderDynamic {
 public:
+    bool canRenderBands() const override {
+        return true;
+    }
+
     void render(csRandGen& /*rand*/, tTime currTime) const override {
+        renderBand(currTime, 0, cBandEnd);
+    }
+
+    uint8_t getCapabilities() override {
+        return csRenderDynamic::getCapabilities() | effect_caps::Scalable;
+    }
+
+    void renderScaled(tTime currTime, csMatrixBase& dest, csRect rect, uint8_t divisor) const override {
+        if (disabled) {
+            return;
+        }
+        renderArea(dest, rect.intersect(dest.getRect()), currTime, divisor);
+    }
+
+    void renderBand(tTime currTime, tMatrixPixelsCoord yBegin, tMatrixPixelsCoord yEnd) const override {
         if (disabled || !matrixDest) {
             return;
         }
+        renderArea(*matrixDest, bandRows(rectDest.intersect(matrixDest->getRect()), yBegin, yEnd), currTime, 1);
+    }
+
+private:
+    // Draw 'target' of 'dst'; pixel (x, y) of 'dst' shows (x * divisor, y * divisor) of the full frame.
+    void renderArea(csMatrixBase& dst, csRect target, tTime currTime, uint8_t divisor) const {
+        if (target.empty()) {
+            return;
+        }
         const float t = static_cast<float>(currTime) * 0.001f * speed.to_float();
 
         auto wave = [](float v) -> uint8_t {
             return static_cast<uint8_t>((sin(v) * 0.5f + 0.5f) * 255.0f);
         };
 
-        const csRect target = rectDest.intersect(matrixDest->getRect());
-        if (target.empty()) {
-            return;
-        }
-
         const tMatrixPixelsCoord endX = target.x + to_coord(target.width);
         const tMatrixPixelsCoord endY = target.y + to_coord(target.height);
         const float scaleF = scale.to_float();
         // Invert scale: divide by scale so larger values stretch the waves (bigger scale = more stretched).
-        const float invScaleF = (scaleF > 0.0f) ? (1.0f / scaleF) : 1.0f;
+        const float invScaleF = ((scaleF > 0.0f) ? (1.0f / scaleF) : 1.0f) * static_cast<float>(divisor);
         for (tMatrixPixelsCoord y = target.y; y < endY; ++y) {
             for (tMatrixPixelsCoord x = target.x; x < endX; ++x) {
                 const float xf = static_cast<float>(x) * 0.4f * invScaleF;
@@ -78,7 +101,7 @@ public:
                 const uint8_t r = wave(t * 0.8f + xf);
                 const uint8_t g = wave(t * 1.0f + yf);
                 const uint8_t b = wave(t * 0.6f + xf + yf * 0.5f);
-                matrixDest->setPixel(x, y, csColorRGBA{255, r, g, b});
+                dst.setPixelMode(x, y, csColorRGBA{255, r, g, b}, blendMode);
             }
         }
     }
@@ -101,10 +124,38 @@ public:
         return static_cast<uint8_t>(v);
     }
 
+    bool canRenderBands() const override {
+        return true;
+    }
+
     void render(csRandGen& /*rand*/, tTime currTime) const override {
+        renderBand(currTime, 0, cBandEnd);
+    }
+
+    uint8_t getCapabilities() override {
+        return csRenderDynamic::getCapabilities() | effect_caps::Scalable;
+    }
+
+    void renderScaled(tTime currTime, csMatrixBase& dest, csRect rect, uint8_t divisor) const override {
+        if (disabled) {
+            return;
+        }
+        renderArea(dest, rect.intersect(dest.getRect()), currTime, divisor);
+    }
+
+    void renderBand(tTime currTime, tMatrixPixelsCoord yBegin, tMatrixPixelsCoord yEnd) const override {
         if (disabled || !matrixDest) {
             return;
         }
+        renderArea(*matrixDest, bandRows(rectDest.intersect(matrixDest->getRect()), yBegin, yEnd), currTime, 1);
+    }
+
+private:
+    // Draw 'target' of 'dst'; pixel (x, y) of 'dst' shows (x * divisor, y * divisor) of the full frame.
+    void renderArea(csMatrixBase& dst, csRect target, tTime currTime, uint8_t divisor) const {
+        if (target.empty()) {
+            return;
+        }
         using namespace math;
 
         // Convert milliseconds to seconds in 16.16 fixed-point WITHOUT float:
@@ -121,11 +172,8 @@ public:
         static constexpr csFP32 k05 = FP32(0.4f);
         // Convert scale from FP16 to FP32 and invert: divide by scale so larger values stretch the waves (bigger scale = more stretched).
         const csFP32 scaleFP32 = math::fp16_to_fp32(scale);
-        const csFP32 invScaleFP32 = (scaleFP32 > csFP32::zero) ? (csFP32::one / scaleFP32) : csFP32::one;
-        const csRect target = rectDest.intersect(matrixDest->getRect());
-        if (target.empty()) {
-            return;
-        }
+        const csFP32 invScaleFP32 =
+            ((scaleFP32 > csFP32::zero) ? (csFP32::one / scaleFP32) : csFP32::one) * csFP32(divisor);
 
         const tMatrixPixelsCoord endX = target.x + to_coord(target.width);
         const tMatrixPixelsCoord endY = target.y + to_coord(target.height);
@@ -138,7 +186,7 @@ public:
                 const uint8_t r = wave_fp(t * k08 + xf_scaled);
                 const uint8_t g = wave_fp(t + yf_scaled);
                 const uint8_t b = wave_fp(t * csFP32::half + xf_scaled + yf_scaled * k05);
-                matrixDest->setPixel(x, y, csColorRGBA{255, r, g, b});
+                dst.setPixelMode(x, y, csColorRGBA{255, r, g, b}, blendMode);
             }
         }
     }
@@ -147,19 +195,43 @@ public:
 // Simple sinusoidal plasma effect (float).
 class csRenderPlasma : public csRenderDynamic {
 public:
+    bool canRenderBands() const override {
+        return true;
+    }
+
     void render(csRandGen& /*rand*/, tTime currTime) const override {
+        renderBand(currTime, 0, cBandEnd);
+    }
+
+    uint8_t getCapabilities() override {
+        return csRenderDynamic::getCapabilities() | effect_caps::Scalable;
+    }
+
+    void renderScaled(tTime currTime, csMatrixBase& dest, csRect rect, uint8_t divisor) const override {
+        if (disabled) {
+            return;
+        }
+        renderArea(dest, rect.intersect(dest.getRect()), currTime, divisor);
+    }
+
+    void renderBand(tTime currTime, tMatrixPixelsCoord yBegin, tMatrixPixelsCoord yEnd) const override {
         if (disabled || !matrixDest) {
             return;
         }
-        const float t = static_cast<float>(currTime) * 0.0025f * speed.to_float();
-        const csRect target = rectDest.intersect(matrixDest->getRect());
+        renderArea(*matrixDest, bandRows(rectDest.intersect(matrixDest->getRect()), yBegin, yEnd), currTime, 1);
+    }
+
+private:
+    // Draw 'target' of 'dst'; pixel (x, y) of 'dst' shows (x * divisor, y * divisor) of the full frame.
+    void renderArea(csMatrixBase& dst, csRect target, tTime currTime, uint8_t divisor) const {
         if (target.empty()) {
             return;
         }
+        const float t = static_cast<float>(currTime) * 0.0025f * speed.to_float();
 
         const float scaleF = scale.to_float();
         // Invert scale: divide by scale so larger values stretch the waves (bigger scale = more stretched).
-        const float invScaleF = (scaleF > 0.0f) ? (1.0f / scaleF) : 1.0f;
+        const float invScaleF = ((scaleF > 0.0f) ? (1.0f / scaleF) : 1.0f) * static_cast<float>(divisor);
         const tMatrixPixelsCoord endX = target.x + to_coord(target.width);
         const tMatrixPixelsCoord endY = target.y + to_coord(target.height);
         for (tMatrixPixelsCoord y = target.y; y < endY; ++y) {
@@ -171,7 +243,7 @@ public:
                 const uint8_t r = static_cast<uint8_t>(norm * 255.0f);
                 const uint8_t g = static_cast<uint8_t>((1.0f - norm) * 255.0f);
                 const uint8_t b = static_cast<uint8_t>((0.5f + 0.5f * sin(t + xf * 0.1f)) * 255.0f);
-                matrixDest->setPixel(x, y, csColorRGBA{255, r, g, b});
+                dst.setPixelMode(x, y, csColorRGBA{255, r, g, b}, blendMode);
             }
         }
     }
@@ -198,6 +270,8 @@ public:
     int8_t wind = 0;
 
     csMatrixBytes heatA{0, 0};
+    // Per-step row scratch: row 0 = random cooling amounts, row 1 = diffusion jitter (-1/0/+1 as int8_t).
+    csMatrixBytes rowScratch{0, 0};
     uint16_t lastUpdateTime = 0;
 
     // Hidden fuel-burn row count appended below visible area. Sparks/fuel live here; blurred into visible bottom row.
@@ -283,6 +357,7 @@ public:
         }
         heatA.resize(w, internalH);
         heatA.clear();
+        rowScratch.resize(w, 2);
         lastUpdateTime = 0;
     }
 
@@ -329,6 +404,9 @@ private:
     // Weighting:
     //   dst(x,y) = (v1 + vL + vR + v2 + v2) / 5
     //
+    // The jitter row is drawn first (same RNG order as a per-pixel loop), then the whole row runs
+    // through diffuseUpRow() (byte_row.hpp) on raw row pointers.
+    //
     // Args:
     // - rand: RNG used for per-pixel horizontal jitter (-1/0/+1).
     // - y: Destination row index (valid range: 0..visibleH-2). Uses source rows y+1 and y+2.
@@ -337,6 +415,7 @@ private:
     // - windShift: Horizontal drift added to x before clamping (typically static_cast<int>(wind)).
     // - src: Source heat buffer (read-only). Can be the same object as dst for in-place diffusion.
     // - dst: Destination heat buffer (written). Can be the same object as src for in-place diffusion.
+    // - jitter: Scratch row of at least w entries.
     static void diffuseUpwardRow(
         csRandGen& rand,
         tMatrixPixelsSize y,
@@ -344,40 +423,27 @@ private:
         tMatrixPixelsSize visibleH,
         int windShift,
         const csMatrixBytes& src,
-        csMatrixBytes& dst
+        csMatrixBytes& dst,
+        int8_t* jitter
     ) {
-        // Keep all computations identical to the previous inline loop in recalc().
         const tMatrixPixelsSize yp1 = y + 1;
         const tMatrixPixelsSize yp2 = (y + 2 < visibleH) ? (y + 2) : (visibleH - 1);
         for (tMatrixPixelsSize x = 0; x < w; ++x) {
-            const int jitter = static_cast<int>(rand.rand(3)) - 1;
-            const int sx = static_cast<int>(x) + windShift + jitter;
-            const int sxClamp = (sx < 0) ? 0 : (sx >= static_cast<int>(w)) ? (static_cast<int>(w) - 1) : sx;
-            const int sxLClamp = (sxClamp - 1 < 0) ? 0 : (sxClamp - 1);
-            const int sxRClamp = (sxClamp + 1 >= static_cast<int>(w)) ? (static_cast<int>(w) - 1) : (sxClamp + 1);
-            const tMatrixPixelsCoord cx = to_coord(sxClamp);
-            const tMatrixPixelsCoord cxL = to_coord(sxLClamp);
-            const tMatrixPixelsCoord cxR = to_coord(sxRClamp);
-
-            const uint16_t v1 = src.getValue(cx, to_coord(yp1));
-            const uint16_t v2 = src.getValue(cx, to_coord(yp2));
-            const uint16_t vL = src.getValue(cxL, to_coord(yp1));
-            const uint16_t vR = src.getValue(cxR, to_coord(yp1));
-            const uint8_t v = static_cast<uint8_t>((v1 + vL + vR + v2 + v2) / 5u);
-            dst.setValue(to_coord(x), to_coord(y), v);
+            jitter[x] = static_cast<int8_t>(static_cast<int>(rand.rand(3)) - 1);
         }
+        diffuseUpRow(dst.row(to_coord(y)), src.row(to_coord(yp1)), src.row(to_coord(yp2)), w, windShift, jitter);
     }
 
     // Cooling: subtract random [0..coolMax) from each cell; write back into heatA (full internal height).
     // w = width, internalH = internal height, coolMax = max cool per cell.
+    // The random amounts of a row are drawn first, then subtracted with subSaturateRow().
     void stepCooling(csRandGen& rand, tMatrixPixelsSize w, tMatrixPixelsSize internalH, uint8_t coolMax) {
+        uint8_t* cool = rowScratch.row(0);
         for (tMatrixPixelsSize y = 0; y < internalH; ++y) {
             for (tMatrixPixelsSize x = 0; x < w; ++x) {
-                uint8_t v = heatA.getValue(to_coord(x), to_coord(y));
-                const uint8_t cool = rand.rand(coolMax);
-                v = (v > cool) ? static_cast<uint8_t>(v - cool) : 0;
-                heatA.setValue(to_coord(x), to_coord(y), v);
+                cool[x] = rand.rand(coolMax);
             }
+            subSaturateRow(heatA.row(to_coord(y)), cool, w);
         }
     }
 
@@ -405,20 +471,9 @@ private:
     // Blur technical fuel row into visible bottom row: v(x) = (L + 2*C + R) / 4
     // IMPORTANT: `fuelYPos != bottomVisibleY`
     // w = width, fuelYPos = fuel row y, bottomVisibleY = visible bottom row y.
+    // Samples outside the row are 0 (csEdgeMode::Zero).
     void stepFuelBlur(tMatrixPixelsSize w, tMatrixPixelsCoord fuelYPos, tMatrixPixelsCoord bottomVisibleY) {
-
-        // sliding window
-        uint8_t L = 0;
-        uint8_t C = 0;
-        uint8_t R = 0;
-
-        for (tMatrixPixelsCoord x = -1; x < (w + 1); ++x) {
-            L = C;
-            C = R;
-            R = heatA.getValue(x + 1, fuelYPos);
-            const uint8_t v = (L + (C * 2) + R) / 4;
-            heatA.setValue(x, bottomVisibleY, v);
-        }
+        convolveRow<3>(heatA.row(bottomVisibleY), heatA.row(fuelYPos), w, cByteKernelBlur3, csEdgeMode::Zero);
     }
 
     // Upward diffusion (weighted rise + slight lateral spread): heat rises (y decreases).
@@ -426,7 +481,8 @@ private:
     void stepDiffuse(csRandGen& rand, tMatrixPixelsSize w, tMatrixPixelsSize visibleH, int windShift) {
         if (visibleH >= 2) {
             for (tMatrixPixelsSize y = 0; y + 1 < visibleH; ++y) {
-                diffuseUpwardRow(rand, y, w, visibleH, windShift, heatA, heatA);
+                diffuseUpwardRow(rand, y, w, visibleH, windShift, heatA, heatA,
+                                 reinterpret_cast<int8_t*>(rowScratch.row(1)));
             }
         }
     }
@@ -437,6 +493,11 @@ public:
     // - add sparks into technical fuel row
     // - blur technical row into visible bottom row
     // - diffuse upward with slight lateral spread
+    // Heat field carried over between frames.
+    uint8_t getCapabilities() override {
+        return csRenderDynamic::getCapabilities() | effect_caps::Stateful;
+    }
+
     void recalc(csRandGen& rand, tTime currTime) override {
         if (disabled || rectDest.empty()) {
             return;
@@ -517,12 +578,18 @@ public:
                                                   to_coord(matrixDest->width()) - rectDest.x);
         const tMatrixPixelsCoord end_y = math::min(to_coord(visibleH),
                                                   to_coord(matrixDest->height()) - rectDest.y);
+        // Palette-map a chunk of the row, then composite it with one row call (blend mode aware).
+        static constexpr tMatrixPixelsCoord cChunk = 32;
+        csColorRGBA line[cChunk];
         for (tMatrixPixelsCoord sy = start_y; sy < end_y; ++sy) {
             const tMatrixPixelsCoord dy = sy + rectDest.y;
-            for (tMatrixPixelsCoord sx = start_x; sx < end_x; ++sx) {
-                const tMatrixPixelsCoord dx = sx + rectDest.x;
-                const uint8_t heatVal = heatA.getValue(to_coord(sx), to_coord(sy));
-                matrixDest->setPixel(dx, dy, heatToColor(heatVal).alpha(alpha));
+            for (tMatrixPixelsCoord sx0 = start_x; sx0 < end_x; sx0 += cChunk) {
+                const tMatrixPixelsCoord len = math::min(cChunk, end_x - sx0);
+                for (tMatrixPixelsCoord i = 0; i < len; ++i) {
+                    line[i] = heatToColor(heatA.getValue(to_coord(sx0 + i), to_coord(sy)));
+                }
+                matrixDest->setPixelsRowMode(sx0 + rectDest.x, dy, line, static_cast<tMatrixPixelsSize>(len),
+                                             alpha, blendMode);
             }
         }
     }
@@ -647,6 +714,10 @@ public:
         };
     }
 
+    uint8_t getCapabilities() override {
+        return csRenderMatrixBase::getCapabilities() | effect_caps::Static;
+    }
+
     void render(csRandGen& /*rand*/, uint16_t /*currTime*/) const override {
         if (disabled || !matrixDest || !font) {
             return;
@@ -657,13 +728,7 @@ public:
             return;
         }
 
-        const tMatrixPixelsCoord endX = target.x + to_coord(target.width);
-        const tMatrixPixelsCoord endY = target.y + to_coord(target.height);
-        for (tMatrixPixelsCoord y = target.y; y < endY; ++y) {
-            for (tMatrixPixelsCoord x = target.x; x < endX; ++x) {
-                matrixDest->setPixel(x, y, backgroundColor);
-            }
-        }
+        matrix_utils::fillArea(*matrixDest, target, backgroundColor, blendMode);
 
         const tMatrixPixelsSize glyphWidth = math::min(rectDest.width, to_size(font->width()));
         const tMatrixPixelsSize glyphHeight = math::min(rectDest.height, to_size(font->height()));
@@ -684,7 +749,7 @@ public:
                 if (csFontBase::getColBit(glyphRow, static_cast<uint16_t>(col))) {
                     const tMatrixPixelsCoord px = offsetX + to_coord(col);
                     const tMatrixPixelsCoord py = offsetY + to_coord(row);
-                    matrixDest->setPixel(px, py, color);
+                    blendPixel(px, py, color);
                 }
             }
         }
@@ -732,14 +797,14 @@ public:
 
                 //TODO:!!!
                 /*if (csFontBase::getColBit(glyphRowAllSeg, static_cast<uint16_t>(col))) {
-                    matrixDest->setPixel(px, py, csColorRGBA(255, 0,0));
+                    blendPixel(px, py, csColorRGBA(255, 0,0));
                 }*/
 
                 if (csFontBase::getColBit(glyphRow, static_cast<uint16_t>(col))) {
-                    matrixDest->setPixel(px, py, color);
+                    blendPixel(px, py, color);
                 } else {
                     if (csFontBase::getColBit(glyphRowAllSeg, static_cast<uint16_t>(col))) {
-                        matrixDest->setPixel(px, py, backgroundColor);
+                        blendPixel(px, py, backgroundColor);
                     }
                 }
             }
@@ -789,7 +854,15 @@ public:
         }
     }
 
-    void render(csRandGen& /*rand*/, uint16_t /*currTime*/) const override {
+    bool canRenderBands() const override {
+        return true;
+    }
+
+    void render(csRandGen& /*rand*/, tTime currTime) const override {
+        renderBand(currTime, 0, cBandEnd);
+    }
+
+    void renderBand(tTime /*currTime*/, tMatrixPixelsCoord yBegin, tMatrixPixelsCoord yEnd) const override {
         if (disabled || !matrixDest) {
             return;
         }
@@ -799,8 +872,10 @@ public:
             return;
         }
 
+        // Circle geometry comes from the whole target; only the band rows are drawn.
+        const csRect rows = bandRows(target, yBegin, yEnd);
         const tMatrixPixelsCoord endX = target.x + to_coord(target.width);
-        const tMatrixPixelsCoord endY = target.y + to_coord(target.height);
+        const tMatrixPixelsCoord endY = rows.y + to_coord(rows.height);
 
         const float cx = static_cast<float>(target.x) + static_cast<float>(target.width) * 0.5f;
         const float cy = static_cast<float>(target.y) + static_cast<float>(target.height) * 0.5f;
@@ -808,7 +883,7 @@ public:
         const float radiusSq = radius * radius;
         const float aaHalfPixel = 0.5f; // simple 1px-wide anti-aliasing ramp
 
-        for (tMatrixPixelsCoord y = target.y; y < endY; ++y) {
+        for (tMatrixPixelsCoord y = rows.y; y < endY; ++y) {
             const float py = static_cast<float>(y) + 0.5f;
             const float dy = py - cy;
             const float dySq = dy * dy;
@@ -818,7 +893,7 @@ public:
                 const float distSq = dx * dx + dySq;
                 if (!smoothEdges) {
                     const csColorRGBA c = (distSq <= radiusSq) ? color : backgroundColor;
-                    matrixDest->setPixel(x, y, c);
+                    blendPixel(x, y, c);
                     continue;
                 }
 
@@ -832,10 +907,10 @@ public:
                 }
 
                 // First lay down background (blended over existing content), then blend circle with coverage-scaled alpha.
-                matrixDest->setPixel(x, y, backgroundColor);
+                blendPixel(x, y, backgroundColor);
                 if (coverage > 0.0f) {
                     const uint8_t coverageAlpha = static_cast<uint8_t>(coverage * 255.0f + 0.5f);
-                    matrixDest->setPixel(x, y, color.alpha(coverageAlpha));
+                    blendPixel(x, y, color.alpha(coverageAlpha));
                 }
             }
         }
@@ -845,7 +920,7 @@ public:
 // Optimized circle renderer: per-scanline chord computation, optional AA on edges.
 class csRenderCircleFast : public csRenderCircle {
 public:
-    void render(csRandGen& /*rand*/, uint16_t /*currTime*/) const override {
+    void renderBand(tTime /*currTime*/, tMatrixPixelsCoord yBegin, tMatrixPixelsCoord yEnd) const override {
         if (disabled || !matrixDest) {
             return;
         }
@@ -864,19 +939,18 @@ public:
 
         const float radiusSq = radius * radius;
         const float aaWidth = 1.0f; // ~1px anti-aliased ramp
-        const tMatrixPixelsCoord endY = target.y + to_coord(target.height);
+        const csRect rows = bandRows(target, yBegin, yEnd);
+        const tMatrixPixelsCoord endY = rows.y + to_coord(rows.height);
         const tMatrixPixelsCoord endX = target.x + to_coord(target.width);
 
-        for (tMatrixPixelsCoord y = target.y; y < endY; ++y) {
+        for (tMatrixPixelsCoord y = rows.y; y < endY; ++y) {
             const float py = static_cast<float>(y) + 0.5f;
             const float dy = py - cy;
             const float dySq = dy * dy;
 
             // If the entire scanline is outside the AA band, fill with background and continue.
             if (dySq > radiusSq + aaWidth * aaWidth) {
-                for (tMatrixPixelsCoord x = target.x; x < endX; ++x) {
-                    matrixDest->setPixel(x, y, backgroundColor);
-                }
+                matrix_utils::fillArea(*matrixDest, csRect{target.x, y, target.width, 1}, backgroundColor, blendMode);
                 continue;
             }
 
@@ -892,25 +966,23 @@ public:
             const tMatrixPixelsCoord xRight = static_cast<tMatrixPixelsCoord>(floorf(rightF));
 
             // Lay down background first (alpha-aware).
-            for (tMatrixPixelsCoord x = target.x; x < endX; ++x) {
-                matrixDest->setPixel(x, y, backgroundColor);
-            }
+            matrix_utils::fillArea(*matrixDest, csRect{target.x, y, target.width, 1}, backgroundColor, blendMode);
 
             // Solid interior (no AA).
             for (tMatrixPixelsCoord x = xLeft + 1; x < xRight; ++x) {
                 if (x < target.x || x >= endX) {
                     continue;
                 }
-                matrixDest->setPixel(x, y, color);
+                blendPixel(x, y, color);
             }
 
             if (!smoothEdges) {
                 // Hard edges: fill boundary pixels if inside bounds.
                 if (xLeft >= target.x && xLeft < endX) {
-                    matrixDest->setPixel(xLeft, y, color);
+                    blendPixel(xLeft, y, color);
                 }
                 if (xRight >= target.x && xRight < endX && xRight != xLeft) {
-                    matrixDest->setPixel(xRight, y, color);
+                    blendPixel(xRight, y, color);
                 }
                 continue;
             }
@@ -928,7 +1000,7 @@ public:
                     coverage = 1.0f;
                 }
                 const uint8_t coverageAlpha = static_cast<uint8_t>(coverage * 255.0f + 0.5f);
-                matrixDest->setPixel(x, y, color.alpha(coverageAlpha));
+                blendPixel(x, y, color.alpha(coverageAlpha));
             };
 
             const float leftPixelCenter = static_cast<float>(xLeft) + 0.5f;
@@ -966,7 +1038,7 @@ public:
         csRenderCircle::getPropInfo(propNum, info);
     }
 
-    void render(csRandGen& /*rand*/, uint16_t /*currTime*/) const override {
+    void renderBand(tTime /*currTime*/, tMatrixPixelsCoord yBegin, tMatrixPixelsCoord yEnd) const override {
         if (disabled || !matrixDest) {
             return;
         }
@@ -988,9 +1060,10 @@ public:
         const float startR = radius * offsetNorm; // inner radius where gradient starts (t=0)
         const float span = radius - startR;
 
+        const csRect rows = bandRows(target, yBegin, yEnd);
         const tMatrixPixelsCoord endX = target.x + to_coord(target.width);
-        const tMatrixPixelsCoord endY = target.y + to_coord(target.height);
-        for (tMatrixPixelsCoord y = target.y; y < endY; ++y) {
+        const tMatrixPixelsCoord endY = rows.y + to_coord(rows.height);
+        for (tMatrixPixelsCoord y = rows.y; y < endY; ++y) {
             const float py = static_cast<float>(y) + 0.5f;
             const float dy = py - cy;
             const float dySq = dy * dy;
@@ -1001,7 +1074,7 @@ public:
 
                 // Outside circle: just background.
                 if (distSq > radiusSq) {
-                    matrixDest->setPixel(x, y, backgroundColor);
+                    blendPixel(x, y, backgroundColor);
                     continue;
                 }
 
@@ -1018,7 +1091,7 @@ public:
                 const uint8_t t8 = static_cast<uint8_t>(t * 255.0f + 0.5f);
                 const csColorRGBA gradColor = lerp(color, backgroundColor, t8);
 
-                matrixDest->setPixel(x, y, gradColor);
+                blendPixel(x, y, gradColor);
             }
         }
     }
@@ -1083,7 +1156,6 @@ public:
     // State fields (not mutable, changed in recalc())
     Snowflake* snowflakes = nullptr;
     uint16_t snowflakesAllocatedCount = 0; // Track allocated array size
-    uint16_t filledPixelsCount = 0;
     uint16_t lastUpdateTime = 0;
     uint8_t snowfallCount = 0; // Counter for compactSnow calls
     bool lastDirectionWasLeft = false; // Alternating priority for moveDownSide directions
@@ -1163,6 +1235,11 @@ public:
             rand.randRange(0, cSpawnDelayMax - cSpawnDelayMin)));
     }
 
+    // Snowflakes move from frame to frame.
+    uint8_t getCapabilities() override {
+        return csRenderDynamic::getCapabilities() | effect_caps::Stateful;
+    }
+
     void recalc(csRandGen& rand, tTime currTime) override {
         if (disabled) {
             return;
@@ -1176,9 +1253,9 @@ public:
         const uint32_t totalPixels = static_cast<uint32_t>(rectDest.width) * static_cast<uint32_t>(rectDest.height);
 
         // Check for clearing mode activation at specified fill percentage
-        if (clearingIterations == 0 && filledPixelsCount >= (totalPixels * restartFillPercent) / 100) {
+        // Fill level is a word-parallel popcount of the pile bitmap.
+        if (clearingIterations == 0 && bitmap->countOnes() >= (totalPixels * restartFillPercent) / 100) {
             clearingIterations = rectDest.height;
-            filledPixelsCount = 0;
         }
 
         // Calculate time step based on speed
@@ -1220,18 +1297,17 @@ public:
             auto fixSnowflakeAtCurrent = [&](Snowflake& flake) {
                 // Logic with outOfBoundsValue = true:
                 // - If snowflake is inside bounds and position is empty: getValue returns false,
-                //   we set the pixel and increment counter.
+                //   we set the pixel.
                 // - If snowflake is inside bounds and position already has snowflake: getValue returns true,
                 //   we do nothing.
                 // - If snowflake is out of bounds: getValue returns true (due to outOfBoundsValue = true),
-                //   we do nothing, counter is not incremented.
+                //   we do nothing.
                 // No boundary check needed: getValue with outOfBoundsValue = true already handles out-of-bounds.
                 // Convert fixed-point coordinates to integer for bitmap operations
                 const tMatrixPixelsSize flakeX = to_size(static_cast<tMatrixPixelsCoord>(flake.x.round_int()));
                 const tMatrixPixelsSize flakeY = to_size(static_cast<tMatrixPixelsCoord>(flake.y.round_int()));
                 if (!bitmap->getValue(flakeX, flakeY)) {
                     bitmap->setValue(flakeX, flakeY, true);
-                    ++filledPixelsCount;
                 }
 
                 randOneSnowflake(flake, rand);
@@ -1279,14 +1355,13 @@ public:
         const tMatrixPixelsCoord endX = target.x + to_coord(target.width);
         const tMatrixPixelsCoord endY = target.y + to_coord(target.height);
 
-        // Draw fixed snowflakes from bitmap and clear background
+        // Draw fixed snowflakes from bitmap: jump between set bits with findFirstSet (empty runs cost one word test).
         for (tMatrixPixelsCoord y = target.y; y < endY; ++y) {
-            for (tMatrixPixelsCoord x = target.x; x < endX; ++x) {
-                const tMatrixPixelsCoord localX = x - rectDest.x;
-                const tMatrixPixelsCoord localY = y - rectDest.y;
-                if (bitmap->getValue(to_size(localX), to_size(localY))) {
-                    matrixDest->setPixel(x, y, color);
-                }
+            const tMatrixPixelsCoord localY = y - rectDest.y;
+            tMatrixPixelsCoord localX = bitmap->findFirstSet(localY, target.x - rectDest.x);
+            while (localX >= 0 && localX + rectDest.x < endX) {
+                blendPixel(localX + rectDest.x, y, color);
+                localX = bitmap->findFirstSet(localY, localX + 1);
             }
         }
 
@@ -1312,9 +1387,9 @@ public:
             if (globalXInt >= target.x && globalXInt < endX &&
                 globalYInt >= target.y && globalYInt < endY) {
                 if (smoothMovement) {
-                    matrixDest->setPixelFloat2(globalX, globalY, color);
+                    matrixDest->setPixelFloat2(globalX, globalY, color, blendMode);
                 } else {
-                    matrixDest->setPixel(globalXInt, globalYInt, color);
+                    blendPixel(globalXInt, globalYInt, color);
                 }
             }
         }
@@ -1322,16 +1397,20 @@ public:
 
 private:
     void updateBitmap() {
-        delete bitmap;
-        bitmap = nullptr;
-
         if (rectDest.empty()) {
+            delete bitmap;
+            bitmap = nullptr;
             return;
         }
 
-        bitmap = new csMatrixBoolean(rectDest.width, rectDest.height, true);
+        // Reuse the bitmap object; resize() keeps the buffer when the size did not change.
+        if (bitmap) {
+            bitmap->resize(rectDest.width, rectDest.height);
+            bitmap->clear();
+        } else {
+            bitmap = new csMatrixBoolean(rectDest.width, rectDest.height, true);
+        }
         // Reset state when bitmap is recreated
-        filledPixelsCount = 0;
         snowfallCount = 0;
         clearingIterations = 0;
         lastDirectionWasLeft = false;
@@ -1409,11 +1488,19 @@ private:
 
         const tMatrixPixelsSize w = bitmap->width();
         const tMatrixPixelsSize h = bitmap->height();
+        if (h == 0) {
+            return;
+        }
 
         // Process from bottom to top, right to left
-        // This ensures snowflakes fall correctly without glitches
-        for (tMatrixPixelsSize y = h; y > 0; --y) {
+        // This ensures snowflakes fall correctly without glitches.
+        // The bottom row never moves; a row is skipped when it is empty or the row below is full.
+        for (tMatrixPixelsSize y = h - 1; y > 0; --y) {
             const tMatrixPixelsSize py = y - 1;
+            if (bitmap->findFirstSet(to_coord(py)) < 0 ||
+                bitmap->countOnes(csRect{0, to_coord(py + 1), w, 1}) == w) {
+                continue;
+            }
             for (tMatrixPixelsSize x = w; x > 0; --x) {
                 const tMatrixPixelsSize px = x - 1;
 
@@ -1446,36 +1533,40 @@ private:
             return;
         }
 
-        const tMatrixPixelsSize w = bitmap->width();
-        const tMatrixPixelsSize h = bitmap->height();
-        if (h == 0) {
-            return;
-        }
-
-        // Shift all rows down (from bottom to top to avoid overwriting)
-        for (tMatrixPixelsSize y = h - 1; y > 0; --y) {
-            for (tMatrixPixelsSize x = 0; x < w; ++x) {
-                const bool value = bitmap->getValue(x, y - 1);
-                bitmap->setValue(x, y, value);
-            }
-        }
-
-        // Clear top row
-        for (tMatrixPixelsSize x = 0; x < w; ++x) {
-            bitmap->setValue(x, 0, false);
-        }
+        // Word-parallel row shift; the top row is cleared.
+        bitmap->shiftRows(1, false);
     }
 
 };
 
-// Effect: clear matrix to transparent black.
+// Effect: clear matrix to a color (transparent black by default), no blending.
 class csRenderClear : public csRenderMatrixBase {
 public:
+    csColorRGBA color{0, 0, 0, 0};
+
+    void getPropInfo(uint8_t propNum, csPropInfo& info) override {
+        csRenderMatrixBase::getPropInfo(propNum, info);
+        switch (propNum) {
+            case propColor:
+                info.valueType = PropType::Color;
+                info.name = "Clear color";
+                info.valuePtr = &color;
+                info.readOnly = false;
+                info.disabled = false;
+                break;
+        }
+    }
+
     void render(csRandGen& /*rand*/, uint16_t /*currTime*/) const override {
         if (disabled || !matrixDest) {
             return;
         }
-        matrixDest->clear();
+        const csPixelFormat fmt = matrixDest->pixelFormat();
+        if (fmt == csPixelFormat::ARGB8 || fmt == csPixelFormat::ARGB8Premul) {
+            static_cast<csMatrixPixels*>(matrixDest)->clear(color);
+        } else {
+            matrix_utils::fillAreaRewrite(*matrixDest, matrixDest->getRect(), color);
+        }
     }
 };
 
@@ -1497,11 +1588,15 @@ public:
         }
     }
 
+    uint8_t getCapabilities() override {
+        return csRenderMatrixBase::getCapabilities() | effect_caps::Static;
+    }
+
     void render(csRandGen& /*rand*/, uint16_t /*currTime*/) const override {
         if (disabled || !matrixDest) {
             return;
         }
-        matrix_utils::fillArea(*matrixDest, rectDest, color);
+        matrix_utils::fillArea(*matrixDest, rectDest, color, blendMode);
     }
 };
 
@@ -1945,6 +2040,11 @@ public:
         }
     }
 
+    // Position and velocity carried over between frames.
+    uint8_t getCapabilities() override {
+        return csRenderDynamic::getCapabilities() | effect_caps::Stateful;
+    }
+
     void recalc(csRandGen& rand, tTime currTime) override {
         if (disabled || !matrixDest || rectDest.empty()) {
             return;
@@ -2009,10 +2109,11 @@ public:
             matrixDest->setPixelFloat4(
                 math::fp32_to_fp16(posX),
                 math::fp32_to_fp16(posY),
-                color
+                color,
+                blendMode
             );
         } else {
-            matrixDest->setPixel(px, py, color);
+            blendPixel(px, py, color);
         }
     }
 
@@ -2225,7 +2326,7 @@ public:
 
         // If we're in the same cell as previous, just draw one pixel
         if (prevCellX == currCellX && prevCellY == currCellY) {
-            matrixDest->setPixel(currCellX, currCellY, color);
+            blendPixel(currCellX, currCellY, color);
             return;
         }
 
@@ -2288,12 +2389,12 @@ public:
         // Draw both pixels with smooth transition
         if (alphaOld > 0) {
             const csColorRGBA oldColor{alphaOld, color.r, color.g, color.b};
-            matrixDest->setPixel(prevCellX, prevCellY, oldColor);
+            blendPixel(prevCellX, prevCellY, oldColor);
         }
 
         if (alphaNew > 0) {
             const csColorRGBA newColor{alphaNew, color.r, color.g, color.b};
-            matrixDest->setPixel(currCellX, currCellY, newColor);
+            blendPixel(currCellX, currCellY, newColor);
         }
     }
 
@@ -2350,6 +2451,11 @@ public:
         }
     }
 
+    // Random point and on/off phase carried over between frames.
+    uint8_t getCapabilities() override {
+        return csRenderMatrixBase::getCapabilities() | effect_caps::Stateful;
+    }
+
     void recalc(csRandGen& rand, tTime currTime) override {
         if (disabled || !matrixDest || rectDest.empty()) {
             return;
@@ -2404,7 +2510,7 @@ public:
             return;
         }
 
-        matrixDest->setPixel(x, y, color);
+        blendPixel(x, y, color);
     }
 
     // Virtual respawn: choose random position and color. Override in derived classes to customize.
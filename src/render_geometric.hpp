@@ -13,7 +13,7 @@ using namespace amp::math;
 namespace amp {
 
 // Render filled triangle in target rectangle
-void fillTriangleSlow(const csRect& target, float x1, float y1, float x2, float y2, float x3, float y3, csMatrixPixels* matrix, const csColorRGBA& color) {
+void fillTriangleSlow(const csRect& target, float x1, float y1, float x2, float y2, float x3, float y3, csMatrixBase* matrix, const csColorRGBA& color) {
     if (!matrix || target.empty()) {
         return;
     }
@@ -57,7 +57,7 @@ void fillTriangleSlow(const csRect& target, float x1, float y1, float x2, float
 void fillTriangleScanlineFast(const csRect& target,
                           float xTop, float yTop,   // Top vertex
                           float xMid, float yMid,   // Middle vertex (by Y)
-                          float xBot, float yBot, csMatrixPixels* matrix, const csColorRGBA& color) {
+                          float xBot, float yBot, csMatrixBase* matrix, const csColorRGBA& color) {
     if (!matrix || target.empty()) {
         return;
     }
@@ -164,7 +164,7 @@ void fillTriangleScanlineFast(const csRect& target,
 void fillTriangleScanline(const csRect& target,
                                  float xTop, float yTop,   // Top vertex
                                  float xMid, float yMid,   // Middle vertex (by Y)
-                                 float xBot, float yBot, csMatrixPixels* matrix, const csColorRGBA& color) {
+                                 float xBot, float yBot, csMatrixBase* matrix, const csColorRGBA& color) {
     if (!matrix || target.empty()) {
         return;
     }
@@ -262,7 +262,7 @@ void fillTriangleScanline(const csRect& target,
 }
 
 // Render filled triangle in target rectangle (csFP32 version)
-void fillTriangleSlowFP32(const csRect& target, csFP32 x1, csFP32 y1, csFP32 x2, csFP32 y2, csFP32 x3, csFP32 y3, csMatrixPixels* matrix, const csColorRGBA& color) {
+void fillTriangleSlowFP32(const csRect& target, csFP32 x1, csFP32 y1, csFP32 x2, csFP32 y2, csFP32 x3, csFP32 y3, csMatrixBase* matrix, const csColorRGBA& color) {
     if (!matrix || target.empty()) {
         return;
     }
@@ -306,7 +306,7 @@ void fillTriangleSlowFP32(const csRect& target, csFP32 x1, csFP32 y1, csFP32 x2,
 void fillTriangleScanlineFastFP32(const csRect& target,
                           csFP32 xTop, csFP32 yTop,   // Top vertex
                           csFP32 xMid, csFP32 yMid,   // Middle vertex (by Y)
-                          csFP32 xBot, csFP32 yBot, csMatrixPixels* matrix, const csColorRGBA& color) {
+                          csFP32 xBot, csFP32 yBot, csMatrixBase* matrix, const csColorRGBA& color) {
     if (!matrix || target.empty()) {
         return;
     }
@@ -413,7 +413,7 @@ void fillTriangleScanlineFastFP32(const csRect& target,
 void fillTriangleScanlineFP32(const csRect& target,
                                  csFP32 xTop, csFP32 yTop,   // Top vertex
                                  csFP32 xMid, csFP32 yMid,   // Middle vertex (by Y)
-                                 csFP32 xBot, csFP32 yBot, csMatrixPixels* matrix, const csColorRGBA& color) {
+                                 csFP32 xBot, csFP32 yBot, csMatrixBase* matrix, const csColorRGBA& color) {
     if (!matrix || target.empty()) {
         return;
     }
@@ -192,6 +192,10 @@ public:
     // Internal random generator
     csRandGen int_rand;
     
+    // All pixels hold uniformColor: render() fills rows instead of blending pixel by pixel.
+    bool uniform = false;
+    csColorRGBA uniformColor{0, 0, 0, 0};
+    
     ~csRenderBackgroundColor() override {
         delete[] pixels;
     }
@@ -203,6 +207,8 @@ public:
         for (uint32_t i = 0; i < pixelCount; ++i) {
             pixels[i] = setColor;
         }
+        uniform = true;
+        uniformColor = setColor;
     }
     
     void init(csRandGen& rand) {
@@ -223,6 +229,8 @@ public:
         for (uint32_t i = 0; i < pixelCount; ++i) {
             pixels[i] = getNewColor(i);
         }
+        uniform = !useRandomColor;
+        uniformColor = selectedColor;
     }
     
     void reset() {
@@ -279,6 +287,14 @@ public:
             return;
         }
         
+        if (uniform) {
+            // Transparent black is skipped, as in the per-pixel loop below.
+            if (uniformColor.value != 0) {
+                matrix_utils::fillArea(*matrixDest, target, uniformColor);
+            }
+            return;
+        }
+        
         const tMatrixPixelsCoord endX = target.x + to_coord(target.width);
         const tMatrixPixelsCoord endY = target.y + to_coord(target.height);
         
@@ -326,14 +342,7 @@ public:
             return;
         }
         
-        const tMatrixPixelsCoord endX = target.x + to_coord(target.width);
-        const tMatrixPixelsCoord endY = target.y + to_coord(target.height);
-        
-        for (tMatrixPixelsCoord y = target.y; y < endY; ++y) {
-            for (tMatrixPixelsCoord x = target.x; x < endX; ++x) {
-                matrix->setPixel(x, y, color);
-            }
-        }
+        matrix_utils::fillArea(*matrixDest, target, color);
     }
 };
 
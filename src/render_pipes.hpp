@@ -6,6 +6,8 @@
 #include "amp_macros.hpp"
 #include "fixed_point.hpp"
 #include "matrix_utils.hpp"
+#include "matrix_pixels16.hpp"
+#include "blend_row.hpp"
 // #include <stdint.h>
 
 namespace amp {
@@ -115,7 +117,7 @@ public:
 
         // Get average color of source area and fill destination area with it
         const csColorRGBA areaColor = matrix_utils::getAreaColor(*matrixSource, rectSource);
-        matrix_utils::fillArea(*matrixDest, rectDest, areaColor);
+        matrix_utils::fillArea(*matrixDest, rectDest, areaColor, blendMode);
     }
 };
 
@@ -134,7 +136,7 @@ public:
 
         // If sizes match, use simple drawMatrix (faster)
         if (rectDest.width == rectSource.width && rectDest.height == rectSource.height) {
-            matrix_utils::drawMatrixArea(*matrixDest, rectSource, rectDest.x, rectDest.y, *matrixSource);
+            matrix_utils::drawMatrixArea(*matrixDest, rectSource, rectDest.x, rectDest.y, *matrixSource, 255, blendMode);
         } else {
             // Use drawMatrixScale for different sizes
             (void)matrix_utils::drawMatrixScale(*matrixDest, rectSource, rectDest, *matrixSource);
@@ -175,8 +177,14 @@ public:
             return;
         }
 
+        // Destination origin is rectDest.(x, y); remapped coordinates may leave rectDest (e.g. 2D->1D
+        // strips), so only the destination matrix bounds clip.
+        const tMatrixPixelsCoord origin_x = rectDest.x;
+        const tMatrixPixelsCoord origin_y = rectDest.y;
+
         // Iterate over all pixels in source rectangle
         for (tMatrixPixelsSize y = 0; y < rectSource.height; ++y) {
+            const tMatrixPixelsCoord src_y = rectSource.y + to_coord(y);
             for (tMatrixPixelsSize x = 0; x < rectSource.width; ++x) {
                 // Get remapped destination coordinates
                 tMatrixPixelsCoord dst_x = 0;
@@ -186,15 +194,12 @@ public:
                     continue; // Skip if remap function returns false
                 }
 
-                const tMatrixPixelsCoord src_x = rectSource.x + to_coord(x);
-                const tMatrixPixelsCoord src_y = rectSource.y + to_coord(y);
-
                 // Get source pixel and write to destination with blending
-                const csColorRGBA sourcePixel = matrixSource->getPixel(src_x, src_y);
+                const csColorRGBA sourcePixel = matrixSource->getPixel(rectSource.x + to_coord(x), src_y);
                 if (rewrite)
-                    matrixDest->setPixelRewrite(rectDest.x + dst_x, rectDest.x + dst_y, sourcePixel);
+                    matrixDest->setPixelRewrite(origin_x + dst_x, origin_y + dst_y, sourcePixel);
                 else
-                    matrixDest->setPixel(rectDest.x + dst_x, rectDest.x + dst_y, sourcePixel);
+                    matrixDest->setPixel(origin_x + dst_x, origin_y + dst_y, sourcePixel);
             }
         }
     }
@@ -786,8 +791,9 @@ public:
 
     static constexpr uint16_t cFadeIntervalMs = 32; // Hz
 
-    // Internal buffer that stores the accumulated image.
-    csMatrixPixels* buffer = nullptr;
+    // Internal buffer that stores the accumulated image (16-bit: the trail is rounded to 8 bits
+    // only when it is written to the frame, so slow fades do not band).
+    csMatrixPixels16* buffer = nullptr;
 
     // User-facing trail strength (0-255): higher = slower fade.
     // Note: internally we apply a non-linear curve so the lower half of the range
@@ -825,6 +831,11 @@ public:
         }
     }
 
+    // The accumulated trail in 'buffer' is carried over between frames.
+    uint8_t getCapabilities() override {
+        return csRenderPostFrame::getCapabilities() | effect_caps::Stateful;
+    }
+
     void onFrameDone(csMatrixPixels& frame, csRandGen& /*rand*/, tTime currTime) override {
         // Base class handles disabled check, but we need to check it here too since
         // base method returns early and we can't detect that with void return type.
@@ -861,10 +872,25 @@ public:
         const tMatrixPixelsSize height = rectSource.height;
         const tMatrixPixelsSize width = rectSource.width;
 
+        const csRect bufferRect = buffer->getRect();
         for (tMatrixPixelsSize y = 0; y < height; ++y) {
+            const tMatrixPixelsCoord fy = rectSource.y + to_coord(y);
+
+            // Fast path: whole row as direct spans of both frame and buffer.
+            // Row class is read first: the mutable span request below resets it.
+            const csRowAlpha frameAlpha = frame.rowAlpha(fy);
+            csColorRGBA* frameLine = nullptr;
+            csColorRGBA16* bufferLine = nullptr;
+            tMatrixPixelsSize frameLen = 0;
+            tMatrixPixelsSize bufferLen = 0;
+            if (frame.getScanLine(rectSource, 0, to_coord(y), frameLine, frameLen) && frameLen == width &&
+                buffer->getScanLine16(bufferRect, 0, to_coord(y), bufferLine, bufferLen) && bufferLen == width) {
+                processRow(frame, rectSource.x, fy, y, frameLine, bufferLine, width, frameAlpha);
+                continue;
+            }
+
             for (tMatrixPixelsSize x = 0; x < width; ++x) {
                 const tMatrixPixelsCoord fx = rectSource.x + to_coord(x);
-                const tMatrixPixelsCoord fy = rectSource.y + to_coord(y);
                 const csColorRGBA cur = frame.getPixel(fx, fy);
                 const csColorRGBA trail = buffer->getPixel(x, y);
 
@@ -894,6 +920,26 @@ protected:
         frame.setPixelRewrite(fx, fy, composite);
     }
 
+    // Row processing hook: 'frameLine' and 'bufferLine' are direct spans of 'len' pixels
+    // (frame row starts at (fx, fy), buffer row is 'y'; the buffer row is premultiplied unorm16,
+    // see csMatrixPixels16); 'frameAlpha' is the alpha class of the whole frame row before
+    // processing (csMatrixPixels::rowAlpha()).
+    // Default implementation forwards every pixel to processPixel(); derived classes
+    // override it with row kernels (see blend_row.hpp) when they override processPixel().
+    virtual void processRow(csMatrixPixels& frame,
+                            tMatrixPixelsCoord fx,
+                            tMatrixPixelsCoord fy,
+                            tMatrixPixelsSize y,
+                            csColorRGBA* frameLine,
+                            csColorRGBA16* bufferLine,
+                            tMatrixPixelsSize len,
+                            csRowAlpha frameAlpha) {
+        (void)frameAlpha;
+        for (tMatrixPixelsSize x = 0; x < len; ++x) {
+            processPixel(frame, fx + to_coord(x), fy, x, y, frameLine[x], bufferLine[x].toColor8Straight());
+        }
+    }
+
     // Protected methods for derived classes to use
     void updateBuffer() {
         if (rectSource.empty()) {
@@ -914,10 +960,12 @@ protected:
             return;
         }
 
-        // TODO: тут ошибка! удалять объект buffer не нужно. достаточно вызывать `resize`.
-        delete buffer;
-        buffer = new csMatrixPixels(width, height);
-        buffer->clear();
+        // Keep the object, only the pixel buffer is replaced (resize clears it).
+        if (buffer) {
+            buffer->resize(width, height);
+        } else {
+            buffer = new csMatrixPixels16(width, height);
+        }
     }
 
     void fadeBuffer() {
@@ -925,29 +973,8 @@ protected:
             return;
         }
 
-        const tMatrixPixelsSize height = buffer->height();
-        const tMatrixPixelsSize width = buffer->width();
-        for (tMatrixPixelsSize y = 0; y < height; ++y) {
-            for (tMatrixPixelsSize x = 0; x < width; ++x) {
-                uint8_t newAlpha;
-                csColorRGBA pixel = buffer->getPixel(x, y);
-                
-                if (pixel.a < 4) {
-                    if (pixel.a == 0) {
-                        continue;
-                    } else {
-                        newAlpha = 0;
-                    }
-                } else {
-                    newAlpha = mul8(pixel.a, getFadeMul(fadeAlpha));
-                }
-
-                if (newAlpha != pixel.a) {
-                    pixel.a = newAlpha;
-                    buffer->setPixelRewrite(x, y, pixel);
-                }
-            }
-        }
+        // Premultiplied 16-bit fade: color and alpha decay together and always reach zero.
+        buffer->fade(getFadeMul(fadeAlpha));
     }
 
 private:
@@ -978,6 +1005,26 @@ protected:
         // Current frame over trail (trail = background)
         return csColorRGBA::sourceOverStraight(trail, cur);
     }
+
+    void processRow(csMatrixPixels& /*frame*/,
+                    tMatrixPixelsCoord /*fx*/,
+                    tMatrixPixelsCoord /*fy*/,
+                    tMatrixPixelsSize /*y*/,
+                    csColorRGBA* frameLine,
+                    csColorRGBA16* bufferLine,
+                    tMatrixPixelsSize len,
+                    csRowAlpha frameAlpha) override {
+        // Opaque frame row covers the trail: buffer takes the frame, frame stays as is.
+        if (frameAlpha == csRowAlpha::Opaque) {
+            for (tMatrixPixelsSize x = 0; x < len; ++x) {
+                bufferLine[x] = csColorRGBA16::fromColor8Premul(frameLine[x]);
+            }
+            return;
+        }
+        // Same as composePixel() per pixel: current frame over trail in 16 bits, quantized into the frame.
+        blendRow16(bufferLine, frameLine, len);
+        quantizeRow16(frameLine, bufferLine, len);
+    }
 };
 
 // Effect: slow fading overlay ("slow motion") that draws the accumulated trail over the current frame.
@@ -1045,17 +1092,41 @@ protected:
                       tMatrixPixelsSize x,
                       tMatrixPixelsSize y,
                       csColorRGBA cur,
-                      csColorRGBA trail) override {
-        // Accumulate: current frame over existing trail in buffer (slowly).
+                      csColorRGBA /*trail*/) override {
+        // Accumulate: current frame over existing trail in buffer (slowly, in 16 bits).
         // NOTE: accumulationAlpha is currently fixed to 16.
         // TODO: `accumulationAlpha=16` - make a property.
-        const csColorRGBA accumulated = csColorRGBA::sourceOverStraight(trail, cur, 16);
-        buffer->setPixelRewrite(x, y, accumulated);
+        buffer->setPixel(x, y, cur.alpha(16));
+        const csColorRGBA accumulated = buffer->getPixel(x, y);
 
         // Display: accumulated buffer, plus optional direct feed-through of the current frame.
         const csColorRGBA composite = csColorRGBA::sourceOverStraight(accumulated, cur, directAlpha);
         frame.setPixelRewrite(fx, fy, composite);
     }
+
+    void processRow(csMatrixPixels& /*frame*/,
+                    tMatrixPixelsCoord /*fx*/,
+                    tMatrixPixelsCoord /*fy*/,
+                    tMatrixPixelsSize /*y*/,
+                    csColorRGBA* frameLine,
+                    csColorRGBA16* bufferLine,
+                    tMatrixPixelsSize len,
+                    csRowAlpha frameAlpha) override {
+        // Row version of processPixel(): accumulate into buffer, then compose into frame in place.
+        blendRow16(bufferLine, frameLine, len, 16);
+        // Opaque frame fed through at full alpha covers the accumulated buffer: frame is unchanged.
+        if (frameAlpha == csRowAlpha::Opaque && directAlpha == 255) {
+            return;
+        }
+        // Quantize the accumulated row in chunks and put the frame over it.
+        static constexpr tMatrixPixelsSize cChunk = 32;
+        csColorRGBA accumulated[cChunk];
+        for (tMatrixPixelsSize x = 0; x < len; x = to_size(x + cChunk)) {
+            const tMatrixPixelsSize n = min(to_size(len - x), cChunk);
+            quantizeRow16(accumulated, bufferLine + x, n);
+            blendRowTo(frameLine + x, accumulated, frameLine + x, n, directAlpha);
+        }
+    }
 };
 
 } // namespace amp
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdint.h>
+#include "frame_clock.hpp"
+
+namespace amp {
+
+using ::uint8_t;
+using ::uint16_t;
+using ::uint32_t;
+
+// Picks the render resolution of csMatrixSFXSystem from measured frame times.
+//
+// level 0 renders at full resolution, level n at 1/(1 << n) (see csEffectManager::setRenderDivisor).
+// - downFrames consecutive frames over targetFrameUs: one level down (coarser).
+// - upFrames consecutive frames under upPercent of targetFrameUs: one level up (finer). The margin
+//   keeps a frame that only fits at the coarser level from flipping back and forth.
+// - A level that is left again within upFrames frames after a step up doubles the wait for the
+//   next step up (up to cMaxUpFrames); a step up that holds restores it.
+class csResolutionGovernor {
+public:
+    static constexpr uint16_t cMaxUpFrames = 1024;
+
+    // Frame budget in microseconds; 0 disables the governor (level stays 0).
+    uint32_t targetFrameUs = 0;
+    uint8_t maxLevel = 2;
+    uint8_t downFrames = 3;
+    uint16_t upFrames = 30;
+    // A frame counts as fast when it takes less than upPercent % of targetFrameUs.
+    uint8_t upPercent = 40;
+    // Clock of csMatrixSFXSystem::recalcAndRender() timing.
+    tMicrosFn clock = &systemMicros;
+
+    [[nodiscard]] uint8_t level() const noexcept {
+        return level_;
+    }
+
+    // Render divisor of the current level (1, 2, 4, ...).
+    [[nodiscard]] uint8_t divisor() const noexcept {
+        return static_cast<uint8_t>(1u << level_);
+    }
+
+    // Report the time of the last frame. Returns true when the level changed.
+    bool frameDone(uint32_t frameUs) {
+        if (targetFrameUs == 0) {
+            const bool changed = level_ != 0;
+            reset();
+            return changed;
+        }
+        if (sinceStepUp_ < UINT16_MAX) {
+            ++sinceStepUp_;
+        }
+        if (frameUs > targetFrameUs) {
+            fastCount_ = 0;
+            if (++slowCount_ < downFrames || level_ >= maxLevel) {
+                return false;
+            }
+            slowCount_ = 0;
+            if (sinceStepUp_ <= currentUpFrames()) {
+                backoff_ = (backoff_ < cMaxBackoff) ? static_cast<uint8_t>(backoff_ + 1) : backoff_;
+            }
+            sinceStepUp_ = UINT16_MAX;
+            ++level_;
+            return true;
+        }
+        slowCount_ = 0;
+        if (static_cast<uint64_t>(frameUs) * 100u >= static_cast<uint64_t>(targetFrameUs) * upPercent) {
+            fastCount_ = 0;
+            return false;
+        }
+        if (sinceStepUp_ != UINT16_MAX && sinceStepUp_ > currentUpFrames()) {
+            backoff_ = 0; // the last step up held
+            sinceStepUp_ = UINT16_MAX;
+        }
+        if (++fastCount_ < currentUpFrames() || level_ == 0) {
+            return false;
+        }
+        fastCount_ = 0;
+        sinceStepUp_ = 0;
+        --level_;
+        return true;
+    }
+
+    void reset() {
+        level_ = 0;
+        slowCount_ = 0;
+        fastCount_ = 0;
+        backoff_ = 0;
+        sinceStepUp_ = UINT16_MAX;
+    }
+
+private:
+    static constexpr uint8_t cMaxBackoff = 6;
+
+    uint8_t level_{0};
+    uint8_t slowCount_{0};
+    uint16_t fastCount_{0};
+    uint8_t backoff_{0};
+    // Frames since the last step up (UINT16_MAX: none pending).
+    uint16_t sinceStepUp_{UINT16_MAX};
+
+    [[nodiscard]] uint16_t currentUpFrames() const noexcept {
+        const uint32_t frames = static_cast<uint32_t>(upFrames) << backoff_;
+        return static_cast<uint16_t>((frames > cMaxUpFrames) ? cMaxUpFrames : frames);
+    }
+};
+
+} // namespace amp
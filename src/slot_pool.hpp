@@ -0,0 +1,133 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace amp {
+
+using ::uint8_t;
+using ::uint16_t;
+
+// Pool of up to 255 objects of type T addressed by a one-byte slot id.
+//
+// - Storage grows in fixed blocks of (1 << BlockShift) slots and never moves: a slot id (and a
+//   pointer to its object) stays valid until the slot is released. Blocks are freed by clear().
+// - acquire() and release() are O(1) (free list); acquire() returns a value-initialized T.
+// - Slot ids are reused: the lowest free ids of a new block come first, released ids are reused
+//   most-recent-first.
+template <typename T, uint8_t BlockShift = 3>
+class csSlotPool {
+public:
+    using tSlot = uint8_t;
+    static constexpr tSlot cInvalid = UINT8_MAX;
+    static constexpr uint8_t cBlockSize = static_cast<uint8_t>(1u << BlockShift);
+    // Slot UINT8_MAX is never handed out (it is cInvalid).
+    static constexpr uint8_t cMaxBlocks = static_cast<uint8_t>((UINT8_MAX + cBlockSize - 1u) >> BlockShift);
+
+    csSlotPool() = default;
+    csSlotPool(const csSlotPool&) = delete;
+    csSlotPool& operator=(const csSlotPool&) = delete;
+
+    ~csSlotPool() {
+        clear();
+    }
+
+    // Free slot id, or cInvalid when all 255 slots are used (or a block could not be allocated).
+    tSlot acquire() {
+        if (free_ == cInvalid && !grow()) {
+            return cInvalid;
+        }
+        const tSlot slot = free_;
+        Block& b = block(slot);
+        free_ = b.link[slot & cBlockMask];
+        b.items[slot & cBlockMask] = T{};
+        ++used_;
+        return slot;
+    }
+
+    void release(tSlot slot) {
+        if (slot == cInvalid || (slot >> BlockShift) >= blockCount_) {
+            return;
+        }
+        block(slot).link[slot & cBlockMask] = free_;
+        free_ = slot;
+        --used_;
+    }
+
+    // Object of an acquired slot.
+    T& operator[](tSlot slot) {
+        return block(slot).items[slot & cBlockMask];
+    }
+
+    const T& operator[](tSlot slot) const {
+        return block(slot).items[slot & cBlockMask];
+    }
+
+    // Slots currently acquired.
+    [[nodiscard]] uint8_t used() const noexcept {
+        return used_;
+    }
+
+    // Slots in allocated blocks (used + free).
+    [[nodiscard]] uint16_t capacity() const noexcept {
+        const uint16_t slots = static_cast<uint16_t>(blockCount_) << BlockShift;
+        return (slots > UINT8_MAX) ? UINT8_MAX : slots;
+    }
+
+    // Free every block. Objects are not destroyed individually: T must not own resources.
+    void clear() {
+        for (uint8_t i = 0; i < blockCount_; ++i) {
+            delete blocks_[i];
+            blocks_[i] = nullptr;
+        }
+        blockCount_ = 0;
+        free_ = cInvalid;
+        used_ = 0;
+    }
+
+private:
+    static constexpr uint8_t cBlockMask = static_cast<uint8_t>(cBlockSize - 1u);
+
+    struct Block {
+        T items[cBlockSize];
+        // Next free slot id (valid while the slot is free).
+        tSlot link[cBlockSize];
+    };
+
+    Block* blocks_[cMaxBlocks] = {};
+    uint8_t blockCount_{0};
+    tSlot free_{cInvalid};
+    uint8_t used_{0};
+
+    Block& block(tSlot slot) {
+        return *blocks_[slot >> BlockShift];
+    }
+
+    const Block& block(tSlot slot) const {
+        return *blocks_[slot >> BlockShift];
+    }
+
+    bool grow() {
+        if (blockCount_ >= cMaxBlocks) {
+            return false;
+        }
+        Block* b = new Block();
+        if (b == nullptr) {
+            return false; // Allocation failed
+        }
+        const uint16_t first = static_cast<uint16_t>(blockCount_) << BlockShift;
+        blocks_[blockCount_++] = b;
+        // Push in reverse so the lowest id is handed out first; never hand out cInvalid.
+        for (uint8_t i = cBlockSize; i-- > 0;) {
+            const uint16_t slot = static_cast<uint16_t>(first + i);
+            if (slot >= cInvalid) {
+                continue;
+            }
+            b->link[i] = free_;
+            free_ = static_cast<tSlot>(slot);
+        }
+        return true;
+    }
+};
+
+} // namespace amp
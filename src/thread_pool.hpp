@@ -0,0 +1,175 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Worker threads on host builds; Arduino targets run every task on the calling thread.
+// Define AMP_ENABLE_THREADS to 0 to force the single-threaded fallback everywhere.
+#ifndef AMP_ENABLE_THREADS
+#  if defined(ARDUINO)
+#    define AMP_ENABLE_THREADS 0
+#  else
+#    define AMP_ENABLE_THREADS 1
+#  endif
+#endif
+
+#if AMP_ENABLE_THREADS
+#  include <atomic>
+#  include <condition_variable>
+#  include <mutex>
+#  include <thread>
+#  include <vector>
+#endif
+
+namespace amp {
+
+using ::size_t;
+using ::uint8_t;
+using ::uint16_t;
+using ::uint32_t;
+
+// Fixed set of worker threads for fork/join loops: parallelFor(count, fn) runs fn(0..count-1) on
+// the workers and the calling thread, and returns when every index is done.
+//
+// - Indices are claimed one by one (dynamic balancing), so the order of calls is unspecified.
+// - One parallelFor() at a time: the pool is not reentrant and must be driven by one thread.
+// - Without threads (AMP_ENABLE_THREADS == 0) threadCount() is 1 and parallelFor() is a plain loop.
+class csThreadPool {
+public:
+    using tTaskFn = void (*)(void* ctx, uint16_t index);
+
+#if AMP_ENABLE_THREADS
+    // 'threads' includes the calling thread; 0 = one per hardware thread.
+    explicit csThreadPool(uint8_t threads = 0) {
+        uint32_t n = threads;
+        if (n == 0) {
+            n = std::thread::hardware_concurrency();
+            if (n == 0) {
+                n = 1;
+            } else if (n > UINT8_MAX) {
+                n = UINT8_MAX;
+            }
+        }
+        workers_.reserve(n - 1u);
+        for (uint32_t i = 1; i < n; ++i) {
+            workers_.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    csThreadPool(const csThreadPool&) = delete;
+    csThreadPool& operator=(const csThreadPool&) = delete;
+
+    ~csThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& t : workers_) {
+            t.join();
+        }
+    }
+
+    // Threads that run tasks, the calling thread included.
+    [[nodiscard]] uint8_t threadCount() const noexcept {
+        return static_cast<uint8_t>(workers_.size() + 1u);
+    }
+
+    void run(uint16_t count, tTaskFn fn, void* ctx) {
+        if (count == 0) {
+            return;
+        }
+        if (count == 1 || workers_.empty()) {
+            for (uint16_t i = 0; i < count; ++i) {
+                fn(ctx, i);
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            fn_ = fn;
+            ctx_ = ctx;
+            count_ = count;
+            next_.store(0, std::memory_order_relaxed);
+            busy_ = workers_.size();
+            ++generation_;
+        }
+        wake_.notify_all();
+        drain();
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return busy_ == 0; });
+    }
+#else
+    explicit csThreadPool(uint8_t threads = 0) {
+        (void)threads;
+    }
+
+    csThreadPool(const csThreadPool&) = delete;
+    csThreadPool& operator=(const csThreadPool&) = delete;
+
+    [[nodiscard]] uint8_t threadCount() const noexcept {
+        return 1;
+    }
+
+    void run(uint16_t count, tTaskFn fn, void* ctx) {
+        for (uint16_t i = 0; i < count; ++i) {
+            fn(ctx, i);
+        }
+    }
+#endif
+
+    // Call fn(index) for index 0..count-1; fn must be safe to run concurrently for distinct indices.
+    template <typename F>
+    void parallelFor(uint16_t count, const F& fn) {
+        run(count, [](void* ctx, uint16_t index) { (*static_cast<const F*>(ctx))(index); },
+            const_cast<void*>(static_cast<const void*>(&fn)));
+    }
+
+private:
+#if AMP_ENABLE_THREADS
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    tTaskFn fn_{nullptr};
+    void* ctx_{nullptr};
+    uint16_t count_{0};
+    std::atomic<uint32_t> next_{0};
+    size_t busy_{0};
+    uint32_t generation_{0};
+    bool stop_{false};
+
+    // Claim and run indices of the current job until none is left.
+    void drain() {
+        for (;;) {
+            const uint32_t i = next_.fetch_add(1, std::memory_order_relaxed);
+            if (i >= count_) {
+                return;
+            }
+            fn_(ctx_, static_cast<uint16_t>(i));
+        }
+    }
+
+    void workerLoop() {
+        uint32_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+            }
+            drain();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --busy_;
+            }
+            done_.notify_one();
+        }
+    }
+#endif
+};
+
+} // namespace amp
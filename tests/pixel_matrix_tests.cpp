@@ -1,12 +1,26 @@
+#include <chrono>
 #include <iostream>
+#include <thread>
 #include <cmath>
+#include <cstdlib>
+#include "../src/effect_manager.hpp"
+#include "../src/matrix_sfx_system.hpp"
+#include "../src/matrix_boolean.hpp"
+#include "../src/matrix_buffer_pool.hpp"
 #include "../src/matrix_bytes.hpp"
 #include "../src/matrix_pixels.hpp"
+#include "../src/matrix_pixels_premul.hpp"
+#include "../src/matrix_pixels16.hpp"
+#include "../src/matrix_rgb.hpp"
+#include "../src/matrix_views.hpp"
+#include "../src/render_efffects.hpp"
 #include "../src/render_pipes.hpp"
+#include "../src/resolution_governor.hpp"
 
 using amp::csColorRGBA;
 using amp::csMatrixBytes;
 using amp::csMatrixPixels;
+using amp::csMatrixPixelsPremul;
 using amp::tMatrixPixelsSize;
 using amp::to_coord;
 using namespace amp::math;
@@ -248,6 +262,409 @@ void test_matrix_drawMatrix_basic(TestStats& stats) {
     expect_true(stats, testName, __LINE__, colorEq(dst.getPixel(1, 0), expected10.a, expected10.r, expected10.g, expected10.b), "drawMatrix fills empty dst");
 }
 
+// Forwarding matrix without row-span access: drives matrix_utils through the per-pixel fallback.
+class csMatrixNoSpans : public amp::csMatrixBase {
+public:
+    explicit csMatrixNoSpans(amp::csMatrixBase& m) : m_(m) {}
+    tMatrixPixelsSize width() const noexcept override { return m_.width(); }
+    tMatrixPixelsSize height() const noexcept override { return m_.height(); }
+    csColorRGBA getPixel(amp::tMatrixPixelsCoord x, amp::tMatrixPixelsCoord y) const noexcept override { return m_.getPixel(x, y); }
+    void setPixelRewrite(amp::tMatrixPixelsCoord x, amp::tMatrixPixelsCoord y, csColorRGBA c) noexcept override { m_.setPixelRewrite(x, y, c); }
+    void setPixel(amp::tMatrixPixelsCoord x, amp::tMatrixPixelsCoord y, csColorRGBA c) noexcept override { m_.setPixel(x, y, c); }
+private:
+    amp::csMatrixBase& m_;
+};
+
+inline void fillPattern(csMatrixPixels& m, uint8_t seed) {
+    for (tMatrixPixelsSize y = 0; y < m.height(); ++y) {
+        for (tMatrixPixelsSize x = 0; x < m.width(); ++x) {
+            const uint8_t v = static_cast<uint8_t>(seed + x * 37 + y * 91);
+            m.setPixelRewrite(to_coord(x), to_coord(y), csColorRGBA{static_cast<uint8_t>(v * 3), v, static_cast<uint8_t>(v ^ 0x5A), static_cast<uint8_t>(255 - v)});
+        }
+    }
+}
+
+inline bool matricesEqual(const csMatrixPixels& a, const csMatrixPixels& b) {
+    if (a.width() != b.width() || a.height() != b.height()) {
+        return false;
+    }
+    for (tMatrixPixelsSize y = 0; y < a.height(); ++y) {
+        for (tMatrixPixelsSize x = 0; x < a.width(); ++x) {
+            if (a.getPixel(to_coord(x), to_coord(y)).value != b.getPixel(to_coord(x), to_coord(y)).value) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void test_matrix_getScanLine(TestStats& stats) {
+    const char* testName = "matrix_getScanLine";
+    csMatrixPixels m{5, 3};
+    m.setPixelRewrite(3, 1, csColorRGBA{1, 2, 3, 4});
+    csColorRGBA* line = nullptr;
+    tMatrixPixelsSize len = 0;
+    const bool ok = m.getScanLine(amp::csRect{2, 1, 10, 2}, 1, 0, line, len);
+    expect_true(stats, testName, __LINE__, ok && len == 2, "span clipped to matrix width");
+    expect_true(stats, testName, __LINE__, ok && colorEq(line[0], 1, 2, 3, 4), "span starts at area + offset");
+    line[1] = csColorRGBA{9, 9, 9, 9};
+    expect_true(stats, testName, __LINE__, colorEq(m.getPixel(4, 1), 9, 9, 9, 9), "writes through span reach matrix");
+    expect_true(stats, testName, __LINE__, !m.getScanLine(amp::csRect{0, 0, 2, 2}, 2, 0, line, len), "offset beyond area fails");
+    expect_true(stats, testName, __LINE__, !m.getScanLine(amp::csRect{-1, 0, 4, 1}, 0, 0, line, len), "start outside matrix fails");
+    const amp::csMatrixBase& base = m;
+    const csColorRGBA* cline = nullptr;
+    expect_true(stats, testName, __LINE__, base.getScanLine(base.getRect(), 0, 2, cline, len) && len == 5, "const span covers full row");
+}
+
+void test_matrix_utils_spans_match_fallback(TestStats& stats) {
+    const char* testName = "matrix_utils_spans_match_fallback";
+    using namespace amp::matrix_utils;
+    csMatrixPixels src{7, 5};
+    fillPattern(src, 11);
+    csMatrixPixels fast{9, 6};
+    csMatrixPixels slow{9, 6};
+    fillPattern(fast, 200);
+    fillPattern(slow, 200);
+    csMatrixNoSpans slowDst{slow};
+    csMatrixNoSpans slowSrc{src};
+
+    drawMatrix(fast, -2, 3, src, 180);
+    drawMatrix(slowDst, -2, 3, slowSrc, 180);
+    expect_true(stats, testName, __LINE__, matricesEqual(fast, slow), "drawMatrix span path matches per-pixel");
+
+    drawMatrixArea(fast, amp::csRect{1, 1, 5, 3}, 6, -1, src, 90);
+    drawMatrixArea(slowDst, amp::csRect{1, 1, 5, 3}, 6, -1, slowSrc, 90);
+    expect_true(stats, testName, __LINE__, matricesEqual(fast, slow), "drawMatrixArea span path matches per-pixel");
+
+    drawMatrixAreaRewrite(fast, amp::csRect{0, 2, 4, 4}, 2, 2, src);
+    drawMatrixAreaRewrite(slowDst, amp::csRect{0, 2, 4, 4}, 2, 2, slowSrc);
+    expect_true(stats, testName, __LINE__, matricesEqual(fast, slow), "drawMatrixAreaRewrite span path matches per-pixel");
+
+    fillArea(fast, amp::csRect{-3, 4, 20, 9}, csColorRGBA{77, 10, 200, 30});
+    fillArea(slowDst, amp::csRect{-3, 4, 20, 9}, csColorRGBA{77, 10, 200, 30});
+    expect_true(stats, testName, __LINE__, matricesEqual(fast, slow), "fillArea span path matches per-pixel");
+
+    expect_true(stats, testName, __LINE__, drawMatrixScale(fast, amp::csRect{1, 0, 5, 4}, amp::csRect{-1, 1, 11, 7}, src) &&
+                                           drawMatrixScale(slowDst, amp::csRect{1, 0, 5, 4}, amp::csRect{-1, 1, 11, 7}, slowSrc),
+                "drawMatrixScale accepts both");
+    expect_true(stats, testName, __LINE__, matricesEqual(fast, slow), "drawMatrixScale span path matches per-pixel");
+
+    const csColorRGBA avgFast = getAreaColor(fast, amp::csRect{1, 1, 8, 4});
+    const csColorRGBA avgSlow = getAreaColor(slowDst, amp::csRect{1, 1, 8, 4});
+    expect_true(stats, testName, __LINE__, avgFast.value == avgSlow.value, "getAreaColor span path matches per-pixel");
+}
+
+void test_blend_row_matches_scalar(TestStats& stats) {
+    const char* testName = "blend_row_matches_scalar";
+    // Odd length exercises SIMD body and scalar tail.
+    static constexpr size_t n = 67;
+    csColorRGBA under[n];
+    csColorRGBA over[n];
+    csColorRGBA out[n];
+    uint32_t seed = 12345u;
+    const uint8_t globalAlphas[] = {255, 0, 1, 16, 128, 254};
+    for (const uint8_t ga : globalAlphas) {
+        bool allEqual = true;
+        for (int round = 0; round < 64; ++round) {
+            for (size_t i = 0; i < n; ++i) {
+                seed = seed * 1664525u + 1013904223u;
+                under[i].value = seed;
+                seed = seed * 1664525u + 1013904223u;
+                over[i].value = seed;
+                // Mix in opaque and transparent runs (opaque fast path, zero alpha).
+                if (round % 4 == 1) {
+                    over[i].a = 255;
+                } else if (round % 4 == 2 && (i % 3) == 0) {
+                    over[i].a = 0;
+                    under[i].a = 0;
+                }
+            }
+            amp::blendRowTo(out, under, over, n, ga);
+            for (size_t i = 0; i < n; ++i) {
+                allEqual = allEqual && out[i].value == csColorRGBA::sourceOverStraight(under[i], over[i], ga).value;
+            }
+            amp::blendRow(under, over, n, ga);
+            for (size_t i = 0; i < n; ++i) {
+                allEqual = allEqual && under[i].value == out[i].value;
+            }
+        }
+        expect_true(stats, testName, __LINE__, allEqual, "blendRow is bit-exact with sourceOverStraight");
+    }
+}
+
+inline bool colorNear(const csColorRGBA& a, const csColorRGBA& b, int tol) {
+    const int da = static_cast<int>(a.a) - static_cast<int>(b.a);
+    const int dr = static_cast<int>(a.r) - static_cast<int>(b.r);
+    const int dg = static_cast<int>(a.g) - static_cast<int>(b.g);
+    const int db = static_cast<int>(a.b) - static_cast<int>(b.b);
+    return std::abs(da) <= tol && std::abs(dr) <= tol && std::abs(dg) <= tol && std::abs(db) <= tol;
+}
+
+void test_matrix_premul_blend(TestStats& stats) {
+    const char* testName = "matrix_premul_blend";
+    csMatrixPixelsPremul m{2, 1};
+    expect_true(stats, testName, __LINE__, m.pixelFormat() == amp::csPixelFormat::ARGB8Premul, "reports premultiplied format");
+    m.setPixelRewrite(0, 0, csColorRGBA{255, 10, 200, 30});
+    expect_true(stats, testName, __LINE__, colorEq(m.getPixel(0, 0), 255, 10, 200, 30), "opaque round-trip is exact");
+    m.setPixel(0, 0, csColorRGBA{128, 250, 0, 100});
+    const csColorRGBA straight = csColorRGBA::sourceOverStraight(csColorRGBA{255, 10, 200, 30}, csColorRGBA{128, 250, 0, 100});
+    expect_true(stats, testName, __LINE__, colorNear(m.getPixel(0, 0), straight, 1), "premul blend over opaque matches straight blend");
+    m.setPixel(1, 0, csColorRGBA{0, 1, 2, 3});
+    expect_true(stats, testName, __LINE__, colorEq(m.getPixel(1, 0), 0, 0, 0, 0), "transparent over empty stays empty");
+    csColorRGBA* line = nullptr;
+    tMatrixPixelsSize len = 0;
+    expect_true(stats, testName, __LINE__, !m.getScanLine(m.getRect(), 0, 0, line, len), "no straight-alpha spans");
+}
+
+void test_matrix_premul_conversion(TestStats& stats) {
+    const char* testName = "matrix_premul_conversion";
+    csMatrixPixels src{6, 4};
+    fillPattern(src, 3);
+    csMatrixPixelsPremul premul{1, 1};
+    premul.copyFrom(src);
+    const csColorRGBA* line = nullptr;
+    tMatrixPixelsSize len = 0;
+    const bool ok = premul.getScanLinePremul(premul.getRect(), 0, 2, line, len);
+    const csColorRGBA expected = src.getPixel(4, 2).toPremul();
+    expect_true(stats, testName, __LINE__, ok && len == 6 && line[4].value == expected.value, "copyFrom stores premultiplied rows");
+
+    csMatrixPixels back{1, 1};
+    premul.copyTo(back);
+    bool allNear = back.width() == 6 && back.height() == 4;
+    for (tMatrixPixelsSize y = 0; y < 4; ++y) {
+        for (tMatrixPixelsSize x = 0; x < 6; ++x) {
+            const csColorRGBA orig = src.getPixel(to_coord(x), to_coord(y));
+            const csColorRGBA got = back.getPixel(to_coord(x), to_coord(y));
+            allNear = allNear && got.value == orig.toPremul().fromPremul().value;
+        }
+    }
+    expect_true(stats, testName, __LINE__, allNear, "copyTo un-premultiplies each pixel");
+
+    // Row path (setPixelsRow) matches per-pixel setPixel on premultiplied target.
+    csMatrixPixelsPremul fast{5, 5};
+    csMatrixPixelsPremul slow{5, 5};
+    csMatrixNoSpans slowDst{slow};
+    drawMatrix(fast, 1, -1, src, 170);
+    drawMatrix(slowDst, 1, -1, src, 170);
+    expect_true(stats, testName, __LINE__, matricesEqual(fast, slow), "drawMatrix row path matches per-pixel on premul");
+}
+
+void test_matrix_utils_typed_sources(TestStats& stats) {
+    const char* testName = "matrix_utils_typed_sources";
+    using namespace amp::matrix_utils;
+    amp::csMatrixBytes bytes{40, 3};
+    amp::csMatrixBoolean bits{40, 3};
+    for (tMatrixPixelsSize y = 0; y < 3; ++y) {
+        for (tMatrixPixelsSize x = 0; x < 40; ++x) {
+            bytes.setValue(to_coord(x), to_coord(y), static_cast<uint8_t>(x * 13 + y * 7));
+            bits.setValue(to_coord(x), to_coord(y), ((x * 5 + y) % 3) == 0);
+        }
+    }
+    csMatrixNoSpans genericBytes{bytes};
+    csMatrixNoSpans genericBits{bits};
+
+    csMatrixPixels fast{38, 4};
+    csMatrixPixels slow{38, 4};
+    fillPattern(fast, 50);
+    fillPattern(slow, 50);
+    drawMatrix(fast, -1, 1, bytes, 140);
+    drawMatrix(slow, -1, 1, genericBytes, 140);
+    expect_true(stats, testName, __LINE__, matricesEqual(fast, slow), "bytes -> pixels matches generic path");
+
+    drawMatrixArea(fast, amp::csRect{2, 0, 36, 3}, 0, 0, bits, 200);
+    drawMatrixArea(slow, amp::csRect{2, 0, 36, 3}, 0, 0, genericBits, 200);
+    expect_true(stats, testName, __LINE__, matricesEqual(fast, slow), "boolean -> pixels matches generic path");
+
+    drawMatrixAreaRewrite(fast, amp::csRect{0, 1, 40, 2}, 3, 2, bytes);
+    drawMatrixAreaRewrite(slow, amp::csRect{0, 1, 40, 2}, 3, 2, genericBytes);
+    expect_true(stats, testName, __LINE__, matricesEqual(fast, slow), "bytes -> pixels rewrite matches generic path");
+
+    const csColorRGBA avgFast = getAreaColor(bits, amp::csRect{0, 0, 40, 3});
+    const csColorRGBA avgSlow = getAreaColor(genericBits, amp::csRect{0, 0, 40, 3});
+    expect_true(stats, testName, __LINE__, avgFast.value == avgSlow.value, "getAreaColor on boolean matches generic path");
+}
+
+bool rectEquals(const amp::csRect& a, const amp::csRect& b) {
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+void test_matrix_tiled_layout(TestStats& stats) {
+    const char* testName = "matrix_tiled_layout";
+    using amp::csMatrixLayout;
+    using namespace amp::matrix_utils;
+    csMatrixPixels src{19, 11};
+    fillPattern(src, 70);
+    csMatrixPixels rows{21, 13};
+    csMatrixPixels tiles{21, 13, csMatrixLayout::Tiled8x8};
+    expect_true(stats, testName, __LINE__, tiles.layout() == csMatrixLayout::Tiled8x8, "layout selected at construction");
+
+    tiles.setDirtyTracking(true);
+    for (csMatrixPixels* m : {&rows, &tiles}) {
+        fillPattern(*m, 5);
+        drawMatrix(*m, 3, -2, src, 170);
+        fillArea(*m, amp::csRect{6, 4, 11, 3}, csColorRGBA{120, 10, 200, 30});
+        drawMatrixAreaRewrite(*m, amp::csRect{2, 2, 12, 5}, 9, 8, src);
+        (void)drawMatrixScale(*m, amp::csRect{0, 0, 19, 11}, amp::csRect{1, 1, 9, 6}, src);
+    }
+    expect_true(stats, testName, __LINE__, matricesEqual(rows, tiles), "tiled matrix matches row-major results");
+
+    csColorRGBA* line = nullptr;
+    tMatrixPixelsSize len = 0;
+    const bool ok = tiles.getScanLine(tiles.getRect(), 5, 9, line, len);
+    expect_true(stats, testName, __LINE__, ok && len == 3 && line[0].value == tiles.getPixel(5, 9).value,
+                "span ends at tile boundary");
+    expect_true(stats, testName, __LINE__, tiles.rowAlpha(12) == rows.rowAlpha(12), "row alpha over tile runs");
+
+    tiles.commitDirtyFrame();
+    tiles.setPixelRewrite(20, 12, csColorRGBA{255, 1, 1, 1});
+    tiles.commitDirtyFrame();
+    expect_true(stats, testName, __LINE__, rectEquals(tiles.dirtyRect(), amp::csRect{16, 8, 5, 5}), "dirty tiles hash tiled storage");
+
+    csMatrixPixelsPremul premul{1, 1, csMatrixLayout::Tiled8x8};
+    premul.copyFrom(rows);
+    csMatrixPixels back{1, 1, csMatrixLayout::Tiled8x8};
+    premul.copyTo(back);
+    csMatrixPixels backRows{1, 1};
+    csMatrixPixelsPremul premulRows{1, 1};
+    premulRows.copyFrom(rows);
+    premulRows.copyTo(backRows);
+    expect_true(stats, testName, __LINE__, matricesEqual(back, backRows), "premul round trip is layout independent");
+
+    csMatrixBytes bytesRows{13, 10};
+    csMatrixBytes bytesTiles{13, 10, 0, csMatrixLayout::Tiled8x8};
+    for (amp::tMatrixPixelsCoord y = 0; y < 10; ++y) {
+        for (amp::tMatrixPixelsCoord x = 0; x < 13; ++x) {
+            bytesRows.setValue(x, y, static_cast<uint8_t>(x * 11 + y * 5));
+            bytesTiles.setValue(x, y, static_cast<uint8_t>(x * 11 + y * 5));
+        }
+    }
+    csMatrixPixels fromRows{14, 10};
+    csMatrixPixels fromTiles{14, 10};
+    drawMatrix(fromRows, 1, 0, bytesRows, 200);
+    drawMatrix(fromTiles, 1, 0, bytesTiles, 200);
+    expect_true(stats, testName, __LINE__, matricesEqual(fromRows, fromTiles), "tiled byte matrix reads like row-major");
+}
+
+void test_mul8_div255_exhaustive(TestStats& stats) {
+    const char* testName = "mul8_div255_exhaustive";
+    int mul8Mismatch = 0;
+    int div255Mismatch = 0;
+    for (uint32_t a = 0; a < 256; ++a) {
+        for (uint32_t b = 0; b < 256; ++b) {
+            mul8Mismatch += amp::mul8(uint8_t(a), uint8_t(b)) != amp::mul8_ref(uint8_t(a), uint8_t(b));
+            div255Mismatch += amp::div255(uint16_t(b), uint8_t(a)) != amp::div255_ref(uint16_t(b), uint8_t(a));
+        }
+    }
+    expect_true(stats, testName, __LINE__, mul8Mismatch == 0, "mul8 matches division form for all pairs");
+    expect_true(stats, testName, __LINE__, div255Mismatch == 0, "div255 matches division form for all pairs");
+    expect_true(stats, testName, __LINE__, amp::div255(1000, 200) == amp::div255_ref(1000, 200), "div255 above 255 falls back");
+}
+
+void test_matrix_row_alpha(TestStats& stats) {
+    const char* testName = "matrix_row_alpha";
+    using amp::csRowAlpha;
+    using namespace amp::matrix_utils;
+    csMatrixPixels layer{12, 4};
+    expect_true(stats, testName, __LINE__, layer.rowAlpha(0) == csRowAlpha::Transparent, "new matrix rows are transparent");
+    fillArea(layer, amp::csRect{0, 0, 12, 1}, csColorRGBA{255, 9, 8, 7});
+    layer.setPixel(3, 1, csColorRGBA{128, 1, 2, 3});
+    layer.setPixelRewrite(5, 2, csColorRGBA{0, 4, 5, 6});
+    expect_true(stats, testName, __LINE__, layer.rowAlpha(0) == csRowAlpha::Opaque, "filled row is opaque");
+    expect_true(stats, testName, __LINE__, layer.rowAlpha(1) == csRowAlpha::Mixed, "half-transparent pixel makes row mixed");
+    expect_true(stats, testName, __LINE__, layer.rowAlpha(2) == csRowAlpha::Mixed, "a=0 with color is not transparent black");
+    expect_true(stats, testName, __LINE__, layer.rowAlpha(3) == csRowAlpha::Transparent, "untouched row stays transparent");
+    expect_true(stats, testName, __LINE__, layer.rowAlpha(4) == csRowAlpha::Mixed, "row outside matrix is mixed");
+    csMatrixPixels edited{layer};
+    edited.setPixelRewrite(0, 0, csColorRGBA{254, 9, 8, 7});
+    expect_true(stats, testName, __LINE__, edited.rowAlpha(0) == csRowAlpha::Mixed, "write resets cached class");
+
+    // A view's cache goes stale when the parent is written directly: copies must not inherit it.
+    csMatrixPixels parent{12, 4};
+    amp::csMatrixSubView view{parent, amp::csRect{2, 1, 6, 2}};
+    expect_true(stats, testName, __LINE__, view.rowAlpha(0) == csRowAlpha::Transparent, "view row transparent");
+    parent.setPixel(4, 1, csColorRGBA{255, 1, 2, 3});
+    csMatrixPixels viewCopy = view;
+    csMatrixPixels assigned{6, 2};
+    assigned = view;
+    expect_true(stats, testName, __LINE__,
+                viewCopy.rowAlpha(0) == csRowAlpha::Mixed && assigned.rowAlpha(0) == csRowAlpha::Mixed,
+                "copy of a view rescans its rows");
+    csMatrixPixels drawn{6, 2};
+    drawMatrix(drawn, 0, 0, viewCopy);
+    expect_true(stats, testName, __LINE__, drawn.getPixel(2, 0).value == csColorRGBA{255, 1, 2, 3}.value,
+                "pixel written through the parent is drawn from the copy");
+
+    // Fast paths must match the generic per-pixel blend for every destination row class
+    // (rows: 0 mixed, 1 opaque, 2 mixed, 3 transparent black).
+    csMatrixNoSpans genericLayer{layer};
+    for (uint8_t alpha : {uint8_t{255}, uint8_t{100}, uint8_t{0}}) {
+        csMatrixPixels fast{14, 4};
+        fillPattern(fast, 60);
+        fillArea(fast, amp::csRect{0, 1, 14, 1}, csColorRGBA{255, 40, 50, 60});
+        for (amp::tMatrixPixelsCoord x = 0; x < 14; ++x) {
+            fast.setPixelRewrite(x, 3, csColorRGBA{0, 0, 0, 0});
+        }
+        csMatrixPixels slow{fast};
+        csMatrixNoSpans genericSlow{slow};
+        drawMatrix(fast, 1, 0, layer, alpha);
+        drawMatrix(genericSlow, 1, 0, genericLayer, alpha);
+        expect_true(stats, testName, __LINE__, matricesEqual(fast, slow), "classified rows match generic blend");
+
+        csMatrixPixelsPremul premulFast{14, 4};
+        csMatrixPixelsPremul premulSlow{14, 4};
+        premulFast.copyFrom(slow);
+        premulSlow.copyFrom(slow);
+        drawMatrix(premulFast, -1, 0, layer, alpha);
+        csMatrixNoSpans genericPremulSlow{premulSlow};
+        drawMatrix(genericPremulSlow, -1, 0, genericLayer, alpha);
+        expect_true(stats, testName, __LINE__, matricesEqual(premulFast, premulSlow), "premul destination matches generic blend");
+    }
+}
+
+void test_matrix_dirty_tiles(TestStats& stats) {
+    const char* testName = "matrix_dirty_tiles";
+    using namespace amp::matrix_utils;
+    csMatrixPixels m{20, 12};
+    expect_true(stats, testName, __LINE__, m.dirtyTiles() == nullptr, "tracking disabled by default");
+    expect_true(stats, testName, __LINE__, rectEquals(m.dirtyRect(), m.getRect()), "untracked matrix reports full rect");
+
+    m.setDirtyTracking(true);
+    auto renderFrame = [&m](csColorRGBA color) {
+        m.clear();
+        fillArea(m, amp::csRect{2, 2, 5, 3}, color);
+        m.commitDirtyFrame();
+    };
+    renderFrame(csColorRGBA{255, 10, 20, 30});
+    expect_true(stats, testName, __LINE__, rectEquals(m.dirtyRect(), m.getRect()), "first commit reports every tile");
+
+    renderFrame(csColorRGBA{255, 10, 20, 30});
+    expect_true(stats, testName, __LINE__, m.dirtyRect().empty(), "same picture after clear: nothing changed");
+
+    renderFrame(csColorRGBA{255, 10, 20, 31});
+    expect_true(stats, testName, __LINE__, rectEquals(m.dirtyRect(), amp::csRect{0, 0, 8, 8}), "changed fill: one tile");
+
+    m.setPixel(17, 9, csColorRGBA{255, 1, 2, 3});
+    m.commitDirtyFrame();
+    const amp::csDirtyTiles* dirty = m.dirtyTiles();
+    expect_true(stats, testName, __LINE__, dirty->tileChanged(2, 1) && !dirty->tileChanged(0, 0),
+                "single pixel marks only its tile");
+    expect_true(stats, testName, __LINE__, rectEquals(m.dirtyRect(), amp::csRect{16, 8, 4, 4}), "edge tile clipped to matrix");
+
+    m.setPixel(17, 9, csColorRGBA{0, 0, 0, 0});
+    m.commitDirtyFrame();
+    expect_true(stats, testName, __LINE__, m.dirtyRect().empty(), "no-op write is not reported");
+
+    // A hash collision cannot keep a tile stale: every n-th commit reports the whole matrix.
+    m.setDirtyTracking(true, 3);
+    m.commitDirtyFrame();
+    m.commitDirtyFrame();
+    expect_true(stats, testName, __LINE__, m.dirtyRect().empty(), "static frames before the refresh");
+    m.commitDirtyFrame();
+    expect_true(stats, testName, __LINE__, rectEquals(m.dirtyRect(), m.getRect()), "periodic full refresh");
+    m.commitDirtyFrame();
+    expect_true(stats, testName, __LINE__, m.dirtyRect().empty(), "refresh does not repeat the next frame");
+}
+
 void test_fp16_basic(TestStats& stats) {
     using namespace amp::math;
     const char* testName = "fp16_basic";
@@ -846,6 +1263,1569 @@ void test_matrix_bytes_clear_resize(TestStats& stats) {
     expect_eq_int(stats, testName, __LINE__, m.getValue(0, 0), 0, "resize clears content");
 }
 
+void test_matrix_boolean_words(TestStats& stats) {
+    const char* testName = "matrix_boolean_words";
+    using amp::csMatrixBoolean;
+    using amp::tMatrixPixelsCoord;
+    static constexpr int maxW = 70;
+    static constexpr int maxH = 7;
+    uint32_t seed = 99u;
+    auto next = [&]() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 16;
+    };
+    auto randomize = [&](csMatrixBoolean& m, bool ref[maxH][maxW]) {
+        for (int y = 0; y < static_cast<int>(m.height()); ++y) {
+            for (int x = 0; x < static_cast<int>(m.width()); ++x) {
+                ref[y][x] = (next() % 3) == 0;
+                m.setValue(to_coord(x), to_coord(y), ref[y][x]);
+            }
+        }
+    };
+    auto same = [&](const csMatrixBoolean& m, bool ref[maxH][maxW]) {
+        for (int y = 0; y < static_cast<int>(m.height()); ++y) {
+            for (int x = 0; x < static_cast<int>(m.width()); ++x) {
+                if (m.getValue(to_coord(x), to_coord(y)) != ref[y][x]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    // Odd widths (unaligned rows spanning words), exact word width and byte-aligned rows.
+    const int sizes[][2] = {{13, 7}, {64, 3}, {70, 4}, {8, 5}, {1, 6}};
+    bool opsOk = true;
+    bool shiftOk = true;
+    bool countOk = true;
+    bool findOk = true;
+    bool rowOk = true;
+    bool refA[maxH][maxW];
+    bool refB[maxH][maxW];
+    for (const auto& sz : sizes) {
+        const int w = sz[0];
+        const int h = sz[1];
+        csMatrixBoolean a(static_cast<tMatrixPixelsSize>(w), static_cast<tMatrixPixelsSize>(h));
+        csMatrixBoolean b(static_cast<tMatrixPixelsSize>(w), static_cast<tMatrixPixelsSize>(h));
+        for (int op = 0; op < 4; ++op) {
+            randomize(a, refA);
+            randomize(b, refB);
+            switch (op) {
+                case 0: a.andWith(b); break;
+                case 1: a.orWith(b); break;
+                case 2: a.xorWith(b); break;
+                default: a.invert(); break;
+            }
+            for (int y = 0; y < h; ++y) {
+                for (int x = 0; x < w; ++x) {
+                    const bool p = refA[y][x];
+                    const bool q = refB[y][x];
+                    refA[y][x] = (op == 0) ? (p && q) : (op == 1) ? (p || q) : (op == 2) ? (p != q) : !p;
+                }
+            }
+            opsOk = opsOk && same(a, refA);
+        }
+
+        const int shifts[] = {1, 2, -1, -3, h, -h - 1};
+        for (const int dy : shifts) {
+            randomize(a, refA);
+            const bool fill = (dy % 2) != 0;
+            a.shiftRows(to_coord(dy), fill);
+            bool ok = true;
+            for (int y = 0; y < h; ++y) {
+                const int sy = y - dy;
+                for (int x = 0; x < w; ++x) {
+                    const bool expected = (sy >= 0 && sy < h) ? refA[sy][x] : fill;
+                    ok = ok && a.getValue(to_coord(x), to_coord(y)) == expected;
+                }
+            }
+            shiftOk = shiftOk && ok;
+        }
+
+        randomize(a, refA);
+        size_t total = 0;
+        size_t inRect = 0;
+        const amp::csRect area{1, 1, static_cast<tMatrixPixelsSize>(w), 2};
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                total += refA[y][x] ? 1u : 0u;
+                inRect += (refA[y][x] && x >= 1 && y >= 1 && y < 3) ? 1u : 0u;
+            }
+            for (int from = 0; from <= w; from += 3) {
+                int expected = -1;
+                for (int x = from; x < w; ++x) {
+                    if (refA[y][x]) {
+                        expected = x;
+                        break;
+                    }
+                }
+                findOk = findOk && a.findFirstSet(to_coord(y), to_coord(from)) == expected;
+            }
+        }
+        countOk = countOk && a.countOnes() == total && a.countOnes(area) == inRect;
+
+        b = a;
+        rowOk = rowOk && b.rowEqual(to_coord(h - 1), a, to_coord(h - 1));
+        b.setValue(to_coord(w - 1), to_coord(h - 1), !refA[h - 1][w - 1]);
+        rowOk = rowOk && !b.rowEqual(to_coord(h - 1), a, to_coord(h - 1));
+    }
+    expect_true(stats, testName, __LINE__, opsOk, "and/or/xor/invert match per-bit reference");
+    expect_true(stats, testName, __LINE__, shiftOk, "shiftRows moves rows and fills vacated ones");
+    expect_true(stats, testName, __LINE__, countOk, "countOnes matches per-bit count");
+    expect_true(stats, testName, __LINE__, findOk, "findFirstSet matches per-bit scan");
+    expect_true(stats, testName, __LINE__, rowOk, "rowEqual compares whole rows");
+
+    // Strided view: word ops touch only the view bits, never the bits between its rows.
+    uint8_t bits[8];
+    for (uint8_t& v : bits) {
+        v = 0xA5;
+    }
+    amp::csMatrixBooleanView view{bits, 11, 4, 15};
+    const uint8_t before = bits[1];
+    view.invert();
+    view.shiftRows(1, true);
+    bool gapsKept = true;
+    for (size_t y = 0; y < 4; ++y) {
+        for (size_t k = y * 15 + 11; k < y * 15 + 15 && k < 64; ++k) {
+            gapsKept = gapsKept && ((bits[k / 8] >> (k % 8)) & 1u) == ((0xA5u >> (k % 8)) & 1u);
+        }
+    }
+    expect_true(stats, testName, __LINE__, gapsKept && bits[1] != before, "strided view keeps gap bits");
+    expect_true(stats, testName, __LINE__, view.countOnes(amp::csRect{0, 0, 11, 1}) == 11, "shifted-in row is filled");
+
+    // Snowfall draws its pile by jumping between set bits.
+    csMatrixPixels canvas(12, 6);
+    amp::csRenderSnowfall snow;
+    snow.count = 0;
+    snow.propChanged(amp::csRenderSnowfall::propCount);
+    snow.rectDest = amp::csRect{2, 1, 9, 4};
+    snow.renderRectAutosize = false;
+    snow.setMatrix(canvas);
+    snow.propChanged(amp::csRenderSnowfall::propRectDest);
+    snow.bitmap->setValue(0, 0, true);
+    snow.bitmap->setValue(8, 3, true);
+    snow.bitmap->setValue(5, 3, true);
+    amp::csRandGen rand;
+    snow.render(rand, 0);
+    size_t lit = 0;
+    for (tMatrixPixelsCoord y = 0; y < 6; ++y) {
+        for (tMatrixPixelsCoord x = 0; x < 12; ++x) {
+            lit += canvas.getPixel(x, y).a != 0 ? 1u : 0u;
+        }
+    }
+    expect_true(stats, testName, __LINE__,
+                lit == 3 && canvas.getPixel(2, 1).a == 255 && canvas.getPixel(10, 4).a == 255 &&
+                    canvas.getPixel(7, 4).a == 255,
+                "snowfall renders exactly the pile bits");
+}
+
+void test_byte_row_kernels(TestStats& stats) {
+    const char* testName = "byte_row_kernels";
+    using amp::csByteKernel;
+    using amp::csEdgeMode;
+    static constexpr int n = 83;
+    uint8_t src[n];
+    uint8_t far[n];
+    uint8_t dst[n];
+    uint32_t seed = 31337u;
+    auto next = [&]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<uint8_t>(seed >> 24);
+    };
+    auto at = [&](const uint8_t* row, int i, int len, csEdgeMode edge) -> uint32_t {
+        if (i >= 0 && i < len) {
+            return row[i];
+        }
+        return edge == csEdgeMode::Zero ? 0u : row[i < 0 ? 0 : len - 1];
+    };
+    auto ref = [](uint32_t sum, uint32_t div) { return static_cast<uint8_t>(sum / div > 255u ? 255u : sum / div); };
+
+    // Horizontal 3 / 5 taps: SIMD-exact kernels and kernels that fall back to scalar division.
+    const csByteKernel<3> k3[] = {amp::cByteKernelBlur3, {{1, 1, 1}, 3}, {{60, 70, 125}, 7}, {{2, 4, 2}, 1}};
+    const csByteKernel<5> k5[] = {amp::cByteKernelBlur5, {{1, 1, 1, 1, 1}, 5}, {{9, 30, 50, 30, 9}, 11}};
+    const int lengths[] = {n, 1, 2, 4, 17, 40};
+    bool rowOk = true;
+    for (const int len : lengths) {
+        for (int i = 0; i < n; ++i) {
+            src[i] = next();
+        }
+        for (const csEdgeMode edge : {csEdgeMode::Zero, csEdgeMode::Clamp}) {
+            for (const auto& k : k3) {
+                amp::convolveRow<3>(dst, src, static_cast<size_t>(len), k, edge);
+                for (int x = 0; x < len; ++x) {
+                    uint32_t sum = 0;
+                    for (int t = 0; t < 3; ++t) {
+                        sum += k.w[t] * at(src, x - 1 + t, len, edge);
+                    }
+                    rowOk = rowOk && dst[x] == ref(sum, k.div);
+                }
+            }
+            for (const auto& k : k5) {
+                amp::convolveRow<5>(dst, src, static_cast<size_t>(len), k, edge);
+                for (int x = 0; x < len; ++x) {
+                    uint32_t sum = 0;
+                    for (int t = 0; t < 5; ++t) {
+                        sum += k.w[t] * at(src, x - 2 + t, len, edge);
+                    }
+                    rowOk = rowOk && dst[x] == ref(sum, k.div);
+                }
+            }
+            for (const uint8_t r : {uint8_t{1}, uint8_t{2}, uint8_t{7}, uint8_t{60}}) {
+                amp::boxBlurRow(dst, src, static_cast<size_t>(len), r, edge);
+                for (int x = 0; x < len; ++x) {
+                    uint32_t sum = 0;
+                    for (int i = x - r; i <= x + r; ++i) {
+                        sum += at(src, i, len, edge);
+                    }
+                    rowOk = rowOk && dst[x] == sum / (2u * r + 1u);
+                }
+            }
+        }
+    }
+    expect_true(stats, testName, __LINE__, rowOk, "convolveRow / boxBlurRow match the reference");
+
+    // Upward diffusion matches the per-pixel clamped formula, with and without jitter.
+    int8_t jitter[n];
+    bool diffuseOk = true;
+    for (const int shift : {0, 1, -1, 3, -4, 90, -90}) {
+        for (const bool useJitter : {false, true}) {
+            for (const int len : {n, 1, 3, 6}) {
+                for (int i = 0; i < n; ++i) {
+                    src[i] = next();
+                    far[i] = next();
+                    jitter[i] = static_cast<int8_t>(static_cast<int>(next() % 3u) - 1);
+                }
+                amp::diffuseUpRow(dst, src, far, static_cast<size_t>(len), shift, useJitter ? jitter : nullptr);
+                for (int x = 0; x < len; ++x) {
+                    const int sx = x + shift + (useJitter ? jitter[x] : 0);
+                    const int c = sx < 0 ? 0 : (sx >= len ? len - 1 : sx);
+                    const int l = c - 1 < 0 ? 0 : c - 1;
+                    const int r = c + 1 >= len ? len - 1 : c + 1;
+                    const uint32_t expected = (static_cast<uint32_t>(src[c]) + src[l] + src[r] + far[c] + far[c]) / 5u;
+                    diffuseOk = diffuseOk && dst[x] == expected;
+                }
+            }
+        }
+    }
+    expect_true(stats, testName, __LINE__, diffuseOk, "diffuseUpRow matches the per-pixel flame formula");
+
+    // Matrix-level passes (RowMajor and Tiled8x8) match naive 2D sums.
+    bool matrixOk = true;
+    for (const amp::csMatrixLayout layout : {amp::csMatrixLayout::RowMajor, amp::csMatrixLayout::Tiled8x8}) {
+        csMatrixBytes m(37, 11, 0, layout);
+        csMatrixBytes orig(37, 11);
+        for (amp::tMatrixPixelsCoord y = 0; y < 11; ++y) {
+            for (amp::tMatrixPixelsCoord x = 0; x < 37; ++x) {
+                const uint8_t v = next();
+                m.setValue(x, y, v);
+                orig.setValue(x, y, v);
+            }
+        }
+        csMatrixBytes vert = m;
+        amp::matrix_utils::convolveBytesV<5>(vert, amp::cByteKernelBlur5, csEdgeMode::Zero);
+        csMatrixBytes box = m;
+        amp::matrix_utils::boxBlurBytes(box, 2, 3, csEdgeMode::Clamp);
+        for (int y = 0; y < 11; ++y) {
+            for (int x = 0; x < 37; ++x) {
+                uint32_t sum = 0;
+                for (int t = 0; t < 5; ++t) {
+                    const int yy = y - 2 + t;
+                    sum += (yy >= 0 && yy < 11) ? amp::cByteKernelBlur5.w[t] * orig.getValue(to_coord(x), to_coord(yy)) : 0u;
+                }
+                matrixOk = matrixOk && vert.getValue(to_coord(x), to_coord(y)) == sum / 16u;
+
+                // Box blur: rounded-down horizontal average first, then vertical.
+                uint32_t vsum = 0;
+                for (int yy = y - 3; yy <= y + 3; ++yy) {
+                    const int cy = yy < 0 ? 0 : (yy > 10 ? 10 : yy);
+                    uint32_t hsum = 0;
+                    for (int xx = x - 2; xx <= x + 2; ++xx) {
+                        const int cx = xx < 0 ? 0 : (xx > 36 ? 36 : xx);
+                        hsum += orig.getValue(to_coord(cx), to_coord(cy));
+                    }
+                    vsum += hsum / 5u;
+                }
+                matrixOk = matrixOk && box.getValue(to_coord(x), to_coord(y)) == vsum / 7u;
+            }
+        }
+    }
+    expect_true(stats, testName, __LINE__, matrixOk, "convolveBytesV / boxBlurBytes match naive sums");
+}
+
+void test_fill_kernels(TestStats& stats) {
+    const char* testName = "fill_kernels";
+    static constexpr size_t n = 67;
+    csColorRGBA dst[n];
+    csColorRGBA ref[n];
+    uint32_t seed = 777u;
+    const uint8_t alphas[] = {255, 0, 1, 77, 128, 254};
+    bool blendEqual = true;
+    bool premulEqual = true;
+    for (const uint8_t a : alphas) {
+        for (int round = 0; round < 32; ++round) {
+            seed = seed * 1664525u + 1013904223u;
+            csColorRGBA color;
+            color.value = seed;
+            color.a = a;
+            for (size_t i = 0; i < n; ++i) {
+                seed = seed * 1664525u + 1013904223u;
+                dst[i].value = seed;
+                if (round % 4 == 1) {
+                    dst[i].a = (i % 2) ? 255 : 0;
+                }
+                ref[i] = csColorRGBA::sourceOverStraight(dst[i], color);
+            }
+            // Odd start and length: unaligned SIMD body plus scalar tail.
+            const uint32_t untouched = dst[0].value;
+            amp::fillRowBlend(dst + 1, n - 1, color);
+            blendEqual = blendEqual && dst[0].value == untouched;
+            for (size_t i = 1; i < n; ++i) {
+                blendEqual = blendEqual && dst[i].value == ref[i].value;
+            }
+
+            const csColorRGBA src = color.toPremul();
+            for (size_t i = 0; i < n; ++i) {
+                ref[i] = csColorRGBA::sourceOverPremul(dst[i], src);
+            }
+            amp::fillRowPremul(dst, n, src);
+            for (size_t i = 0; i < n; ++i) {
+                premulEqual = premulEqual && dst[i].value == ref[i].value;
+            }
+        }
+    }
+    expect_true(stats, testName, __LINE__, blendEqual, "fillRowBlend is bit-exact with sourceOverStraight");
+    expect_true(stats, testName, __LINE__, premulEqual, "fillRowPremul is bit-exact with sourceOverPremul");
+
+    // Matrix fills match per-pixel setPixel / setPixelRewrite (RowMajor, Tiled8x8 and premultiplied).
+    const amp::csRect area{-3, 2, 14, 9};
+    const csColorRGBA colors[] = {csColorRGBA{128, 10, 200, 30}, csColorRGBA{255, 1, 2, 3}, csColorRGBA{0, 0, 0, 0}};
+    bool matrixEqual = true;
+    for (const csColorRGBA color : colors) {
+        csMatrixPixels rowMajor(13, 11);
+        csMatrixPixels tiled(13, 11, amp::csMatrixLayout::Tiled8x8);
+        csMatrixPixelsPremul premul(13, 11);
+        csMatrixPixels refRowMajor(13, 11);
+        csMatrixPixelsPremul refPremul(13, 11);
+        amp::csMatrixBase* targets[] = {&rowMajor, &tiled, &premul, &refRowMajor, &refPremul};
+        for (amp::csMatrixBase* m : targets) {
+            for (amp::tMatrixPixelsCoord y = 0; y < 11; ++y) {
+                for (amp::tMatrixPixelsCoord x = 0; x < 13; ++x) {
+                    const uint8_t v = static_cast<uint8_t>(x * 17 + y * 29);
+                    m->setPixelRewrite(x, y, csColorRGBA{static_cast<uint8_t>(y < 4 ? 255 : v), v, 40, 90});
+                }
+            }
+        }
+        amp::matrix_utils::fillArea(rowMajor, area, color);
+        amp::matrix_utils::fillArea(tiled, area, color);
+        amp::matrix_utils::fillArea(premul, area, color);
+        const amp::csRect target = area.intersect(refRowMajor.getRect());
+        for (amp::tMatrixPixelsCoord y = target.y; y < target.y + to_coord(target.height); ++y) {
+            for (amp::tMatrixPixelsCoord x = target.x; x < target.x + to_coord(target.width); ++x) {
+                refRowMajor.setPixel(x, y, color);
+                refPremul.setPixel(x, y, color);
+            }
+        }
+        matrixEqual = matrixEqual && matricesEqual(rowMajor, refRowMajor) && matricesEqual(tiled, refRowMajor);
+        for (amp::tMatrixPixelsCoord y = 0; y < 11; ++y) {
+            for (amp::tMatrixPixelsCoord x = 0; x < 13; ++x) {
+                matrixEqual = matrixEqual && premul.getPixelPremul(x, y).value == refPremul.getPixelPremul(x, y).value;
+            }
+        }
+    }
+    expect_true(stats, testName, __LINE__, matrixEqual, "fillArea matches per-pixel setPixel");
+
+    csMatrixPixels m(10, 4, amp::csMatrixLayout::Tiled8x8);
+    m.setDirtyTracking(true);
+    m.commitDirtyFrame();
+    amp::matrix_utils::fillAreaRewrite(m, amp::csRect{2, 1, 20, 2}, csColorRGBA{100, 1, 2, 3});
+    expect_true(stats, testName, __LINE__,
+                m.getPixel(1, 1).value == 0 && m.getPixel(2, 1).value == csColorRGBA{100, 1, 2, 3}.value &&
+                    m.getPixel(9, 2).value == csColorRGBA{100, 1, 2, 3}.value && m.getPixel(5, 3).value == 0,
+                "fillAreaRewrite overwrites the clipped area only");
+    m.commitDirtyFrame();
+    expect_true(stats, testName, __LINE__, rectEquals(m.dirtyRect(), amp::csRect{0, 0, 10, 4}), "fill marks dirty tiles");
+
+    const csColorRGBA opaque{255, 9, 8, 7};
+    m.clear(opaque);
+    bool allOpaque = true;
+    for (amp::tMatrixPixelsCoord y = 0; y < 4; ++y) {
+        for (amp::tMatrixPixelsCoord x = 0; x < 10; ++x) {
+            allOpaque = allOpaque && m.getPixel(x, y).value == opaque.value;
+        }
+        allOpaque = allOpaque && m.rowAlpha(y) == amp::csRowAlpha::Opaque;
+    }
+    expect_true(stats, testName, __LINE__, allOpaque, "clear(color) fills every pixel and sets row classes");
+
+    csMatrixPixelsPremul pm(5, 3);
+    pm.clear(csColorRGBA{128, 255, 0, 0});
+    expect_true(stats, testName, __LINE__, pm.getPixelPremul(4, 2).value == csColorRGBA{128, 255, 0, 0}.toPremul().value,
+                "premultiplied clear(color) stores the premultiplied color");
+}
+
+void test_matrix_rgb(TestStats& stats) {
+    const char* testName = "matrix_rgb";
+    using amp::rgb_codec::csRGB565;
+
+    bool lossless = true;
+    for (uint32_t v = 0; v < 65536u; ++v) {
+        lossless = lossless && csRGB565::encode(csRGB565::decode(static_cast<uint16_t>(v))) == v;
+    }
+    expect_true(stats, testName, __LINE__, lossless, "RGB565 decode -> encode is lossless");
+    expect_true(stats, testName, __LINE__,
+                csRGB565::decode(csRGB565::encode(csColorRGBA{255, 255, 0, 255})).value == csColorRGBA{255, 255, 0, 255}.value &&
+                    csRGB565::encode(csColorRGBA{255, 132, 0, 0}) == (16u << 11),
+                "RGB565 keeps 0 / 255 and rounds to nearest");
+
+    // Storage is flattened onto black and reads back opaque.
+    amp::csMatrixRGB888 rgb(13, 5);
+    rgb.setPixelRewrite(1, 1, csColorRGBA{128, 200, 100, 50});
+    expect_true(stats, testName, __LINE__,
+                rgb.getPixel(1, 1).value == csColorRGBA{255, amp::mul8(200, 128), amp::mul8(100, 128), amp::mul8(50, 128)}.value &&
+                    rgb.getPixel(0, 0).value == csColorRGBA{255, 0, 0, 0}.value && rgb.getPixel(-1, 0).value == 0,
+                "RGB888 stores flattened colors and reads opaque pixels");
+
+    // RGB888 blends exactly like an opaque csMatrixPixels (row paths included).
+    csMatrixPixels ref(13, 5);
+    for (tMatrixPixelsSize y = 0; y < 5; ++y) {
+        for (tMatrixPixelsSize x = 0; x < 13; ++x) {
+            const csColorRGBA c{255, static_cast<uint8_t>(x * 19), static_cast<uint8_t>(y * 51), 77};
+            ref.setPixelRewrite(to_coord(x), to_coord(y), c);
+            rgb.setPixelRewrite(to_coord(x), to_coord(y), c);
+        }
+    }
+    csColorRGBA row[13];
+    for (tMatrixPixelsSize i = 0; i < 13; ++i) {
+        row[i] = csColorRGBA{static_cast<uint8_t>(i * 20), 250, static_cast<uint8_t>(i * 7), 3};
+    }
+    ref.setPixel(3, 0, csColorRGBA{90, 1, 2, 3});
+    rgb.setPixel(3, 0, csColorRGBA{90, 1, 2, 3});
+    ref.setPixelsRow(-2, 1, row, 13, 200);
+    rgb.setPixelsRow(-2, 1, row, 13, 200);
+    amp::matrix_utils::fillArea(ref, amp::csRect{4, 2, 20, 2}, csColorRGBA{60, 9, 200, 90});
+    amp::matrix_utils::fillArea(rgb, amp::csRect{4, 2, 20, 2}, csColorRGBA{60, 9, 200, 90});
+    amp::matrix_utils::fillAreaRewrite(ref, amp::csRect{0, 4, 3, 1}, csColorRGBA{255, 7, 8, 9});
+    amp::matrix_utils::fillAreaRewrite(rgb, amp::csRect{0, 4, 3, 1}, csColorRGBA{255, 7, 8, 9});
+    bool same = true;
+    for (amp::tMatrixPixelsCoord y = 0; y < 5; ++y) {
+        for (amp::tMatrixPixelsCoord x = 0; x < 13; ++x) {
+            same = same && rgb.getPixel(x, y).value == ref.getPixel(x, y).value;
+        }
+    }
+    expect_true(stats, testName, __LINE__, same, "RGB888 matches opaque RGBA blending");
+
+    // Composite into RGBA through the row path, and render into the layer from an effect.
+    csMatrixPixels dstA(16, 8);
+    csMatrixPixels dstB(16, 8);
+    amp::matrix_utils::drawMatrix(dstA, 2, 1, rgb, 180);
+    amp::matrix_utils::drawMatrix(dstB, 2, 1, ref, 180);
+    expect_true(stats, testName, __LINE__, matricesEqual(dstA, dstB), "drawMatrix from RGB888 matches RGBA source");
+
+    amp::csMatrixRGB565 layer(16, 8);
+    amp::csRenderMatrixCopy copy;
+    copy.matrixSource = &dstA;
+    copy.rectSource = dstA.getRect();
+    copy.setMatrix(layer);
+    amp::csRandGen rand;
+    copy.render(rand, 0);
+    const csColorRGBA src = dstA.getPixel(5, 3);
+    const csColorRGBA got = layer.getPixel(5, 3);
+    expect_true(stats, testName, __LINE__,
+                src.a == 180 && got.a == 255 &&
+                    colorNear(got, csColorRGBA{255, amp::mul8(src.r, src.a), amp::mul8(src.g, src.a), amp::mul8(src.b, src.a)}, 4),
+                "effects render into an RGB565 layer");
+
+    amp::csMatrixBufferPool pool;
+    amp::matrix_buffer::setAllocator(&pool);
+    {
+        amp::csMatrixRGB565 m565(32, 32);
+        expect_true(stats, testName, __LINE__, pool.usedBytes() == 2048, "32x32 RGB565 takes 2 KB");
+        amp::csMatrixRGB888 m888(32, 32);
+        expect_true(stats, testName, __LINE__, pool.usedBytes() == 2048 + 3072, "32x32 RGB888 takes 3 KB");
+    }
+    pool.trim();
+    amp::matrix_buffer::setAllocator(nullptr);
+}
+
+void test_matrix_pixels16(TestStats& stats) {
+    const char* testName = "matrix_pixels16";
+    using amp::csColorRGBA16;
+
+    bool exactMul16 = true;
+    for (uint32_t a = 0; a < 65536u; a += 257u) {
+        for (uint32_t b = 0; b < 65536u; b += 13u) {
+            const uint32_t ref = (a * b + 32767u) / 65535u;
+            exactMul16 = exactMul16 && amp::mul16(static_cast<uint16_t>(a), static_cast<uint16_t>(b)) == ref;
+        }
+    }
+    expect_true(stats, testName, __LINE__, exactMul16, "mul16 matches integer division");
+
+    // 8-bit straight -> 16-bit premultiplied -> 8-bit straight is lossless for every a > 0.
+    bool roundTrip = true;
+    for (uint32_t a = 1; a < 256u; ++a) {
+        for (uint32_t c = 0; c < 256u; ++c) {
+            const csColorRGBA in{static_cast<uint8_t>(a), static_cast<uint8_t>(c), static_cast<uint8_t>(255u - c), 7};
+            roundTrip = roundTrip && csColorRGBA16::fromColor8Premul(in).toColor8Straight().value == in.value;
+        }
+    }
+    expect_true(stats, testName, __LINE__, roundTrip, "premultiplied unorm16 round trip is lossless");
+
+    // Vector quantization matches the scalar reference for every alpha.
+    bool quantizeSame = true;
+    csColorRGBA16 in16[9];
+    csColorRGBA out8[9];
+    for (uint32_t A = 0; A < 65536u; ++A) {
+        for (uint32_t i = 0; i < 9u; ++i) {
+            const uint32_t c = (A * (i + 1u) * 2654435761u) >> 7;
+            in16[i] = csColorRGBA16{static_cast<uint16_t>(A), static_cast<uint16_t>(A ? c % (A + 1u) : 0),
+                                    static_cast<uint16_t>(A * i / 8u), static_cast<uint16_t>(A - A * i / 8u)};
+        }
+        amp::quantizeRow16(out8, in16, 9);
+        for (uint32_t i = 0; i < 9u; ++i) {
+            quantizeSame = quantizeSame && out8[i].value == in16[i].toColor8Straight().value;
+        }
+    }
+    expect_true(stats, testName, __LINE__, quantizeSame, "quantizeRow16 matches toColor8Straight");
+
+    // Row paths match per-pixel setPixel; reads are quantized, out of bounds is transparent black.
+    amp::csMatrixPixels16 acc(13, 3);
+    amp::csMatrixPixels16 ref(13, 3);
+    csColorRGBA row[13];
+    for (tMatrixPixelsSize i = 0; i < 13; ++i) {
+        row[i] = csColorRGBA{static_cast<uint8_t>(i * 20), 250, static_cast<uint8_t>(i * 7), 3};
+    }
+    acc.setPixelsRow(-2, 1, row, 13, 200);
+    for (tMatrixPixelsSize i = 2; i < 13; ++i) {
+        ref.setPixel(to_coord(i) - 2, 1, row[i].alpha(200));
+    }
+    amp::matrix_utils::fillArea(acc, amp::csRect{4, 0, 20, 3}, csColorRGBA{60, 9, 200, 90});
+    for (amp::tMatrixPixelsCoord y = 0; y < 3; ++y) {
+        for (amp::tMatrixPixelsCoord x = 4; x < 13; ++x) {
+            ref.setPixel(x, y, csColorRGBA{60, 9, 200, 90});
+        }
+    }
+    bool same = true;
+    for (amp::tMatrixPixelsCoord y = 0; y < 3; ++y) {
+        for (amp::tMatrixPixelsCoord x = 0; x < 13; ++x) {
+            const csColorRGBA16 p = acc.getPixel16(x, y);
+            const csColorRGBA16 q = ref.getPixel16(x, y);
+            same = same && p.a == q.a && p.r == q.r && p.g == q.g && p.b == q.b;
+        }
+    }
+    expect_true(stats, testName, __LINE__, same && acc.getPixel(13, 0).value == 0, "row paths match setPixel");
+
+    // Deep stack of faint layers: one rounding at the end stays within 1 of the exact result,
+    // while the 8-bit matrix rounds every layer.
+    amp::csMatrixPixels16 stack(1, 1);
+    csMatrixPixels stack8(1, 1);
+    stack.setPixelRewrite(0, 0, csColorRGBA{255, 0, 0, 0});
+    stack8.setPixelRewrite(0, 0, csColorRGBA{255, 0, 0, 0});
+    double exact = 0.0;
+    for (int i = 0; i < 200; ++i) {
+        stack.setPixel(0, 0, csColorRGBA{3, 100, 100, 3});
+        stack8.setPixel(0, 0, csColorRGBA{3, 100, 100, 3});
+        exact = exact + (100.0 - exact) * 3.0 / 255.0;
+    }
+    const csColorRGBA stacked = stack.getPixel(0, 0);
+    expect_true(stats, testName, __LINE__,
+                stacked.a == 255 && std::fabs(stacked.r - exact) <= 1.0 &&
+                    std::fabs(stack8.getPixel(0, 0).r - exact) > 1.0,
+                "16-bit stack rounds once");
+
+    // Additive layers saturate; fade reaches zero; quantizeTo / drawMatrix / addMatrix read the quantized image.
+    amp::csMatrixPixels16 glow(4, 2);
+    glow.addPixel(0, 0, csColorRGBA{200, 255, 40, 0});
+    glow.addPixel(0, 0, csColorRGBA{200, 255, 40, 0});
+    const csColorRGBA added = glow.getPixel(0, 0);
+    expect_true(stats, testName, __LINE__, added.a == 255 && added.r == 255 && added.g == 63,
+                "additive blend adds premultiplied colors and saturates");
+    glow.fade(255);
+    expect_true(stats, testName, __LINE__, glow.getPixel(0, 0).value == added.value, "fade(255) is a no-op");
+    for (int i = 0; i < 200; ++i) {
+        glow.fade(240);
+    }
+    const csColorRGBA16 faded = glow.getPixel16(0, 0);
+    expect_true(stats, testName, __LINE__, faded.a == 0 && faded.r == 0 && faded.g == 0, "repeated fade reaches zero");
+
+    acc.addPixelsRow(0, 2, row, 13, 128);
+    csMatrixPixels frame(1, 1);
+    acc.quantizeTo(frame);
+    csMatrixPixels drawn(13, 3);
+    csMatrixPixels drawnRef(13, 3);
+    drawMatrix(drawn, 0, 0, acc);
+    drawMatrix(drawnRef, 0, 0, frame);
+    amp::csMatrixPixels16 summed(13, 3);
+    amp::matrix_utils::addMatrix(summed, 0, 0, frame);
+    bool quantized = frame.width() == 13 && frame.height() == 3;
+    for (amp::tMatrixPixelsCoord y = 0; quantized && y < 3; ++y) {
+        for (amp::tMatrixPixelsCoord x = 0; x < 13; ++x) {
+            quantized = quantized && frame.getPixel(x, y).value == acc.getPixel(x, y).value &&
+                        drawn.getPixel(x, y).value == drawnRef.getPixel(x, y).value &&
+                        summed.getPixel(x, y).value == acc.getPixel(x, y).value;
+        }
+    }
+    expect_true(stats, testName, __LINE__, quantized, "quantizeTo, drawMatrix and addMatrix use the quantized image");
+}
+
+void test_blend_modes(TestStats& stats) {
+    const char* testName = "blend_modes";
+    using amp::csBlendMode;
+
+    // Mode formulas over an opaque destination (mode result fully replaces the source color).
+    const csColorRGBA dstOpaque{255, 100, 200, 30};
+    const csColorRGBA srcOpaque{255, 100, 100, 250};
+    const csColorRGBA add = csColorRGBA::blendStraight(dstOpaque, srcOpaque, csBlendMode::Add);
+    expect_true(stats, testName, __LINE__, colorEq(add, 255, 200, 255, 255), "Add saturates per channel");
+    const csColorRGBA mul = csColorRGBA::blendStraight(dstOpaque, srcOpaque, csBlendMode::Multiply);
+    expect_true(stats, testName, __LINE__,
+                colorEq(mul, 255, amp::mul8(100, 100), amp::mul8(200, 100), amp::mul8(30, 250)),
+                "Multiply is mul8 per channel");
+    const csColorRGBA scr = csColorRGBA::blendStraight(dstOpaque, csColorRGBA{255, 0, 0, 0}, csBlendMode::Screen);
+    expect_true(stats, testName, __LINE__, scr.value == dstOpaque.value, "Screen with black keeps destination");
+    const csColorRGBA mx = csColorRGBA::blendStraight(dstOpaque, srcOpaque, csBlendMode::Max);
+    const csColorRGBA mn = csColorRGBA::blendStraight(dstOpaque, srcOpaque, csBlendMode::Min);
+    expect_true(stats, testName, __LINE__, colorEq(mx, 255, 100, 200, 250), "Max picks lighter channel");
+    expect_true(stats, testName, __LINE__, colorEq(mn, 255, 100, 100, 30), "Min picks darker channel");
+    const csColorRGBA overClear = csColorRGBA::blendStraight(csColorRGBA{0, 0, 0, 0}, srcOpaque, csBlendMode::Add);
+    expect_true(stats, testName, __LINE__, overClear.value == srcOpaque.value, "Any mode over transparent is SourceOver");
+
+    // Row kernels are bit-exact with the per-pixel reference for every mode.
+    static constexpr size_t n = 71;
+    csColorRGBA dst[n];
+    csColorRGBA src[n];
+    csColorRGBA ref[n];
+    uint32_t seed = 4242u;
+    bool rowEqual = true;
+    bool fillEqual = true;
+    const uint8_t alphas[] = {255, 0, 1, 128, 201};
+    for (uint8_t m = 0; m < amp::cBlendModeCount; ++m) {
+        const csBlendMode mode = static_cast<csBlendMode>(m);
+        for (const uint8_t ga : alphas) {
+            for (size_t i = 0; i < n; ++i) {
+                seed = seed * 1664525u + 1013904223u;
+                dst[i].value = seed;
+                seed = seed * 1664525u + 1013904223u;
+                src[i].value = seed;
+                if (i % 5 == 0) {
+                    dst[i].a = 255;
+                }
+                ref[i] = csColorRGBA::blendStraight(dst[i], src[i], mode, ga);
+            }
+            amp::blendRowMode(dst, src, n, ga, mode);
+            for (size_t i = 0; i < n; ++i) {
+                rowEqual = rowEqual && dst[i].value == ref[i].value;
+            }
+
+            const csColorRGBA color = src[static_cast<size_t>(ga) % n];
+            for (size_t i = 0; i < n; ++i) {
+                ref[i] = csColorRGBA::blendStraight(dst[i], color, mode);
+            }
+            amp::fillRowMode(dst + 1, n - 1, color, mode);
+            for (size_t i = 1; i < n; ++i) {
+                fillEqual = fillEqual && dst[i].value == ref[i].value;
+            }
+        }
+    }
+    expect_true(stats, testName, __LINE__, rowEqual, "blendRowMode is bit-exact with blendStraight");
+    expect_true(stats, testName, __LINE__, fillEqual, "fillRowMode is bit-exact with blendStraight");
+
+    // drawMatrix with a mode: row kernel destination and per-pixel fallback agree with the reference.
+    csMatrixPixels layer(9, 5);
+    for (amp::tMatrixPixelsCoord y = 0; y < 5; ++y) {
+        for (amp::tMatrixPixelsCoord x = 0; x < 9; ++x) {
+            layer.setPixelRewrite(x, y, csColorRGBA{static_cast<uint8_t>(x * 30), static_cast<uint8_t>(y * 50), 90,
+                                                    static_cast<uint8_t>(x * 20)});
+        }
+    }
+    bool drawEqual = true;
+    for (uint8_t m = 0; m < amp::cBlendModeCount; ++m) {
+        const csBlendMode mode = static_cast<csBlendMode>(m);
+        csMatrixPixels target(8, 6);
+        amp::csMatrixRGB888 opaque(8, 6);
+        for (amp::tMatrixPixelsCoord y = 0; y < 6; ++y) {
+            for (amp::tMatrixPixelsCoord x = 0; x < 8; ++x) {
+                const csColorRGBA c{static_cast<uint8_t>(y < 3 ? 255 : 120), static_cast<uint8_t>(x * 25), 60,
+                                    static_cast<uint8_t>(y * 40)};
+                target.setPixelRewrite(x, y, c);
+                opaque.setPixelRewrite(x, y, c);
+            }
+        }
+        csMatrixPixels refTarget = target;
+        csMatrixPixels refOpaque(8, 6);
+        for (amp::tMatrixPixelsCoord y = 0; y < 6; ++y) {
+            for (amp::tMatrixPixelsCoord x = 0; x < 8; ++x) {
+                refOpaque.setPixelRewrite(x, y, opaque.getPixel(x, y));
+            }
+        }
+        drawMatrix(target, -1, 2, layer, 200, mode);
+        drawMatrix(opaque, -1, 2, layer, 200, mode);
+        for (amp::tMatrixPixelsCoord y = 0; y < 6; ++y) {
+            for (amp::tMatrixPixelsCoord x = 0; x < 8; ++x) {
+                const bool inside = y >= 2 && x + 1 < 9;
+                const csColorRGBA s = inside ? layer.getPixel(x + 1, y - 2) : csColorRGBA{0, 0, 0, 0};
+                const csColorRGBA expected = csColorRGBA::blendStraight(refTarget.getPixel(x, y), s, mode, 200);
+                csColorRGBA expectedOpaque = csColorRGBA::blendStraight(refOpaque.getPixel(x, y), s, mode, 200);
+                expectedOpaque.a = 255;
+                drawEqual = drawEqual && target.getPixel(x, y).value == expected.value &&
+                            opaque.getPixel(x, y).value == expectedOpaque.value;
+            }
+        }
+    }
+    expect_true(stats, testName, __LINE__, drawEqual, "drawMatrix with mode matches blendStraight");
+
+    // Premultiplied target: row path (drawMatrix, fillArea) agrees with per-pixel setPixelMode().
+    bool premulEqual = true;
+    for (uint8_t m = 0; m < amp::cBlendModeCount; ++m) {
+        const csBlendMode mode = static_cast<csBlendMode>(m);
+        amp::csMatrixPixelsPremul premul(8, 6);
+        amp::csMatrixPixelsPremul premulRef(8, 6);
+        for (amp::tMatrixPixelsCoord y = 0; y < 6; ++y) {
+            for (amp::tMatrixPixelsCoord x = 0; x < 8; ++x) {
+                const csColorRGBA c{static_cast<uint8_t>(128 + y * 20), static_cast<uint8_t>(x * 25), 200,
+                                    static_cast<uint8_t>(50 + y * 10)};
+                premul.setPixelRewrite(x, y, c);
+                premulRef.setPixelRewrite(x, y, c);
+            }
+        }
+        drawMatrix(premul, -1, 2, layer, 200, mode);
+        amp::matrix_utils::fillArea(premul, amp::csRect{2, 0, 3, 2}, csColorRGBA{128, 100, 100, 100}, mode);
+        for (amp::tMatrixPixelsCoord y = 0; y < 6; ++y) {
+            for (amp::tMatrixPixelsCoord x = 0; x < 8; ++x) {
+                if (y >= 2 && x + 1 < 9) {
+                    premulRef.setPixelMode(x, y, layer.getPixel(x + 1, y - 2).alpha(200), mode);
+                }
+                if (y < 2 && x >= 2 && x < 5) {
+                    premulRef.setPixelMode(x, y, csColorRGBA{128, 100, 100, 100}, mode);
+                }
+            }
+        }
+        for (amp::tMatrixPixelsCoord y = 0; y < 6; ++y) {
+            for (amp::tMatrixPixelsCoord x = 0; x < 8; ++x) {
+                premulEqual = premulEqual && premul.getPixelPremul(x, y).value == premulRef.getPixelPremul(x, y).value;
+            }
+        }
+    }
+    expect_true(stats, testName, __LINE__, premulEqual, "premultiplied row modes match setPixelMode");
+
+    // Blend mode is an effect property: additive rectangles accumulate in one pass.
+    csMatrixPixels canvas(4, 4);
+    canvas.clear(csColorRGBA{255, 100, 10, 0});
+    amp::csRenderRectangle rect;
+    rect.setMatrix(canvas);
+    rect.color = csColorRGBA{255, 100, 20, 5};
+    amp::csPropInfo info;
+    rect.getPropInfo(amp::csRenderRectangle::propBlendMode, info);
+    expect_true(stats, testName, __LINE__, !info.disabled && info.valuePtr == &rect.blendMode,
+                "propBlendMode is exposed");
+    *static_cast<uint8_t*>(info.valuePtr) = static_cast<uint8_t>(csBlendMode::Add);
+    rect.propChanged(amp::csRenderRectangle::propBlendMode);
+    amp::csRandGen rand;
+    rect.render(rand, 0);
+    expect_true(stats, testName, __LINE__, colorEq(canvas.getPixel(2, 3), 255, 200, 30, 5),
+                "Add rectangle brightens destination");
+    *static_cast<uint8_t*>(info.valuePtr) = 200;
+    rect.propChanged(amp::csRenderRectangle::propBlendMode);
+    expect_true(stats, testName, __LINE__, rect.blendMode == csBlendMode::SourceOver,
+                "Out of range blend mode falls back to SourceOver");
+}
+
+void test_matrix_views(TestStats& stats) {
+    const char* testName = "matrix_views";
+    using namespace amp::matrix_utils;
+    // 11x6 view inside a 16-pixel-wide external buffer; columns 11..15 belong to the caller.
+    constexpr tMatrixPixelsSize w = 11;
+    constexpr tMatrixPixelsSize h = 6;
+    constexpr size_t stride = 16;
+    const csColorRGBA guard{1, 2, 3, 4};
+    csColorRGBA external[stride * h];
+    for (csColorRGBA& c : external) {
+        c = guard;
+    }
+    amp::csMatrixPixelsView view{external, w, h, stride};
+    csMatrixPixels owned{w, h};
+    csMatrixPixels src{9, 5};
+    fillPattern(src, 40);
+    view.clear();
+    view.setDirtyTracking(true);
+    for (csMatrixPixels* m : {static_cast<csMatrixPixels*>(&view), &owned}) {
+        fillPattern(*m, 7);
+        drawMatrix(*m, 2, 1, src, 200);
+        fillArea(*m, amp::csRect{4, 0, 3, 6}, csColorRGBA{255, 50, 60, 70});
+    }
+    view.resize(30, 30);
+    expect_true(stats, testName, __LINE__, matricesEqual(view, owned), "view renders like owned matrix");
+    expect_true(stats, testName, __LINE__, view.width() == w && !view.ownsPixels(), "resize ignored by view");
+    expect_true(stats, testName, __LINE__, external[stride + 5].value == owned.getPixel(5, 1).value, "writes land in external memory");
+    expect_true(stats, testName, __LINE__, view.rowAlpha(0) == owned.rowAlpha(0), "row alpha on strided rows");
+
+    view.commitDirtyFrame();
+    view.setPixelRewrite(10, 5, csColorRGBA{255, 9, 9, 9});
+    view.commitDirtyFrame();
+    expect_true(stats, testName, __LINE__, rectEquals(view.dirtyRect(), amp::csRect{8, 0, 3, 6}), "dirty hash uses stride");
+
+    csMatrixPixels copy{view};
+    expect_true(stats, testName, __LINE__, copy.ownsPixels() && matricesEqual(copy, view), "copy of view is a deep copy");
+    amp::csMatrixPixelsView alias{view};
+    alias.setPixelRewrite(0, 0, csColorRGBA{255, 0, 0, 1});
+    expect_true(stats, testName, __LINE__, view.getPixel(0, 0).value == alias.getPixel(0, 0).value, "copied view aliases memory");
+
+    view.clear();
+    bool guardKept = true;
+    bool cleared = true;
+    for (size_t y = 0; y < h; ++y) {
+        for (size_t x = 0; x < stride; ++x) {
+            const uint32_t v = external[y * stride + x].value;
+            if (x < w) {
+                cleared = cleared && v == 0;
+            } else {
+                guardKept = guardKept && v == guard.value;
+            }
+        }
+    }
+    expect_true(stats, testName, __LINE__, cleared && guardKept, "clear() keeps memory between rows");
+
+    uint8_t bytes[10 * 4];
+    for (uint8_t& b : bytes) {
+        b = 0xAA;
+    }
+    amp::csMatrixBytesView byteView{bytes, 7, 4, 10};
+    byteView.clear();
+    byteView.setValue(6, 3, 77);
+    byteView.setValue(7, 0, 1);
+    expect_true(stats, testName, __LINE__, bytes[3 * 10 + 6] == 77 && bytes[7] == 0xAA && bytes[0] == 0,
+                "byte view: stride addressing, clear and bounds");
+    csMatrixBytes byteCopy{byteView};
+    expect_true(stats, testName, __LINE__, byteCopy.stride() == 7 && byteCopy.getValue(6, 3) == 77, "byte view deep copy");
+
+    uint8_t bits[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+    amp::csMatrixBooleanView bitView{bits, 5, 3, 10};
+    bitView.clear();
+    bitView.setValue(4, 2, true);
+    // Row starts at bits 0, 10, 20: cleared bits 0-4, 10-14, 20-24; bit 24 set again.
+    expect_true(stats, testName, __LINE__, bits[0] == 0xE0 && bits[1] == 0x83 && bits[2] == 0x0F && bits[3] == 0xFF,
+                "bit view clears only its bits");
+    expect_true(stats, testName, __LINE__, bitView.getValue(4, 2) && !bitView.getValue(3, 2), "bit view addressing");
+}
+
+void test_matrix_sub_view(TestStats& stats) {
+    const char* testName = "matrix_sub_view";
+    using namespace amp::matrix_utils;
+    csMatrixPixels parent{20, 12};
+    csMatrixPixels expected{20, 12};
+    fillPattern(parent, 3);
+    fillPattern(expected, 3);
+    for (amp::tMatrixPixelsCoord x = 0; x < 20; ++x) {
+        parent.setPixelRewrite(x, 6, csColorRGBA{0, 0, 0, 0});
+        expected.setPixelRewrite(x, 6, csColorRGBA{0, 0, 0, 0});
+    }
+    parent.setDirtyTracking(true);
+    parent.commitDirtyFrame();
+    expect_true(stats, testName, __LINE__, parent.rowAlpha(6) == amp::csRowAlpha::Transparent, "row class cached before view writes");
+
+    const amp::csRect region{9, 3, 8, 6};
+    amp::csMatrixSubView view{parent, region};
+    expect_true(stats, testName, __LINE__, view.width() == 8 && view.height() == 6 && view.stride() == 20,
+                "view size and parent stride");
+    csMatrixPixels src{5, 4};
+    fillPattern(src, 90);
+    drawMatrix(view, -2, 3, src, 180);
+    fillArea(view, amp::csRect{1, 0, 3, 9}, csColorRGBA{255, 10, 20, 30});
+    view.setPixel(8, 0, csColorRGBA{255, 1, 1, 1});
+    view.setPixel(-1, 0, csColorRGBA{255, 1, 1, 1});
+    // Same drawing on the parent, clipped to the region by hand.
+    csMatrixPixels scratch{8, 6};
+    drawMatrixAreaRewrite(scratch, region, 0, 0, expected);
+    drawMatrix(scratch, -2, 3, src, 180);
+    fillArea(scratch, amp::csRect{1, 0, 3, 9}, csColorRGBA{255, 10, 20, 30});
+    drawMatrixAreaRewrite(expected, scratch.getRect(), region.x, region.y, scratch);
+    expect_true(stats, testName, __LINE__, matricesEqual(parent, expected), "view renders into parent region only");
+
+    expect_true(stats, testName, __LINE__, parent.rowAlpha(6) == amp::csRowAlpha::Mixed, "view writes reset parent row class");
+    parent.commitDirtyFrame();
+    expect_true(stats, testName, __LINE__, rectEquals(parent.dirtyRect(), amp::csRect{8, 0, 8, 12}), "view writes mark parent tiles");
+
+    fillArea(parent, amp::csRect{0, 5, 20, 1}, csColorRGBA{255, 7, 7, 7});
+    expect_true(stats, testName, __LINE__, view.rowAlpha(2) == amp::csRowAlpha::Opaque, "view sees direct parent writes");
+
+    amp::csMatrixSubView clipped{parent, amp::csRect{15, -2, 10, 4}};
+    expect_true(stats, testName, __LINE__, rectEquals(clipped.parentRect(), amp::csRect{15, 0, 5, 2}), "rect clipped to parent");
+    csMatrixPixelsPremul premul{4, 4};
+    amp::csMatrixSubView premulView{premul, premul.getRect()};
+    expect_true(stats, testName, __LINE__, premulView.width() == 0 && premulView.parent() == nullptr, "premul parent gives empty view");
+
+    // Remap pipes place output at rectDest.(x, y).
+    static const amp::csRenderRemapByConstArray::RemapCoord remap[] = {{1, 0}, {0, 1}};
+    amp::csRenderRemapByConstArray pipe{remap, 2, 1};
+    csMatrixPixels remapSrc{2, 1};
+    remapSrc.setPixelRewrite(0, 0, csColorRGBA{255, 1, 2, 3});
+    remapSrc.setPixelRewrite(1, 0, csColorRGBA{255, 4, 5, 6});
+    csMatrixPixels remapDst{8, 8};
+    pipe.matrixSource = &remapSrc;
+    pipe.rectSource = remapSrc.getRect();
+    pipe.matrixDest = &remapDst;
+    pipe.rectDest = amp::csRect{2, 5, 2, 2};
+    amp::csRandGen rand;
+    pipe.render(rand, 0);
+    expect_true(stats, testName, __LINE__, remapDst.getPixel(3, 5).value == remapSrc.getPixel(0, 0).value &&
+                remapDst.getPixel(2, 6).value == remapSrc.getPixel(1, 0).value, "remap uses rectDest.y for rows");
+}
+
+void test_matrix_buffer_pool(TestStats& stats) {
+    const char* testName = "matrix_buffer_pool";
+    using amp::csMatrixBufferPool;
+    expect_true(stats, testName, __LINE__, csMatrixBufferPool::sizeClass(1) == 16 && csMatrixBufferPool::sizeClass(17) == 20 &&
+                csMatrixBufferPool::sizeClass(64) == 64 && csMatrixBufferPool::sizeClass(2304) == 2560, "size classes");
+
+    csMatrixBufferPool pool;
+    amp::matrix_buffer::setAllocator(&pool);
+    {
+        csMatrixPixels a{16, 16};
+        a.setPixelRewrite(3, 3, csColorRGBA{255, 1, 2, 3});
+        a.resize(20, 16);
+        expect_true(stats, testName, __LINE__, pool.reuseCount() == 0 && pool.heapAllocCount() == 2, "different class allocates");
+        expect_true(stats, testName, __LINE__, a.getPixel(3, 3).value == 0, "resized matrix is cleared");
+        a.resize(16, 16);
+        expect_true(stats, testName, __LINE__, pool.reuseCount() == 1 && a.getPixel(3, 3).value == 0,
+                    "freed buffer reused and zero-filled");
+        csMatrixBytes heat{30, 10};
+        amp::csMatrixBoolean bits{20, 20};
+        expect_true(stats, testName, __LINE__, pool.usedBytes() == 1024 + 320 + 56, "used bytes by class");
+    }
+    expect_true(stats, testName, __LINE__, pool.usedBytes() == 0 && pool.cachedBytes() == 1024 + 1280 + 320 + 56,
+                "freed buffers cached");
+    expect_true(stats, testName, __LINE__, pool.highWaterBytes() == 1024 + 1280 + 320 + 56, "high-water mark");
+    pool.trim();
+    expect_true(stats, testName, __LINE__, pool.heapBytes() == 0, "trim returns cache to heap");
+
+    pool.setMode(csMatrixBufferPool::Mode::ReleaseAfterFrame);
+    for (int frame = 0; frame < 3; ++frame) {
+        for (int i = 0; i < 4; ++i) {
+            csMatrixPixels scratch{8, 8};
+        }
+        pool.endFrame();
+        expect_true(stats, testName, __LINE__, pool.heapBytes() == 0, "scratch buffers released after frame");
+    }
+    expect_true(stats, testName, __LINE__, pool.heapAllocCount() == 4 + 3 && pool.reuseCount() == 1 + 9,
+                "scratch matrices reuse one buffer per frame");
+    amp::matrix_buffer::setAllocator(nullptr);
+}
+
+void test_effect_manager_parallel(TestStats& stats) {
+    const char* testName = "effect_manager_parallel";
+    amp::csThreadPool pool{4};
+    {
+        uint16_t hits[100] = {};
+        pool.parallelFor(100, [&hits](uint16_t i) { ++hits[i]; });
+        bool once = true;
+        for (uint16_t h : hits) {
+            once = once && h == 1;
+        }
+        expect_true(stats, testName, __LINE__, once, "parallelFor runs every index once");
+    }
+
+    // Same effect list in two managers; only one of them gets the pool.
+    auto build = [](amp::csEffectManager& mgr, csMatrixPixels& m) {
+        m.setDirtyTracking(true);
+        mgr.setMatrix(m);
+        mgr.add(new amp::csRenderPlasma());
+        auto* circle = new amp::csRenderCircleFast();
+        mgr.add(circle);
+        circle->renderRectAutosize = false;
+        circle->rectDest = amp::csRect{5, 3, 25, 22};
+        circle->color = csColorRGBA{200, 250, 40, 10};
+        circle->blendMode = amp::csBlendMode::Add;
+        auto* rect = new amp::csRenderRectangle();
+        mgr.add(rect);
+        rect->rectDest = amp::csRect{0, 10, 37, 3};
+        rect->color = csColorRGBA{128, 0, 0, 255};
+        auto* waves = new amp::csRenderGradientWavesFP();
+        mgr.add(waves);
+        waves->blendMode = amp::csBlendMode::Multiply;
+        auto* grad = new amp::csRenderCircleGradient();
+        mgr.add(grad);
+        grad->renderRectAutosize = false;
+        grad->rectDest = amp::csRect{-4, 12, 20, 20};
+        grad->color = csColorRGBA{180, 10, 250, 90};
+        grad->gradientOffset = 64;
+    };
+    csMatrixPixels serialM{37, 29};
+    csMatrixPixels parallelM{37, 29};
+    amp::csEffectManager serial;
+    amp::csEffectManager parallel;
+    build(serial, serialM);
+    build(parallel, parallelM);
+    parallel.setThreadPool(&pool);
+    expect_true(stats, testName, __LINE__, parallel.get(0)->canRenderBands() && !parallel.get(2)->canRenderBands(),
+                "capability flags");
+
+    amp::csRandGen rand;
+    for (amp::tTime t : {amp::tTime(0), amp::tTime(750), amp::tTime(4321)}) {
+        serialM.clear();
+        parallelM.clear();
+        serial.render(rand, t);
+        parallel.render(rand, t);
+        bool same = true;
+        for (tMatrixPixelsSize y = 0; y < serialM.height(); ++y) {
+            for (tMatrixPixelsSize x = 0; x < serialM.width(); ++x) {
+                same = same && serialM.getPixel(to_coord(x), to_coord(y)).value ==
+                               parallelM.getPixel(to_coord(x), to_coord(y)).value;
+            }
+        }
+        expect_true(stats, testName, __LINE__, same, "band rendering matches serial frame");
+        expect_true(stats, testName, __LINE__, rectEquals(serial.getDirtyRect(), parallel.getDirtyRect()),
+                    "same dirty rect");
+    }
+}
+
+void test_effect_graph(TestStats& stats) {
+    const char* testName = "effect_graph";
+    using amp::csEffectHazard;
+    csMatrixPixels canvas{24, 16};
+    csMatrixPixels scratchA{24, 16};
+    csMatrixPixels scratchB{24, 16};
+    // add() binds matrixDest to the manager matrix: destinations are set after it.
+    auto copy = [](amp::csEffectManager& mgr, amp::csMatrixBase& from, amp::csMatrixBase& to) {
+        auto* eff = new amp::csRenderMatrixCopy();
+        mgr.add(eff);
+        eff->setMatrix(to);
+        eff->matrixSource = &from;
+        eff->propChanged(amp::csEffectBase::propMatrixSource);
+        eff->rectSource = from.getRect();
+        return eff;
+    };
+    // Two branches into scratch matrices, merged into the canvas.
+    auto build = [&](amp::csEffectManager& mgr) {
+        mgr.setMatrix(canvas);
+        mgr.add(new amp::csRenderPlasma());
+        static_cast<amp::csRenderMatrixBase*>(mgr.get(0))->setMatrix(scratchA);
+        auto* circle = new amp::csRenderCircleGradient();
+        mgr.add(circle);
+        circle->setMatrix(scratchB);
+        circle->color = csColorRGBA{255, 250, 200, 10};
+        copy(mgr, scratchA, canvas);
+        copy(mgr, scratchB, canvas)->blendMode = amp::csBlendMode::Add;
+    };
+    amp::csEffectManager serial;
+    build(serial);
+    serial.setGraphScheduling(true);
+    amp::csRandGen rand;
+    serial.render(rand, 100);
+    const amp::csEffectGraph& g = serial.getGraph();
+    expect_true(stats, testName, __LINE__, g.size() == 4 && !g.dependsOn(1, 0) && g.dependsOn(2, 0) &&
+                g.dependsOn(3, 1) && g.dependsOn(3, 2) && !g.dependsOn(2, 1), "edges from matrix properties");
+    expect_true(stats, testName, __LINE__, g.hazardCount() == 0 && !g.hasCycle(), "no hazards");
+
+    uint32_t expected[24 * 16];
+    for (int i = 0; i < 24 * 16; ++i) {
+        expected[i] = canvas.getPixel(i % 24, i / 24).value;
+    }
+    amp::csThreadPool pool{3};
+    serial.setThreadPool(&pool);
+    bool same = true;
+    for (int frame = 0; frame < 4; ++frame) {
+        canvas.clear();
+        scratchA.clear();
+        scratchB.clear();
+        serial.render(rand, 100);
+        for (int i = 0; i < 24 * 16; ++i) {
+            same = same && canvas.getPixel(i % 24, i / 24).value == expected[i];
+        }
+    }
+    expect_true(stats, testName, __LINE__, same, "concurrent branches give the serial frame");
+    serial.setThreadPool(nullptr);
+
+    // Reader listed before the writer of its source.
+    amp::csEffectManager late;
+    late.setMatrix(canvas);
+    copy(late, scratchA, canvas);
+    late.add(new amp::csRenderPlasma());
+    static_cast<amp::csRenderMatrixBase*>(late.get(1))->setMatrix(scratchA);
+    late.setGraphScheduling(true);
+    late.render(rand, 0);
+    expect_true(stats, testName, __LINE__, late.getGraph().hazardCount() == 1 &&
+                late.getGraph().hazard(0).kind == csEffectHazard::Kind::ReadBeforeWrite &&
+                late.getGraph().hazard(0).effect == 0 && late.getGraph().hazard(0).other == 1 &&
+                late.getGraph().hazard(0).matrix == &scratchA, "read before write reported");
+    expect_true(stats, testName, __LINE__, late.getGraph().order()[0] == 0, "list order kept without reorder");
+    late.setGraphScheduling(true, true);
+    late.render(rand, 0);
+    expect_true(stats, testName, __LINE__, late.getGraph().order()[0] == 1 && late.getGraph().order()[1] == 0,
+                "reorder moves the writer first");
+
+    // A -> B -> C -> A: reordering would need a cycle.
+    amp::csEffectManager loop;
+    csMatrixPixels scratchC{4, 4};
+    loop.setMatrix(canvas);
+    copy(loop, scratchA, scratchB);
+    copy(loop, scratchB, scratchC);
+    copy(loop, scratchC, scratchA);
+    loop.setGraphScheduling(true, true);
+    loop.render(rand, 0);
+    const amp::csEffectGraph& lg = loop.getGraph();
+    bool cycleReported = false;
+    for (uint8_t i = 0; i < lg.hazardCount(); ++i) {
+        cycleReported = cycleReported || lg.hazard(i).kind == csEffectHazard::Kind::Cycle;
+    }
+    expect_true(stats, testName, __LINE__, lg.hasCycle() && cycleReported, "cycle reported");
+    expect_true(stats, testName, __LINE__, lg.order()[0] == 0 && lg.order()[1] == 1 && lg.order()[2] == 2,
+                "cycle falls back to list order");
+
+    amp::csMatrixSubView left{canvas, amp::csRect{0, 0, 8, 8}};
+    expect_true(stats, testName, __LINE__, left.storageOwner() == &canvas && canvas.storageOwner() == &canvas,
+                "sub view shares the parent's storage owner");
+}
+
+// Records what the output stage received; optionally slow (like FastLED.show() on a long strip).
+class RecordingFrameOutput : public amp::csFrameOutput {
+public:
+    int delayMs = 0;
+    const csMatrixPixels* lastFrame = nullptr;
+    amp::csPixelFormat lastFormat = amp::csPixelFormat::Unknown;
+    uint8_t received[32] = {};
+    int count = 0;
+
+    void outputFrame(const csMatrixPixels& frame, const amp::csRect& /*dirty*/) override {
+#if AMP_ENABLE_THREADS
+        if (delayMs != 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+        }
+#endif
+        lastFrame = &frame;
+        lastFormat = frame.pixelFormat();
+        if (count < 32) {
+            received[count] = frame.getPixel(1, 1).r;
+        }
+        ++count;
+    }
+};
+
+void test_frame_pipeline(TestStats& stats) {
+    const char* testName = "frame_pipeline";
+    const amp::csRect a{2, 3, 4, 5};
+    expect_true(stats, testName, __LINE__, rectEquals(a.unite(amp::csRect{0, 6, 3, 4}), amp::csRect{0, 3, 6, 7}) &&
+                rectEquals(amp::csRect{}.unite(a), a), "rect unite");
+
+    // Frame n shows red = 10 * n at every pixel.
+    auto run = [](amp::csMatrixSFXSystem& sfx, int frames) {
+        for (int n = 1; n <= frames; ++n) {
+            static_cast<amp::csRenderRectangle*>(sfx.effectManager->get(0))->color = csColorRGBA{255, uint8_t(10 * n), 0, 0};
+            sfx.internalMatrix->clear();
+            sfx.recalcAndRender(static_cast<amp::tTime>(n));
+        }
+        sfx.flushFrameOutput();
+    };
+    auto setup = [](amp::csMatrixSFXSystem& sfx) {
+        sfx.effectManager->add(new amp::csRenderRectangle());
+        static_cast<amp::csRenderRectangle*>(sfx.effectManager->get(0))->rectDest = sfx.internalMatrix->getRect();
+    };
+
+    {
+        RecordingFrameOutput out;
+        amp::csMatrixSFXSystem sfx{8, 8};
+        setup(sfx);
+        sfx.setFrameOutput(&out, amp::csFramePipeline::Sync);
+        run(sfx, 3);
+        expect_true(stats, testName, __LINE__, out.count == 3 && out.lastFrame == sfx.internalMatrix &&
+                    out.received[2] == 30, "sync output reads the render matrix");
+    }
+    {
+        RecordingFrameOutput out;
+        out.delayMs = 2;
+        amp::csMatrixSFXSystem sfx{8, 8, true};
+        setup(sfx);
+        sfx.setFrameOutput(&out, amp::csFramePipeline::Double);
+        run(sfx, 6);
+        bool inOrder = out.count == 6;
+        for (int n = 0; n < 6 && inOrder; ++n) {
+            inOrder = out.received[n] == 10 * (n + 1);
+        }
+        expect_true(stats, testName, __LINE__, inOrder, "double buffering sends every frame in order");
+        expect_true(stats, testName, __LINE__, out.lastFormat == amp::csPixelFormat::ARGB8Premul,
+                    "front buffer keeps the render matrix format");
+#if AMP_ENABLE_THREADS
+        expect_true(stats, testName, __LINE__, out.lastFrame != sfx.internalMatrix, "output reads a front buffer");
+#endif
+        const amp::csFramePresenterStats st = sfx.presenter->stats();
+        expect_true(stats, testName, __LINE__, st.presented == 6 && st.output == 6 && st.dropped == 0, "double stats");
+    }
+    {
+        RecordingFrameOutput out;
+        out.delayMs = 5;
+        amp::csMatrixSFXSystem sfx{8, 8};
+        setup(sfx);
+        sfx.setFrameOutput(&out, amp::csFramePipeline::Triple);
+        run(sfx, 10);
+        const amp::csFramePresenterStats st = sfx.presenter->stats();
+        expect_true(stats, testName, __LINE__, st.presented == 10 && st.output + st.dropped == 10 &&
+                    st.waits == 0 && int(st.output) == out.count, "triple buffering never waits");
+        expect_true(stats, testName, __LINE__, out.received[out.count - 1] == 100, "latest frame is sent last");
+    }
+}
+
+void test_effect_registry(TestStats& stats) {
+    const char* testName = "effect_registry";
+    using Mgr = amp::csEffectManager;
+    auto orderIs = [](Mgr& mgr, amp::csEffectBase* const* expected, uint8_t count) {
+        if (mgr.size() != count) {
+            return false;
+        }
+        uint8_t i = 0;
+        for (amp::csEffectBase* eff : mgr) {
+            if (eff != expected[i++]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Well past the old cap of 10; handles stay valid while other effects come and go.
+    Mgr mgr;
+    amp::csEffectBase* effs[40];
+    bool indicesOk = true;
+    for (uint8_t i = 0; i < 40; ++i) {
+        effs[i] = new amp::csRenderPlasma();
+        indicesOk = indicesOk && mgr.add(effs[i]) == i;
+    }
+    expect_true(stats, testName, __LINE__, indicesOk && mgr.size() == 40, "add returns index");
+    const Mgr::tEffectHandle h5 = mgr.handle(5);
+    const Mgr::tEffectHandle h20 = mgr.handle(20);
+    mgr.remove(0);
+    mgr.removeHandle(h20);
+    expect_true(stats, testName, __LINE__, mgr.getByHandle(h5) == effs[5] && mgr.get(4) == effs[5],
+                "handle survives removal of other effects");
+    expect_true(stats, testName, __LINE__, mgr.getByHandle(h20) == nullptr && mgr.find(effs[21]) == mgr.handle(19),
+                "removed handle is free, find() by pointer");
+    amp::csEffectBase* expected[40];
+    uint8_t n = 0;
+    for (uint8_t i = 1; i < 40; ++i) {
+        if (i != 20) {
+            expected[n++] = effs[i];
+        }
+    }
+    expect_true(stats, testName, __LINE__, orderIs(mgr, expected, n), "removal keeps render order");
+    auto* last = new amp::csRenderPlasma();
+    const Mgr::tEffectHandle hLast = mgr.addHandle(last);
+    expected[n++] = last;
+    expect_true(stats, testName, __LINE__, hLast == h20 && mgr.get(n - 1) == last && orderIs(mgr, expected, n),
+                "freed slot reused, new effect renders last");
+    csMatrixPixels canvas{8, 8};
+    mgr.setMatrix(canvas);
+    amp::csRandGen rand;
+    mgr.render(rand, 10);
+    expect_true(stats, testName, __LINE__, canvas.getPixel(3, 3).a != 0, "40 effects render");
+
+    // Effect property index: a container referencing an effect added later and one added earlier.
+    Mgr refs;
+    auto* before = new amp::csRenderPlasma();
+    auto* container = new amp::csRenderContainer();
+    auto* after = new amp::csRenderPlasma();
+    auto* late = new amp::csRenderPlasma();
+    container->effects[0] = after;
+    container->effects[1] = before;
+    refs.add(before);
+    const Mgr::tEffectHandle hContainer = refs.addHandle(container);
+    const Mgr::tEffectHandle hAfter = refs.addHandle(after);
+    refs.add(late);
+    refs.deleteSafe(hAfter);
+    expect_true(stats, testName, __LINE__, container->effects[0] == nullptr && container->effects[1] == before,
+                "reference to a later effect cleared");
+    refs.deleteSlowAndSafety(0);
+    expect_true(stats, testName, __LINE__, container->effects[1] == nullptr && refs.size() == 2,
+                "reference to an earlier effect cleared");
+    // Properties assigned after add() (no re-indexing call) are cleared too; changed ones are left alone.
+    container->effects[2] = late;
+    container->effects[3] = late;
+    auto* other = new amp::csRenderPlasma();
+    refs.add(other);
+    container->effects[3] = other;
+    refs.deleteSafe(refs.find(late));
+    expect_true(stats, testName, __LINE__, container->effects[2] == nullptr && container->effects[3] == other,
+                "references assigned after add() cleared, changed ones left alone");
+    refs.deleteSafe(hContainer);
+    refs.deleteSafe(refs.find(other));
+    expect_true(stats, testName, __LINE__, refs.size() == 0 && refs.begin() == refs.end(), "registry empty");
+
+    // Hard limit: handles are one byte.
+    Mgr full;
+    uint16_t added = 0;
+    for (uint16_t i = 0; i < 300; ++i) {
+        auto* eff = new amp::csRenderPlasma();
+        if (full.add(eff) == Mgr::notFound) {
+            delete eff;
+            break;
+        }
+        ++added;
+    }
+    expect_true(stats, testName, __LINE__, added == Mgr::maxEffects && full.findFreeSlot() == Mgr::notFound,
+                "maxEffects effects fit");
+}
+
+class CountingPostFrame : public amp::csRenderPostFrame {
+public:
+    int* calls = nullptr;
+
+    void onFrameDone(csMatrixPixels& /*frame*/, amp::csRandGen& /*rand*/, amp::tTime /*currTime*/) override {
+        ++*calls;
+    }
+};
+
+void test_effect_capabilities(TestStats& stats) {
+    const char* testName = "effect_capabilities";
+    namespace caps = amp::effect_caps;
+    amp::csRenderPlasma plasma;
+    amp::csRenderFlame flame;
+    amp::csRenderRectangle rect;
+    amp::csRenderMatrixCopy copy;
+    CountingPostFrame post;
+    expect_true(stats, testName, __LINE__,
+                plasma.getCapabilities() == (caps::ThreadSafe | caps::MatrixDest | caps::Scalable),
+                "plasma: band-safe scalable matrix effect");
+    expect_true(stats, testName, __LINE__, flame.getCapabilities() == (caps::Stateful | caps::MatrixDest), "flame");
+    expect_true(stats, testName, __LINE__, rect.getCapabilities() == (caps::Static | caps::MatrixDest),
+                "rectangle is static, not stateful");
+    expect_true(stats, testName, __LINE__, copy.getCapabilities() == (caps::MatrixDest | caps::Pipe),
+                "copy is a pipe");
+    expect_true(stats, testName, __LINE__,
+                post.getCapabilities() == (caps::MatrixDest | caps::Pipe | caps::PostFrame),
+                "post-frame family");
+    amp::csRenderSlowFadingOverlay fade;
+    expect_true(stats, testName, __LINE__, (fade.getCapabilities() & caps::Stateful) != 0, "fading trail is stateful");
+
+    // onFrameDone() goes through the cached post-frame list, kept in step with add/remove/set.
+    csMatrixPixels canvas{8, 8};
+    amp::csEffectManager mgr;
+    mgr.setMatrix(canvas);
+    int calls[3] = {0, 0, 0};
+    CountingPostFrame* posts[3];
+    for (int i = 0; i < 3; ++i) {
+        mgr.add(new amp::csRenderPlasma());
+        posts[i] = new CountingPostFrame();
+        posts[i]->calls = &calls[i];
+        mgr.add(posts[i]);
+    }
+    amp::csRandGen rand;
+    mgr.render(rand, 1);
+    mgr.remove(5); // last effect: posts[2]
+    mgr.render(rand, 2);
+    mgr.set(1, new amp::csRenderPlasma()); // posts[0] replaced
+    mgr.render(rand, 3);
+    expect_true(stats, testName, __LINE__, calls[0] == 2 && calls[1] == 3 && calls[2] == 1, "onFrameDone calls");
+    expect_true(stats, testName, __LINE__,
+                mgr.getCapabilities(1) == (caps::ThreadSafe | caps::MatrixDest | caps::Scalable) &&
+                    (mgr.getCapabilities(3) & caps::PostFrame) && mgr.getCapabilities(9) == 0,
+                "capabilities cached per index");
+}
+
+uint32_t gGovernorClock = 0;
+uint32_t gGovernorStepUs = 0;
+
+uint32_t governorMicros() {
+    return gGovernorClock += gGovernorStepUs;
+}
+
+void test_resolution_governor(TestStats& stats) {
+    const char* testName = "resolution_governor";
+    amp::csResolutionGovernor gov;
+    gov.targetFrameUs = 1000;
+    expect_true(stats, testName, __LINE__, !gov.frameDone(2000) && !gov.frameDone(2000) && gov.frameDone(2000) &&
+                                               gov.level() == 1 && gov.divisor() == 2,
+                "down after downFrames slow frames");
+    bool changed = false;
+    for (int i = 0; i < gov.upFrames; ++i) {
+        changed = gov.frameDone(500) || changed;
+    }
+    expect_true(stats, testName, __LINE__, gov.level() == 1 && !changed, "no step up in the margin");
+    for (int i = 0; i < gov.upFrames; ++i) {
+        changed = gov.frameDone(100);
+    }
+    expect_true(stats, testName, __LINE__, changed && gov.level() == 0, "up after upFrames fast frames");
+    for (int i = 0; i < 3; ++i) {
+        gov.frameDone(2000);
+    }
+    for (int i = 0; i < gov.upFrames; ++i) {
+        gov.frameDone(100);
+    }
+    expect_true(stats, testName, __LINE__, gov.level() == 1, "reverted step up doubles the wait");
+    for (int i = 0; i < gov.upFrames; ++i) {
+        gov.frameDone(100);
+    }
+    expect_true(stats, testName, __LINE__, gov.level() == 0, "step up after the doubled wait");
+
+    // Plasma (stateless) renders at 1/2 and is upscaled, flame (stateful) stays at full resolution.
+    constexpr amp::tMatrixPixelsSize cSize = 32;
+    amp::csMatrixSFXSystem full{cSize, cSize};
+    amp::csMatrixSFXSystem low{cSize, cSize};
+    amp::csMatrixSFXSystem flameFull{cSize, cSize};
+    amp::csMatrixSFXSystem flameLow{cSize, cSize};
+    full.effectManager->add(new amp::csRenderPlasma());
+    low.effectManager->add(new amp::csRenderPlasma());
+    flameFull.effectManager->add(new amp::csRenderFlame());
+    flameLow.effectManager->add(new amp::csRenderFlame());
+    low.governor.clock = &governorMicros;
+    flameLow.governor.clock = &governorMicros;
+    low.setFrameBudget(1000);
+    flameLow.setFrameBudget(1000);
+    gGovernorStepUs = 2000; // every frame takes 2 ms of the fake clock
+    for (amp::tTime t = 0; t < 160; t = static_cast<amp::tTime>(t + 16)) {
+        for (amp::csMatrixSFXSystem* sfx : {&full, &low, &flameFull, &flameLow}) {
+            sfx->internalMatrix->clear();
+            sfx->recalcAndRender(t);
+        }
+    }
+    expect_true(stats, testName, __LINE__,
+                low.governor.level() == 2 && low.effectManager->getRenderDivisor() == 4 && low.lowResMatrix &&
+                    low.lowResMatrix->width() == cSize / 4 + 1,
+                "level 2 with a 1/4 scratch");
+    // Compare the last frame at level 2 with full resolution.
+    uint32_t diffSum = 0;
+    bool flameSame = true;
+    bool opaque = true;
+    for (amp::tMatrixPixelsCoord y = 0; y < amp::to_coord(cSize); ++y) {
+        for (amp::tMatrixPixelsCoord x = 0; x < amp::to_coord(cSize); ++x) {
+            const amp::csColorRGBA a = full.internalMatrix->getPixel(x, y);
+            const amp::csColorRGBA b = low.internalMatrix->getPixel(x, y);
+            diffSum += static_cast<uint32_t>(std::abs(a.r - b.r) + std::abs(a.g - b.g) + std::abs(a.b - b.b));
+            opaque = opaque && b.a == 255;
+            flameSame = flameSame && flameFull.internalMatrix->getPixel(x, y).value == flameLow.internalMatrix->getPixel(x, y).value;
+        }
+    }
+    const uint32_t avgDiff = diffSum / (3u * cSize * cSize);
+    expect_true(stats, testName, __LINE__, opaque && avgDiff < 12, "upscaled plasma close to full resolution");
+    expect_true(stats, testName, __LINE__, flameSame, "stateful effect keeps full resolution");
+
+    // Scaled runs: properties stay untouched, only the effect rects are composited (an odd rect and
+    // two disjoint rects in one run), Add stays full resolution.
+    csMatrixPixels fullCanvas{cSize, cSize};
+    csMatrixPixels lowCanvas{cSize, cSize};
+    csMatrixPixels scratch{amp::csEffectManager::scaledSize(cSize, 2), amp::csEffectManager::scaledSize(cSize, 2)};
+    amp::csEffectManager fullMgr;
+    amp::csEffectManager lowMgr;
+    fullMgr.setMatrix(fullCanvas);
+    lowMgr.setMatrix(lowCanvas);
+    lowMgr.setRenderDivisor(2, &scratch);
+    const amp::csRect rects[3] = {amp::csRect{3, 3, 5, 5}, amp::csRect{24, 2, 4, 4}, amp::csRect{16, 16, 8, 8}};
+    amp::csRenderPlasma* plasmas[2] = {nullptr, nullptr};
+    amp::csEffectManager* mgrs[2] = {&fullMgr, &lowMgr};
+    for (int m = 0; m < 2; ++m) {
+        for (int r = 0; r < 3; ++r) {
+            auto* plasma = new amp::csRenderPlasma();
+            plasma->renderRectAutosize = false;
+            plasma->rectDest = rects[r];
+            plasma->scale = amp::csFP16(1.5f);
+            if (r == 2) {
+                plasma->blendMode = amp::csBlendMode::Add;
+            }
+            mgrs[m]->add(plasma);
+            if (r == 0) {
+                plasmas[m] = plasma;
+            }
+        }
+    }
+    const amp::csColorRGBA backdrop{128, 10, 200, 30};
+    for (csMatrixPixels* canvas : {&fullCanvas, &lowCanvas}) {
+        for (amp::tMatrixPixelsCoord y = 0; y < amp::to_coord(cSize); ++y) {
+            canvas->fillPixelsRowRewrite(0, y, cSize, backdrop);
+        }
+    }
+    amp::csRandGen rand;
+    fullMgr.render(rand, 100);
+    lowMgr.render(rand, 100);
+    expect_true(stats, testName, __LINE__,
+                plasmas[1]->matrixDest == &lowCanvas && plasmas[1]->rectDest.x == 3 &&
+                    plasmas[1]->rectDest.width == 5 && plasmas[1]->scale == amp::csFP16(1.5f),
+                "scaled render leaves properties unchanged");
+    auto inRect = [](amp::csRect r, amp::tMatrixPixelsCoord x, amp::tMatrixPixelsCoord y) {
+        return x >= r.x && x < r.x + amp::to_coord(r.width) && y >= r.y && y < r.y + amp::to_coord(r.height);
+    };
+    bool outsideSame = true;
+    bool insideOpaque = true;
+    bool addSame = true;
+    for (amp::tMatrixPixelsCoord y = 0; y < amp::to_coord(cSize); ++y) {
+        for (amp::tMatrixPixelsCoord x = 0; x < amp::to_coord(cSize); ++x) {
+            const amp::csColorRGBA c = lowCanvas.getPixel(x, y);
+            if (inRect(rects[2], x, y)) {
+                addSame = addSame && c.value == fullCanvas.getPixel(x, y).value;
+            } else if (inRect(rects[0], x, y) || inRect(rects[1], x, y)) {
+                insideOpaque = insideOpaque && c.a == 255;
+            } else {
+                outsideSame = outsideSame && c.value == backdrop.value;
+            }
+        }
+    }
+    expect_true(stats, testName, __LINE__, outsideSame, "composite limited to the effect rects");
+    expect_true(stats, testName, __LINE__, insideOpaque, "no fade at the scaled rect edges");
+    expect_true(stats, testName, __LINE__, addSame, "Add blend mode stays at full resolution");
+
+    gGovernorStepUs = 0;
+    low.setFrameBudget(0);
+    expect_true(stats, testName, __LINE__,
+                low.governor.level() == 0 && low.effectManager->getRenderDivisor() == 1 && !low.lowResMatrix,
+                "budget 0 restores full resolution");
+}
+
+#if AMP_ENABLE_PROFILER
+uint32_t gFakeMicros = 0;
+
+uint32_t fakeMicros() {
+    return gFakeMicros += 50;
+}
+
+void test_effect_profiler(TestStats& stats) {
+    const char* testName = "effect_profiler";
+    using amp::csEffectProfile;
+    amp::profiler::setClock(&fakeMicros);
+    csMatrixPixels canvas{8, 8};
+    amp::csEffectManager mgr;
+    mgr.setMatrix(canvas);
+    mgr.add(new amp::csRenderPlasma());
+    int calls = 0;
+    auto* post = new CountingPostFrame();
+    post->calls = &calls;
+    mgr.add(post);
+    expect_true(stats, testName, __LINE__, mgr.getProfile(0) == nullptr, "no profiles while disabled");
+    mgr.setProfiling(true);
+    amp::csRandGen rand;
+    // Every timed call takes 50 us of the fake clock.
+    for (int frame = 0; frame < csEffectProfile::cWindow; ++frame) {
+        mgr.recalc(rand, static_cast<amp::tTime>(frame));
+        mgr.render(rand, static_cast<amp::tTime>(frame));
+    }
+    csEffectProfile* plasma = mgr.getProfile(0);
+    csEffectProfile* postProfile = mgr.getProfile(1);
+    expect_true(stats, testName, __LINE__, plasma && postProfile && plasma->frames == csEffectProfile::cWindow,
+                "one profiled frame per render()");
+    auto prop = [](csEffectProfile* profile, uint8_t propNum, amp::PropType type) -> uint32_t {
+        amp::csPropInfo info;
+        profile->getPropInfo(propNum, info);
+        if (!info.readOnly || info.disabled || info.valueType != type || !info.valuePtr) {
+            return UINT32_MAX;
+        }
+        return (type == amp::PropType::UInt16) ? *static_cast<uint16_t*>(info.valuePtr)
+                                                : *static_cast<uint32_t*>(info.valuePtr);
+    };
+    using amp::PropType;
+    expect_true(stats, testName, __LINE__,
+                prop(plasma, csEffectProfile::propRecalcMin, PropType::UInt32) == 50 &&
+                    prop(plasma, csEffectProfile::propRenderAvg, PropType::UInt32) == 50 &&
+                    prop(plasma, csEffectProfile::propFrameDoneMax, PropType::UInt32) == 0,
+                "plasma min/avg/max as read-only properties");
+    expect_true(stats, testName, __LINE__,
+                prop(postProfile, csEffectProfile::propFrameDoneMin, PropType::UInt32) == 50 &&
+                    prop(postProfile, csEffectProfile::propFrameDoneMax, PropType::UInt32) == 50,
+                "onFrameDone timed");
+    // Frame totals: plasma 100 us (bucket "< 128"), post-frame effect 150 us (bucket "< 256").
+    expect_true(stats, testName, __LINE__,
+                prop(plasma, csEffectProfile::propHistogram + 1, PropType::UInt16) == csEffectProfile::cWindow &&
+                    prop(postProfile, csEffectProfile::propHistogram + 2, PropType::UInt16) ==
+                        csEffectProfile::cWindow &&
+                    prop(plasma, csEffectProfile::propHistogram, PropType::UInt16) == 0,
+                "histogram of frame totals");
+    mgr.setProfiling(false);
+    expect_true(stats, testName, __LINE__, mgr.getProfile(0) == nullptr && calls == csEffectProfile::cWindow,
+                "disabling frees profiles");
+    amp::profiler::setClock(nullptr);
+}
+#endif
+
 int main() {
     TestStats stats;
     test_color_component_ctor(stats);
@@ -865,6 +2845,32 @@ int main() {
     test_matrix_getPixelBlend(stats);
     test_matrix_drawMatrix_clip(stats);
     test_matrix_drawMatrix_basic(stats);
+    test_matrix_getScanLine(stats);
+    test_matrix_utils_spans_match_fallback(stats);
+    test_blend_row_matches_scalar(stats);
+    test_fill_kernels(stats);
+    test_matrix_premul_blend(stats);
+    test_matrix_premul_conversion(stats);
+    test_matrix_utils_typed_sources(stats);
+    test_matrix_tiled_layout(stats);
+    test_mul8_div255_exhaustive(stats);
+    test_matrix_row_alpha(stats);
+    test_matrix_dirty_tiles(stats);
+    test_matrix_views(stats);
+    test_matrix_sub_view(stats);
+    test_matrix_buffer_pool(stats);
+    test_matrix_rgb(stats);
+    test_matrix_pixels16(stats);
+    test_blend_modes(stats);
+    test_effect_manager_parallel(stats);
+    test_effect_graph(stats);
+    test_frame_pipeline(stats);
+    test_effect_registry(stats);
+    test_effect_capabilities(stats);
+    test_resolution_governor(stats);
+#if AMP_ENABLE_PROFILER
+    test_effect_profiler(stats);
+#endif
 
     test_fp16_basic(stats);
     test_fp32_basic(stats);
@@ -897,6 +2903,8 @@ int main() {
     test_matrix_bytes_copy_deep(stats);
     test_matrix_bytes_move(stats);
     test_matrix_bytes_clear_resize(stats);
+    test_matrix_boolean_words(stats);
+    test_byte_row_kernels(stats);
 
     std::cout << "Passed: " << stats.passed << ", Failed: " << stats.failed << '\n';
     if (stats.failed != 0) {